@@ -0,0 +1,37 @@
+// Small Buffer allocation rate, the way protocol parsers allocate: millions of short-lived Buffers under 100 bytes
+// bun alloc-rate.mjs [allocations]
+const count = Number(process.argv[2] || 5_000_000);
+
+const header = "GET /api/v1/items HTTP/1.1";
+const token = "eyJhbGciOiJIUzI1NiJ9.e30";
+const utf16 = "données reçues · 状態";
+
+const cases = {
+  "allocUnsafe(16)": () => Buffer.allocUnsafe(16),
+  "allocUnsafe(64)": () => Buffer.allocUnsafe(64),
+  "allocUnsafe(96)": () => Buffer.allocUnsafe(96),
+  "allocUnsafeSlow(64)": () => Buffer.allocUnsafeSlow(64),
+  "from(latin1 string)": () => Buffer.from(header),
+  "from(utf16 string)": () => Buffer.from(utf16),
+  "from(string, base64)": () => Buffer.from(token, "base64"),
+  "alloc(64)": () => Buffer.alloc(64),
+};
+
+function bench(name, fn) {
+  let sink = 0;
+  for (let i = 0; i < 100_000; i++) sink += fn().length;
+  Bun.gc(true);
+  const start = Bun.nanoseconds();
+  for (let i = 0; i < count; i++) sink += fn().length;
+  const elapsed = Bun.nanoseconds() - start;
+  console.log(`${name.padEnd(22)} ${((count / elapsed) * 1e3).toFixed(2).padStart(7)} M allocs/s  ${(elapsed / count).toFixed(1).padStart(6)} ns/op`);
+  return sink;
+}
+
+console.log(`${count} allocations each, Buffer.poolSize = ${Buffer.poolSize}`);
+for (const [name, fn] of Object.entries(cases)) bench(name, fn);
+
+// The same allocations with the pool turned off, to compare against a fresh backing store per Buffer
+Buffer.poolSize = 0;
+console.log(`\nBuffer.poolSize = 0`);
+for (const name of ["allocUnsafe(64)", "from(latin1 string)"]) bench(name, cases[name]);
@@ -0,0 +1,41 @@
+// Buffer.indexOf / lastIndexOf / includes over a large haystack for needles of 1 to 256 bytes
+// bun index-of.mjs [haystack MB]
+const megabytes = Number(process.argv[2] || 100);
+const length = megabytes * 1024 * 1024;
+
+// Log-like text, so the first and last bytes of a needle turn up often and candidates need verifying
+const line = Buffer.from("2024-05-17T09:12:44.118Z INFO  request handled method=GET path=/api/v1/items status=200\n");
+const haystack = Buffer.alloc(length);
+for (let i = 0; i < length; i += line.length) line.copy(haystack, i);
+const utf16 = Buffer.from(haystack.subarray(0, length / 2).toString("latin1"), "utf16le");
+
+// Built from the line's own bytes so only the final byte keeps it from matching everywhere
+function needleOf(size) {
+  const needle = Buffer.alloc(size);
+  for (let i = 0; i < size; i++) needle[i] = line[(i * 7) % (line.length - 1)];
+  needle[size - 1] = 0x7c;
+  return needle;
+}
+
+function bench(name, bytes, fn) {
+  fn();
+  let best = Infinity;
+  for (let i = 0; i < 5; i++) {
+    const start = Bun.nanoseconds();
+    if (fn() !== -1) throw new Error(name + " should not have matched");
+    best = Math.min(best, Bun.nanoseconds() - start);
+  }
+  console.log(`${name.padEnd(28)} ${(best / 1e6).toFixed(2).padStart(9)} ms  ${(bytes / best).toFixed(2).padStart(6)} GB/s`);
+}
+
+console.log(`${megabytes} MB haystack, best of 5`);
+for (const size of [1, 2, 4, 8, 16, 32, 64, 128, 256]) {
+  const needle = needleOf(size);
+  bench(`indexOf      ${size} bytes`, length, () => haystack.indexOf(needle));
+  bench(`lastIndexOf  ${size} bytes`, length, () => haystack.lastIndexOf(needle));
+  bench(`includes     ${size} bytes`, length, () => (haystack.includes(needle) ? 0 : -1));
+  if (size > 1) {
+    const needle16 = needleOf(size >> 1).toString("latin1");
+    bench(`indexOf ucs2 ${size} bytes`, utf16.length, () => utf16.indexOf(needle16, 0, "ucs2"));
+  }
+}
@@ -0,0 +1,43 @@
+// SHA-256 of many small chunks: createHash() per chunk, hash() per chunk, and hashBatch()
+// bun hash-batch.mjs [chunks] [average chunk size]
+//
+// Chunk sizes vary between half and one and a half times the average, the way content-defined
+// chunking splits files. hashBatch() takes either the chunks or one buffer and their offsets, and
+// returns every digest in one buffer.
+import * as crypto from "node:crypto";
+
+const chunks = Number(process.argv[2] || 1_000_000);
+const averageSize = Number(process.argv[3] || 256);
+
+const offsets = new Uint32Array(chunks + 1);
+for (let i = 0; i < chunks; i++) {
+  offsets[i + 1] = offsets[i] + Math.floor(averageSize / 2 + ((i * 2654435761) % 1024) / 1024 * averageSize);
+}
+const data = new Uint8Array(offsets[chunks]);
+for (let i = 0; i < data.length; i++) data[i] = (i * 31) ^ (i >>> 8);
+const views = Array.from({ length: chunks }, (_, i) => data.subarray(offsets[i], offsets[i + 1]));
+
+function bench(name, hashAll) {
+  const start = performance.now();
+  const digests = hashAll();
+  const elapsed = performance.now() - start;
+  console.log(
+    `${name.padEnd(22)} ${elapsed.toFixed(1).padStart(8)} ms  ${((chunks / elapsed) * 1e3 / 1e6).toFixed(2).padStart(6)} M chunks/s  ${(data.length / elapsed / 1e3).toFixed(0).padStart(6)} MB/s`,
+  );
+  return digests;
+}
+
+console.log(`${chunks} chunks, ${(data.length / 1024 / 1024).toFixed(1)} MiB`);
+const results = [
+  bench("createHash()", () => Buffer.concat(views.map(view => crypto.createHash("sha256").update(view).digest()))),
+];
+if (crypto.hash) {
+  results.push(bench("hash()", () => Buffer.concat(views.map(view => crypto.hash("sha256", view, "buffer")))));
+}
+if (crypto.hashBatch) {
+  results.push(bench("hashBatch(chunks)", () => crypto.hashBatch("sha256", views)));
+  results.push(bench("hashBatch(offsets)", () => crypto.hashBatch("sha256", data, offsets)));
+}
+for (const result of results) {
+  if (!result.equals(results[0])) throw new Error("Digests differ");
+}
@@ -0,0 +1,35 @@
+// Shared client for the hello-world servers: keep-alive fetches from a fixed number of workers.
+const requests = Number(process.argv[2] || 100_000);
+const concurrency = Number(process.argv[3] || 64);
+
+// Roughly what a browser sends: a dozen well-known headers plus a couple of custom ones.
+const headers = {
+  "Accept": "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8",
+  "Accept-Encoding": "gzip, deflate, br",
+  "Accept-Language": "en-US,en;q=0.9",
+  "Cache-Control": "no-cache",
+  "Connection": "keep-alive",
+  "Cookie": "session=4f2a9c; theme=dark",
+  "Pragma": "no-cache",
+  "Referer": "http://localhost/",
+  "Upgrade-Insecure-Requests": "1",
+  "User-Agent": "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36",
+  "X-Request-Id": "b7e0c0de",
+  "X-Forwarded-For": "10.0.0.1",
+};
+
+export async function drive(name, url) {
+  const run = async count => {
+    let next = 0;
+    const worker = async () => {
+      while (next++ < count) await (await fetch(url, { headers })).text();
+    };
+    await Promise.all(Array.from({ length: concurrency }, worker));
+  };
+
+  await run(Math.min(requests, 10_000));
+  const start = performance.now();
+  await run(requests);
+  const elapsed = performance.now() - start;
+  console.log(`${name.padEnd(10)} ${Math.round((requests / elapsed) * 1e3).toLocaleString().padStart(9)} req/s  (${requests} requests, ${concurrency} concurrent)`);
+}
@@ -0,0 +1,15 @@
+// express hello-world throughput, with browser-like request headers
+// bun express.mjs [requests] [concurrency]
+import express from "express";
+import { drive } from "./drive.mjs";
+
+const app = express();
+app.get("/", (req, res) => {
+  res.send("Hello World!");
+});
+
+const server = await new Promise(resolve => {
+  const server = app.listen(0, "127.0.0.1", () => resolve(server));
+});
+await drive("express", `http://127.0.0.1:${server.address().port}/`);
+server.close();
@@ -0,0 +1,13 @@
+// node:http hello-world throughput, with browser-like request headers
+// bun node-http.mjs [requests] [concurrency]
+import { createServer } from "node:http";
+import { drive } from "./drive.mjs";
+
+const server = createServer((req, res) => {
+  res.writeHead(200, { "Content-Type": "text/plain" });
+  res.end("Hello World!");
+});
+
+await new Promise(resolve => server.listen(0, "127.0.0.1", resolve));
+await drive("node:http", `http://127.0.0.1:${server.address().port}/`);
+server.close();
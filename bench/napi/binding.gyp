@@ -0,0 +1,10 @@
+{
+    "targets": [
+        {
+            "target_name": "property_access",
+            "sources": ["property_access.c"],
+            "include_dirs": ["<!@(node -p \"require('node-api-headers').include_dir\")"],
+            "cflags": ["-O2"],
+        }
+    ]
+}
@@ -0,0 +1,26 @@
+// Per-call overhead of N-API property access, for comparing runtimes
+// bun property-access.mjs [calls]
+// node property-access.mjs [calls]
+import { createRequire } from "node:module";
+
+const addon = createRequire(import.meta.url)("./build/Release/property_access.node");
+const count = Number(process.argv[2] || 10_000_000);
+
+const object = { w: 0, x: 1, y: 2, z: 3 };
+const rows = Array.from({ length: 1000 }, (_, i) => ({ id: i, name: `user${i}`, email: `user${i}@example.com` }));
+
+const cases = {
+  "napi_get_undefined": () => addon.getUndefined(count),
+  "napi_get_named_property": () => addon.getNamed(object, count),
+  "napi_set_named_property": () => addon.setNamed(object, count, 42),
+  "napi_has_named_property": () => addon.hasNamed(object, count),
+  "  ...on rows of a shape": () => addon.readRows(rows, count / 3),
+};
+
+for (const [name, run] of Object.entries(cases)) {
+  run();
+  const start = performance.now();
+  run();
+  const elapsed = performance.now() - start;
+  console.log(`${name.padEnd(24)} ${((elapsed * 1e6) / count).toFixed(1).padStart(6)} ns/call`);
+}
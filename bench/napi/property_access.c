@@ -0,0 +1,103 @@
+// Each export runs one N-API call in a loop so the timing is per-call overhead, not JS -> native
+// transitions.
+#include <node_api.h>
+#include <stdint.h>
+
+#define CALL(call)                    \
+  do {                                \
+    if ((call) != napi_ok)            \
+      return NULL;                    \
+  } while (0)
+
+static uint32_t get_count(napi_env env, napi_value value) {
+  uint32_t count = 0;
+  napi_get_value_uint32(env, value, &count);
+  return count;
+}
+
+// getNamed(object, count): object.x
+static napi_value get_named(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2], result;
+  CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  uint32_t count = get_count(env, argv[1]);
+  for (uint32_t i = 0; i < count;) {
+    // Bounds the handles a long run leaves behind without timing a scope per call.
+    napi_handle_scope scope;
+    CALL(napi_open_handle_scope(env, &scope));
+    for (uint32_t end = i + 4096 < count ? i + 4096 : count; i < end; i++)
+      CALL(napi_get_named_property(env, argv[0], "x", &result));
+    CALL(napi_close_handle_scope(env, scope));
+  }
+  return NULL;
+}
+
+// setNamed(object, count, value): object.x = value
+static napi_value set_named(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value argv[3];
+  CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  uint32_t count = get_count(env, argv[1]);
+  for (uint32_t i = 0; i < count; i++)
+    CALL(napi_set_named_property(env, argv[0], "x", argv[2]));
+  return NULL;
+}
+
+// hasNamed(object, count): "x" in object
+static napi_value has_named(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2], result;
+  bool has = false;
+  CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  uint32_t count = get_count(env, argv[1]);
+  for (uint32_t i = 0; i < count; i++)
+    CALL(napi_has_named_property(env, argv[0], "x", &has));
+  CALL(napi_get_boolean(env, has, &result));
+  return result;
+}
+
+// readRows(rows, count): row.id, row.name and row.email for every row, the way a driver reads
+// results back out of objects of one shape.
+static napi_value read_rows(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2], row, value;
+  uint32_t length;
+  CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  CALL(napi_get_array_length(env, argv[0], &length));
+  uint32_t count = get_count(env, argv[1]);
+  for (uint32_t i = 0; i < count; i++) {
+    napi_handle_scope scope;
+    CALL(napi_open_handle_scope(env, &scope));
+    CALL(napi_get_element(env, argv[0], i % length, &row));
+    CALL(napi_get_named_property(env, row, "id", &value));
+    CALL(napi_get_named_property(env, row, "name", &value));
+    CALL(napi_get_named_property(env, row, "email", &value));
+    CALL(napi_close_handle_scope(env, scope));
+  }
+  return NULL;
+}
+
+// getUndefined(count): the floor, a call that touches no object
+static napi_value get_undefined(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1], result = NULL;
+  CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  uint32_t count = get_count(env, argv[0]);
+  for (uint32_t i = 0; i < count; i++)
+    CALL(napi_get_undefined(env, &result));
+  return result;
+}
+
+static napi_value init(napi_env env, napi_value exports) {
+  napi_property_descriptor properties[] = {
+      {"getNamed", NULL, get_named, NULL, NULL, NULL, napi_default, NULL},
+      {"setNamed", NULL, set_named, NULL, NULL, NULL, napi_default, NULL},
+      {"hasNamed", NULL, has_named, NULL, NULL, NULL, napi_default, NULL},
+      {"readRows", NULL, read_rows, NULL, NULL, NULL, napi_default, NULL},
+      {"getUndefined", NULL, get_undefined, NULL, NULL, NULL, napi_default, NULL},
+  };
+  CALL(napi_define_properties(env, exports, sizeof(properties) / sizeof(properties[0]), properties));
+  return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)
@@ -0,0 +1,68 @@
+// Aggregating a large result set with .all(), .values() and .columnar()
+// bun columnar.js [rows]
+import { Database } from "bun:sqlite";
+
+const rows = Number(process.argv[2] || 500_000);
+const db = new Database(":memory:");
+db.exec("CREATE TABLE events (id INTEGER PRIMARY KEY, user_id INTEGER, amount REAL, country TEXT)");
+
+const countries = ["SE", "US", "DE", "JP", "BR", "IN", "FR", "GB"];
+const insert = db.prepare("INSERT INTO events (user_id, amount, country) VALUES (?, ?, ?)");
+db.transaction(() => {
+  for (let i = 0; i < rows; i++) {
+    insert.run(i % 9973, (i % 1000) / 10, countries[i % countries.length]);
+  }
+})();
+
+const query = db.prepare("SELECT id, user_id, amount, country FROM events");
+
+function viaAll() {
+  let total = 0;
+  let se = 0;
+  for (const row of query.all()) {
+    total += row.amount;
+    if (row.country === "SE") se++;
+  }
+  return total + se;
+}
+
+function viaValues() {
+  let total = 0;
+  let se = 0;
+  for (const row of query.values()) {
+    total += row[2];
+    if (row[3] === "SE") se++;
+  }
+  return total + se;
+}
+
+function viaColumnar() {
+  const [, , amount, country] = query.columnar();
+  let total = 0;
+  for (const value of amount.values) total += value;
+
+  // Compare the UTF-8 bytes in place rather than decoding a string per row
+  const { offsets, bytes } = country;
+  let se = 0;
+  for (let i = 0; i + 1 < offsets.length; i++) {
+    const start = offsets[i];
+    if (offsets[i + 1] - start === 2 && bytes[start] === 0x53 && bytes[start + 1] === 0x45) se++;
+  }
+  return total + se;
+}
+
+function bench(name, fn) {
+  const expected = fn();
+  let best = Infinity;
+  for (let i = 0; i < 10; i++) {
+    const start = Bun.nanoseconds();
+    if (fn() !== expected) throw new Error(name + " returned a different result");
+    best = Math.min(best, Bun.nanoseconds() - start);
+  }
+  console.log(`${name.padEnd(12)} ${(best / 1e6).toFixed(1).padStart(8)} ms  ${((rows / best) * 1e3).toFixed(2)} M rows/s`);
+  return expected;
+}
+
+console.log(`${rows} rows, best of 10`);
+const results = [bench(".all()", viaAll), bench(".values()", viaValues), bench(".columnar()", viaColumnar)];
+if (new Set(results).size !== 1) throw new Error("Results differ: " + results.join(", "));
@@ -0,0 +1,46 @@
+// Bulk inserting rows with run() in a transaction, runMany(rows) and runMany({ columns })
+// bun run-many.js [rows]
+import { Database } from "bun:sqlite";
+
+const rows = Number(process.argv[2] || 1_000_000);
+const countries = ["SE", "US", "DE", "JP", "BR", "IN", "FR", "GB"];
+
+// The same data in both shapes, built up front so only the insert is timed
+const userIds = new Int32Array(rows);
+const amounts = new Float64Array(rows);
+const countryColumn = new Array(rows);
+const rowArrays = new Array(rows);
+for (let i = 0; i < rows; i++) {
+  userIds[i] = i % 9973;
+  amounts[i] = (i % 1000) / 10;
+  countryColumn[i] = countries[i % countries.length];
+  rowArrays[i] = [userIds[i], amounts[i], countryColumn[i]];
+}
+
+function bench(name, insertAll) {
+  const db = new Database(":memory:");
+  db.exec("CREATE TABLE events (id INTEGER PRIMARY KEY, user_id INTEGER, amount REAL, country TEXT)");
+  const insert = db.prepare("INSERT INTO events (user_id, amount, country) VALUES (?, ?, ?)");
+
+  const start = Bun.nanoseconds();
+  insertAll(db, insert);
+  const elapsed = Bun.nanoseconds() - start;
+
+  const { count, total } = db.query("SELECT count(*) AS count, sum(amount) AS total FROM events").get();
+  if (count !== rows) throw new Error(`${name} inserted ${count} rows, expected ${rows}`);
+  console.log(`${name.padEnd(20)} ${(elapsed / 1e6).toFixed(1).padStart(8)} ms  ${((rows / elapsed) * 1e3).toFixed(2)} M rows/s`);
+  db.close();
+  return total;
+}
+
+console.log(`${rows} rows`);
+const results = [
+  bench("run() in transaction", (db, insert) =>
+    db.transaction(() => {
+      for (let i = 0; i < rows; i++) insert.run(rowArrays[i]);
+    })(),
+  ),
+  bench("runMany(rows)", (db, insert) => insert.runMany(rowArrays)),
+  bench("runMany({ columns })", (db, insert) => insert.runMany({ columns: [userIds, amounts, countryColumn] })),
+];
+if (new Set(results).size !== 1) throw new Error("Results differ: " + results.join(", "));
@@ -0,0 +1,50 @@
+// Preparing ORM-style queries that only differ in layout, against queries that never repeat
+// bun statement-cache.js [iterations]
+import { Database } from "bun:sqlite";
+
+const iterations = Number(process.argv[2] || 100_000);
+const db = new Database(":memory:");
+db.exec(`CREATE TABLE users (
+  id INTEGER PRIMARY KEY, email TEXT NOT NULL, name TEXT, team_id INTEGER, created_at INTEGER, deleted_at INTEGER
+)`);
+db.exec("CREATE INDEX users_team ON users (team_id, created_at)");
+for (let i = 0; i < 1000; i++) {
+  db.run("INSERT INTO users (email, name, team_id, created_at) VALUES (?, ?, ?, ?)", [`u${i}@example.com`, `User ${i}`, i % 17, i]);
+}
+
+// What a query builder emits for the same query depending on which branches it took
+const layouts = [
+  `SELECT id, email, name FROM users WHERE team_id = ? AND deleted_at IS NULL ORDER BY created_at DESC LIMIT ?`,
+  `SELECT id, email, name\n  FROM users\n  WHERE team_id = ?\n    AND deleted_at IS NULL\n  ORDER BY created_at DESC\n  LIMIT ?;`,
+  `SELECT id , email , name FROM users WHERE ( team_id = ? ) AND deleted_at IS NULL ORDER BY created_at DESC LIMIT ? -- list`,
+  `/* users.list */ SELECT id,email,name FROM users WHERE (team_id = ?) AND deleted_at IS NULL ORDER BY created_at DESC LIMIT ?`,
+];
+
+function prepareAndRun(sql, team) {
+  const stmt = db.prepare(sql);
+  const rows = stmt.all(team, 10);
+  stmt.finalize();
+  return rows.length;
+}
+
+function bench(name, sqlFor) {
+  let rows = 0;
+  const start = Bun.nanoseconds();
+  for (let i = 0; i < iterations; i++) {
+    rows += prepareAndRun(sqlFor(i), i % 17);
+  }
+  const elapsed = Bun.nanoseconds() - start;
+  console.log(`${name.padEnd(16)} ${(elapsed / iterations / 1e3).toFixed(2).padStart(7)} us/query`);
+  return rows;
+}
+
+console.log(`${iterations} x prepare, all, finalize`);
+
+db.setStatementCacheSize(0);
+const uncached = bench("cache off", i => layouts[i % layouts.length]);
+
+db.setStatementCacheSize(64);
+const cached = bench("cache on", i => layouts[i % layouts.length]);
+
+if (cached !== uncached) throw new Error(`Results differ: ${uncached} vs ${cached}`);
+console.log(db.statementCacheStats());
@@ -0,0 +1,67 @@
+// Startup time of an app with thousands of modules, with and without the bytecode cache
+// bun cold-start.mjs [modules] [runs]
+//
+// Generates a synthetic app (half ESM, half CommonJS, each module a few dozen functions) and times
+// a process that imports all of it: once with no cache, once populating BUN_BYTECODE_CACHE_PATH,
+// then with every module served from the cache.
+import { mkdtempSync, mkdirSync, rmSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+
+const moduleCount = Number(process.argv[2] || 3000);
+const runs = Number(process.argv[3] || 5);
+
+const root = mkdtempSync(join(tmpdir(), "bun-cold-start-"));
+const app = join(root, "app");
+const cache = join(root, "cache");
+mkdirSync(join(app, "lib"), { recursive: true });
+
+function body(i) {
+  let code = "";
+  for (let f = 0; f < 30; f++) {
+    code += `function f${f}(items, options = {}) {
+  const out = [];
+  for (const item of items) {
+    if (item == null || (options.skip && options.skip.includes(item.id))) continue;
+    out.push({ id: item.id ?? ${i * 100 + f}, name: String(item.name).trim(), tags: [...(item.tags || [])].sort() });
+  }
+  return out.length > ${f} ? out.slice(0, ${f}) : out;
+}
+`;
+  }
+  return code;
+}
+
+let index = "";
+for (let i = 0; i < moduleCount; i++) {
+  if (i % 2) {
+    writeFileSync(join(app, "lib", `m${i}.cjs`), `${body(i)}module.exports = { ${Array.from({ length: 30 }, (_, f) => `f${f}`)} };\n`);
+    index += `import m${i} from "./lib/m${i}.cjs";\n`;
+  } else {
+    writeFileSync(join(app, "lib", `m${i}.mjs`), `${body(i)}export { ${Array.from({ length: 30 }, (_, f) => `f${f}`)} };\n`);
+    index += `import * as m${i} from "./lib/m${i}.mjs";\n`;
+  }
+}
+index += `globalThis.sink = [${Array.from({ length: moduleCount }, (_, i) => `m${i}.f0`)}].length;\n`;
+writeFileSync(join(app, "index.mjs"), index);
+
+function start(env) {
+  const begin = performance.now();
+  const { exitCode, stderr } = Bun.spawnSync([process.execPath, join(app, "index.mjs")], { env: { ...process.env, ...env } });
+  if (exitCode !== 0) throw new Error(stderr.toString());
+  return performance.now() - begin;
+}
+
+function report(name, env) {
+  const times = Array.from({ length: runs }, () => start(env)).sort((a, b) => a - b);
+  console.log(`${name.padEnd(20)} ${times[times.length >> 1].toFixed(1).padStart(8)} ms (median of ${runs})`);
+}
+
+// The transpiler cache is shared by all three, so only bytecode generation differs.
+start({});
+report("no bytecode cache", { BUN_BYTECODE_CACHE_PATH: "" });
+const populate = start({ BUN_BYTECODE_CACHE_PATH: cache });
+console.log(`${"populating cache".padEnd(20)} ${populate.toFixed(1).padStart(8)} ms`);
+report("bytecode cache hit", { BUN_BYTECODE_CACHE_PATH: cache });
+
+rmSync(root, { recursive: true, force: true });
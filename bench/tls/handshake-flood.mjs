@@ -0,0 +1,107 @@
+// Request latency on established TLS connections while new clients flood the server with handshakes
+// bun handshake-flood.mjs [seconds per run] [flood concurrency] [established connections]
+//
+// The server uses an RSA 4096 key so each handshake's signature is expensive. It runs once with
+// the signing on the event loop and once with BUN_TLS_HANDSHAKE_THREADS=4, and each time p50/p99
+// of requests on already open connections is measured with and without the flood.
+import { mkdtempSync, readFileSync, rmSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { connect } from "node:tls";
+
+const mode = process.argv[2];
+
+if (mode === "--server") {
+  const dir = process.argv[3];
+  const server = Bun.serve({
+    port: 0,
+    tls: { cert: readFileSync(join(dir, "cert.pem"), "utf8"), key: readFileSync(join(dir, "key.pem"), "utf8") },
+    fetch: () => new Response("ok"),
+  });
+  console.log(server.port);
+} else if (mode === "--flood") {
+  const port = Number(process.argv[3]);
+  const concurrency = Number(process.argv[4]);
+  const handshake = () =>
+    new Promise(resolve => {
+      const socket = connect({ host: "127.0.0.1", port, servername: "localhost", rejectUnauthorized: false });
+      socket.once("secureConnect", () => socket.destroy());
+      socket.once("close", resolve);
+      socket.once("error", () => {});
+    });
+  for (let i = 0; i < concurrency; i++) {
+    (async () => {
+      while (true) await handshake();
+    })();
+  }
+} else {
+  const seconds = Number(process.argv[2] || 5);
+  const floodConcurrency = Number(process.argv[3] || 256);
+  const established = Number(process.argv[4] || 32);
+
+  const dir = mkdtempSync(join(tmpdir(), "bun-handshake-flood-"));
+  const { exitCode, stderr } = Bun.spawnSync(
+    ["openssl", "req", "-x509", "-newkey", "rsa:4096", "-nodes", "-days", "1"]
+      .concat(["-subj", "/CN=localhost", "-keyout", join(dir, "key.pem"), "-out", join(dir, "cert.pem")]),
+  );
+  if (exitCode !== 0) throw new Error(stderr.toString());
+
+  function percentile(sorted, p) {
+    return sorted[Math.min(sorted.length - 1, Math.floor((sorted.length * p) / 100))];
+  }
+
+  async function measure(url) {
+    const latencies = [];
+    const deadline = performance.now() + seconds * 1000;
+    await Promise.all(
+      Array.from({ length: established }, async () => {
+        while (performance.now() < deadline) {
+          const begin = performance.now();
+          await (await fetch(url, { tls: { rejectUnauthorized: false } })).text();
+          latencies.push(performance.now() - begin);
+        }
+      }),
+    );
+    return latencies.sort((a, b) => a - b);
+  }
+
+  async function run(name, env) {
+    const server = Bun.spawn([process.execPath, import.meta.path, "--server", dir], {
+      env: { ...process.env, ...env },
+      stdout: "pipe",
+      stderr: "inherit",
+    });
+    const { value } = await server.stdout.getReader().read();
+    const port = Number(new TextDecoder().decode(value));
+    const url = `https://localhost:${port}/`;
+
+    // Open the established connections before anything else
+    await measure(url);
+    for (const flood of [false, true]) {
+      const flooder = flood
+        ? Bun.spawn([process.execPath, import.meta.path, "--flood", String(port), String(floodConcurrency)], {
+            stdout: "ignore",
+            stderr: "ignore",
+          })
+        : null;
+      if (flooder) await Bun.sleep(500);
+      const latencies = await measure(url);
+      flooder?.kill();
+      await flooder?.exited;
+      console.log(
+        `${name.padEnd(16)} ${(flood ? "flood" : "idle").padEnd(6)} ` +
+          `p50 ${percentile(latencies, 50).toFixed(2).padStart(8)} ms  ` +
+          `p99 ${percentile(latencies, 99).toFixed(2).padStart(8)} ms  (${latencies.length} requests)`,
+      );
+    }
+    server.kill();
+    await server.exited;
+  }
+
+  try {
+    await run("event loop", {});
+    await run("handshake pool", { BUN_TLS_HANDSHAKE_THREADS: "4" });
+  } finally {
+    rmSync(dir, { recursive: true, force: true });
+  }
+}
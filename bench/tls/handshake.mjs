@@ -0,0 +1,103 @@
+// Full vs resumed TLS handshakes per second against a reusePort group of server processes
+// bun handshake.mjs [processes] [seconds per run] [concurrency]
+//
+// Each process has its own SSL_CTX, so by default a resumption attempt only succeeds when it lands
+// on the process that issued the ticket. With BUN_TLS_TICKET_KEYS_FILE every process encrypts
+// tickets with the same keys and any of them can resume.
+import { randomBytes } from "node:crypto";
+import { mkdtempSync, readFileSync, rmSync, writeFileSync } from "node:fs";
+import { createServer } from "node:net";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { connect } from "node:tls";
+
+if (process.argv[2] === "--server") {
+  const [, , , dir, port] = process.argv;
+  Bun.serve({
+    port: Number(port),
+    reusePort: true,
+    tls: { cert: readFileSync(join(dir, "cert.pem"), "utf8"), key: readFileSync(join(dir, "key.pem"), "utf8") },
+    fetch: () => new Response("ok"),
+  });
+  console.log("ready");
+} else {
+  const processes = Number(process.argv[2] || 8);
+  const seconds = Number(process.argv[3] || 5);
+  const concurrency = Number(process.argv[4] || 16);
+
+  const dir = mkdtempSync(join(tmpdir(), "bun-handshake-"));
+  const { exitCode, stderr } = Bun.spawnSync(
+    ["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1", "-nodes", "-days", "1"]
+      .concat(["-subj", "/CN=localhost", "-keyout", join(dir, "key.pem"), "-out", join(dir, "cert.pem")]),
+  );
+  if (exitCode !== 0) throw new Error(stderr.toString());
+  writeFileSync(join(dir, "ticket-keys"), randomBytes(48));
+
+  const port = await new Promise(resolve => {
+    const probe = createServer().listen(0, "127.0.0.1", () => {
+      const { port } = probe.address();
+      probe.close(() => resolve(port));
+    });
+  });
+
+  function handshake(session) {
+    return new Promise((resolve, reject) => {
+      const socket = connect({ host: "127.0.0.1", port, servername: "localhost", rejectUnauthorized: false, session });
+      socket.once("error", reject);
+      if (session) {
+        socket.once("secureConnect", () => {
+          const reused = socket.isSessionReused();
+          socket.destroy();
+          resolve({ reused });
+        });
+      } else {
+        // TLS 1.3 tickets arrive after the handshake
+        socket.once("session", ticket => {
+          socket.destroy();
+          resolve({ reused: false, ticket });
+        });
+      }
+    });
+  }
+
+  async function run(name, env, resume) {
+    const servers = Array.from({ length: processes }, () =>
+      Bun.spawn([process.execPath, import.meta.path, "--server", dir, String(port)], {
+        env: { ...process.env, ...env },
+        stdout: "pipe",
+        stderr: "inherit",
+      }),
+    );
+    for (const server of servers) await server.stdout.getReader().read();
+
+    // One ticket per client loop, taken from whichever process that loop first reached
+    const tickets = await Promise.all(Array.from({ length: concurrency }, () => handshake().then(r => r.ticket)));
+    let total = 0;
+    let reused = 0;
+    const deadline = performance.now() + seconds * 1000;
+    await Promise.all(
+      tickets.map(async ticket => {
+        while (performance.now() < deadline) {
+          const result = await handshake(resume ? ticket : undefined);
+          total++;
+          if (result.reused) reused++;
+        }
+      }),
+    );
+    for (const server of servers) server.kill();
+    await Promise.all(servers.map(server => server.exited));
+
+    console.log(
+      `${name.padEnd(24)} ${(total / seconds).toFixed(0).padStart(7)} handshakes/s  ` +
+        `${((100 * reused) / total).toFixed(1).padStart(5)}% resumed`,
+    );
+  }
+
+  try {
+    await run("full", {}, false);
+    await run("resume, own keys", {}, true);
+    await run("resume, shared keys", { BUN_TLS_TICKET_KEYS_FILE: join(dir, "ticket-keys") }, true);
+  } finally {
+    rmSync(dir, { recursive: true, force: true });
+  }
+}
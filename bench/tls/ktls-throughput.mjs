@@ -0,0 +1,76 @@
+// HTTPS download throughput and server CPU per GB, with and without kernel TLS (Linux only)
+// bun ktls-throughput.mjs [total MB] [response MB]
+//
+// Starts a Bun.serve HTTPS server in a child process, once as is and once with
+// BUN_FEATURE_FLAG_KTLS=1, and downloads the same bytes from each. With kTLS the server's
+// writes are encrypted by the kernel, so the CPU the server process spends per GB is the number
+// to compare; it reads its own process.cpuUsage() so the client's decryption is not counted.
+import { mkdtempSync, readFileSync, rmSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+
+if (process.argv[2] === "--server") {
+  const [, , , dir, responseMB] = process.argv;
+  const body = new Uint8Array(Number(responseMB) * 1024 * 1024).fill(97);
+  const server = Bun.serve({
+    port: 0,
+    tls: { cert: readFileSync(join(dir, "cert.pem"), "utf8"), key: readFileSync(join(dir, "key.pem"), "utf8") },
+    fetch(req) {
+      if (new URL(req.url).pathname === "/cpu") return Response.json(process.cpuUsage());
+      return new Response(body);
+    },
+  });
+  console.log(server.port);
+} else {
+  const totalMB = Number(process.argv[2] || 4096);
+  const responseMB = Number(process.argv[3] || 64);
+  const requests = Math.max(1, Math.round(totalMB / responseMB));
+
+  const dir = mkdtempSync(join(tmpdir(), "bun-ktls-"));
+  const { exitCode, stderr } = Bun.spawnSync(
+    ["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1", "-nodes", "-days", "1"]
+      .concat(["-subj", "/CN=localhost", "-keyout", join(dir, "key.pem"), "-out", join(dir, "cert.pem")]),
+  );
+  if (exitCode !== 0) throw new Error(stderr.toString());
+
+  async function run(name, env) {
+    const server = Bun.spawn([process.execPath, import.meta.path, "--server", dir, String(responseMB)], {
+      env: { ...process.env, ...env },
+      stdout: "pipe",
+      stderr: "inherit",
+    });
+    const reader = server.stdout.getReader();
+    const { value } = await reader.read();
+    const base = `https://localhost:${Number(new TextDecoder().decode(value))}`;
+    const tls = { rejectUnauthorized: false };
+    const cpu = async () => (await fetch(`${base}/cpu`, { tls })).json();
+
+    // One warm-up request so connection setup and allocation are not measured
+    await (await fetch(base, { tls })).arrayBuffer();
+    const before = await cpu();
+    const begin = performance.now();
+    let bytes = 0;
+    for (let i = 0; i < requests; i++) {
+      for await (const chunk of (await fetch(base, { tls })).body) bytes += chunk.byteLength;
+    }
+    const seconds = (performance.now() - begin) / 1000;
+    const after = await cpu();
+    server.kill();
+    await server.exited;
+
+    const gb = bytes / 1024 ** 3;
+    const cpuMs = (after.user - before.user + after.system - before.system) / 1000;
+    console.log(
+      `${name.padEnd(10)} ${((bytes / 1024 ** 2) / seconds).toFixed(0).padStart(6)} MB/s  ` +
+        `server ${(cpuMs / gb).toFixed(0).padStart(6)} ms CPU/GB ` +
+        `(user ${((after.user - before.user) / 1000 / gb).toFixed(0)}, sys ${((after.system - before.system) / 1000 / gb).toFixed(0)})`,
+    );
+  }
+
+  try {
+    await run("userspace", { BUN_FEATURE_FLAG_KTLS: "0" });
+    await run("ktls", { BUN_FEATURE_FLAG_KTLS: "1" });
+  } finally {
+    rmSync(dir, { recursive: true, force: true });
+  }
+}
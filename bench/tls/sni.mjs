@@ -0,0 +1,66 @@
+// SNI lookups with many server names: startup time and handshakes per second by name
+// bun sni.mjs [names] [seconds] [concurrency]
+//
+// Every name shares one certificate, so the handshake cost is the same whichever name is picked
+// and the difference between runs is the server name lookup. A tenth of the names are only
+// reachable through a "*.zoneN.test" wildcard.
+import { mkdtempSync, readFileSync, rmSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { connect } from "node:tls";
+
+const count = Number(process.argv[2] || 20000);
+const seconds = Number(process.argv[3] || 5);
+const concurrency = Number(process.argv[4] || 16);
+const zones = 100;
+
+const dir = mkdtempSync(join(tmpdir(), "bun-sni-"));
+const { exitCode, stderr } = Bun.spawnSync(
+  ["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1", "-nodes", "-days", "1"]
+    .concat(["-subj", "/CN=localhost", "-keyout", join(dir, "key.pem"), "-out", join(dir, "cert.pem")]),
+);
+if (exitCode !== 0) throw new Error(stderr.toString());
+const cert = readFileSync(join(dir, "cert.pem"), "utf8");
+const key = readFileSync(join(dir, "key.pem"), "utf8");
+rmSync(dir, { recursive: true });
+
+const exact = Array.from({ length: count }, (_, i) => `host${i}.zone${i % zones}.test`);
+const tls = [{ cert, key }]
+  .concat(exact.map(serverName => ({ serverName, cert, key })))
+  .concat(Array.from({ length: zones }, (_, i) => ({ serverName: `*.zone${i}.test`, cert, key })));
+
+const start = performance.now();
+const server = Bun.serve({ port: 0, tls, fetch: () => new Response("ok") });
+console.log(`${count} names + ${zones} wildcards: listening after ${(performance.now() - start).toFixed(0)} ms`);
+
+function handshake(servername) {
+  return new Promise((resolve, reject) => {
+    const socket = connect({ host: "127.0.0.1", port: server.port, servername, rejectUnauthorized: false });
+    socket.once("error", reject);
+    socket.once("secureConnect", () => {
+      socket.destroy();
+      resolve();
+    });
+  });
+}
+
+async function run(label, pick) {
+  let done = 0;
+  const end = performance.now() + seconds * 1000;
+  await Promise.all(
+    Array.from({ length: concurrency }, async () => {
+      while (performance.now() < end) {
+        await handshake(pick());
+        done++;
+      }
+    }),
+  );
+  console.log(`${label.padEnd(10)} ${(done / seconds).toFixed(0)} handshakes/s`);
+}
+
+const random = n => Math.floor(Math.random() * n);
+await run("exact", () => exact[random(count)]);
+await run("wildcard", () => `other${random(count)}.zone${random(zones)}.test`);
+await run("missing", () => `host${random(count)}.nowhere.test`);
+
+server.stop(true);
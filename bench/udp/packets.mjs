@@ -0,0 +1,54 @@
+// Loopback UDP packets per second with Bun.udpSocket
+// bun packets.mjs [payload bytes] [batch size] [seconds]
+//
+// The sender queues batches of equal sized datagrams with sendMany, which on Linux go out as one
+// UDP_SEGMENT (GSO) send per run of up to 64, and counts what the receiver got back. Compare
+// against a payload size over 1452 bytes, which is never segmented.
+const size = Number(process.argv[2] || 1200);
+const batch = Number(process.argv[3] || 256);
+const seconds = Number(process.argv[4] || 5);
+
+let received = 0;
+let bytes = 0;
+const receiver = await Bun.udpSocket({
+  hostname: "127.0.0.1",
+  socket: {
+    data(socket, data) {
+      received++;
+      bytes += data.byteLength;
+    },
+  },
+});
+
+let drained = () => {};
+const sender = await Bun.udpSocket({
+  hostname: "127.0.0.1",
+  connect: { hostname: "127.0.0.1", port: receiver.port },
+  socket: {
+    drain() {
+      drained();
+    },
+  },
+});
+
+const payload = new Uint8Array(size).fill(42);
+const packets = Array(batch).fill(payload);
+
+let sent = 0;
+let batches = 0;
+const end = performance.now() + seconds * 1000;
+while (performance.now() < end) {
+  const count = sender.sendMany(packets);
+  sent += count;
+  if (count < batch) await new Promise(resolve => (drained = resolve));
+  // Let the receiver run
+  else if (++batches % 16 === 0) await new Promise(resolve => setImmediate(resolve));
+}
+await Bun.sleep(100);
+
+console.log(`${size} byte datagrams, batches of ${batch}`);
+console.log(`sent     ${(sent / seconds).toFixed(0)} packets/s`);
+console.log(`received ${(received / seconds).toFixed(0)} packets/s, ${((bytes * 8) / seconds / 1e9).toFixed(2)} Gbit/s`);
+
+sender.close();
+receiver.close();
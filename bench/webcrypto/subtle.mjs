@@ -0,0 +1,52 @@
+// crypto.subtle operations per second as the number of operations in flight grows
+// bun subtle.mjs [seconds per run]
+//
+// Small HMAC, AES-GCM and SHA-256 inputs (a JWT, a wrapped data key) are computed on the calling
+// thread; large inputs and asymmetric keys go to the work pool, so those should scale with
+// concurrency up to the number of cores.
+const seconds = Number(process.argv[2] || 1);
+const { subtle } = globalThis.crypto;
+
+const jwt = new TextEncoder().encode("eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9." + "e".repeat(180));
+const dataKey = crypto.getRandomValues(new Uint8Array(32));
+const large = new Uint8Array(256 * 1024).fill(7);
+const iv = crypto.getRandomValues(new Uint8Array(12));
+
+const hmacKey = await subtle.importKey("raw", crypto.getRandomValues(new Uint8Array(32)), { name: "HMAC", hash: "SHA-256" }, false, ["sign", "verify"]);
+const hmacSignature = await subtle.sign("HMAC", hmacKey, jwt);
+const aesKey = await subtle.generateKey({ name: "AES-GCM", length: 256 }, false, ["encrypt", "decrypt"]);
+const ecKeys = await subtle.generateKey({ name: "ECDSA", namedCurve: "P-256" }, false, ["sign", "verify"]);
+const ecSignature = await subtle.sign({ name: "ECDSA", hash: "SHA-256" }, ecKeys.privateKey, jwt);
+
+const cases = {
+  "HMAC verify, JWT": () => subtle.verify("HMAC", hmacKey, hmacSignature, jwt),
+  "AES-GCM encrypt, 32 B": () => subtle.encrypt({ name: "AES-GCM", iv }, aesKey, dataKey),
+  "SHA-256, 32 B": () => subtle.digest("SHA-256", dataKey),
+  "SHA-256, 256 KiB": () => subtle.digest("SHA-256", large),
+  "AES-GCM encrypt, 256 KiB": () => subtle.encrypt({ name: "AES-GCM", iv }, aesKey, large),
+  "ECDSA P-256 verify": () => subtle.verify({ name: "ECDSA", hash: "SHA-256" }, ecKeys.publicKey, ecSignature, jwt),
+};
+
+async function run(operation, concurrency) {
+  let done = 0;
+  const end = performance.now() + seconds * 1000;
+  await Promise.all(
+    Array.from({ length: concurrency }, async () => {
+      while (performance.now() < end) {
+        await operation();
+        done++;
+      }
+    }),
+  );
+  return done / seconds;
+}
+
+const concurrencies = [1, 4, 16, 64, 256];
+console.log(["operation".padEnd(26)].concat(concurrencies.map(c => `${c} in flight`.padStart(14))).join(""));
+for (const [name, operation] of Object.entries(cases)) {
+  const row = [name.padEnd(26)];
+  for (const concurrency of concurrencies) {
+    row.push(`${(await run(operation, concurrency)).toFixed(0)}/s`.padStart(14));
+  }
+  console.log(row.join(""));
+}
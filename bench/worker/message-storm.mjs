@@ -0,0 +1,73 @@
+// Many workers posting to the main thread at once, then the main thread posting to all of them
+// bun message-storm.mjs [workers] [messages per worker]
+if (!Bun.isMainThread) {
+  let received = 0;
+  let expected = 0;
+  self.onmessage = ({ data }) => {
+    if (data.storm) {
+      for (let i = 0; i < data.storm; i++) postMessage(i);
+      return;
+    }
+    if (data.expect) {
+      expected = data.expect;
+      received = 0;
+      return;
+    }
+    if (++received === expected) postMessage("done");
+  };
+} else {
+  const workerCount = Number(process.argv[2] || 32);
+  const messages = Number(process.argv[3] || 20_000);
+
+  const workers = await Promise.all(
+    Array.from({ length: workerCount }, () => {
+      const worker = new Worker(new URL(import.meta.url));
+      return new Promise(resolve => worker.addEventListener("open", () => resolve(worker), { once: true }));
+    }),
+  );
+
+  function inbound() {
+    let remaining = workerCount * messages;
+    return new Promise(resolve => {
+      for (const worker of workers) {
+        worker.onmessage = () => {
+          if (--remaining === 0) resolve();
+        };
+        worker.postMessage({ storm: messages });
+      }
+    });
+  }
+
+  function outbound() {
+    let remaining = workerCount;
+    const done = new Promise(resolve => {
+      for (const worker of workers) {
+        worker.onmessage = () => {
+          if (--remaining === 0) resolve();
+        };
+        worker.postMessage({ expect: messages });
+      }
+    });
+    for (let i = 0; i < messages; i++) {
+      for (const worker of workers) worker.postMessage(i);
+    }
+    return done;
+  }
+
+  async function bench(name, fn) {
+    await fn();
+    let best = Infinity;
+    for (let i = 0; i < 5; i++) {
+      const start = Bun.nanoseconds();
+      await fn();
+      best = Math.min(best, Bun.nanoseconds() - start);
+    }
+    const total = workerCount * messages;
+    console.log(`${name.padEnd(18)} ${(best / 1e6).toFixed(1).padStart(8)} ms  ${((total / best) * 1e3).toFixed(2)} M messages/s`);
+  }
+
+  console.log(`${workerCount} workers, ${messages} messages each, best of 5`);
+  await bench("workers -> main", inbound);
+  await bench("main -> workers", outbound);
+  for (const worker of workers) worker.terminate();
+}
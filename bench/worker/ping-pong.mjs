@@ -0,0 +1,59 @@
+// Round trip latency of Worker.postMessage for the kinds of messages workers usually exchange
+// bun ping-pong.mjs [round trips]
+if (!Bun.isMainThread) {
+  self.onmessage = event => postMessage(event.data);
+} else {
+  const roundTrips = Number(process.argv[2] || 50_000);
+
+  const messages = {
+    "string": "job:3f2a1c:resize:1280x720",
+    "job descriptor": {
+      id: 48213,
+      kind: "thumbnail",
+      source: "uploads/2024/05/IMG_4821.jpg",
+      width: 320,
+      height: 240,
+      quality: 0.82,
+      retry: false,
+    },
+    "nested": {
+      id: "req_8f2b",
+      user: { id: 1042, name: "Ada", roles: ["admin", "billing"] },
+      items: [
+        { sku: "A-100", quantity: 2, price: 9.99 },
+        { sku: "B-220", quantity: 1, price: 24.5 },
+      ],
+      meta: { attempt: 1, deadline: 1717171717171, trace: null },
+    },
+    // Not simple, so this one measures the general path
+    "with a Date": { id: 7, at: new Date(0) },
+  };
+
+  const worker = new Worker(new URL(import.meta.url));
+
+  async function bench(name, message) {
+    // Warm up both sides first
+    for (let i = 0; i < 1000; i++) {
+      await new Promise(resolve => {
+        worker.onmessage = resolve;
+        worker.postMessage(message);
+      });
+    }
+
+    const start = Bun.nanoseconds();
+    for (let i = 0; i < roundTrips; i++) {
+      await new Promise(resolve => {
+        worker.onmessage = resolve;
+        worker.postMessage(message);
+      });
+    }
+    const elapsed = Bun.nanoseconds() - start;
+    console.log(`${name.padEnd(16)} ${(elapsed / roundTrips / 1e3).toFixed(2).padStart(7)} us/round trip`);
+  }
+
+  console.log(`${roundTrips} round trips`);
+  for (const [name, message] of Object.entries(messages)) {
+    await bench(name, message);
+  }
+  worker.terminate();
+}
@@ -0,0 +1,70 @@
+// Streaming chunks from a worker to the main thread through a MessagePort and a Bun.RingChannel
+// bun ring-channel.mjs [chunks] [chunk size]
+const chunks = Number(process.argv[2] || 200_000);
+const chunkSize = Number(process.argv[3] || 1024);
+
+if (!Bun.isMainThread) {
+  self.onmessage = ({ data }) => {
+    const chunk = new Uint8Array(chunkSize).fill(7);
+    if (data.port) {
+      for (let i = 0; i < chunks; i++) data.port.postMessage(chunk);
+      return;
+    }
+
+    const channel = new Bun.RingChannel(data.ring);
+    for (let i = 0; i < chunks; i++) channel.writeSync(chunk);
+    channel.close();
+  };
+} else {
+  const worker = new Worker(new URL(import.meta.url));
+
+  async function viaMessagePort() {
+    const { port1, port2 } = new MessageChannel();
+    let remaining = chunks;
+    let bytes = 0;
+    const done = new Promise(resolve => {
+      port1.onmessage = ({ data }) => {
+        bytes += data.byteLength;
+        if (--remaining === 0) resolve();
+      };
+    });
+    worker.postMessage({ port: port2 }, [port2]);
+    await done;
+    port1.close();
+    return bytes;
+  }
+
+  async function viaRingChannelAsync() {
+    const channel = new Bun.RingChannel(4 * 1024 * 1024);
+    worker.postMessage({ ring: channel.buffer });
+    let bytes = 0;
+    for (let chunk; (chunk = await channel.read()) !== null; ) bytes += chunk.byteLength;
+    return bytes;
+  }
+
+  async function viaRingChannelSync() {
+    const channel = new Bun.RingChannel(4 * 1024 * 1024);
+    worker.postMessage({ ring: channel.buffer });
+    let bytes = 0;
+    for (let chunk; (chunk = channel.readSync()) !== null; ) bytes += chunk.byteLength;
+    return bytes;
+  }
+
+  async function bench(name, fn) {
+    const expected = chunks * chunkSize;
+    let best = Infinity;
+    for (let i = 0; i < 5; i++) {
+      const start = Bun.nanoseconds();
+      const bytes = await fn();
+      best = Math.min(best, Bun.nanoseconds() - start);
+      if (bytes !== expected) throw new Error(`${name} received ${bytes} bytes, expected ${expected}`);
+    }
+    console.log(`${name.padEnd(22)} ${(best / 1e6).toFixed(1).padStart(8)} ms  ${((expected / best) * 1e3).toFixed(0).padStart(6)} MB/s`);
+  }
+
+  console.log(`${chunks} chunks of ${chunkSize} bytes, best of 5`);
+  await bench("MessagePort", viaMessagePort);
+  await bench("RingChannel read()", viaRingChannelAsync);
+  await bench("RingChannel readSync()", viaRingChannelSync);
+  worker.terminate();
+}
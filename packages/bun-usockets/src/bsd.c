@@ -38,6 +38,18 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#ifdef __linux__
+#include <netinet/udp.h>
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
 #else /* _WIN32 */
 #include <mstcpip.h>
 #endif
@@ -174,7 +186,16 @@ void bsd_udp_setup_recvbuf(struct udp_recvbuf *recvbuf, void *databuf, size_t da
 #endif
 }
 
-int bsd_udp_setup_sendbuf(struct udp_sendbuf *buf, size_t bufsize, void** payloads, size_t* lengths, void** addresses, int num) {
+#ifdef __linux__
+static int bsd_udp_same_peer(void *a, void *b, socklen_t addr_len) {
+    if (a == b) return 1;
+    return a && b && addr_len && memcmp(a, b, addr_len) == 0;
+}
+#endif
+
+/* Returns how many of the payloads went into buf, which may hold fewer messages than that when gso
+ * merged some of them */
+int bsd_udp_setup_sendbuf(struct udp_sendbuf *buf, size_t bufsize, void** payloads, size_t* lengths, void** addresses, int num, int gso) {
 #if defined(_WIN32)
     buf->payloads = payloads;
     buf->lengths = lengths;
@@ -187,15 +208,27 @@ int bsd_udp_setup_sendbuf(struct udp_sendbuf *buf, size_t bufsize, void** payloa
 
     // sendmsg_x docs states it does not support addresses.
     buf->has_addresses = 0;
+    buf->has_segments = 0;
 
     struct mmsghdr *msgvec = buf->msgvec;
+    size_t per_payload = sizeof(struct mmsghdr) + sizeof(struct iovec);
+#ifdef __linux__
+    typedef char gso_control_t[CMSG_SPACE(sizeof(uint16_t))];
+    if (gso) {
+        per_payload += sizeof(gso_control_t);
+    }
+#endif
     // todo check this math
-    size_t count = (bufsize - sizeof(struct udp_sendbuf)) / (sizeof(struct mmsghdr) + sizeof(struct iovec));
+    size_t count = (bufsize - sizeof(struct udp_sendbuf)) / per_payload;
     if (count > num) {
         count = num;
     }
     struct iovec *iov = (struct iovec *) (msgvec + count);
-    for (int i = 0; i < count; i++) {
+#ifdef __linux__
+    gso_control_t *control = (gso_control_t *) (iov + count);
+#endif
+    unsigned int messages = 0;
+    for (size_t i = 0; i < count; messages++) {
         struct sockaddr *addr = (struct sockaddr *)addresses[i];
         socklen_t addr_len = 0;
         if (addr) {
@@ -206,27 +239,74 @@ int bsd_udp_setup_sendbuf(struct udp_sendbuf *buf, size_t bufsize, void** payloa
                 buf->has_addresses = 1;
             }
         }
-        iov[i].iov_base = payloads[i];
-        iov[i].iov_len = lengths[i];
-        msgvec[i].msg_hdr.msg_name = addresses[i];
-        msgvec[i].msg_hdr.msg_namelen = addr_len;
-        msgvec[i].msg_hdr.msg_control = NULL;
-        msgvec[i].msg_hdr.msg_controllen = 0;
-        msgvec[i].msg_hdr.msg_iov = iov + i;
-        msgvec[i].msg_hdr.msg_iovlen = 1;
-        msgvec[i].msg_hdr.msg_flags = 0;
-        msgvec[i].msg_len = 0;
-
-
-        if (lengths[i] == 0) {
+
+        size_t first = i++;
+        iov[first].iov_base = payloads[first];
+        iov[first].iov_len = lengths[first];
+        if (lengths[first] == 0) {
             buf->has_empty = 1;
         }
+
+#ifdef __linux__
+        /* Follow with every datagram of the same size to the same peer that fits in one send. The
+         * last segment may be shorter, which also ends the run */
+        size_t segment_size = lengths[first];
+        size_t total = segment_size;
+        if (gso && segment_size > 0 && segment_size <= LIBUS_UDP_GSO_MAX_SEGMENT_SIZE) {
+            while (i < count && i - first < LIBUS_UDP_GSO_MAX_SEGMENTS && lengths[i] > 0 && lengths[i] <= segment_size &&
+                   total + lengths[i] <= LIBUS_UDP_GSO_MAX_BYTES && bsd_udp_same_peer(addresses[first], addresses[i], addr_len)) {
+                iov[i].iov_base = payloads[i];
+                iov[i].iov_len = lengths[i];
+                total += lengths[i];
+                if (lengths[i++] < segment_size) {
+                    break;
+                }
+            }
+        }
+#endif
+
+        struct msghdr *mh = &msgvec[messages].msg_hdr;
+        mh->msg_name = addresses[first];
+        mh->msg_namelen = addr_len;
+        mh->msg_control = NULL;
+        mh->msg_controllen = 0;
+        mh->msg_iov = iov + first;
+        mh->msg_iovlen = i - first;
+        mh->msg_flags = 0;
+        msgvec[messages].msg_len = 0;
+
+#ifdef __linux__
+        if (i - first > 1) {
+            uint16_t size = (uint16_t) segment_size;
+            mh->msg_control = control[messages];
+            mh->msg_controllen = sizeof(control[messages]);
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(mh);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(size));
+            memcpy(CMSG_DATA(cmsg), &size, sizeof(size));
+            buf->has_segments = 1;
+        }
+#endif
     }
-    buf->num = count;
+    buf->num = messages;
     return count;
 #endif
 }
 
+/* How many payloads the first messages of a set up buf carry */
+int bsd_udp_sendbuf_payloads(struct udp_sendbuf *buf, int messages) {
+#if defined(_WIN32)
+    return messages;
+#else
+    int payloads = 0;
+    for (int i = 0; i < messages; i++) {
+        payloads += buf->msgvec[i].msg_hdr.msg_iovlen;
+    }
+    return payloads;
+#endif
+}
+
 // this one is needed for knowing the destination addr of udp packet
 // an udp socket can only bind to one port, and that port never changes
 // this function returns ONLY the IP address, not any port
@@ -279,6 +359,21 @@ int bsd_udp_packet_buffer_payload_length(struct udp_recvbuf *msgvec, int index)
 #endif
 }
 
+// with UDP_GRO the kernel may hand us several datagrams in one payload, each this long but the last
+int bsd_udp_packet_buffer_segment_size(struct udp_recvbuf *msgvec, int index) {
+#if defined(__linux__)
+    struct msghdr *mh = &((struct mmsghdr *) msgvec)[index].msg_hdr;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(mh); cmsg != NULL; cmsg = CMSG_NXTHDR(mh, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment_size;
+            memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+            return segment_size;
+        }
+    }
+#endif
+    return 0;
+}
+
 LIBUS_SOCKET_DESCRIPTOR apple_no_sigpipe(LIBUS_SOCKET_DESCRIPTOR fd) {
 #ifdef __APPLE__
     if (fd != LIBUS_SOCKET_ERROR) {
@@ -345,6 +440,19 @@ void bsd_socket_nodelay(LIBUS_SOCKET_DESCRIPTOR fd, int enabled) {
     setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
 }
 
+/* Whether sockets accepted from this listen socket come out with TCP_NODELAY already set.
+ * Only Linux copies the option over on accept, and only if the listen socket has it */
+int bsd_socket_accepts_nodelay(LIBUS_SOCKET_DESCRIPTOR fd) {
+#ifdef __linux__
+    int enabled = 0;
+    socklen_t len = sizeof(enabled);
+    return getsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, &len) == 0 && enabled;
+#else
+    (void) fd;
+    return 0;
+#endif
+}
+
 int bsd_socket_broadcast(LIBUS_SOCKET_DESCRIPTOR fd, int enabled) {
     return setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &enabled, sizeof(enabled));
 }
@@ -900,6 +1008,11 @@ inline __attribute__((always_inline)) LIBUS_SOCKET_DESCRIPTOR bsd_bind_listen_fd
     }
 #endif
 
+#ifdef __linux__
+    /* Accepted sockets inherit TCP_NODELAY from the listen socket, saving a syscall per accept */
+    bsd_socket_nodelay(listenFd, 1);
+#endif
+
     if (us_internal_bind_and_listen(listenFd, listenAddr->ai_addr, (socklen_t) listenAddr->ai_addrlen, 512, error)) {
         return LIBUS_SOCKET_ERROR;
     }
@@ -1199,6 +1312,13 @@ LIBUS_SOCKET_DESCRIPTOR bsd_create_udp_socket(const char *host, int port, int op
         }
     }
 
+#ifdef __linux__
+    /* Best effort, without it every datagram simply arrives on its own */
+    if (options & LIBUS_SOCKET_UDP_GRO) {
+        setsockopt(listenFd, SOL_UDP, UDP_GRO, &enabled, sizeof(enabled));
+    }
+#endif
+
     /* We bind here as well */
     if (bind(listenFd, listenAddr->ai_addr, (socklen_t) listenAddr->ai_addrlen)) {
         if (err != NULL) {
@@ -46,6 +46,9 @@ void us_listen_socket_close(int ssl, struct us_listen_socket_t *ls) {
     if (!us_socket_is_closed(0, &ls->s)) {
         us_internal_socket_context_unlink_listen_socket(ssl, ls->s.context, ls);
         us_poll_stop((struct us_poll_t *) &ls->s, ls->s.context->loop);
+#ifdef LIBUS_USE_IO_URING
+        us_internal_ring_detach((struct us_poll_t *) &ls->s, 0, 0);
+#endif
         bsd_close_socket(us_poll_fd((struct us_poll_t *) &ls->s));
 
         /* Link this socket to the close-list and let it be deleted after this iteration */
@@ -86,11 +89,6 @@ void us_socket_context_close(int ssl, struct us_socket_context_t *context) {
 }
 
 void us_internal_socket_context_unlink_listen_socket(int ssl, struct us_socket_context_t *context, struct us_listen_socket_t *ls) {
-    /* We have to properly update the iterator used to sweep sockets for timeouts */
-    if (ls == (struct us_listen_socket_t *) context->iterator) {
-        context->iterator = ls->s.next;
-    }
-
     if (ls->s.prev == ls->s.next) {
         context->head_listen_sockets = 0;
     } else {
@@ -107,10 +105,9 @@ void us_internal_socket_context_unlink_listen_socket(int ssl, struct us_socket_c
 }
 
 void us_internal_socket_context_unlink_socket(int ssl, struct us_socket_context_t *context, struct us_socket_t *s) {
-    /* We have to properly update the iterator used to sweep sockets for timeouts */
-    if (s == context->iterator) {
-        context->iterator = s->next;
-    }
+    /* Unlinked sockets are not swept, but they keep their timeouts in case they are linked again */
+    us_internal_timeout_wheel_unlink(s);
+    s->is_linked = 0;
 
     if (s->prev == s->next) {
         context->head_sockets = 0;
@@ -147,6 +144,10 @@ void us_internal_socket_context_link_listen_socket(struct us_socket_context_t *c
     ls->s.context = context;
     ls->s.next = (struct us_socket_t *) context->head_listen_sockets;
     ls->s.prev = 0;
+    /* Listen sockets never time out */
+    ls->s.is_linked = 0;
+    ls->s.timeout_node.pprev = 0;
+    ls->s.long_timeout_node.pprev = 0;
     if (context->head_listen_sockets) {
         context->head_listen_sockets->s.prev = &ls->s;
     }
@@ -176,6 +177,12 @@ void us_internal_socket_context_link_socket(struct us_socket_context_t *context,
     }
     context->head_sockets = s;
     us_socket_context_ref(0, context);
+
+    /* Pick up whatever timeouts were set on the socket before it was linked */
+    s->is_linked = 1;
+    s->timeout_node.pprev = 0;
+    s->long_timeout_node.pprev = 0;
+    us_internal_timeout_wheel_link(s);
 }
 
 struct us_loop_t *us_socket_context_loop(int ssl, struct us_socket_context_t *context) {
@@ -221,6 +228,16 @@ int us_bun_socket_context_add_server_name(int ssl, struct us_socket_context_t *c
     return 0;
 }
 
+/* Replace SNI context, or add it */
+int us_bun_socket_context_replace_server_name(int ssl, struct us_socket_context_t *context, const char *hostname_pattern, struct us_bun_socket_context_options_t options, void *user) {
+#ifndef LIBUS_NO_SSL
+    if (ssl) {
+        return us_bun_internal_ssl_socket_context_replace_server_name((struct us_internal_ssl_socket_context_t *) context, hostname_pattern, options, user);
+    }
+#endif
+    return 0;
+}
+
 /* Remove SNI context */
 void us_socket_context_remove_server_name(int ssl, struct us_socket_context_t *context, const char *hostname_pattern) {
 #ifndef LIBUS_NO_SSL
@@ -256,6 +273,27 @@ void *us_socket_context_get_native_handle(int ssl, struct us_socket_context_t *c
     return 0;
 }
 
+void us_socket_context_session_stats(int ssl, struct us_socket_context_t *context, struct us_socket_context_session_stats_t *stats) {
+#ifndef LIBUS_NO_SSL
+    if (ssl) {
+        us_internal_ssl_socket_context_session_stats((struct us_internal_ssl_socket_context_t *) context, stats);
+        return;
+    }
+#endif
+
+    memset(stats, 0, sizeof(*stats));
+}
+
+int us_socket_context_set_ticket_keys(int ssl, struct us_socket_context_t *context, const unsigned char *keys, unsigned int length) {
+#ifndef LIBUS_NO_SSL
+    if (ssl) {
+        return us_internal_ssl_socket_context_set_ticket_keys((struct us_internal_ssl_socket_context_t *) context, keys, length);
+    }
+#endif
+
+    return 0;
+}
+
 /* Options is currently only applicable for SSL - this will change with time (prefer_low_memory is one example) */
 struct us_socket_context_t *us_create_socket_context(int ssl, struct us_loop_t *loop, int context_ext_size, struct us_socket_context_options_t options) {
 #ifndef LIBUS_NO_SSL
@@ -370,11 +408,13 @@ struct us_listen_socket_t *us_socket_context_listen(int ssl, struct us_socket_co
     ls->s.timeout = 255;
     ls->s.long_timeout = 255;
     ls->s.low_prio_state = 0;
+    ls->s.pool_index = 0;
     ls->s.next = 0;
     ls->s.allow_half_open = (options & LIBUS_SOCKET_ALLOW_HALF_OPEN);
     us_internal_socket_context_link_listen_socket(context, ls);
 
     ls->socket_ext_size = socket_ext_size;
+    ls->accepts_nodelay = bsd_socket_accepts_nodelay(listen_socket_fd);
 
     return ls;
 }
@@ -402,12 +442,15 @@ struct us_listen_socket_t *us_socket_context_listen_unix(int ssl, struct us_sock
     ls->s.timeout = 255;
     ls->s.long_timeout = 255;
     ls->s.low_prio_state = 0;
+    ls->s.pool_index = 0;
     ls->s.next = 0;
     ls->s.allow_half_open = (options & LIBUS_SOCKET_ALLOW_HALF_OPEN);
 
     us_internal_socket_context_link_listen_socket(context, ls);
 
     ls->socket_ext_size = socket_ext_size;
+    /* Unix sockets have no Nagle to disable */
+    ls->accepts_nodelay = 1;
 
     return ls;
 }
@@ -433,6 +476,7 @@ struct us_socket_t* us_socket_context_connect_resolved_dns(struct us_socket_cont
     socket->timeout = 255;
     socket->long_timeout = 255;
     socket->low_prio_state = 0;
+    socket->pool_index = 0;
     socket->connect_state = NULL;
     socket->allow_half_open = (options & LIBUS_SOCKET_ALLOW_HALF_OPEN);
 
@@ -525,6 +569,7 @@ void *us_socket_context_connect(int ssl, struct us_socket_context_t *context, co
     c->ssl = ssl > 0;
     c->timeout = 255;
     c->long_timeout = 255;
+    c->timeout_rounds = 0;
     c->pending_resolve_callback = 1;
     c->port = port;
     us_internal_socket_context_link_connecting_socket(ssl, context, c);
@@ -556,7 +601,9 @@ int start_connections(struct us_connecting_socket_t *c, int count) {
         s->context = c->context;
         s->timeout = c->timeout;
         s->long_timeout = c->long_timeout;
+        s->timeout_rounds = c->timeout_rounds;
         s->low_prio_state = 0;
+        s->pool_index = 0;
         s->allow_half_open = (c->options & LIBUS_SOCKET_ALLOW_HALF_OPEN);
         /* Link it into context so that timeout fires properly */
         us_internal_socket_context_link_socket(s->context, s);
@@ -732,6 +779,7 @@ struct us_socket_t *us_socket_context_connect_unix(int ssl, struct us_socket_con
     connect_socket->timeout = 255;
     connect_socket->long_timeout = 255;
     connect_socket->low_prio_state = 0;
+    connect_socket->pool_index = 0;
     connect_socket->connect_state = NULL;
     connect_socket->allow_half_open = (options & LIBUS_SOCKET_ALLOW_HALF_OPEN);
     us_internal_socket_context_link_socket(context, connect_socket);
@@ -767,7 +815,7 @@ struct us_socket_t *us_socket_context_adopt_socket(int ssl, struct us_socket_con
     if (s->low_prio_state != 1) {
          /* We need to be sure that we still holding a reference*/
         us_socket_context_ref(ssl, context);
-        /* This properly updates the iterator if in on_timeout */
+        /* This also takes the socket out of the timeout wheel, before it may be moved in memory */
         us_internal_socket_context_unlink_socket(ssl, s->context, s);
     }
 
@@ -776,7 +824,11 @@ struct us_socket_t *us_socket_context_adopt_socket(int ssl, struct us_socket_con
 
     struct us_socket_t *new_s = s;
     if (ext_size != -1) {
-        new_s = (struct us_socket_t *) us_poll_resize(&s->p, s->context->loop, sizeof(struct us_socket_t) + ext_size);
+        /* Pooled sockets already have room for any ext up to their size class */
+        if (!us_internal_socket_pool_fits(s, ext_size)) {
+            new_s = (struct us_socket_t *) us_poll_resize(&s->p, s->context->loop, sizeof(struct us_socket_t) + ext_size);
+            new_s->pool_index = 0;
+        }
         if (c) {
             c->connecting_head = new_s;
             struct us_socket_context_t *old_context = s->context;
@@ -0,0 +1,254 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ *     http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* A few threads that do the private key half of TLS handshakes (the CertificateVerify or
+ * ServerKeyExchange signature, or the RSA key exchange decryption) so a burst of new clients does
+ * not stall the loop. openssl.c hands operations over from its SSL_PRIVATE_KEY_METHOD and gets
+ * them back, on the loop thread, through a per-loop queue whose async it wakes.
+ *
+ * Off unless BUN_TLS_HANDSHAKE_THREADS is set to the number of threads. */
+
+#if defined(LIBUS_USE_OPENSSL)
+
+#include <openssl/ssl.h>
+
+#ifdef OPENSSL_IS_BORINGSSL
+
+#include "internal/internal.h"
+#include "libusockets.h"
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+struct us_internal_key_operations;
+
+struct us_internal_key_operation {
+    /* Loop thread only */
+    void *user;
+    int done;
+
+    EVP_PKEY *key;
+    /* 0 for an RSA decryption */
+    uint16_t signature_algorithm;
+    std::vector<uint8_t> input;
+    us_internal_key_operations *queue;
+
+    /* Written by the worker before the operation is queued back */
+    std::vector<uint8_t> output;
+    int ok;
+
+    ~us_internal_key_operation() {
+        EVP_PKEY_free(key);
+    }
+};
+
+/* Finished operations waiting for their loop. Operations in flight hold a reference, so the loop
+ * can go away before they finish */
+struct us_internal_key_operations {
+    std::atomic<unsigned> references { 1 };
+    std::mutex mutex;
+    std::deque<us_internal_key_operation *> finished;
+    struct us_internal_async *async;
+    bool closed = false;
+
+    void release() {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+
+    void push(us_internal_key_operation *operation) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) {
+            delete operation;
+            return;
+        }
+        finished.push_back(operation);
+        if (finished.size() == 1) us_internal_async_wakeup(async);
+    }
+};
+
+namespace {
+
+class handshake_pool {
+public:
+    explicit handshake_pool(unsigned threads) {
+        for (unsigned i = 0; i < threads; i++) std::thread([this] { work(); }).detach();
+    }
+
+    void submit(us_internal_key_operation *operation) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.push_back(operation);
+        }
+        m_wakeup.notify_one();
+    }
+
+private:
+    static void run(us_internal_key_operation &operation) {
+        size_t length = 0;
+        if (!operation.signature_algorithm) {
+            RSA *rsa = EVP_PKEY_get0_RSA(operation.key);
+            if (!rsa) return;
+            operation.output.resize(RSA_size(rsa));
+            operation.ok = RSA_decrypt(rsa, &length, operation.output.data(), operation.output.size(),
+                operation.input.data(), operation.input.size(), RSA_NO_PADDING);
+        } else {
+            uint16_t algorithm = operation.signature_algorithm;
+            if (EVP_PKEY_id(operation.key) != SSL_get_signature_algorithm_key_type(algorithm)) return;
+            bssl::ScopedEVP_MD_CTX context;
+            EVP_PKEY_CTX *key_context;
+            operation.output.resize(EVP_PKEY_size(operation.key));
+            length = operation.output.size();
+            operation.ok = EVP_DigestSignInit(context.get(), &key_context, SSL_get_signature_algorithm_digest(algorithm), nullptr, operation.key) &&
+                (!SSL_is_signature_algorithm_rsa_pss(algorithm) ||
+                    (EVP_PKEY_CTX_set_rsa_padding(key_context, RSA_PKCS1_PSS_PADDING) &&
+                        EVP_PKEY_CTX_set_rsa_pss_saltlen(key_context, -1 /* digest length */))) &&
+                EVP_DigestSign(context.get(), operation.output.data(), &length, operation.input.data(), operation.input.size());
+        }
+        operation.output.resize(operation.ok ? length : 0);
+    }
+
+    void work() {
+        while (true) {
+            us_internal_key_operation *operation;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeup.wait(lock, [this] { return !m_pending.empty(); });
+                operation = m_pending.front();
+                m_pending.pop_front();
+            }
+            run(*operation);
+            us_internal_key_operations *queue = operation->queue;
+            queue->push(operation);
+            queue->release();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<us_internal_key_operation *> m_pending;
+};
+
+unsigned handshake_threads() {
+    static unsigned threads = [] {
+        const char *value = getenv("BUN_TLS_HANDSHAKE_THREADS");
+        long count = value ? strtol(value, nullptr, 10) : 0;
+        return (unsigned) (count < 0 ? 0 : count > 64 ? 64 : count);
+    }();
+    return threads;
+}
+
+handshake_pool &pool() {
+    /* Never destroyed: its threads are detached and may outlive static destructors */
+    static handshake_pool *pool = new handshake_pool(handshake_threads());
+    return *pool;
+}
+
+}
+
+extern "C" {
+
+int us_internal_handshake_pool_enabled() {
+    return handshake_threads() > 0;
+}
+
+struct us_internal_key_operations *us_internal_key_operations_create(struct us_internal_async *async) {
+    auto *queue = new us_internal_key_operations();
+    queue->async = async;
+    return queue;
+}
+
+/* Operations still running are dropped when they finish; call before closing the async */
+void us_internal_key_operations_free(struct us_internal_key_operations *queue) {
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->closed = true;
+        for (us_internal_key_operation *operation : queue->finished) delete operation;
+        queue->finished.clear();
+    }
+    queue->release();
+}
+
+/* Returns NULL if the operation could not be started. signature_algorithm is 0 to decrypt */
+struct us_internal_key_operation *us_internal_key_operation_submit(struct us_internal_key_operations *queue, EVP_PKEY *key,
+    uint16_t signature_algorithm, const uint8_t *input, size_t input_length, void *user) {
+    if (!key) return nullptr;
+    auto *operation = new us_internal_key_operation();
+    operation->user = user;
+    operation->done = 0;
+    operation->key = EVP_PKEY_up_ref(key) ? key : nullptr;
+    operation->signature_algorithm = signature_algorithm;
+    operation->input.assign(input, input + input_length);
+    operation->queue = queue;
+    queue->references.fetch_add(1, std::memory_order_relaxed);
+    operation->ok = 0;
+    pool().submit(operation);
+    return operation;
+}
+
+/* Next finished operation, marked done, or NULL */
+struct us_internal_key_operation *us_internal_key_operations_pop(struct us_internal_key_operations *queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->finished.empty()) return nullptr;
+    us_internal_key_operation *operation = queue->finished.front();
+    queue->finished.pop_front();
+    operation->done = 1;
+    return operation;
+}
+
+void *us_internal_key_operation_user(struct us_internal_key_operation *operation) {
+    return operation->user;
+}
+
+void us_internal_key_operation_set_user(struct us_internal_key_operation *operation, void *user) {
+    operation->user = user;
+}
+
+int us_internal_key_operation_done(struct us_internal_key_operation *operation) {
+    return operation->done;
+}
+
+/* The owner went away: free it now if it is back, or once it is */
+void us_internal_key_operation_cancel(struct us_internal_key_operation *operation) {
+    if (operation->done) {
+        delete operation;
+    } else {
+        operation->user = nullptr;
+    }
+}
+
+/* Copies out the result of a done operation and frees it */
+int us_internal_key_operation_finish(struct us_internal_key_operation *operation, uint8_t *out, size_t *out_length, size_t max_out) {
+    int ok = operation->ok && operation->output.size() <= max_out;
+    if (ok) {
+        memcpy(out, operation->output.data(), operation->output.size());
+        *out_length = operation->output.size();
+    }
+    delete operation;
+    return ok;
+}
+
+}
+
+#endif
+#endif
@@ -0,0 +1,220 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ *     http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Kernel TLS transmit offload. Once a handshake is done the keys this end writes with are handed to
+ * the kernel (TCP_ULP "tls" + SOL_TLS/TLS_TX), after which application data is written to the
+ * socket as plaintext and the kernel frames and encrypts it, so it can also be sendfile()'d.
+ *
+ * Written in C++ because BoringSSL only exposes TLS 1.3 traffic secrets through its C++ API.
+ * Receiving stays in BoringSSL so post-handshake messages keep working. */
+
+#if defined(LIBUS_USE_OPENSSL) && defined(__linux__)
+
+#include <openssl/ssl.h>
+
+#ifdef OPENSSL_IS_BORINGSSL
+
+#include <openssl/digest.h>
+#include <openssl/hkdf.h>
+#include <openssl/mem.h>
+
+#include <errno.h>
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+namespace {
+
+union ktls_crypto_info {
+    struct tls_crypto_info info;
+    struct tls12_crypto_info_aes_gcm_128 aes_gcm_128;
+    struct tls12_crypto_info_aes_gcm_256 aes_gcm_256;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+    struct tls12_crypto_info_chacha20_poly1305 chacha20_poly1305;
+#endif
+};
+
+/* Where each piece of key material goes in the kernel's struct for one cipher */
+struct ktls_layout {
+    unsigned char *key, *salt, *iv, *rec_seq;
+    size_t key_length, salt_length, iv_length;
+    socklen_t size;
+};
+
+bool ktls_layout_for_cipher(int nid, ktls_crypto_info &crypto, ktls_layout &layout) {
+    switch (nid) {
+    case NID_aes_128_gcm:
+        crypto.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        layout = { crypto.aes_gcm_128.key, crypto.aes_gcm_128.salt, crypto.aes_gcm_128.iv, crypto.aes_gcm_128.rec_seq,
+            TLS_CIPHER_AES_GCM_128_KEY_SIZE, TLS_CIPHER_AES_GCM_128_SALT_SIZE, TLS_CIPHER_AES_GCM_128_IV_SIZE, sizeof(crypto.aes_gcm_128) };
+        return true;
+    case NID_aes_256_gcm:
+        crypto.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        layout = { crypto.aes_gcm_256.key, crypto.aes_gcm_256.salt, crypto.aes_gcm_256.iv, crypto.aes_gcm_256.rec_seq,
+            TLS_CIPHER_AES_GCM_256_KEY_SIZE, TLS_CIPHER_AES_GCM_256_SALT_SIZE, TLS_CIPHER_AES_GCM_256_IV_SIZE, sizeof(crypto.aes_gcm_256) };
+        return true;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+    case NID_chacha20_poly1305:
+        crypto.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+        layout = { crypto.chacha20_poly1305.key, crypto.chacha20_poly1305.salt, crypto.chacha20_poly1305.iv, crypto.chacha20_poly1305.rec_seq,
+            TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE, TLS_CIPHER_CHACHA20_POLY1305_SALT_SIZE, TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE, sizeof(crypto.chacha20_poly1305) };
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+/* HKDF-Expand-Label from RFC 8446 section 7.1, with an empty context */
+bool hkdf_expand_label(uint8_t *out, size_t out_length, const EVP_MD *digest, bssl::Span<const uint8_t> secret, const char *label) {
+    size_t label_length = strlen(label);
+    uint8_t info[2 + 1 + 6 + 255 + 1];
+    if (label_length > 255 - 6) return false;
+    info[0] = (uint8_t) (out_length >> 8);
+    info[1] = (uint8_t) out_length;
+    info[2] = (uint8_t) (6 + label_length);
+    memcpy(info + 3, "tls13 ", 6);
+    memcpy(info + 9, label, label_length);
+    info[9 + label_length] = 0;
+    return HKDF_expand(out, out_length, digest, secret.data(), secret.size(), info, 10 + label_length);
+}
+
+/* TLS 1.3: key and nonce both come from the current write traffic secret. The first salt_length
+ * bytes of the 12 byte nonce are the kernel's salt, the rest its iv. */
+bool fill_tls13(SSL *ssl, const SSL_CIPHER *cipher, ktls_layout &layout) {
+    bssl::Span<const uint8_t> read_secret, write_secret;
+    if (!bssl::SSL_get_traffic_secrets(ssl, &read_secret, &write_secret)) return false;
+    const EVP_MD *digest = EVP_get_digestbynid(SSL_CIPHER_get_prf_nid(cipher));
+    if (!digest) return false;
+
+    uint8_t nonce[12];
+    if (layout.salt_length + layout.iv_length != sizeof(nonce)) return false;
+    if (!hkdf_expand_label(layout.key, layout.key_length, digest, write_secret, "key") ||
+        !hkdf_expand_label(nonce, sizeof(nonce), digest, write_secret, "iv")) {
+        OPENSSL_cleanse(nonce, sizeof(nonce));
+        return false;
+    }
+    memcpy(layout.salt, nonce, layout.salt_length);
+    memcpy(layout.iv, nonce + layout.salt_length, layout.iv_length);
+    OPENSSL_cleanse(nonce, sizeof(nonce));
+    return true;
+}
+
+/* TLS 1.2: the key block is client key, server key, client fixed iv, server fixed iv (AEAD suites
+ * have no MAC keys). GCM's fixed iv is the salt and its explicit nonce starts at the sequence
+ * number, as BoringSSL's own does; ChaCha20-Poly1305's fixed iv is the whole 12 byte iv. */
+bool fill_tls12(SSL *ssl, ktls_layout &layout, uint64_t sequence) {
+    size_t fixed_iv_length = layout.salt_length ? layout.salt_length : layout.iv_length;
+    uint8_t key_block[2 * (32 + 12)];
+    size_t key_block_length = SSL_get_key_block_len(ssl);
+    if (key_block_length != 2 * (layout.key_length + fixed_iv_length)) return false;
+    if (!SSL_generate_key_block(ssl, key_block, key_block_length)) return false;
+
+    int is_server = SSL_is_server(ssl);
+    const uint8_t *key = key_block + (is_server ? layout.key_length : 0);
+    const uint8_t *fixed_iv = key_block + 2 * layout.key_length + (is_server ? fixed_iv_length : 0);
+    memcpy(layout.key, key, layout.key_length);
+    if (layout.salt_length) {
+        memcpy(layout.salt, fixed_iv, layout.salt_length);
+        for (size_t i = 0; i < layout.iv_length; i++)
+            layout.iv[i] = (uint8_t) (sequence >> (8 * (layout.iv_length - 1 - i)));
+    } else {
+        memcpy(layout.iv, fixed_iv, layout.iv_length);
+    }
+    OPENSSL_cleanse(key_block, sizeof(key_block));
+    return true;
+}
+
+}
+
+extern "C" {
+
+/* Returns 1 once the kernel encrypts everything written to fd, 0 if this connection stays in
+ * userspace, and -1 if the kernel has no TLS support at all so the caller can stop trying. */
+int us_internal_ktls_enable_tx(SSL *ssl, int fd) {
+    const SSL_CIPHER *cipher = SSL_get_current_cipher(ssl);
+    if (!cipher || !SSL_is_init_finished(ssl)) return 0;
+
+    ktls_crypto_info crypto;
+    memset(&crypto, 0, sizeof(crypto));
+    ktls_layout layout;
+    if (!ktls_layout_for_cipher(SSL_CIPHER_get_cipher_nid(cipher), crypto, layout)) return 0;
+
+    uint64_t sequence = SSL_get_write_sequence(ssl);
+    bool filled = false;
+    switch (SSL_version(ssl)) {
+    case TLS1_2_VERSION:
+        crypto.info.version = TLS_1_2_VERSION;
+        filled = fill_tls12(ssl, layout, sequence);
+        break;
+    case TLS1_3_VERSION:
+        crypto.info.version = TLS_1_3_VERSION;
+        filled = fill_tls13(ssl, cipher, layout);
+        break;
+    }
+    if (!filled) {
+        OPENSSL_cleanse(&crypto, sizeof(crypto));
+        return 0;
+    }
+    for (size_t i = 0; i < 8; i++)
+        layout.rec_seq[i] = (uint8_t) (sequence >> (8 * (7 - i)));
+
+    int result = 0;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")) == 0) {
+        /* If the kernel refuses this cipher the socket is left with the ULP attached and nothing
+         * configured, which passes writes through unchanged, so BoringSSL can carry on. */
+        result = setsockopt(fd, SOL_TLS, TLS_TX, &crypto, layout.size) == 0;
+    } else if (errno == ENOENT || errno == ENOPROTOOPT) {
+        result = -1;
+    }
+    OPENSSL_cleanse(&crypto, sizeof(crypto));
+    return result;
+}
+
+/* After offload BoringSSL can no longer write, so close_notify goes out as a kernel alert record */
+void us_internal_ktls_send_close_notify(int fd) {
+    unsigned char alert[2] = { 1 /* warning */, 0 /* close_notify */ };
+    char control[CMSG_SPACE(sizeof(unsigned char))];
+    memset(control, 0, sizeof(control));
+
+    struct iovec iov = { alert, sizeof(alert) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(unsigned char));
+    *CMSG_DATA(cmsg) = 21; /* alert */
+
+    sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+}
+
+#endif
+#endif
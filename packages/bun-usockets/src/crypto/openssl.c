@@ -20,6 +20,7 @@
 
 #include "internal/internal.h"
 #include "libusockets.h"
+#include <stdlib.h>
 #include <string.h>
 
 /* These are in sni_tree.cpp */
@@ -27,6 +28,7 @@ void *sni_new();
 void sni_free(void *sni, void (*cb)(void *));
 int sni_add(void *sni, const char *hostname, void *user);
 void *sni_remove(void *sni, const char *hostname);
+void *sni_replace(void *sni, const char *hostname, void *user);
 void *sni_find(void *sni, const char *hostname);
 
 /* This module contains the entire OpenSSL implementation
@@ -49,6 +51,51 @@ void *sni_find(void *sni, const char *hostname);
 /* These are in root_certs.cpp */
 extern X509_STORE *us_get_default_ca_store();
 
+#if defined(LIBUS_USE_OPENSSL) && defined(OPENSSL_IS_BORINGSSL) && defined(__linux__)
+#define LIBUS_USE_KTLS
+/* These are in ktls.cpp */
+int us_internal_ktls_enable_tx(SSL *ssl, int fd);
+void us_internal_ktls_send_close_notify(int fd);
+#endif
+
+#if defined(LIBUS_USE_OPENSSL) && defined(OPENSSL_IS_BORINGSSL)
+#define LIBUS_USE_SESSION_STORE
+/* These are in session_cache.cpp */
+void us_internal_ssl_session_store_attach(SSL_CTX *ssl_context);
+void us_internal_ssl_session_store_pin(SSL *ssl);
+void us_internal_ssl_session_store_count_handshake(SSL *ssl);
+int us_internal_ssl_session_store_set_ticket_keys(SSL_CTX *ssl_context,
+                                                  const unsigned char *keys,
+                                                  unsigned int length);
+void us_internal_ssl_session_store_stats(
+    SSL_CTX *ssl_context, struct us_socket_context_session_stats_t *stats);
+#endif
+
+struct us_internal_key_operation;
+#if defined(LIBUS_USE_OPENSSL) && defined(OPENSSL_IS_BORINGSSL)
+#define LIBUS_USE_HANDSHAKE_POOL
+/* These are in handshake_pool.cpp */
+struct us_internal_key_operations;
+int us_internal_handshake_pool_enabled();
+struct us_internal_key_operations *
+us_internal_key_operations_create(struct us_internal_async *async);
+void us_internal_key_operations_free(struct us_internal_key_operations *queue);
+struct us_internal_key_operation *us_internal_key_operation_submit(
+    struct us_internal_key_operations *queue, EVP_PKEY *key,
+    uint16_t signature_algorithm, const uint8_t *input, size_t input_length,
+    void *user);
+struct us_internal_key_operation *
+us_internal_key_operations_pop(struct us_internal_key_operations *queue);
+void *us_internal_key_operation_user(struct us_internal_key_operation *operation);
+void us_internal_key_operation_set_user(
+    struct us_internal_key_operation *operation, void *user);
+int us_internal_key_operation_done(struct us_internal_key_operation *operation);
+void us_internal_key_operation_cancel(struct us_internal_key_operation *operation);
+int us_internal_key_operation_finish(struct us_internal_key_operation *operation,
+                                     uint8_t *out, size_t *out_length,
+                                     size_t max_out);
+#endif
+
 struct loop_ssl_data {
   char *ssl_read_input, *ssl_read_output;
   unsigned int ssl_read_input_length;
@@ -62,6 +109,17 @@ struct loop_ssl_data {
   BIO *shared_rbio;
   BIO *shared_wbio;
   BIO_METHOD *shared_biom;
+
+  /* Hand write keys to the kernel after each handshake (BUN_FEATURE_FLAG_KTLS=1), cleared for
+   * good the first time the kernel turns out not to support it */
+  int ktls_tx;
+
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+  /* Private key operations finished by the handshake pool come back here,
+   * created the first time one is started */
+  struct us_internal_key_operations *key_operations;
+  struct us_internal_async *key_operations_async;
+#endif
 };
 
 struct us_internal_ssl_socket_context_t {
@@ -114,6 +172,11 @@ struct us_internal_ssl_socket_t {
   unsigned int ssl_read_wants_write : 1;
   unsigned int handshake_state : 2;
   unsigned int fatal_error : 1;
+  unsigned int ssl_write_wants_write : 1; // BoringSSL holds part of a record until SSL_write is retried
+  unsigned int ktls_tx : 1; // the kernel encrypts writes, SSL_write must not be used
+  struct us_internal_key_operation *key_operation; // signing or decrypting on the handshake pool
+  char *key_operation_input; // records that arrived while key_operation held the handshake
+  unsigned int key_operation_input_length;
 };
 
 int passphrase_cb(char *buf, int size, int rwflag, void *u) {
@@ -142,6 +205,16 @@ int BIO_s_custom_write(BIO *bio, const char *data, int length) {
   struct loop_ssl_data *loop_ssl_data =
       (struct loop_ssl_data *)BIO_get_data(bio);
 
+#ifdef LIBUS_USE_KTLS
+  // the kernel owns the write keys and sequence numbers now, anything BoringSSL
+  // still wants to send (a TLS 1.3 KeyUpdate reply) would be out of step with
+  // them, so fail the connection instead of corrupting it
+  if (((struct us_internal_ssl_socket_t *)loop_ssl_data->ssl_socket)->ktls_tx) {
+    BIO_clear_retry_flags(bio);
+    return -1;
+  }
+#endif
+
   loop_ssl_data->last_write_was_msg_more =
       loop_ssl_data->msg_more || length == 16413;
   int written = us_socket_write(0, loop_ssl_data->ssl_socket, data, length,
@@ -212,6 +285,11 @@ struct us_internal_ssl_socket_t *ssl_on_open(struct us_internal_ssl_socket_t *s,
   s->ssl_write_wants_read = 0;
   s->ssl_read_wants_write = 0;
   s->fatal_error = 0;
+  s->ssl_write_wants_write = 0;
+  s->ktls_tx = 0;
+  s->key_operation = NULL;
+  s->key_operation_input = NULL;
+  s->key_operation_input_length = 0;
   s->handshake_state = HANDSHAKE_PENDING;
   
 
@@ -254,6 +332,25 @@ struct us_internal_ssl_socket_t *ssl_on_open(struct us_internal_ssl_socket_t *s,
   return result;
 }
 
+#ifdef LIBUS_USE_KTLS
+// SSL_shutdown would encrypt close_notify with keys the kernel has since moved
+// past, so send it through the kernel and only record that it went out
+static void us_internal_ssl_socket_ktls_shutdown(struct us_internal_ssl_socket_t *s) {
+  int state = SSL_get_shutdown(s->ssl);
+  if (state & SSL_SENT_SHUTDOWN) return;
+  if (!SSL_get_quiet_shutdown(s->ssl)) {
+#ifdef LIBUS_USE_IO_URING
+    // records the ring still has queued must reach the peer before the alert
+    if (us_internal_ring_serves_writes(&s->s) && us_internal_ring_drain(&s->s)) {
+      us_internal_ring_after_drain(&s->s, us_internal_ktls_send_close_notify);
+    } else
+#endif
+    us_internal_ktls_send_close_notify(us_poll_fd(&s->s.p));
+  }
+  SSL_set_shutdown(s->ssl, state | SSL_SENT_SHUTDOWN);
+}
+#endif
+
 /// @brief Complete the shutdown or do a fast shutdown when needed, this should only be called before closing the socket
 /// @param s 
 int us_internal_handle_shutdown(struct us_internal_ssl_socket_t *s, int force_fast_shutdown) {
@@ -272,6 +369,13 @@ int us_internal_handle_shutdown(struct us_internal_ssl_socket_t *s, int force_fa
   int received_shutdown = state & SSL_RECEIVED_SHUTDOWN;
   // if we are missing a shutdown call, we need to do a fast shutdown here
   if(!sent_shutdown || !received_shutdown) {
+#ifdef LIBUS_USE_KTLS
+    if (s->ktls_tx) {
+      us_internal_ssl_socket_ktls_shutdown(s);
+      // like SSL_shutdown, waits for the peer's close_notify unless forced
+      return force_fast_shutdown || received_shutdown;
+    }
+#endif
     // make sure that the ssl loop data is set
     us_internal_set_loop_ssl_data(s);
     // Zero means that we should wait for the peer to close the connection
@@ -392,6 +496,28 @@ int us_internal_ssl_renegotiate(struct us_internal_ssl_socket_t *s) {
   return 1;
 }
 
+#ifdef LIBUS_USE_KTLS
+static void us_internal_ssl_socket_enable_ktls_tx(struct us_internal_ssl_socket_t *s) {
+  struct us_internal_ssl_socket_context_t *context =
+      (struct us_internal_ssl_socket_context_t *)us_socket_context(0, &s->s);
+  struct loop_ssl_data *loop_ssl_data =
+      (struct loop_ssl_data *)us_socket_context_loop(0, &context->sc)->data.ssl_data;
+
+  // an early SSL_write (from on_data, before this callback) may have left a
+  // record half sent, and only BoringSSL can finish it
+  if (!loop_ssl_data->ktls_tx || s->ssl_write_wants_write) return;
+  // a TLS 1.2 client can be asked to renegotiate, which needs BoringSSL to write
+  // handshake records again
+  if (SSL_version(s->ssl) != TLS1_3_VERSION && !SSL_is_server(s->ssl)) return;
+
+  int result = us_internal_ktls_enable_tx(s->ssl, us_poll_fd(&s->s.p));
+  if (result < 0) {
+    loop_ssl_data->ktls_tx = 0;
+  }
+  s->ktls_tx = result > 0;
+}
+#endif
+
 void us_internal_update_handshake(struct us_internal_ssl_socket_t *s) {
 
   // nothing todo here, renegotiation must be handled in SSL_read
@@ -415,7 +541,8 @@ void us_internal_update_handshake(struct us_internal_ssl_socket_t *s) {
   if (result <= 0) {
     int err = SSL_get_error(s->ssl, result);
     // as far as I know these are the only errors we want to handle
-    if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
+    if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE &&
+        err != SSL_ERROR_WANT_PRIVATE_KEY_OPERATION) {
       // clear per thread error queue if it may contain something
       if (err == SSL_ERROR_SSL || err == SSL_ERROR_SYSCALL) {
         ERR_clear_error();
@@ -431,6 +558,12 @@ void us_internal_update_handshake(struct us_internal_ssl_socket_t *s) {
     return;
   }
   // success
+#ifdef LIBUS_USE_SESSION_STORE
+  us_internal_ssl_session_store_count_handshake(s->ssl);
+#endif
+#ifdef LIBUS_USE_KTLS
+  us_internal_ssl_socket_enable_ktls_tx(s);
+#endif
   us_internal_trigger_handshake_callback(s, 1);
   s->ssl_write_wants_read = 1;
 }
@@ -442,6 +575,15 @@ ssl_on_close(struct us_internal_ssl_socket_t *s, int code, void *reason) {
 
   us_internal_set_loop_ssl_data(s);
   struct us_internal_ssl_socket_t * ret = context->on_close(s, code, reason);
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+  if (s->key_operation) {
+    us_internal_key_operation_cancel(s->key_operation);
+    s->key_operation = NULL;
+  }
+  us_free(s->key_operation_input);
+  s->key_operation_input = NULL;
+  s->key_operation_input_length = 0;
+#endif
   SSL_free(s->ssl); // free SSL after on_close
   s->ssl = NULL; // set to NULL
   return ret;
@@ -470,6 +612,32 @@ ssl_on_end(struct us_internal_ssl_socket_t *s) {
   return us_internal_ssl_socket_close(s, 0, NULL);
 }
 
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+/* BoringSSL stops reading as soon as a private key operation suspends the
+ * handshake, so whatever followed it in the same read (the ChangeCipherSpec and
+ * Finished behind an RSA ClientKeyExchange) is kept here until it resumes */
+static int ssl_keep_key_operation_input(struct us_internal_ssl_socket_t *s,
+                                        const char *data, unsigned int length) {
+  if (s->key_operation_input && data >= s->key_operation_input &&
+      data < s->key_operation_input + s->key_operation_input_length) {
+    // resumed from this buffer and suspended again before the end of it
+    memmove(s->key_operation_input, data, length);
+    s->key_operation_input_length = length;
+    return 1;
+  }
+
+  char *input = us_realloc(s->key_operation_input,
+                           s->key_operation_input_length + length);
+  if (!input) {
+    return 0;
+  }
+  memcpy(input + s->key_operation_input_length, data, length);
+  s->key_operation_input = input;
+  s->key_operation_input_length += length;
+  return 1;
+}
+#endif
+
 // this whole function needs a complete clean-up
 struct us_internal_ssl_socket_t *ssl_on_data(struct us_internal_ssl_socket_t *s,
                                              void *data, int length) {
@@ -494,6 +662,22 @@ struct us_internal_ssl_socket_t *ssl_on_data(struct us_internal_ssl_socket_t *s,
       return NULL;
   }
 
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+  // anything newer queues up behind the records kept when a private key
+  // operation suspended the handshake, and those go into the BIO first once it
+  // is done (ssl_key_operations_ready comes back through here)
+  if (s->key_operation_input) {
+    if (length && !ssl_keep_key_operation_input(s, data, (unsigned int)length)) {
+      return us_internal_ssl_socket_close(s, 0, NULL);
+    }
+    if (s->key_operation) {
+      return s;
+    }
+    loop_ssl_data->ssl_read_input = s->key_operation_input;
+    loop_ssl_data->ssl_read_input_length = s->key_operation_input_length;
+  }
+#endif
+
   // bug checking: this loop needs a lot of attention and clean-ups and
   // check-ups
   int read = 0;
@@ -507,8 +691,10 @@ restart:
     
     if (just_read <= 0) {
       int err = SSL_get_error(s->ssl, just_read);
-      // as far as I know these are the only errors we want to handle
-      if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
+      // as far as I know these are the only errors we want to handle, a
+      // private key operation resumes us from ssl_key_operations_ready
+      if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE &&
+          err != SSL_ERROR_WANT_PRIVATE_KEY_OPERATION) {
         if (err == SSL_ERROR_WANT_RENEGOTIATE) {
           if (us_internal_ssl_renegotiate(s)) {
             // ok, we are done here, we need to call SSL_read again
@@ -556,6 +742,27 @@ restart:
           s->ssl_read_wants_write = 1;
         }
 
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+        if (err == SSL_ERROR_WANT_PRIVATE_KEY_OPERATION &&
+            loop_ssl_data->ssl_read_input_length) {
+          if (!ssl_keep_key_operation_input(
+                  s,
+                  loop_ssl_data->ssl_read_input +
+                      loop_ssl_data->ssl_read_input_offset,
+                  loop_ssl_data->ssl_read_input_length)) {
+            return us_internal_ssl_socket_close(s, 0, NULL);
+          }
+          loop_ssl_data->ssl_read_input_length = 0;
+        } else if (s->key_operation_input &&
+                   loop_ssl_data->ssl_read_input == s->key_operation_input &&
+                   !loop_ssl_data->ssl_read_input_length) {
+          // everything kept while the handshake was suspended has been read
+          us_free(s->key_operation_input);
+          s->key_operation_input = NULL;
+          s->key_operation_input_length = 0;
+        }
+#endif
+
         // assume we emptied the input buffer fully or error here as well!
         if (loop_ssl_data->ssl_read_input_length) {
           return us_internal_ssl_socket_close(s, 0, NULL);
@@ -661,6 +868,100 @@ ssl_on_writable(struct us_internal_ssl_socket_t *s) {
   return s;
 }
 
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+/* Internal asyncs are called with their loop */
+static void ssl_key_operations_ready(struct us_internal_async *a) {
+  struct us_loop_t *loop = (struct us_loop_t *)a;
+  struct loop_ssl_data *loop_ssl_data = (struct loop_ssl_data *)loop->data.ssl_data;
+
+  struct us_internal_key_operation *operation;
+  while ((operation = us_internal_key_operations_pop(loop_ssl_data->key_operations))) {
+    struct us_internal_ssl_socket_t *s = us_internal_key_operation_user(operation);
+    if (!s) {
+      // the socket closed while the pool had it
+      us_internal_key_operation_cancel(operation);
+      continue;
+    }
+
+    // pick the handshake up where SSL_read left it, it collects the result
+    // from ssl_private_key_complete, then ssl_on_data feeds the BIO whatever
+    // arrived behind the operation
+    struct us_internal_ssl_socket_context_t *context =
+        (struct us_internal_ssl_socket_context_t *)us_socket_context(0, &s->s);
+    context->sc.on_data(&s->s, 0, 0);
+  }
+}
+
+static enum ssl_private_key_result_t
+ssl_private_key_start(SSL *ssl, uint16_t signature_algorithm, const uint8_t *in,
+                      size_t in_len) {
+  struct loop_ssl_data *loop_ssl_data =
+      (struct loop_ssl_data *)BIO_get_data(SSL_get_rbio(ssl));
+  struct us_internal_ssl_socket_t *s =
+      (struct us_internal_ssl_socket_t *)loop_ssl_data->ssl_socket;
+  if (!s || s->ssl != ssl || s->key_operation) {
+    return ssl_private_key_failure;
+  }
+
+  if (!loop_ssl_data->key_operations) {
+    struct us_loop_t *loop = us_socket_context_loop(0, us_socket_context(0, &s->s));
+    loop_ssl_data->key_operations_async = us_internal_create_async(loop, 1, 0);
+    loop_ssl_data->key_operations =
+        us_internal_key_operations_create(loop_ssl_data->key_operations_async);
+    us_internal_async_set(loop_ssl_data->key_operations_async,
+                          ssl_key_operations_ready);
+  }
+
+  s->key_operation = us_internal_key_operation_submit(
+      loop_ssl_data->key_operations, SSL_get_privatekey(ssl),
+      signature_algorithm, in, in_len, s);
+  return s->key_operation ? ssl_private_key_retry : ssl_private_key_failure;
+}
+
+static enum ssl_private_key_result_t
+ssl_private_key_sign(SSL *ssl, uint8_t *out, size_t *out_len, size_t max_out,
+                     uint16_t signature_algorithm, const uint8_t *in,
+                     size_t in_len) {
+  return ssl_private_key_start(ssl, signature_algorithm, in, in_len);
+}
+
+/* RSA key exchange, only used by TLS 1.2 clients that offer no ECDHE */
+static enum ssl_private_key_result_t
+ssl_private_key_decrypt(SSL *ssl, uint8_t *out, size_t *out_len,
+                        size_t max_out, const uint8_t *in, size_t in_len) {
+  return ssl_private_key_start(ssl, 0, in, in_len);
+}
+
+static enum ssl_private_key_result_t
+ssl_private_key_complete(SSL *ssl, uint8_t *out, size_t *out_len,
+                         size_t max_out) {
+  struct loop_ssl_data *loop_ssl_data =
+      (struct loop_ssl_data *)BIO_get_data(SSL_get_rbio(ssl));
+  struct us_internal_ssl_socket_t *s =
+      (struct us_internal_ssl_socket_t *)loop_ssl_data->ssl_socket;
+  if (!s || s->ssl != ssl || !s->key_operation) {
+    return ssl_private_key_failure;
+  }
+  if (!us_internal_key_operation_done(s->key_operation)) {
+    return ssl_private_key_retry;
+  }
+
+  struct us_internal_key_operation *operation = s->key_operation;
+  s->key_operation = NULL;
+  return us_internal_key_operation_finish(operation, out, out_len, max_out)
+             ? ssl_private_key_success
+             : ssl_private_key_failure;
+}
+
+/* Signing or decrypting with the certificate's key happens on the handshake
+ * pool (BUN_TLS_HANDSHAKE_THREADS) and the loop carries on with other sockets */
+static const SSL_PRIVATE_KEY_METHOD ssl_private_key_method = {
+    .sign = ssl_private_key_sign,
+    .decrypt = ssl_private_key_decrypt,
+    .complete = ssl_private_key_complete,
+};
+#endif
+
 /* Lazily inits loop ssl data first time */
 void us_internal_init_loop_ssl_data(struct us_loop_t *loop) {
   if (!loop->data.ssl_data) {
@@ -674,6 +975,11 @@ void us_internal_init_loop_ssl_data(struct us_loop_t *loop) {
     loop_ssl_data->ssl_read_output =
         us_malloc(LIBUS_RECV_BUFFER_LENGTH + LIBUS_RECV_BUFFER_PADDING * 2);
 
+#ifdef LIBUS_USE_KTLS
+    const char *ktls = getenv("BUN_FEATURE_FLAG_KTLS");
+    loop_ssl_data->ktls_tx = ktls && (!strcmp(ktls, "1") || !strcmp(ktls, "true"));
+#endif
+
     OPENSSL_init_ssl(0, NULL);
 
     loop_ssl_data->shared_biom = BIO_meth_new(BIO_TYPE_MEM, "µS BIO");
@@ -697,6 +1003,13 @@ void us_internal_free_loop_ssl_data(struct us_loop_t *loop) {
       (struct loop_ssl_data *)loop->data.ssl_data;
 
   if (loop_ssl_data) {
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+    if (loop_ssl_data->key_operations) {
+      // operations still on the pool are dropped when they finish
+      us_internal_key_operations_free(loop_ssl_data->key_operations);
+      us_internal_async_close(loop_ssl_data->key_operations_async);
+    }
+#endif
     us_free(loop_ssl_data->ssl_read_output);
 
     BIO_free(loop_ssl_data->shared_rbio);
@@ -724,6 +1037,27 @@ void *us_internal_ssl_socket_context_get_native_handle(
   return context->ssl_context;
 }
 
+void us_internal_ssl_socket_context_session_stats(
+    struct us_internal_ssl_socket_context_t *context,
+    struct us_socket_context_session_stats_t *stats) {
+#ifdef LIBUS_USE_SESSION_STORE
+  us_internal_ssl_session_store_stats(context->ssl_context, stats);
+#else
+  memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+int us_internal_ssl_socket_context_set_ticket_keys(
+    struct us_internal_ssl_socket_context_t *context, const unsigned char *keys,
+    unsigned int length) {
+#ifdef LIBUS_USE_SESSION_STORE
+  return us_internal_ssl_session_store_set_ticket_keys(context->ssl_context,
+                                                       keys, length);
+#else
+  return 0;
+#endif
+}
+
 struct us_internal_ssl_socket_context_t *
 us_internal_create_child_ssl_socket_context(
     struct us_internal_ssl_socket_context_t *context, int context_ext_size) {
@@ -1323,6 +1657,13 @@ SSL_CTX *create_ssl_context_from_bun_options(
     SSL_CTX_set_options(ssl_context, options.secure_options);
   }
 
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+  if (us_internal_handshake_pool_enabled() &&
+      SSL_CTX_get0_privatekey(ssl_context)) {
+    SSL_CTX_set_private_key_method(ssl_context, &ssl_private_key_method);
+  }
+#endif
+
   /* This must be free'd with free_ssl_context, not SSL_CTX_free */
   return ssl_context;
 }
@@ -1399,12 +1740,45 @@ int us_bun_internal_ssl_socket_context_add_server_name(
     return -1;
   }
 
-  if (sni_add(context->sni, hostname_pattern, ssl_context)) {
+  int added = sni_add(context->sni, hostname_pattern, ssl_context);
+  if (added) {
     /* If we already had that name, ignore */
     free_ssl_context(ssl_context);
   }
 
-  return 0;
+  /* Out of memory */
+  return added < 0 ? -1 : 0;
+}
+
+/* Swaps the certificate of a name in place, or adds it. Handshakes already past SNI keep the old
+ * SSL_CTX, which they hold a reference to */
+int us_bun_internal_ssl_socket_context_replace_server_name(
+    struct us_internal_ssl_socket_context_t *context,
+    const char *hostname_pattern,
+    struct us_bun_socket_context_options_t options, void *user) {
+
+  enum create_bun_socket_error_t err = CREATE_BUN_SOCKET_ERROR_NONE;
+  SSL_CTX *ssl_context = create_ssl_context_from_bun_options(options, &err);
+  if (ssl_context == NULL) {
+    return -1;
+  }
+
+  if (1 != SSL_CTX_set_ex_data(ssl_context, 0, user)) {
+#if BUN_DEBUG
+    printf("CANNOT SET EX DATA!\n");
+    abort();
+#endif
+    free_ssl_context(ssl_context);
+    return -1;
+  }
+
+  SSL_CTX *previous =
+      (SSL_CTX *)sni_replace(context->sni, hostname_pattern, ssl_context);
+  /* Out of memory, the name keeps whatever it had */
+  int failed = previous == ssl_context;
+  free_ssl_context(previous);
+
+  return failed ? -1 : 0;
 }
 
 void us_internal_ssl_socket_context_on_server_name(
@@ -1457,6 +1831,10 @@ int sni_cb(SSL *ssl, int *al, void *arg) {
       SSL_CTX *resolved_ssl_context = resolve_context(
           (struct us_internal_ssl_socket_context_t *)arg, hostname);
       if (resolved_ssl_context) {
+#ifdef LIBUS_USE_SESSION_STORE
+        /* tickets and the session cache stay with the parent SSL_CTX */
+        us_internal_ssl_session_store_pin(ssl);
+#endif
         SSL_set_SSL_CTX(ssl, resolved_ssl_context);
       } else {
         /* Call a blocking callback notifying of missing context */
@@ -1513,6 +1891,10 @@ struct us_internal_ssl_socket_context_t *us_internal_create_ssl_socket_context(
   /* Also create the SNI tree */
   context->sni = sni_new();
 
+#ifdef LIBUS_USE_SESSION_STORE
+  us_internal_ssl_session_store_attach(context->ssl_context);
+#endif
+
   return context;
 }
 struct us_internal_ssl_socket_context_t *
@@ -1559,6 +1941,10 @@ us_internal_bun_create_ssl_socket_context(
   /* Also create the SNI tree */
   context->sni = sni_new();
 
+#ifdef LIBUS_USE_SESSION_STORE
+  us_internal_ssl_session_store_attach(context->ssl_context);
+#endif
+
   return context;
 }
 
@@ -1606,6 +1992,11 @@ static void us_internal_zero_ssl_data_for_connected_socket_before_onopen(struct
   s->ssl_write_wants_read = 0;
   s->ssl_read_wants_write = 0;
   s->fatal_error = 0;
+  s->ssl_write_wants_write = 0;
+  s->ktls_tx = 0;
+  s->key_operation = NULL;
+  s->key_operation_input = NULL;
+  s->key_operation_input_length = 0;
   s->handshake_state = HANDSHAKE_PENDING;
 }
 
@@ -1761,6 +2152,16 @@ int us_internal_ssl_socket_write(struct us_internal_ssl_socket_t *s,
     return 0;
   }
 
+#ifdef LIBUS_USE_KTLS
+  // the kernel frames and encrypts, so this is a plain (possibly partial) send.
+  // MSG_MORE would make the kernel hold the record open until a later send
+  // without it, and callers only expect that flush on the userspace path, so
+  // every write closes its record
+  if (s->ktls_tx) {
+    return us_socket_write(0, &s->s, data, length, 0);
+  }
+#endif
+
   struct us_internal_ssl_socket_context_t *context =
       (struct us_internal_ssl_socket_context_t *)us_socket_context(0, &s->s);
 
@@ -1781,6 +2182,7 @@ int us_internal_ssl_socket_write(struct us_internal_ssl_socket_t *s,
 
   int written = SSL_write(s->ssl, data, length);
   loop_ssl_data->msg_more = 0;
+  s->ssl_write_wants_write = written <= 0 && SSL_get_error(s->ssl, written) == SSL_ERROR_WANT_WRITE;
   if (loop_ssl_data->last_write_was_msg_more && !msg_more) {
     us_socket_flush(0, &s->s);
   }
@@ -1841,6 +2243,15 @@ void us_internal_ssl_socket_shutdown(struct us_internal_ssl_socket_t *s) {
     loop_ssl_data->ssl_socket = &s->s;
 
     loop_ssl_data->msg_more = 0;
+#ifdef LIBUS_USE_KTLS
+    if (s->ktls_tx) {
+      us_internal_ssl_socket_ktls_shutdown(s);
+      if (SSL_get_quiet_shutdown(s->ssl)) {
+        us_socket_shutdown(0, &s->s);
+      }
+      return;
+    }
+#endif
     // sets SSL_SENT_SHUTDOWN and waits for the other side to do the same
     int ret = SSL_shutdown(s->ssl);
 
@@ -1873,9 +2284,16 @@ struct us_internal_ssl_socket_t *us_internal_ssl_socket_context_adopt_socket(
   if (ext_size != -1) {
     new_ext_size = sizeof(struct us_internal_ssl_socket_t) - sizeof(struct us_socket_t) + ext_size;
   }
-  return (struct us_internal_ssl_socket_t *)us_socket_context_adopt_socket(
-      0, &context->sc, &s->s,
-      new_ext_size);
+  struct us_internal_ssl_socket_t *new_s =
+      (struct us_internal_ssl_socket_t *)us_socket_context_adopt_socket(
+          0, &context->sc, &s->s, new_ext_size);
+#ifdef LIBUS_USE_HANDSHAKE_POOL
+  // the socket may have moved in memory
+  if (new_s->key_operation) {
+    us_internal_key_operation_set_user(new_s->key_operation, new_s);
+  }
+#endif
+  return new_s;
 }
 
 struct us_internal_ssl_socket_t *
@@ -2057,6 +2475,11 @@ struct us_socket_t *us_socket_upgrade_to_tls(us_socket_r s, us_socket_context_r
   socket->ssl_write_wants_read = 0;
   socket->ssl_read_wants_write = 0;
   socket->fatal_error = 0;
+  socket->ssl_write_wants_write = 0;
+  socket->ktls_tx = 0;
+  socket->key_operation = NULL;
+  socket->key_operation_input = NULL;
+  socket->key_operation_input_length = 0;
   socket->handshake_state = HANDSHAKE_PENDING;
 
   void** new_ext_ptr = (void**)us_socket_ext(1, (struct us_socket_t *)socket);
@@ -2181,6 +2604,11 @@ us_socket_context_on_socket_connect_error(
   socket->ssl_write_wants_read = 0;
   socket->ssl_read_wants_write = 0;
   socket->fatal_error = 0;
+  socket->ssl_write_wants_write = 0;
+  socket->ktls_tx = 0;
+  socket->key_operation = NULL;
+  socket->key_operation_input = NULL;
+  socket->key_operation_input_length = 0;
   socket->handshake_state = HANDSHAKE_PENDING;
   // always resume the socket
   us_socket_resume(1, &socket->s);
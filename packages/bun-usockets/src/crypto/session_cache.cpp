@@ -0,0 +1,431 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ *     http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Session resumption that survives landing on a different process. Every SSL_CTX otherwise makes
+ * up its own ticket keys and keeps its own session cache, so with reusePort a returning client
+ * usually reaches a process that cannot resume it.
+ *
+ * Ticket keys: set per context with us_socket_context_set_ticket_keys, or for every server in the
+ * process from BUN_TLS_TICKET_KEYS_FILE. Either takes 1 to 4 keys in Node's 48 byte ticketKeys
+ * layout; the first encrypts new tickets and the rest are only accepted, with the ticket renewed.
+ * The file is re-read when it changes, so keys rotate by prepending a new one and dropping the last.
+ *
+ * Session IDs: with BUN_TLS_SESSION_CACHE_SHM set to a name like "/bun-tls-sessions", sessions are
+ * also kept in a fixed size table in that POSIX shared memory object, mapped by every process on
+ * the host. BoringSSL only resumes TLS 1.3 from tickets, so this helps TLS 1.2 clients that do not
+ * use them. The table holds master secrets, so it is never a regular file: it lives in memory,
+ * must be owned by and private to the current user, and stays until shm_unlink or a reboot. */
+
+#if defined(LIBUS_USE_OPENSSL)
+
+#include "internal/internal.h"
+#include "libusockets.h"
+
+#include <openssl/ssl.h>
+
+#ifdef OPENSSL_IS_BORINGSSL
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/mem.h>
+#include <openssl/rand.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct ticket_key {
+    uint8_t name[16];
+    uint8_t hmac_secret[16];
+    uint8_t aes_key[16];
+};
+static_assert(sizeof(ticket_key) == 48, "ticket keys are in Node's 48 byte layout");
+
+constexpr unsigned max_ticket_keys = 4;
+/* How stale BUN_TLS_TICKET_KEYS_FILE may be, so handshakes do not all stat() it */
+constexpr time_t ticket_keys_file_check_interval = 5;
+
+#ifndef _WIN32
+constexpr uint32_t shared_cache_magic = 0x43535375; /* "uSSC" */
+constexpr uint32_t shared_cache_version = 1;
+constexpr uint32_t shared_cache_slots = 8192;
+constexpr uint32_t shared_cache_slot_size = 1024;
+
+struct shared_cache_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint8_t reserved[48];
+};
+
+/* One session, guarded by a sequence lock: sequence is odd while a process writes the slot.
+ * Nobody waits on it; a writer that finds it taken drops its session and a reader whose copy
+ * raced a writer counts a miss */
+struct shared_cache_slot {
+    uint32_t sequence;
+    uint8_t id_length;
+    uint8_t reserved;
+    uint16_t session_length;
+    int64_t expires;
+    uint8_t id[SSL_MAX_SSL_SESSION_ID_LENGTH];
+    uint8_t session[shared_cache_slot_size - 48];
+};
+static_assert(sizeof(shared_cache_slot) == shared_cache_slot_size, "slots are a fixed size on disk");
+#endif
+
+struct session_store {
+    ticket_key keys[max_ticket_keys];
+    unsigned key_count;
+
+    /* Cleared once keys are set explicitly, which then win over the file */
+    char *keys_file;
+    time_t keys_file_mtime;
+    time_t keys_file_checked;
+
+#ifndef _WIN32
+    /* Mapped on first use, so client contexts never open it */
+    char *cache_name;
+    void *cache_mapping;
+    size_t cache_mapping_length;
+    int cache_failed;
+#endif
+
+    struct us_socket_context_session_stats_t stats;
+};
+
+void free_session_store(void *, void *ptr, CRYPTO_EX_DATA *, int, long, void *) {
+    session_store *store = (session_store *) ptr;
+    if (!store) return;
+#ifndef _WIN32
+    if (store->cache_mapping) munmap(store->cache_mapping, store->cache_mapping_length);
+    free(store->cache_name);
+#endif
+    free(store->keys_file);
+    OPENSSL_cleanse(store->keys, sizeof(store->keys));
+    free(store);
+}
+
+int ssl_ctx_store_index() {
+    static int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, free_session_store);
+    return index;
+}
+
+/* Set by sni_cb before it swaps the SSL_CTX, since resumption keeps using the one the handshake
+ * started on */
+int ssl_store_index() {
+    static int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+session_store *store_for_ssl(SSL *ssl) {
+    session_store *store = (session_store *) SSL_get_ex_data(ssl, ssl_store_index());
+    if (store) return store;
+    return (session_store *) SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), ssl_ctx_store_index());
+}
+
+/* Leaves the current keys alone unless the whole file is valid */
+int read_ticket_keys_file(session_store *store) {
+    FILE *file = fopen(store->keys_file, "rb");
+    if (!file) return 0;
+    uint8_t buffer[max_ticket_keys * sizeof(ticket_key) + 1];
+    size_t length = fread(buffer, 1, sizeof(buffer), file);
+    fclose(file);
+
+    int valid = length && length % sizeof(ticket_key) == 0 && length <= max_ticket_keys * sizeof(ticket_key);
+    if (valid) {
+        memcpy(store->keys, buffer, length);
+        store->key_count = (unsigned) (length / sizeof(ticket_key));
+    }
+    OPENSSL_cleanse(buffer, sizeof(buffer));
+    return valid;
+}
+
+void refresh_ticket_keys(session_store *store) {
+    if (!store->keys_file) return;
+    time_t now = time(nullptr);
+    if (now - store->keys_file_checked < ticket_keys_file_check_interval) return;
+    store->keys_file_checked = now;
+
+    struct stat info;
+    if (stat(store->keys_file, &info) != 0 || info.st_mtime == store->keys_file_mtime) return;
+    if (read_ticket_keys_file(store)) store->keys_file_mtime = info.st_mtime;
+}
+
+int ticket_key_cb(SSL *ssl, uint8_t *key_name, uint8_t *iv, EVP_CIPHER_CTX *cipher_ctx, HMAC_CTX *hmac_ctx, int encrypt) {
+    session_store *store = store_for_ssl(ssl);
+    if (!store || !store->key_count) return encrypt ? -1 : 0;
+    refresh_ticket_keys(store);
+
+    if (encrypt) {
+        const ticket_key &key = store->keys[0];
+        if (!RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_128_cbc()))) return -1;
+        memcpy(key_name, key.name, sizeof(key.name));
+        if (!EVP_EncryptInit_ex(cipher_ctx, EVP_aes_128_cbc(), nullptr, key.aes_key, iv) ||
+            !HMAC_Init_ex(hmac_ctx, key.hmac_secret, sizeof(key.hmac_secret), EVP_sha256(), nullptr)) {
+            return -1;
+        }
+        store->stats.tickets_issued++;
+        return 1;
+    }
+
+    for (unsigned i = 0; i < store->key_count; i++) {
+        const ticket_key &key = store->keys[i];
+        if (CRYPTO_memcmp(key_name, key.name, sizeof(key.name))) continue;
+        if (!HMAC_Init_ex(hmac_ctx, key.hmac_secret, sizeof(key.hmac_secret), EVP_sha256(), nullptr) ||
+            !EVP_DecryptInit_ex(cipher_ctx, EVP_aes_128_cbc(), nullptr, key.aes_key, iv)) {
+            return -1;
+        }
+        /* An older key still decrypts but asks for a ticket under the current one */
+        return i == 0 ? 1 : 2;
+    }
+    return 0;
+}
+
+#ifndef _WIN32
+shared_cache_slot *shared_cache_slots_for(session_store *store) {
+    if (!store->cache_name || store->cache_failed) return nullptr;
+    if (store->cache_mapping) return (shared_cache_slot *) ((char *) store->cache_mapping + sizeof(shared_cache_header));
+
+    store->cache_failed = 1;
+    size_t length = sizeof(shared_cache_header) + (size_t) shared_cache_slots * sizeof(shared_cache_slot);
+    int fd = shm_open(store->cache_name, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return nullptr;
+
+    /* Refuse an object another user made or can read. The first process sizes it; zeroed slots
+     * are empty ones. Some systems round the size up to a page */
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_uid != geteuid() || (info.st_mode & 077) ||
+        (info.st_size == 0 && ftruncate(fd, (off_t) length) != 0) ||
+        (info.st_size != 0 && (size_t) info.st_size < length)) {
+        close(fd);
+        return nullptr;
+    }
+    void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return nullptr;
+
+    shared_cache_header *header = (shared_cache_header *) mapping;
+    if (!__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE)) {
+        /* Racing processes all write the same values */
+        header->version = shared_cache_version;
+        header->slot_count = shared_cache_slots;
+        header->slot_size = shared_cache_slot_size;
+        __atomic_store_n(&header->magic, shared_cache_magic, __ATOMIC_RELEASE);
+    }
+    if (header->magic != shared_cache_magic || header->version != shared_cache_version ||
+        header->slot_count != shared_cache_slots || header->slot_size != shared_cache_slot_size) {
+        munmap(mapping, length);
+        return nullptr;
+    }
+
+    store->cache_mapping = mapping;
+    store->cache_mapping_length = length;
+    store->cache_failed = 0;
+    return (shared_cache_slot *) ((char *) mapping + sizeof(shared_cache_header));
+}
+
+shared_cache_slot *shared_cache_slot_for(shared_cache_slot *slots, const uint8_t *id, unsigned id_length) {
+    /* Session IDs are random, so their first bytes are as good as any hash */
+    uint32_t hash = id_length;
+    for (unsigned i = 0; i < id_length && i < 4; i++) hash = (hash << 8) | id[i];
+    return &slots[hash % shared_cache_slots];
+}
+
+/* Returns the sequence the slot was claimed at, or 0 if another process is writing it */
+uint32_t shared_cache_lock_slot(shared_cache_slot *slot) {
+    uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    if ((sequence & 1) || !__atomic_compare_exchange_n(&slot->sequence, &sequence, sequence + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return sequence + 1;
+}
+
+void shared_cache_unlock_slot(shared_cache_slot *slot, uint32_t sequence) {
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+/* Returns 0 so BoringSSL keeps its reference; the session is stored serialized */
+int shared_cache_new_session_cb(SSL *ssl, SSL_SESSION *session) {
+    session_store *store = store_for_ssl(ssl);
+    shared_cache_slot *slots = store ? shared_cache_slots_for(store) : nullptr;
+    if (!slots) return 0;
+
+    unsigned id_length;
+    const uint8_t *id = SSL_SESSION_get_id(session, &id_length);
+    if (!id_length || id_length > SSL_MAX_SSL_SESSION_ID_LENGTH) return 0;
+
+    uint8_t *data;
+    size_t length;
+    if (!SSL_SESSION_to_bytes(session, &data, &length)) return 0;
+    shared_cache_slot *slot = shared_cache_slot_for(slots, id, id_length);
+    uint32_t sequence;
+    if (length <= sizeof(slot->session) && (sequence = shared_cache_lock_slot(slot))) {
+        slot->id_length = (uint8_t) id_length;
+        memcpy(slot->id, id, id_length);
+        slot->expires = (int64_t) SSL_SESSION_get_time(session) + (int64_t) SSL_SESSION_get_timeout(session);
+        slot->session_length = (uint16_t) length;
+        memcpy(slot->session, data, length);
+        /* Nothing of the session this replaces stays behind */
+        OPENSSL_cleanse(slot->session + length, sizeof(slot->session) - length);
+        shared_cache_unlock_slot(slot, sequence);
+    }
+    OPENSSL_free(data);
+    return 0;
+}
+
+SSL_SESSION *shared_cache_get_session_cb(SSL *ssl, const uint8_t *id, int id_length, int *out_copy) {
+    *out_copy = 0;
+    session_store *store = store_for_ssl(ssl);
+    shared_cache_slot *slots = store ? shared_cache_slots_for(store) : nullptr;
+    if (!slots || id_length <= 0 || id_length > SSL_MAX_SSL_SESSION_ID_LENGTH) return nullptr;
+
+    shared_cache_slot *slot = shared_cache_slot_for(slots, id, (unsigned) id_length);
+    shared_cache_slot copy;
+    uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    memcpy(&copy, slot, sizeof(copy));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    int torn = (sequence & 1) || sequence != __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+
+    SSL_SESSION *session = nullptr;
+    if (!torn && copy.id_length == id_length && !memcmp(copy.id, id, id_length) &&
+        copy.session_length <= sizeof(copy.session) && copy.expires > (int64_t) time(nullptr)) {
+        session = SSL_SESSION_from_bytes(copy.session, copy.session_length, SSL_get_SSL_CTX(ssl));
+    }
+    OPENSSL_cleanse(&copy, sizeof(copy));
+
+    if (session) {
+        store->stats.shared_cache_hits++;
+    } else {
+        store->stats.shared_cache_misses++;
+    }
+    return session;
+}
+
+void shared_cache_remove_session_cb(SSL_CTX *ssl_context, SSL_SESSION *session) {
+    session_store *store = (session_store *) SSL_CTX_get_ex_data(ssl_context, ssl_ctx_store_index());
+    shared_cache_slot *slots = store ? shared_cache_slots_for(store) : nullptr;
+    if (!slots) return;
+
+    unsigned id_length;
+    const uint8_t *id = SSL_SESSION_get_id(session, &id_length);
+    if (!id_length || id_length > SSL_MAX_SSL_SESSION_ID_LENGTH) return;
+    shared_cache_slot *slot = shared_cache_slot_for(slots, id, id_length);
+    uint32_t sequence = shared_cache_lock_slot(slot);
+    if (!sequence) return;
+    if (slot->id_length == id_length && !memcmp(slot->id, id, id_length)) {
+        slot->id_length = 0;
+        slot->session_length = 0;
+        OPENSSL_cleanse(slot->session, sizeof(slot->session));
+    }
+    shared_cache_unlock_slot(slot, sequence);
+}
+#endif
+
+char *getenv_copy(const char *name) {
+    const char *value = getenv(name);
+    if (!value || !value[0]) return nullptr;
+#ifdef _WIN32
+    return _strdup(value);
+#else
+    return strdup(value);
+#endif
+}
+
+}
+
+extern "C" {
+
+/* Called for every parent SSL_CTX; the store is freed along with it */
+void us_internal_ssl_session_store_attach(SSL_CTX *ssl_context) {
+    session_store *store = (session_store *) calloc(1, sizeof(session_store));
+    if (!store) return;
+    if (!SSL_CTX_set_ex_data(ssl_context, ssl_ctx_store_index(), store)) {
+        free(store);
+        return;
+    }
+
+    store->keys_file = getenv_copy("BUN_TLS_TICKET_KEYS_FILE");
+    if (store->keys_file) {
+        struct stat info;
+        store->keys_file_checked = time(nullptr);
+        if (stat(store->keys_file, &info) == 0 && read_ticket_keys_file(store)) {
+            store->keys_file_mtime = info.st_mtime;
+            SSL_CTX_set_tlsext_ticket_key_cb(ssl_context, ticket_key_cb);
+        }
+    }
+
+#ifndef _WIN32
+    store->cache_name = getenv_copy("BUN_TLS_SESSION_CACHE_SHM");
+    if (store->cache_name) {
+        SSL_CTX_sess_set_new_cb(ssl_context, shared_cache_new_session_cb);
+        SSL_CTX_sess_set_get_cb(ssl_context, shared_cache_get_session_cb);
+        SSL_CTX_sess_set_remove_cb(ssl_context, shared_cache_remove_session_cb);
+    }
+#endif
+}
+
+void us_internal_ssl_session_store_pin(SSL *ssl) {
+    void *store = SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), ssl_ctx_store_index());
+    if (store) SSL_set_ex_data(ssl, ssl_store_index(), store);
+}
+
+void us_internal_ssl_session_store_count_handshake(SSL *ssl) {
+    session_store *store = store_for_ssl(ssl);
+    if (!store) return;
+    if (SSL_session_reused(ssl)) {
+        store->stats.resumed_handshakes++;
+    } else {
+        store->stats.full_handshakes++;
+    }
+}
+
+int us_internal_ssl_session_store_set_ticket_keys(SSL_CTX *ssl_context, const unsigned char *keys, unsigned int length) {
+    session_store *store = (session_store *) SSL_CTX_get_ex_data(ssl_context, ssl_ctx_store_index());
+    if (!store || !length || length % sizeof(ticket_key) || length > max_ticket_keys * sizeof(ticket_key)) return 0;
+
+    free(store->keys_file);
+    store->keys_file = nullptr;
+    memcpy(store->keys, keys, length);
+    store->key_count = length / sizeof(ticket_key);
+    SSL_CTX_set_tlsext_ticket_key_cb(ssl_context, ticket_key_cb);
+    return 1;
+}
+
+void us_internal_ssl_session_store_stats(SSL_CTX *ssl_context, struct us_socket_context_session_stats_t *stats) {
+    session_store *store = (session_store *) SSL_CTX_get_ex_data(ssl_context, ssl_ctx_store_index());
+    if (store) {
+        *stats = store->stats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+}
+
+#endif
+#endif
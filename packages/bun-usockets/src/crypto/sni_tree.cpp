@@ -15,204 +15,308 @@
  * limitations under the License.
  */
 
-/* This Server Name Indication hostname tree is written in C++ but could be ported to C.
- * Overall it looks like crap, but has no memory allocations in fast path and is O(log n). */
+/* Server Name Indication lookup. Names and patterns live in one open addressing hash table keyed by
+ * the whole name, so an exact match is one probe and "*.example.com" is a second one. A "*" label
+ * matches any one label, anywhere in a pattern; for each label count we remember which positions
+ * any pattern has a "*" at, and only try wildcards there. Candidates are tried in the order the old
+ * label tree used: at each label from the left, the label itself before the wildcard.
+ *
+ * No allocations on lookup for names up to SNI_MAX_NAME_LENGTH. */
 
 #ifndef SNI_TREE_H
 #define SNI_TREE_H
 
 #ifndef LIBUS_NO_SSL
 
-#include <map>
-#include <memory>
 #include <string_view>
 #include <cstring>
 #include <cstdlib>
-#include <algorithm>
+#include <cstdint>
+#include <string>
 
 /* We only handle a maximum of 10 labels per hostname */
 #define MAX_LABELS 10
+/* DNS names are at most 253 characters, anything longer is looked up through a temporary string */
+#define SNI_MAX_NAME_LENGTH 256
 
-/* This cannot be shared */
-thread_local void (*sni_free_cb)(void *);
+namespace {
 
-struct sni_node {
-    /* Empty nodes must always hold null */
-    void *user = nullptr;
-    std::map<std::string_view, std::unique_ptr<sni_node>> children;
+struct sni_entry {
+    uint64_t hash;
+    /* nullptr for an empty slot */
+    char *name;
+    size_t length;
+    void *user;
+};
 
-    ~sni_node() {
-        for (auto &p : children) {
-            /* The data of our string_views are managed by malloc */
-            free((void *) p.first.data());
+struct sni_table {
+    sni_entry *entries = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
 
-            /* Call destructor passed to sni_free only if we hold data.
-             * This is important since sni_remove does not have sni_free_cb set */
-            if (p.second.get()->user) {
-                sni_free_cb(p.second.get()->user);
-            }
-        }
-    }
+    /* How many patterns of each label count have a "*" at each position */
+    unsigned int wildcards[MAX_LABELS + 1][MAX_LABELS] = {};
+    /* The positions above that are in use, leftmost label as the highest bit */
+    unsigned int wildcardMasks[MAX_LABELS + 1] = {};
 };
 
-// this can only delete ONE single node, but may cull "empty nodes with null as data"
-void *removeUser(struct sni_node *root, unsigned int label, std::string_view *labels, unsigned int numLabels) {
+struct sni_labels {
+    std::string_view labels[MAX_LABELS];
+    unsigned int numLabels = 0;
+};
 
-    /* If we are in the bottom (past bottom by one), there is nothing to remove */
-    if (label == numLabels) {
-        void *user = root->user;
-        /* Mark us for culling on the way up */
-        root->user = nullptr;
-        return user;
-    }
+/* Splits on dots the way the label tree did, so "a.b." is "a.b". False past MAX_LABELS */
+bool splitLabels(std::string_view view, sni_labels &out) {
+    for (std::string_view label; view.length(); view.remove_prefix(std::min(view.length(), label.length() + 1))) {
+        /* Label is the token separated by dot */
+        label = view.substr(0, view.find('.', 0));
 
-    /* Is this label a child of root? */
-    auto it = root->children.find(labels[label]);
-    if (it == root->children.end()) {
-        /* We cannot continue */
-        return nullptr;
-    }
+        /* Anything longer than 10 labels is forbidden */
+        if (out.numLabels == MAX_LABELS) {
+            return false;
+        }
 
-    void *removedUser = removeUser(it->second.get(), label + 1, labels, numLabels);
+        out.labels[out.numLabels++] = label;
+    }
+    return true;
+}
 
-    /* On the way back up, we may cull empty nodes with no children.
-     * This ends up being where we remove all nodes */
-    if (it->second.get()->children.empty() && it->second.get()->user == nullptr) {
+uint64_t hashName(const char *name, size_t length) {
+    /* FNV-1a */
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char) name[i]) * 1099511628211ull;
+    }
+    return hash;
+}
 
-        /* The data of our string_views are managed by malloc */
-        free((void *) it->first.data());
+sni_entry *findEntry(sni_table *table, const char *name, size_t length, uint64_t hash) {
+    if (!table->capacity) {
+        return nullptr;
+    }
+    size_t mask = table->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        sni_entry *entry = &table->entries[i];
+        if (!entry->name) {
+            return nullptr;
+        }
+        if (entry->hash == hash && entry->length == length && !memcmp(entry->name, name, length)) {
+            return entry;
+        }
+    }
+}
 
-        /* This can only happen with user set to null, otherwise we use sni_free_cb which is unset by sni_remove */
-        root->children.erase(it);
+void insertEntry(sni_entry *entries, size_t capacity, const sni_entry &entry) {
+    size_t mask = capacity - 1;
+    size_t i = entry.hash & mask;
+    while (entries[i].name) {
+        i = (i + 1) & mask;
     }
+    entries[i] = entry;
+}
 
-    return removedUser;
+/* Keeps the load factor at or under one half. False, with the table untouched, if out of memory */
+bool reserve(sni_table *table, size_t size) {
+    if (size * 2 <= table->capacity) {
+        return true;
+    }
+    size_t capacity = table->capacity ? table->capacity * 2 : 16;
+    while (size * 2 > capacity) {
+        capacity *= 2;
+    }
+    sni_entry *entries = (sni_entry *) calloc(capacity, sizeof(sni_entry));
+    if (!entries) {
+        return false;
+    }
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->entries[i].name) {
+            insertEntry(entries, capacity, table->entries[i]);
+        }
+    }
+    free(table->entries);
+    table->entries = entries;
+    table->capacity = capacity;
+    return true;
 }
 
-void *getUser(struct sni_node *root, unsigned int label, std::string_view *labels, unsigned int numLabels) {
+/* Linear probing deletion without tombstones: pull later entries of the run back into the hole */
+void eraseEntry(sni_table *table, sni_entry *entry) {
+    size_t mask = table->capacity - 1;
+    size_t hole = entry - table->entries;
+    free(entry->name);
+    for (size_t i = (hole + 1) & mask; table->entries[i].name; i = (i + 1) & mask) {
+        size_t home = table->entries[i].hash & mask;
+        /* Move it if its home slot is not cyclically in (hole, i] */
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            table->entries[hole] = table->entries[i];
+            hole = i;
+        }
+    }
+    table->entries[hole] = sni_entry {};
+    table->size--;
+}
 
-    /* Do we have labels to match? Otherwise, return where we stand */
-    if (label == numLabels) {
-        return root->user;
+void countWildcards(sni_table *table, std::string_view name, int delta) {
+    sni_labels labels;
+    if (!splitLabels(name, labels)) {
+        /* Never found either, so it needs no bookkeeping */
+        return;
+    }
+    unsigned int n = labels.numLabels;
+    for (unsigned int i = 0; i < n; i++) {
+        if (labels.labels[i] == "*") {
+            unsigned int &count = table->wildcards[n][i];
+            count += delta;
+            unsigned int bit = 1u << (n - 1 - i);
+            table->wildcardMasks[n] = count ? (table->wildcardMasks[n] | bit) : (table->wildcardMasks[n] & ~bit);
+        }
     }
+}
 
-    /* Try and match by our label */
-    auto it = root->children.find(labels[label]);
-    if (it != root->children.end()) {
-        void *user = getUser(it->second.get(), label + 1, labels, numLabels);
-        if (user) {
-            return user;
+/* The name as the table keys it: every label followed by a dot, so "" and "." stay apart */
+size_t joinLabels(const sni_labels &labels, unsigned int wildcardBits, char *out) {
+    size_t length = 0;
+    for (unsigned int i = 0; i < labels.numLabels; i++) {
+        if (wildcardBits & (1u << (labels.numLabels - 1 - i))) {
+            out[length++] = '*';
+        } else {
+            memcpy(out + length, labels.labels[i].data(), labels.labels[i].length());
+            length += labels.labels[i].length();
         }
+        out[length++] = '.';
     }
+    return length;
+}
 
-    /* Try and match by wildcard */
-    it = root->children.find("*");
-    if (it == root->children.end()) {
-        /* Matching has failed for both label and wildcard */
-        return nullptr;
+/* Same as joinLabels, for names of any length being added or removed */
+std::string keyFor(const char *hostname) {
+    std::string key;
+    std::string_view view(hostname, strlen(hostname));
+    for (std::string_view label; view.length(); view.remove_prefix(std::min(view.length(), label.length() + 1))) {
+        label = view.substr(0, view.find('.', 0));
+        key += label;
+        key += '.';
     }
+    return key;
+}
 
-    /* We matched by wildcard */
-    return getUser(it->second.get(), label + 1, labels, numLabels);
 }
 
 extern "C" {
 
     void *sni_new() {
-        return new sni_node;
+        return new sni_table;
     }
 
     void sni_free(void *sni, void (*cb)(void *)) {
-        /* We want to run this callback for every remaining name */
-        sni_free_cb = cb;
+        sni_table *table = (sni_table *) sni;
 
-        delete (sni_node *) sni;
+        /* We want to run this callback for every remaining name */
+        for (size_t i = 0; i < table->capacity; i++) {
+            if (table->entries[i].name) {
+                free(table->entries[i].name);
+                cb(table->entries[i].user);
+            }
+        }
+        free(table->entries);
+        delete table;
     }
 
-    /* Returns non-null if this name already exists */
+    /* Returns 0 if added, 1 if this name already exists and -1 if out of memory */
     int sni_add(void *sni, const char *hostname, void *user) {
-        struct sni_node *root = (struct sni_node *) sni;
-
-        /* Traverse all labels in hostname */
-        for (std::string_view view(hostname, strlen(hostname)), label;
-            view.length(); view.remove_prefix(std::min(view.length(), label.length() + 1))) {
-            /* Label is the token separated by dot */
-            label = view.substr(0, view.find('.', 0));
-
-            auto it = root->children.find(label);
-            if (it == root->children.end()) {
-                /* Duplicate this label for our kept string_view of it */
-                void *labelString = malloc(label.length());
-                memcpy(labelString, label.data(), label.length());
-
-                it = root->children.emplace(std::string_view((char *) labelString, label.length()),
-                                            std::make_unique<sni_node>()).first; // NOLINT(clang-analyzer-unix.Malloc)
-            }
-
-            root = it->second.get();
-        }
+        sni_table *table = (sni_table *) sni;
+        std::string key = keyFor(hostname);
+        uint64_t hash = hashName(key.data(), key.length());
 
         /* We must never add multiple contexts for the same name, as that would overwrite and leak */
-        if (root->user) {
+        if (findEntry(table, key.data(), key.length(), hash)) {
             return 1;
         }
 
-        root->user = user;
+        if (!reserve(table, table->size + 1)) {
+            return -1;
+        }
+        char *name = (char *) malloc(key.length() + 1);
+        if (!name) {
+            return -1;
+        }
+        memcpy(name, key.data(), key.length() + 1);
+        insertEntry(table->entries, table->capacity, sni_entry { hash, name, key.length(), user });
+        table->size++;
+        countWildcards(table, key, 1);
 
         return 0;
     }
 
+    /* Swaps in user for an existing name, returning the one it had, or adds it and returns null.
+     * Returns user itself if it could not be added. Lets a certificate be replaced without a moment
+     * where the name is missing */
+    void *sni_replace(void *sni, const char *hostname, void *user) {
+        sni_table *table = (sni_table *) sni;
+        std::string key = keyFor(hostname);
+        sni_entry *entry = findEntry(table, key.data(), key.length(), hashName(key.data(), key.length()));
+        if (!entry) {
+            return sni_add(sni, hostname, user) ? user : nullptr;
+        }
+        void *previous = entry->user;
+        entry->user = user;
+        return previous;
+    }
+
     /* Removes the exact match. Wildcards are treated as the verbatim asterisk char, not as an actual wildcard */
     void *sni_remove(void *sni, const char *hostname) {
-        struct sni_node *root = (struct sni_node *) sni;
-
-        /* I guess 10 labels is an okay limit */
-        std::string_view labels[10];
-        unsigned int numLabels = 0;
-
-        /* We traverse all labels first of all */
-        for (std::string_view view(hostname, strlen(hostname)), label;
-            view.length(); view.remove_prefix(std::min(view.length(), label.length() + 1))) {
-            /* Label is the token separated by dot */
-            label = view.substr(0, view.find('.', 0));
-
-            /* Anything longer than 10 labels is forbidden */
-            if (numLabels == 10) {
-                return nullptr;
-            }
-
-            labels[numLabels++] = label;
+        sni_table *table = (sni_table *) sni;
+        std::string key = keyFor(hostname);
+        sni_entry *entry = findEntry(table, key.data(), key.length(), hashName(key.data(), key.length()));
+        if (!entry) {
+            return nullptr;
         }
-
-        return removeUser(root, 0, labels, numLabels);
+        void *user = entry->user;
+        countWildcards(table, key, -1);
+        eraseEntry(table, entry);
+        return user;
     }
 
     void *sni_find(void *sni, const char *hostname) {
-        struct sni_node *root = (struct sni_node *) sni;
+        sni_table *table = (sni_table *) sni;
+        if (!table->size) {
+            return nullptr;
+        }
 
-        /* I guess 10 labels is an okay limit */
-        std::string_view labels[10];
-        unsigned int numLabels = 0;
+        size_t hostnameLength = strlen(hostname);
+        sni_labels labels;
+        if (!splitLabels(std::string_view(hostname, hostnameLength), labels)) {
+            return nullptr;
+        }
 
-        /* We traverse all labels first of all */
-        for (std::string_view view(hostname, strlen(hostname)), label;
-            view.length(); view.remove_prefix(std::min(view.length(), label.length() + 1))) {
-            /* Label is the token separated by dot */
-            label = view.substr(0, view.find('.', 0));
+        /* A wildcard can stand in for an empty label and every label gets a dot, so a candidate
+         * may be a little longer than the name */
+        char stackBuffer[SNI_MAX_NAME_LENGTH + 2 * MAX_LABELS];
+        std::string heapBuffer;
+        char *buffer = stackBuffer;
+        if (hostnameLength + 2 * MAX_LABELS > sizeof(stackBuffer)) {
+            heapBuffer.resize(hostnameLength + 2 * MAX_LABELS);
+            buffer = heapBuffer.data();
+        }
 
-            /* Anything longer than 10 labels is forbidden */
-            if (numLabels == 10) {
-                return nullptr;
+        /* Every subset of the wildcard positions in increasing order, starting from the empty one
+         * (the name itself), is exactly the tree's label before wildcard, left to right order */
+        unsigned int mask = table->wildcardMasks[labels.numLabels];
+        unsigned int bits = 0;
+        do {
+            size_t length = joinLabels(labels, bits, buffer);
+            sni_entry *entry = findEntry(table, buffer, length, hashName(buffer, length));
+            if (entry) {
+                return entry->user;
             }
+            bits = (bits - mask) & mask;
+        } while (bits);
 
-            labels[numLabels++] = label;
-        }
-
-        return getUser(root, 0, labels, numLabels);
+        return nullptr;
     }
 
 }
 
 #endif
 
-#endif
\ No newline at end of file
+#endif
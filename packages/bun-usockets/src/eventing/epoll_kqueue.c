@@ -51,6 +51,9 @@ void us_loop_run_bun_tick(struct us_loop_t *loop, const struct timespec* timeout
 
 /* Loop */
 void us_loop_free(struct us_loop_t *loop) {
+#ifdef LIBUS_USE_IO_URING
+    us_internal_ring_free(loop);
+#endif
     us_internal_loop_data_free(loop);
     close(loop->fd);
     us_free(loop);
@@ -78,6 +81,10 @@ void *us_poll_ext(struct us_poll_t *p) {
 void us_poll_init(struct us_poll_t *p, LIBUS_SOCKET_DESCRIPTOR fd, int poll_type) {
     p->state.fd = fd;
     p->state.poll_type = poll_type;
+#ifdef LIBUS_USE_IO_URING
+    p->epoll_events = -1;
+    p->ring = 0;
+#endif
 }
 
 int us_poll_events(struct us_poll_t *p) {
@@ -186,6 +193,9 @@ struct us_loop_t *us_create_loop(void *hint, void (*wakeup_cb)(struct us_loop_t
 #endif
 
     us_internal_loop_data_init(loop, wakeup_cb, pre_cb, post_cb);
+#ifdef LIBUS_USE_IO_URING
+    us_internal_ring_init(loop);
+#endif
     return loop;
 }
 
@@ -197,6 +207,11 @@ void us_loop_run(struct us_loop_t *loop) {
         /* Emit pre callback */
         us_internal_loop_pre(loop);
 
+#ifdef LIBUS_USE_IO_URING
+        /* Everything queued for the ring this iteration goes out in one submission */
+        us_internal_ring_submit(loop);
+#endif
+
         /* Fetch ready polls */
 #ifdef LIBUS_USE_EPOLL
         loop->num_ready_polls = bun_epoll_pwait2(loop->fd, loop->ready_polls, 1024, NULL);
@@ -268,6 +283,11 @@ void us_loop_run_bun_tick(struct us_loop_t *loop, const struct timespec* timeout
     /* Safe if jsc_vm is NULL */
     Bun__JSC_onBeforeWait(loop->data.jsc_vm);
 
+#ifdef LIBUS_USE_IO_URING
+    /* Everything queued for the ring this iteration goes out in one submission */
+    us_internal_ring_submit(loop);
+#endif
+
     /* Fetch ready polls */
 #ifdef LIBUS_USE_EPOLL
     loop->num_ready_polls = bun_epoll_pwait2(loop->fd, loop->ready_polls, 1024, timeout);
@@ -377,6 +397,25 @@ struct us_poll_t *us_poll_resize(struct us_poll_t *p, struct us_loop_t *loop, un
     int events = us_poll_events(p);
 
     struct us_poll_t *new_p = us_realloc(p, sizeof(struct us_poll_t) + ext_size);
+#ifdef LIBUS_USE_IO_URING
+    if (p != new_p) {
+        us_internal_ring_poll_moved(new_p);
+
+        /* Only whatever is registered with epoll refers to the old address */
+        if (new_p->epoll_events != -1) {
+            struct epoll_event event;
+            event.events = new_p->epoll_events;
+            event.data.ptr = new_p;
+            int rc;
+            do {
+                rc = epoll_ctl(loop->fd, EPOLL_CTL_MOD, new_p->state.fd, &event);
+            } while (IS_EINTR(rc));
+        }
+
+        us_internal_loop_update_pending_ready_polls(loop, p, new_p, events, events);
+    }
+    return new_p;
+#endif
     if (p != new_p && events) {
 #ifdef LIBUS_USE_EPOLL
         /* Hack: forcefully update poll by stripping away already set events */
@@ -394,10 +433,46 @@ struct us_poll_t *us_poll_resize(struct us_poll_t *p, struct us_loop_t *loop, un
     return new_p;
 }
 
+#ifdef LIBUS_USE_IO_URING
+/* Lets the ring take what it serves and brings the epoll registration in line with the rest */
+static int us_internal_epoll_update(struct us_poll_t *p, struct us_loop_t *loop, int events) {
+    int epoll_events = us_internal_ring_poll_events(loop, p, events);
+
+    int op;
+    if (epoll_events == -1) {
+        if (p->epoll_events == -1) {
+            return 0;
+        }
+        op = EPOLL_CTL_DEL;
+    } else if (p->epoll_events == -1) {
+        op = EPOLL_CTL_ADD;
+    } else if (p->epoll_events != epoll_events) {
+        op = EPOLL_CTL_MOD;
+    } else {
+        return 0;
+    }
+
+    struct epoll_event event;
+    event.events = epoll_events;
+    event.data.ptr = p;
+    int rc;
+    do {
+        rc = epoll_ctl(loop->fd, op, p->state.fd, &event);
+    } while (IS_EINTR(rc));
+
+    if (rc == 0 || op == EPOLL_CTL_DEL) {
+        p->epoll_events = epoll_events;
+    }
+    return rc;
+}
+#endif
+
 int us_poll_start_rc(struct us_poll_t *p, struct us_loop_t *loop, int events) {
     p->state.poll_type = us_internal_poll_type(p) | ((events & LIBUS_SOCKET_READABLE) ? POLL_TYPE_POLLING_IN : 0) | ((events & LIBUS_SOCKET_WRITABLE) ? POLL_TYPE_POLLING_OUT : 0);
 
-#ifdef LIBUS_USE_EPOLL
+#if defined(LIBUS_USE_IO_URING)
+    return us_internal_epoll_update(p, loop, events);
+#elif defined(LIBUS_USE_EPOLL)
     struct epoll_event event;
     event.events = events;
     event.data.ptr = p;
@@ -421,7 +496,9 @@ void us_poll_change(struct us_poll_t *p, struct us_loop_t *loop, int events) {
 
         p->state.poll_type = us_internal_poll_type(p) | ((events & LIBUS_SOCKET_READABLE) ? POLL_TYPE_POLLING_IN : 0) | ((events & LIBUS_SOCKET_WRITABLE) ? POLL_TYPE_POLLING_OUT : 0);
 
-#ifdef LIBUS_USE_EPOLL
+#if defined(LIBUS_USE_IO_URING)
+        us_internal_epoll_update(p, loop, events);
+#elif defined(LIBUS_USE_EPOLL)
         struct epoll_event event;
         event.events = events;
         event.data.ptr = p;
@@ -440,7 +517,17 @@ void us_poll_change(struct us_poll_t *p, struct us_loop_t *loop, int events) {
 void us_poll_stop(struct us_poll_t *p, struct us_loop_t *loop) {
     int old_events = us_poll_events(p);
     int new_events = 0;
-#ifdef LIBUS_USE_EPOLL
+#if defined(LIBUS_USE_IO_URING)
+    us_internal_ring_poll_stop(loop, p);
+    if (p->epoll_events != -1) {
+        struct epoll_event event;
+        int rc;
+        do {
+             rc = epoll_ctl(loop->fd, EPOLL_CTL_DEL, p->state.fd, &event);
+        } while (IS_EINTR(rc));
+        p->epoll_events = -1;
+    }
+#elif defined(LIBUS_USE_EPOLL)
     struct epoll_event event;
     int rc;
     do {
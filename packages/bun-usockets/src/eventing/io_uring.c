@@ -0,0 +1,1040 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ *     http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "libusockets.h"
+#include "internal/internal.h"
+
+#ifdef LIBUS_USE_IO_URING
+
+/* The io_uring backend runs next to epoll: Bun's own polls, timers, asyncs, UDP and connecting sockets
+ * stay in the epoll set, and so does the ring's own fd which becomes readable with new completions.
+ * Listen sockets use multishot accept, sockets use multishot recv into a provided buffer ring, and all
+ * sends queued during an iteration go out with one io_uring_enter right before the loop waits.
+ *
+ * It is only compiled in with LIBUS_USE_IO_URING (make usockets USE_IO_URING=1) and then still needs
+ * BUN_FEATURE_FLAG_IO_URING=1 at runtime. Writes are reported as written once they are queued here, and a
+ * caller about to write to the fd directly waits on the loop thread for the send in flight (us_internal_ring_drain) */
+
+#include <linux/io_uring.h>
+#ifndef IORING_RECV_MULTISHOT
+#error "LIBUS_USE_IO_URING needs the io_uring headers of Linux 6.0 or newer (multishot recv, provided buffer rings)"
+#endif
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#define LIBUS_RING_ENTRIES 4096
+#define LIBUS_RING_RECV_BUFFERS 1024
+#define LIBUS_RING_RECV_BUFFER_LENGTH (1 << 14)
+#define LIBUS_RING_RECV_BUFFER_GROUP 0
+/* Bytes queued per socket before writes start to come up short, like on a full kernel buffer */
+#define LIBUS_RING_SEND_BUFFER_LIMIT (1 << 16)
+
+#define RING_BUFFER_STRIDE (LIBUS_RING_RECV_BUFFER_LENGTH + LIBUS_RECV_BUFFER_PADDING * 2)
+
+/* Low bits of user_data tell what a completion is for, the rest points to its ring socket */
+enum {
+    RING_OP_WAKEUP = 0,
+    RING_OP_ACCEPT = 1,
+    RING_OP_RECV = 2,
+    RING_OP_SEND = 3,
+    RING_OP_CANCEL = 4,
+};
+#define RING_OP_MASK 7
+
+/* Ring side of a socket, outlives the socket until every request referring to it has completed */
+struct us_internal_ring_socket_t {
+    alignas(8) struct us_poll_t *p; /* 0 once detached from its socket */
+    LIBUS_SOCKET_DESCRIPTOR fd; /* -1 once nothing may be sent anymore */
+    unsigned int refs; /* Requests in flight plus dispatches in progress */
+
+    /* What the socket wants */
+    unsigned char is_listen, accepting, receiving, want_writable;
+    /* What the ring is doing about it. Multishots stay armed until their last completion, even when cancelled */
+    unsigned char accept_armed, accept_cancelled, recv_armed, recv_cancelled, send_armed;
+
+    unsigned char close_fd, shutdown_pending, is_dirty, is_ready;
+    /* Set while a direct write waits for the queue to empty, writable then means empty */
+    unsigned char drain_wanted;
+    /* 0, -1 for EOF or an errno, seen while paused */
+    int stashed_end;
+
+    /* Bytes owned by the send in flight, and bytes queued behind it */
+    char *sending;
+    unsigned int sending_offset, sending_length, sending_capacity;
+    char *queued;
+    unsigned int queued_length, queued_capacity;
+
+    /* Data that arrived after the socket was paused, delivered on resume */
+    char *stashed;
+    unsigned int stashed_length;
+
+    /* Runs once everything queued went out, for writes that must not get ahead of it */
+    void (*after_drain)(LIBUS_SOCKET_DESCRIPTOR fd);
+
+    struct us_internal_ring_socket_t *next_dirty, *next_ready;
+    /* Every ring socket of a ring, so that freeing the loop can free those still waiting for completions */
+    struct us_internal_ring_t *ring;
+    struct us_internal_ring_socket_t *prev, *next;
+};
+
+struct us_internal_ring_t {
+    int fd;
+    unsigned int to_submit;
+
+    unsigned int *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned int sq_entries;
+    struct io_uring_sqe *sqes;
+
+    unsigned int *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *rings;
+    size_t rings_size, sqes_size;
+
+    struct io_uring_buf_ring *buf_ring;
+    char *buffers;
+    unsigned short buf_tail;
+
+    struct us_internal_callback_t *poll;
+    struct us_loop_t *loop;
+
+    /* Sockets whose requests need updating, handled right before submitting */
+    struct us_internal_ring_socket_t *dirty_head;
+    /* Sockets with writable or stashed events to emit after the next completions */
+    struct us_internal_ring_socket_t *ready_head;
+    struct us_internal_ring_socket_t *sockets;
+
+    /* Completions taken off the queue while waiting for a send, handled before any newer ones */
+    struct io_uring_cqe *deferred;
+    unsigned int deferred_head, deferred_length, deferred_capacity;
+};
+
+static int ring_enter(int fd, unsigned int to_submit) {
+    int ret;
+    do {
+        ret = (int) syscall(__NR_io_uring_enter, fd, to_submit, 0, 0, NULL, 0);
+    } while (ret == -1 && errno == EINTR);
+    return ret;
+}
+
+static void ring_flush(struct us_internal_ring_t *ring) {
+    if (ring->to_submit) {
+        /* EBUSY means the completion queue is backed up, what is left goes with the next flush */
+        int ret = ring_enter(ring->fd, ring->to_submit);
+        if (ret > 0) {
+            ring->to_submit -= ret;
+        }
+    }
+}
+
+/* Returns 0 only if the submission queue is still full after flushing it */
+static struct io_uring_sqe *ring_get_sqe(struct us_internal_ring_t *ring) {
+    unsigned int tail = *ring->sq_tail;
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->sq_entries) {
+        ring_flush(ring);
+        if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->sq_entries) {
+            return 0;
+        }
+    }
+
+    unsigned int index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit++;
+    return sqe;
+}
+
+static void ring_recycle_buffer(struct us_internal_ring_t *ring, unsigned short bid) {
+    struct io_uring_buf *buf = &ring->buf_ring->bufs[ring->buf_tail & (LIBUS_RING_RECV_BUFFERS - 1)];
+    buf->addr = (uint64_t) (uintptr_t) (ring->buffers + bid * RING_BUFFER_STRIDE + LIBUS_RECV_BUFFER_PADDING);
+    buf->len = LIBUS_RING_RECV_BUFFER_LENGTH;
+    buf->bid = bid;
+    ring->buf_tail++;
+    __atomic_store_n(&ring->buf_ring->tail, ring->buf_tail, __ATOMIC_RELEASE);
+}
+
+static unsigned int ring_socket_buffered(struct us_internal_ring_socket_t *r) {
+    return (r->sending_length - r->sending_offset) + r->queued_length;
+}
+
+static int ring_socket_writable(struct us_internal_ring_socket_t *r) {
+    return ring_socket_buffered(r) < (r->drain_wanted ? 1 : LIBUS_RING_SEND_BUFFER_LIMIT);
+}
+
+static void ring_mark_dirty(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r) {
+    if (!r->is_dirty) {
+        r->is_dirty = 1;
+        r->next_dirty = ring->dirty_head;
+        ring->dirty_head = r;
+    }
+}
+
+/* Ready sockets are handled after the next batch of completions, a nop makes sure there is one */
+static void ring_mark_ready(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r) {
+    if (!r->is_ready) {
+        r->is_ready = 1;
+        if (!ring->ready_head) {
+            struct io_uring_sqe *sqe = ring_get_sqe(ring);
+            if (sqe) {
+                sqe->opcode = IORING_OP_NOP;
+                sqe->user_data = RING_OP_WAKEUP;
+            }
+        }
+        r->next_ready = ring->ready_head;
+        ring->ready_head = r;
+    }
+}
+
+/* Frees the ring socket once nothing refers to it anymore */
+static void ring_socket_release(struct us_internal_ring_socket_t *r) {
+    if (r->p || r->refs || r->is_dirty || r->is_ready) {
+        return;
+    }
+
+    if (r->prev) {
+        r->prev->next = r->next;
+    } else {
+        r->ring->sockets = r->next;
+    }
+    if (r->next) {
+        r->next->prev = r->prev;
+    }
+
+    if (r->close_fd) {
+        bsd_close_socket(r->fd);
+    }
+    us_free(r->sending);
+    us_free(r->queued);
+    us_free(r->stashed);
+    us_free(r);
+}
+
+static struct us_internal_ring_socket_t *ring_socket(struct us_internal_ring_t *ring, struct us_poll_t *p) {
+    if (!p->ring) {
+        struct us_internal_ring_socket_t *r = us_calloc(1, sizeof(struct us_internal_ring_socket_t));
+        r->p = p;
+        r->fd = us_poll_fd(p);
+        r->ring = ring;
+        r->next = ring->sockets;
+        if (r->next) {
+            r->next->prev = r;
+        }
+        ring->sockets = r;
+        p->ring = r;
+    }
+    return p->ring;
+}
+
+/* Moves the queued bytes up to be sent next once the previous send is through */
+static void ring_take_queued(struct us_internal_ring_socket_t *r) {
+    if (r->sending_offset == r->sending_length && r->queued_length) {
+        char *spare = r->sending;
+        unsigned int spare_capacity = r->sending_capacity;
+        r->sending = r->queued;
+        r->sending_capacity = r->queued_capacity;
+        r->sending_offset = 0;
+        r->sending_length = r->queued_length;
+        r->queued = spare;
+        r->queued_capacity = spare_capacity;
+        r->queued_length = 0;
+    }
+}
+
+static int ring_prep_send(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r) {
+    struct io_uring_sqe *sqe = ring_get_sqe(ring);
+    if (!sqe) {
+        return 0;
+    }
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = r->fd;
+    sqe->addr = (uint64_t) (uintptr_t) (r->sending + r->sending_offset);
+    sqe->len = r->sending_length - r->sending_offset;
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = (uint64_t) (uintptr_t) r | RING_OP_SEND;
+    r->send_armed = 1;
+    r->refs++;
+    return 1;
+}
+
+static int ring_prep_cancel(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r, int op) {
+    struct io_uring_sqe *sqe = ring_get_sqe(ring);
+    if (!sqe) {
+        return 0;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = (uint64_t) (uintptr_t) r | op;
+    sqe->user_data = (uint64_t) (uintptr_t) r | RING_OP_CANCEL;
+    r->refs++;
+    return 1;
+}
+
+/* Brings the requests in flight in line with what the socket wants, stays dirty if the queue is full */
+static void ring_socket_update(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r) {
+    int complete = 1;
+
+    if (r->accepting && !r->accept_armed) {
+        struct io_uring_sqe *sqe = ring_get_sqe(ring);
+        if (sqe) {
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->fd = r->fd;
+            sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+            sqe->accept_flags = SOCK_CLOEXEC | SOCK_NONBLOCK;
+            sqe->user_data = (uint64_t) (uintptr_t) r | RING_OP_ACCEPT;
+            r->accept_armed = 1;
+            r->refs++;
+        } else {
+            complete = 0;
+        }
+    } else if (!r->accepting && r->accept_armed && !r->accept_cancelled) {
+        r->accept_cancelled = ring_prep_cancel(ring, r, RING_OP_ACCEPT);
+        complete &= r->accept_cancelled;
+    }
+
+    if (r->receiving && !r->recv_armed) {
+        struct io_uring_sqe *sqe = ring_get_sqe(ring);
+        if (sqe) {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = r->fd;
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = LIBUS_RING_RECV_BUFFER_GROUP;
+            sqe->user_data = (uint64_t) (uintptr_t) r | RING_OP_RECV;
+            r->recv_armed = 1;
+            r->refs++;
+        } else {
+            complete = 0;
+        }
+    } else if (!r->receiving && r->recv_armed && !r->recv_cancelled) {
+        r->recv_cancelled = ring_prep_cancel(ring, r, RING_OP_RECV);
+        complete &= r->recv_cancelled;
+    }
+
+    /* Only one send per socket is ever in flight, which keeps them in order */
+    if (!r->send_armed && r->fd != -1) {
+        ring_take_queued(r);
+        if (r->sending_offset < r->sending_length) {
+            complete &= ring_prep_send(ring, r);
+        }
+    }
+
+    if (!complete) {
+        ring_mark_dirty(ring, r);
+    }
+}
+
+static void ring_on_accept(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r, int res, int more) {
+    if (res >= 0) {
+        if (r->p && r->accepting) {
+            /* Multishot accept has nowhere to put each peer's address, so ask for it like epoll's accept4 would have filled it in */
+            struct bsd_addr_t addr;
+            us_internal_accept_socket((struct us_listen_socket_t *) r->p, res, bsd_remote_addr(res, &addr) == 0 ? &addr : NULL);
+        } else {
+            bsd_close_socket(res);
+        }
+    }
+
+    if (!more) {
+        r->accept_armed = 0;
+        r->accept_cancelled = 0;
+        r->refs--;
+        /* Multishot accept also ends on errors such as EMFILE, keep accepting like epoll would keep reporting readable */
+        if (r->p && r->accepting) {
+            ring_mark_dirty(ring, r);
+        }
+    }
+}
+
+/* Keeps data for a socket that is paused, to be delivered once it reads again */
+static int ring_stash(struct us_internal_ring_socket_t *r, const char *data, unsigned int length) {
+    char *stashed = us_realloc(r->stashed, r->stashed_length + length);
+    if (!stashed) {
+        return 0;
+    }
+    memcpy(stashed + r->stashed_length, data, length);
+    r->stashed = stashed;
+    r->stashed_length += length;
+    return 1;
+}
+
+/* The checks us_internal_dispatch_ready_poll makes before its own recv: nothing is delivered to a closed socket,
+ * and a socket the context holds back (TLS handshakes over the iteration's budget) goes to the low-priority queue,
+ * which pauses it so its data gets stashed */
+static int ring_socket_may_read(struct us_internal_ring_socket_t *r) {
+    if (!r->p || !r->receiving) {
+        return 0;
+    }
+    struct us_socket_t *s = (struct us_socket_t *) r->p;
+    return !us_socket_is_closed(0, s) && !us_internal_socket_defer_low_prio(s);
+}
+
+static void ring_on_recv(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r, int res, unsigned int flags) {
+    int more = flags & IORING_CQE_F_MORE;
+    if (!more) {
+        r->recv_armed = 0;
+        r->recv_cancelled = 0;
+        r->refs--;
+    }
+
+    if (res > 0) {
+        unsigned short bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        char *data = ring->buffers + bid * RING_BUFFER_STRIDE + LIBUS_RECV_BUFFER_PADDING;
+
+        if (!r->stashed_length && ring_socket_may_read(r)) {
+            struct us_socket_t *s = (struct us_socket_t *) r->p;
+            s->context->on_data(s, data, res);
+        } else if (r->p && !us_socket_is_closed(0, (struct us_socket_t *) r->p) && !ring_stash(r, data, (unsigned int) res)) {
+            /* Dropping it would leave a hole in the stream */
+            us_socket_close(0, (struct us_socket_t *) r->p, LIBUS_ERR, NULL);
+        }
+        ring_recycle_buffer(ring, bid);
+    } else if (res != -ENOBUFS && res != -ECANCELED) {
+        /* EOF or an error, multishot recv is over */
+        if (r->p && r->receiving && !r->stashed_length) {
+            us_internal_dispatch_ready_poll(r->p, res ? -res : 0, res == 0, 0);
+        } else if (r->p) {
+            r->stashed_end = res ? -res : -1;
+        }
+        return;
+    }
+
+    /* Ran out of buffers or got resumed while cancelling, keep receiving */
+    if (!more && r->p && r->receiving) {
+        ring_mark_dirty(ring, r);
+    }
+}
+
+static void ring_on_send(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r, int res) {
+    r->send_armed = 0;
+    r->refs--;
+
+    if (res < 0) {
+        /* The connection is gone, drop whatever is left and let the socket find out */
+        r->sending_offset = r->sending_length = 0;
+        r->queued_length = 0;
+        r->shutdown_pending = 0;
+        r->after_drain = 0;
+        r->drain_wanted = 0;
+        if (r->p) {
+            us_internal_dispatch_ready_poll(r->p, -res, 0, 0);
+        }
+        return;
+    }
+
+    r->sending_offset += res;
+    if (r->sending_offset == r->sending_length) {
+        r->sending_offset = r->sending_length = 0;
+    }
+
+    if (ring_socket_buffered(r)) {
+        ring_socket_update(ring, r);
+    } else {
+        r->drain_wanted = 0;
+        if (r->after_drain) {
+            void (*after_drain)(LIBUS_SOCKET_DESCRIPTOR) = r->after_drain;
+            r->after_drain = 0;
+            after_drain(r->fd);
+        }
+        if (r->shutdown_pending) {
+            r->shutdown_pending = 0;
+            bsd_shutdown_socket(r->fd);
+        }
+    }
+
+    if (r->p && r->want_writable && ring_socket_writable(r)) {
+        ring_mark_ready(ring, r);
+    }
+}
+
+/* Emits what waited for the completions: writable events and data stashed during a pause */
+static void ring_dispatch_ready(struct us_internal_ring_t *ring) {
+    struct us_internal_ring_socket_t *r = ring->ready_head;
+    ring->ready_head = 0;
+
+    while (r) {
+        struct us_internal_ring_socket_t *next = r->next_ready;
+        r->is_ready = 0;
+        r->refs++;
+
+        if ((r->stashed_length || r->stashed_end) && ring_socket_may_read(r)) {
+            char *stashed = r->stashed;
+            unsigned int stashed_length = r->stashed_length;
+            int stashed_end = r->stashed_end;
+            r->stashed = 0;
+            r->stashed_length = 0;
+            r->stashed_end = 0;
+
+            /* Handlers expect padding around the data, which the loop's receive buffer has */
+            char *data = ring->loop->data.recv_buf + LIBUS_RECV_BUFFER_PADDING;
+            for (unsigned int offset = 0; offset < stashed_length && r->p && r->receiving; offset += LIBUS_RECV_BUFFER_LENGTH) {
+                unsigned int length = stashed_length - offset < LIBUS_RECV_BUFFER_LENGTH ? stashed_length - offset : LIBUS_RECV_BUFFER_LENGTH;
+                memcpy(data, stashed + offset, length);
+                struct us_socket_t *s = (struct us_socket_t *) r->p;
+                s->context->on_data(s, data, length);
+            }
+            us_free(stashed);
+
+            if (stashed_end && r->p) {
+                us_internal_dispatch_ready_poll(r->p, stashed_end == -1 ? 0 : stashed_end, stashed_end == -1, 0);
+            } else if (r->p && r->receiving) {
+                ring_mark_dirty(ring, r);
+            }
+        }
+
+        if (r->p && r->want_writable && ring_socket_writable(r)) {
+            us_internal_dispatch_ready_poll(r->p, 0, 0, LIBUS_SOCKET_WRITABLE);
+        }
+
+        r->refs--;
+        ring_socket_release(r);
+        r = next;
+    }
+}
+
+static void ring_complete(struct us_internal_ring_t *ring, struct io_uring_cqe *cqe) {
+    struct us_internal_ring_socket_t *r = (struct us_internal_ring_socket_t *) (uintptr_t) (cqe->user_data & ~(uint64_t) RING_OP_MASK);
+    if (!r) {
+        return;
+    }
+
+    /* Handlers may close the socket, keep r alive until they return */
+    r->refs++;
+    switch (cqe->user_data & RING_OP_MASK) {
+    case RING_OP_ACCEPT:
+        ring_on_accept(ring, r, cqe->res, cqe->flags & IORING_CQE_F_MORE);
+        break;
+    case RING_OP_RECV:
+        ring_on_recv(ring, r, cqe->res, cqe->flags);
+        break;
+    case RING_OP_SEND:
+        ring_on_send(ring, r, cqe->res);
+        break;
+    case RING_OP_CANCEL:
+        r->refs--;
+        break;
+    }
+    r->refs--;
+    ring_socket_release(r);
+}
+
+/* Called by epoll when the ring has completions */
+static void ring_reap(struct us_internal_callback_t *cb) {
+    struct us_loop_t *loop = (struct us_loop_t *) cb;
+    struct us_internal_ring_t *ring = loop->data.ring;
+
+    /* Deferred completions are older than anything still in the queue, and handlers may defer more */
+    for (;;) {
+        struct io_uring_cqe cqe;
+        if (ring->deferred_head < ring->deferred_length) {
+            cqe = ring->deferred[ring->deferred_head++];
+        } else {
+            ring->deferred_head = ring->deferred_length = 0;
+            unsigned int head = *ring->cq_head;
+            if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            cqe = ring->cqes[head & *ring->cq_mask];
+            __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+        }
+        ring_complete(ring, &cqe);
+    }
+
+    ring_dispatch_ready(ring);
+}
+
+static int ring_op_supported(struct io_uring_probe *probe, unsigned int op) {
+    return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+}
+
+static int ring_kernel_supported(int fd) {
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = us_calloc(1, size);
+    int supported = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) == 0
+        && ring_op_supported(probe, IORING_OP_NOP)
+        && ring_op_supported(probe, IORING_OP_ACCEPT)
+        && ring_op_supported(probe, IORING_OP_RECV)
+        && ring_op_supported(probe, IORING_OP_SEND)
+        && ring_op_supported(probe, IORING_OP_ASYNC_CANCEL);
+    us_free(probe);
+    return supported;
+}
+
+/* Multishot recv (Linux 6.0) has no opcode of its own to probe for, and older kernels fail it with EINVAL,
+ * so try one on a socket pair before the ring is used. Everything it submits has completed on return */
+static int ring_recv_multishot_supported(struct us_internal_ring_t *ring) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        return 0;
+    }
+
+    int supported = 0, armed = 0, peer_closed = 0;
+    struct io_uring_sqe *sqe = ring_get_sqe(ring);
+    if (sqe && send(fds[1], "", 1, MSG_NOSIGNAL) == 1) {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fds[0];
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = LIBUS_RING_RECV_BUFFER_GROUP;
+        sqe->user_data = RING_OP_WAKEUP;
+        armed = 1;
+    }
+
+    /* The byte comes back with more to follow if multishot works, closing the peer then ends it */
+    while (armed) {
+        int ret = (int) syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0 && errno != EINTR) {
+            supported = 0;
+            break;
+        }
+        if (ret > 0) {
+            ring->to_submit -= (unsigned int) ret;
+        }
+
+        unsigned int head = *ring->cq_head;
+        while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe cqe = ring->cqes[head & *ring->cq_mask];
+            __atomic_store_n(ring->cq_head, ++head, __ATOMIC_RELEASE);
+            if (cqe.flags & IORING_CQE_F_BUFFER) {
+                ring_recycle_buffer(ring, (unsigned short) (cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+            }
+            if (cqe.res == 1 && (cqe.flags & IORING_CQE_F_MORE)) {
+                supported = 1;
+            }
+            if (!(cqe.flags & IORING_CQE_F_MORE)) {
+                armed = 0;
+            }
+        }
+        if (armed && !peer_closed) {
+            close(fds[1]);
+            peer_closed = 1;
+        }
+    }
+
+    close(fds[0]);
+    if (!peer_closed) {
+        close(fds[1]);
+    }
+    return supported;
+}
+
+void us_internal_ring_init(struct us_loop_t *loop) {
+    /* Opt-in until it has seen more production traffic than epoll */
+    const char *enabled = getenv("BUN_FEATURE_FLAG_IO_URING");
+    if (!enabled || strcmp(enabled, "1") != 0) {
+        return;
+    }
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL;
+    params.cq_entries = LIBUS_RING_ENTRIES * 4;
+
+    int fd = (int) syscall(__NR_io_uring_setup, LIBUS_RING_ENTRIES, &params);
+    if (fd < 0) {
+        /* io_uring is disabled, epoll does it all */
+        return;
+    }
+    if (!ring_kernel_supported(fd)) {
+        close(fd);
+        return;
+    }
+
+    struct us_internal_ring_t *ring = us_calloc(1, sizeof(struct us_internal_ring_t));
+    ring->fd = fd;
+    ring->loop = loop;
+    ring->sq_entries = params.sq_entries;
+    loop->data.ring = ring;
+
+    /* Submission and completion queue share one mapping (IORING_FEAT_SINGLE_MMAP, always there on 6.0) */
+    ring->rings_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (cq_size > ring->rings_size) {
+        ring->rings_size = cq_size;
+    }
+    ring->rings = mmap(0, ring->rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(0, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    ring->buf_ring = mmap(0, LIBUS_RING_RECV_BUFFERS * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring->buffers = mmap(0, (size_t) LIBUS_RING_RECV_BUFFERS * RING_BUFFER_STRIDE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring->rings == MAP_FAILED || ring->sqes == MAP_FAILED || ring->buf_ring == MAP_FAILED || ring->buffers == MAP_FAILED) {
+        us_internal_ring_free(loop);
+        return;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t) (uintptr_t) ring->buf_ring;
+    reg.ring_entries = LIBUS_RING_RECV_BUFFERS;
+    reg.bgid = LIBUS_RING_RECV_BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        us_internal_ring_free(loop);
+        return;
+    }
+
+    char *rings = ring->rings;
+    ring->sq_head = (unsigned int *) (rings + params.sq_off.head);
+    ring->sq_tail = (unsigned int *) (rings + params.sq_off.tail);
+    ring->sq_mask = (unsigned int *) (rings + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *) (rings + params.sq_off.array);
+    ring->cq_head = (unsigned int *) (rings + params.cq_off.head);
+    ring->cq_tail = (unsigned int *) (rings + params.cq_off.tail);
+    ring->cq_mask = (unsigned int *) (rings + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) (rings + params.cq_off.cqes);
+
+    for (unsigned int bid = 0; bid < LIBUS_RING_RECV_BUFFERS; bid++) {
+        ring_recycle_buffer(ring, bid);
+    }
+
+    if (!ring_recv_multishot_supported(ring)) {
+        us_internal_ring_free(loop);
+        return;
+    }
+
+    /* The ring is a fallthrough poll, sockets keep the loop alive on their own */
+    struct us_internal_callback_t *cb = (struct us_internal_callback_t *) us_create_poll(loop, 1, sizeof(struct us_internal_callback_t) - sizeof(struct us_poll_t));
+    memset(cb, 0, sizeof(struct us_internal_callback_t));
+    us_poll_init(&cb->p, fd, POLL_TYPE_CALLBACK);
+    cb->loop = loop;
+    cb->cb_expects_the_loop = 1;
+    cb->leave_poll_ready = 1;
+    cb->cb = ring_reap;
+    ring->poll = cb;
+    us_poll_start(&cb->p, loop, LIBUS_SOCKET_READABLE);
+}
+
+void us_internal_ring_free(struct us_loop_t *loop) {
+    struct us_internal_ring_t *ring = loop->data.ring;
+    if (!ring) {
+        return;
+    }
+
+    if (ring->poll) {
+        us_poll_stop(&ring->poll->p, loop);
+        us_free(ring->poll);
+    }
+    loop->data.ring = 0;
+
+    /* Whatever is still in flight dies with the ring, as do the sockets waiting for it */
+    struct us_internal_ring_socket_t *r = ring->sockets;
+    while (r) {
+        struct us_internal_ring_socket_t *next = r->next;
+        if (r->p) {
+            r->p->ring = 0;
+        }
+        if (r->close_fd) {
+            bsd_close_socket(r->fd);
+        }
+        us_free(r->sending);
+        us_free(r->queued);
+        us_free(r->stashed);
+        us_free(r);
+        r = next;
+    }
+    us_free(ring->deferred);
+
+    if (ring->rings && ring->rings != MAP_FAILED) {
+        munmap(ring->rings, ring->rings_size);
+    }
+    if (ring->sqes && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->buf_ring && ring->buf_ring != MAP_FAILED) {
+        munmap(ring->buf_ring, LIBUS_RING_RECV_BUFFERS * sizeof(struct io_uring_buf));
+    }
+    if (ring->buffers && ring->buffers != MAP_FAILED) {
+        munmap(ring->buffers, (size_t) LIBUS_RING_RECV_BUFFERS * RING_BUFFER_STRIDE);
+    }
+    close(ring->fd);
+    us_free(ring);
+}
+
+void us_internal_ring_submit(struct us_loop_t *loop) {
+    struct us_internal_ring_t *ring = loop->data.ring;
+    if (!ring) {
+        return;
+    }
+
+    struct us_internal_ring_socket_t *r = ring->dirty_head;
+    ring->dirty_head = 0;
+    while (r) {
+        struct us_internal_ring_socket_t *next = r->next_dirty;
+        r->is_dirty = 0;
+        ring_socket_update(ring, r);
+        ring_socket_release(r);
+        r = next;
+    }
+
+    ring_flush(ring);
+}
+
+/* Takes over accept for listen sockets, reading and writing for sockets. Returns the events
+ * epoll still has to watch, or -1 if epoll has nothing to do for this poll */
+int us_internal_ring_poll_events(struct us_loop_t *loop, struct us_poll_t *p, int events) {
+    struct us_internal_ring_t *ring = loop->data.ring;
+    if (!ring) {
+        return events;
+    }
+
+    struct us_internal_ring_socket_t *r = p->ring;
+    int type = us_internal_poll_type(p);
+    if (type == POLL_TYPE_SEMI_SOCKET) {
+        /* Listen sockets start out readable, connecting sockets start out writable */
+        if (!(r && r->is_listen) && !(!r && p->epoll_events == -1 && events == LIBUS_SOCKET_READABLE)) {
+            return events;
+        }
+        r = ring_socket(ring, p);
+        r->is_listen = 1;
+        r->accepting = (events & LIBUS_SOCKET_READABLE) != 0;
+        ring_mark_dirty(ring, r);
+        return -1;
+    }
+
+    if (type != POLL_TYPE_SOCKET && type != POLL_TYPE_SOCKET_SHUT_DOWN) {
+        return events;
+    }
+
+    r = ring_socket(ring, p);
+    int receiving = (events & LIBUS_SOCKET_READABLE) != 0;
+    if (receiving != r->receiving) {
+        r->receiving = receiving;
+        if (receiving && (r->stashed_length || r->stashed_end)) {
+            ring_mark_ready(ring, r);
+        } else {
+            ring_mark_dirty(ring, r);
+        }
+    }
+
+    /* Writable means room in the send buffer, which only the ring knows about */
+    r->want_writable = (events & LIBUS_SOCKET_WRITABLE) != 0;
+    if (r->want_writable && ring_socket_writable(r)) {
+        ring_mark_ready(ring, r);
+    }
+    return -1;
+}
+
+void us_internal_ring_poll_stop(struct us_loop_t *loop, struct us_poll_t *p) {
+    struct us_internal_ring_socket_t *r = p->ring;
+    if (r && loop->data.ring) {
+        r->accepting = r->receiving = r->want_writable = 0;
+        ring_mark_dirty(loop->data.ring, r);
+    }
+}
+
+void us_internal_ring_poll_moved(struct us_poll_t *p) {
+    if (p->ring) {
+        p->ring->p = p;
+    }
+}
+
+int us_internal_ring_serves_writes(struct us_socket_t *s) {
+    int type = us_internal_poll_type(&s->p);
+    return s->context->loop->data.ring && (type == POLL_TYPE_SOCKET || type == POLL_TYPE_SOCKET_SHUT_DOWN);
+}
+
+/* Queues as much as fits into the socket's send buffer, to go out with the next submission */
+int us_internal_ring_write(struct us_socket_t *s, const char *data, int length, const char *data2, int length2) {
+    struct us_internal_ring_t *ring = s->context->loop->data.ring;
+    struct us_internal_ring_socket_t *r = ring_socket(ring, &s->p);
+
+    unsigned int buffered = ring_socket_buffered(r);
+    unsigned int room = buffered < LIBUS_RING_SEND_BUFFER_LIMIT ? LIBUS_RING_SEND_BUFFER_LIMIT - buffered : 0;
+    unsigned int first = length > 0 ? ((unsigned int) length < room ? (unsigned int) length : room) : 0;
+    unsigned int second = length2 > 0 ? ((unsigned int) length2 < room - first ? (unsigned int) length2 : room - first) : 0;
+
+    if (first + second) {
+        unsigned int needed = r->queued_length + first + second;
+        if (needed > r->queued_capacity) {
+            unsigned int capacity = r->queued_capacity * 2 > needed ? r->queued_capacity * 2 : needed;
+            r->queued = us_realloc(r->queued, capacity);
+            r->queued_capacity = capacity;
+        }
+        memcpy(r->queued + r->queued_length, data, first);
+        if (second) {
+            memcpy(r->queued + r->queued_length + first, data2, second);
+        }
+        r->queued_length = needed;
+        ring_mark_dirty(ring, r);
+    }
+
+    return first + second;
+}
+
+int us_internal_ring_shutdown(struct us_socket_t *s) {
+    struct us_internal_ring_socket_t *r = s->p.ring;
+    if (r && ring_socket_buffered(r)) {
+        r->shutdown_pending = 1;
+        return 1;
+    }
+    return 0;
+}
+
+static void ring_defer(struct us_internal_ring_t *ring, struct io_uring_cqe *cqe) {
+    if (ring->deferred_length == ring->deferred_capacity) {
+        ring->deferred_capacity = ring->deferred_capacity ? ring->deferred_capacity * 2 : 64;
+        ring->deferred = us_realloc(ring->deferred, ring->deferred_capacity * sizeof(struct io_uring_cqe));
+    }
+    ring->deferred[ring->deferred_length++] = *cqe;
+}
+
+/* Cancels the socket's send in flight and waits for what it managed to send. Other completions
+ * are deferred to ring_reap, which a nop makes sure runs. Returns 0 if the send failed instead */
+static int ring_wait_send(struct us_internal_ring_t *ring, struct us_internal_ring_socket_t *r) {
+    uint64_t send_data = (uint64_t) (uintptr_t) r | RING_OP_SEND;
+    int deferred = 0, ok = 1;
+
+    if (!ring_prep_cancel(ring, r, RING_OP_SEND)) {
+        return 0;
+    }
+    while (r->send_armed && ok) {
+        int ret = (int) syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0 && errno != EINTR) {
+            ok = 0;
+            break;
+        }
+        if (ret > 0) {
+            ring->to_submit -= (unsigned int) ret;
+        }
+
+        unsigned int head = *ring->cq_head;
+        while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe cqe = ring->cqes[head & *ring->cq_mask];
+            __atomic_store_n(ring->cq_head, ++head, __ATOMIC_RELEASE);
+
+            /* A cancelled send reports what it sent before it was cancelled, or ECANCELED for nothing */
+            if (cqe.user_data == send_data && (cqe.res >= 0 || cqe.res == -ECANCELED)) {
+                r->send_armed = 0;
+                r->refs--;
+                r->sending_offset += cqe.res > 0 ? (unsigned int) cqe.res : 0;
+                if (r->sending_offset == r->sending_length) {
+                    r->sending_offset = r->sending_length = 0;
+                }
+            } else {
+                /* Errors are left for ring_on_send to tell the socket about, outside of whoever is draining */
+                if (cqe.user_data == send_data) {
+                    ok = 0;
+                }
+                ring_defer(ring, &cqe);
+                deferred = 1;
+            }
+        }
+    }
+
+    if (deferred) {
+        struct io_uring_sqe *sqe = ring_get_sqe(ring);
+        if (sqe) {
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = RING_OP_WAKEUP;
+            ring_flush(ring);
+        }
+    }
+    return ok;
+}
+
+/* Gets everything queued for the socket out of the ring and onto the socket itself, for callers
+ * about to write to its fd directly. Returns the bytes that did not fit and are still queued */
+unsigned int us_internal_ring_drain(struct us_socket_t *s) {
+    struct us_internal_ring_socket_t *r = s->p.ring;
+    struct us_internal_ring_t *ring = s->context->loop->data.ring;
+    if (!r || !ring || r->fd == -1 || !ring_socket_buffered(r)) {
+        return r ? ring_socket_buffered(r) : 0;
+    }
+
+    if (r->send_armed && !ring_wait_send(ring, r)) {
+        return ring_socket_buffered(r);
+    }
+
+    while (ring_socket_buffered(r)) {
+        ring_take_queued(r);
+        ssize_t written = bsd_send(r->fd, r->sending + r->sending_offset, (int) (r->sending_length - r->sending_offset), 0);
+        if (written <= 0) {
+            break;
+        }
+        r->sending_offset += (unsigned int) written;
+        if (r->sending_offset == r->sending_length) {
+            r->sending_offset = r->sending_length = 0;
+        }
+    }
+
+    unsigned int buffered = ring_socket_buffered(r);
+    r->drain_wanted = buffered != 0;
+    if (buffered) {
+        ring_mark_dirty(ring, r);
+    } else if (r->shutdown_pending) {
+        r->shutdown_pending = 0;
+        bsd_shutdown_socket(r->fd);
+    }
+    if (r->p && r->want_writable && ring_socket_writable(r)) {
+        ring_mark_ready(ring, r);
+    }
+    return buffered;
+}
+
+/* Runs cb with the socket's fd once its queued bytes went out, right away if there are none */
+void us_internal_ring_after_drain(struct us_socket_t *s, void (*cb)(LIBUS_SOCKET_DESCRIPTOR fd)) {
+    struct us_internal_ring_socket_t *r = s->p.ring;
+    if (r && r->fd != -1 && ring_socket_buffered(r)) {
+        r->after_drain = cb;
+    } else {
+        cb(us_poll_fd(&s->p));
+    }
+}
+
+/* Cuts the ring side loose from a socket being closed or detached. Queued data is still sent unless
+ * the connection is reset, returns whether the ring now owns closing the fd once that is done */
+int us_internal_ring_detach(struct us_poll_t *p, int close_fd, int reset) {
+    struct us_internal_ring_socket_t *r = p->ring;
+    if (!r) {
+        return 0;
+    }
+    struct us_internal_ring_t *ring = ((struct us_socket_t *) p)->context->loop->data.ring;
+
+    p->ring = 0;
+    r->p = 0;
+    r->accepting = r->receiving = r->want_writable = 0;
+    us_free(r->stashed);
+    r->stashed = 0;
+    r->stashed_length = 0;
+
+    if (reset || !ring_socket_buffered(r)) {
+        /* Nothing more to send on this fd, whoever has it now */
+        r->queued_length = 0;
+        r->shutdown_pending = 0;
+        r->after_drain = 0;
+        r->fd = -1;
+    } else {
+        r->close_fd = close_fd;
+    }
+
+    if (ring && r->is_listen) {
+        /* Let go of the listening port right away, not with the next iteration */
+        ring_socket_update(ring, r);
+        ring_flush(ring);
+    } else if (ring) {
+        ring_mark_dirty(ring, r);
+    }
+
+    int owns_fd = r->close_fd;
+    ring_socket_release(r);
+    return owns_fd;
+}
+
+#endif
@@ -20,6 +20,10 @@
 
 #include "internal/loop_data.h"
 
+#if defined(LIBUS_USE_IO_URING) && !defined(LIBUS_USE_EPOLL)
+#error "The io_uring backend runs alongside epoll and requires LIBUS_USE_EPOLL"
+#endif
+
 #ifdef LIBUS_USE_EPOLL
 #include <sys/epoll.h>
 #include <sys/timerfd.h>
@@ -67,6 +71,11 @@ struct us_poll_t {
         signed int fd : 27; // we could have this unsigned if we wanted to, -1 should never be used
         unsigned int poll_type : 5;
     } state;
+#ifdef LIBUS_USE_IO_URING
+    /* Events registered with epoll, -1 if not registered. Whatever the ring serves is not registered */
+    int epoll_events;
+    struct us_internal_ring_socket_t *ring;
+#endif
 };
 
 #undef FD_BITS
@@ -115,6 +115,11 @@ extern struct addrinfo_result *Bun__addrinfo_getRequestResult(struct addrinfo_re
 /* Loop related */
 void us_internal_dispatch_ready_poll(struct us_poll_t *p, int error, int eof, int events);
 void us_internal_timer_sweep(us_loop_r loop);
+void us_internal_timeout_wheel_link(us_socket_r s);
+void us_internal_timeout_wheel_unlink(us_socket_r s);
+struct us_socket_t *us_internal_socket_pool_alloc(us_loop_r loop, unsigned int ext_size);
+void us_internal_socket_pool_free(us_loop_r loop, us_socket_r s);
+int us_internal_socket_pool_fits(us_socket_r s, unsigned int ext_size);
 void us_internal_free_closed_sockets(us_loop_r loop);
 void us_internal_loop_link(struct us_loop_t *loop,
                            struct us_socket_context_t *context);
@@ -141,6 +146,24 @@ void us_internal_async_wakeup(struct us_internal_async *a);
 size_t us_internal_accept_poll_event(struct us_poll_t *p);
 int us_internal_poll_type(struct us_poll_t *p);
 void us_internal_poll_set_type(struct us_poll_t *p, int poll_type);
+int us_internal_accept_socket(struct us_listen_socket_t *listen_socket, LIBUS_SOCKET_DESCRIPTOR client_fd, struct bsd_addr_t *addr);
+int us_internal_socket_defer_low_prio(us_socket_r s);
+
+#ifdef LIBUS_USE_IO_URING
+/* The io_uring backend serves accept, recv and send of TCP sockets, everything else stays with epoll */
+void us_internal_ring_init(us_loop_r loop);
+void us_internal_ring_free(us_loop_r loop);
+void us_internal_ring_submit(us_loop_r loop);
+int us_internal_ring_poll_events(us_loop_r loop, us_poll_r p, int events);
+void us_internal_ring_poll_stop(us_loop_r loop, us_poll_r p);
+void us_internal_ring_poll_moved(us_poll_r p);
+int us_internal_ring_serves_writes(us_socket_r s);
+int us_internal_ring_write(us_socket_r s, const char *data, int length, const char *data2, int length2);
+int us_internal_ring_shutdown(us_socket_r s);
+int us_internal_ring_detach(us_poll_r p, int close_fd, int reset);
+unsigned int us_internal_ring_drain(us_socket_r s);
+void us_internal_ring_after_drain(us_socket_r s, void (*cb)(LIBUS_SOCKET_DESCRIPTOR fd));
+#endif
 
 /* SSL loop data */
 void us_internal_init_loop_ssl_data(us_loop_r loop);
@@ -160,6 +183,36 @@ us_internal_ssl_socket_close(us_internal_ssl_socket_r s, int code,
                              
 int us_internal_handle_dns_results(us_loop_r loop);
 
+/* Number of slots in each of the two timeout wheels of a socket context */
+#define LIBUS_TIMEOUT_WHEEL_SLOTS 240
+/* Short timeout wheel ticks per long timeout wheel tick (one minute) */
+#define LIBUS_TIMEOUT_TICKS_PER_MINUTE (60000 / LIBUS_TIMEOUT_RESOLUTION_MS)
+
+#if (60000 % LIBUS_TIMEOUT_RESOLUTION_MS) != 0
+#error "LIBUS_TIMEOUT_RESOLUTION_MS must evenly divide one minute"
+#endif
+
+/* Intrusive link of a socket in a timeout wheel bucket. pprev points at whatever
+ * pointer points at us (bucket head or previous node's next), so unlinking never
+ * needs to know which bucket we are in */
+struct us_timeout_node_t {
+  struct us_socket_t *next;
+  struct us_socket_t **pprev;
+};
+
+/* Memory of closed accepted sockets is kept on per-loop free lists and handed out again on the next accept.
+ * Class i holds sockets with an ext of up to (LIBUS_SOCKET_POOL_MIN_EXT << i) bytes, larger exts are not pooled */
+#define LIBUS_SOCKET_POOL_CLASSES 4
+#define LIBUS_SOCKET_POOL_MIN_EXT 64u
+#define LIBUS_SOCKET_POOL_MAX_FREE 1024
+
+struct us_internal_socket_pool_t {
+  struct {
+    unsigned int num_free;
+    struct us_socket_t *head;
+  } classes[LIBUS_SOCKET_POOL_CLASSES];
+};
+
 /* Sockets are polls */
 struct us_socket_t {
   alignas(LIBUS_EXT_ALIGNMENT) struct us_poll_t p; // 4 bytes
@@ -169,9 +222,13 @@ struct us_socket_t {
       low_prio_state; /* 0 = not in low-prio queue, 1 = is in low-prio queue, 2
                          = was in low-prio queue in this iteration */
   unsigned char allow_half_open; /* Allow to stay alive after FIN/EOF */
+  unsigned char timeout_rounds; /* Full wheel revolutions left before timeout fires */
+  unsigned char is_linked; /* Is in its context's socket list (only those are swept) */
+  unsigned char pool_index; /* 1 + size class of the socket pool this memory goes back to, 0 if none */
 
   struct us_socket_context_t *context;
   struct us_socket_t *prev, *next;
+  struct us_timeout_node_t timeout_node, long_timeout_node;
   struct us_socket_t *connect_next;
   struct us_connecting_socket_t *connect_state;
 };
@@ -187,6 +244,7 @@ struct us_connecting_socket_t {
     unsigned int closed : 1, shutdown : 1, ssl : 1, shutdown_read : 1, pending_resolve_callback : 1;
     unsigned char timeout;
     unsigned char long_timeout;
+    unsigned char timeout_rounds;
     uint16_t port;
     int error;
     struct addrinfo *addrinfo_head;
@@ -214,6 +272,8 @@ struct us_udp_socket_t {
     uint16_t port;
     uint16_t closed : 1;
     uint16_t connected : 1;
+    /* The kernel or the route refused UDP_SEGMENT, so send every datagram on its own */
+    uint16_t no_gso : 1;
     struct us_udp_socket_t *next;
 };
 
@@ -255,6 +315,8 @@ int us_internal_raw_root_certs(struct us_cert_string_t **out);
 struct us_listen_socket_t {
   alignas(LIBUS_EXT_ALIGNMENT) struct us_socket_t s;
   unsigned int socket_ext_size;
+  /* Set when accepted sockets inherit TCP_NODELAY, so accept can skip setting it */
+  unsigned int accepts_nodelay;
 };
 
 /* Listen sockets are keps in their own list */
@@ -272,7 +334,9 @@ struct us_socket_context_t {
   struct us_socket_t *head_sockets;
   struct us_listen_socket_t *head_listen_sockets;
   struct us_connecting_socket_t *head_connecting_sockets;
-  struct us_socket_t *iterator;
+  /* LIBUS_TIMEOUT_WHEEL_SLOTS short buckets followed by as many long buckets,
+   * allocated the first time a socket of this context arms a timeout */
+  struct us_socket_t **timeout_wheel;
   struct us_socket_context_t *prev, *next;
 
   struct us_socket_t *(*on_open)(struct us_socket_t *, int is_client, char *ip,
@@ -309,6 +373,10 @@ int us_bun_internal_ssl_socket_context_add_server_name(
     us_internal_ssl_socket_context_r context,
     const char *hostname_pattern,
     struct us_bun_socket_context_options_t options, void *user);
+int us_bun_internal_ssl_socket_context_replace_server_name(
+    us_internal_ssl_socket_context_r context,
+    const char *hostname_pattern,
+    struct us_bun_socket_context_options_t options, void *user);
 void us_internal_ssl_socket_context_remove_server_name(
     us_internal_ssl_socket_context_r context,
     const char *hostname_pattern);
@@ -325,6 +393,12 @@ void *
 us_internal_ssl_socket_get_native_handle(us_internal_ssl_socket_r s);
 void *us_internal_ssl_socket_context_get_native_handle(
     us_internal_ssl_socket_context_r context);
+void us_internal_ssl_socket_context_session_stats(
+    us_internal_ssl_socket_context_r context,
+    struct us_socket_context_session_stats_t *stats);
+int us_internal_ssl_socket_context_set_ticket_keys(
+    us_internal_ssl_socket_context_r context, const unsigned char *keys,
+    unsigned int length);
 struct us_bun_verify_error_t
 us_internal_verify_error(us_internal_ssl_socket_r s);
 struct us_internal_ssl_socket_context_t *us_internal_create_ssl_socket_context(
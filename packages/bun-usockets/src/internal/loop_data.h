@@ -57,6 +57,10 @@ struct us_internal_loop_data_t {
     /* We do not care if this flips or not, it doesn't matter */
     size_t iteration_nr;
     void* jsc_vm;
+    /* Free lists of accepted socket memory, see us_internal_socket_pool_alloc */
+    struct us_internal_socket_pool_t *socket_pool;
+    /* Only set when built with LIBUS_USE_IO_URING and the kernel supports it */
+    struct us_internal_ring_t *ring;
 };
 
 #endif // LOOP_DATA_H
@@ -48,6 +48,14 @@
 
 #define LIBUS_UDP_MAX_SIZE (64 * 1024)
 
+#ifdef __linux__
+/* Runs of equal sized datagrams to one peer are sent as one UDP_SEGMENT (GSO) message. Only
+ * datagrams that fit an ethernet frame over IPv6 are merged, since segments can not be fragmented */
+#define LIBUS_UDP_GSO_MAX_SEGMENTS 64
+#define LIBUS_UDP_GSO_MAX_SEGMENT_SIZE 1452
+#define LIBUS_UDP_GSO_MAX_BYTES (65535 - 40 - 8)
+#endif
+
 struct bsd_addr_t {
     struct sockaddr_storage mem;
     socklen_t len;
@@ -160,6 +168,7 @@ struct udp_sendbuf {
 #else
     unsigned int has_empty : 1;
     unsigned int has_addresses : 1;
+    unsigned int has_segments : 1;
     unsigned int num;
     struct mmsghdr msgvec[];
 #endif
@@ -168,8 +177,10 @@ struct udp_sendbuf {
 int bsd_sendmmsg(LIBUS_SOCKET_DESCRIPTOR fd, struct udp_sendbuf* sendbuf, int flags);
 int bsd_recvmmsg(LIBUS_SOCKET_DESCRIPTOR fd, struct udp_recvbuf *recvbuf, int flags);
 void bsd_udp_setup_recvbuf(struct udp_recvbuf *recvbuf, void *databuf, size_t databuflen);
-int bsd_udp_setup_sendbuf(struct udp_sendbuf *buf, size_t bufsize, void** payloads, size_t* lengths, void** addresses, int num);
+int bsd_udp_setup_sendbuf(struct udp_sendbuf *buf, size_t bufsize, void** payloads, size_t* lengths, void** addresses, int num, int gso);
+int bsd_udp_sendbuf_payloads(struct udp_sendbuf *buf, int messages);
 int bsd_udp_packet_buffer_payload_length(struct udp_recvbuf *msgvec, int index);
+int bsd_udp_packet_buffer_segment_size(struct udp_recvbuf *msgvec, int index);
 char *bsd_udp_packet_buffer_payload(struct udp_recvbuf *msgvec, int index);
 char *bsd_udp_packet_buffer_peer(struct udp_recvbuf *msgvec, int index);
 int bsd_udp_packet_buffer_local_ip(struct udp_recvbuf *msgvec, int index, char *ip);
@@ -178,6 +189,7 @@ int bsd_udp_packet_buffer_local_ip(struct udp_recvbuf *msgvec, int index, char *
 LIBUS_SOCKET_DESCRIPTOR apple_no_sigpipe(LIBUS_SOCKET_DESCRIPTOR fd);
 LIBUS_SOCKET_DESCRIPTOR bsd_set_nonblocking(LIBUS_SOCKET_DESCRIPTOR fd);
 void bsd_socket_nodelay(LIBUS_SOCKET_DESCRIPTOR fd, int enabled);
+int bsd_socket_accepts_nodelay(LIBUS_SOCKET_DESCRIPTOR fd);
 int bsd_socket_broadcast(LIBUS_SOCKET_DESCRIPTOR fd, int enabled);
 int bsd_socket_ttl_unicast(LIBUS_SOCKET_DESCRIPTOR fd, int ttl);
 int bsd_socket_ttl_multicast(LIBUS_SOCKET_DESCRIPTOR fd, int ttl);
@@ -62,6 +62,11 @@
 #define LIBUS_SEND_BUFFER_LENGTH (1 << 14)
 /* A timeout granularity of 4 seconds means give or take 4 seconds from set timeout */
 #define LIBUS_TIMEOUT_GRANULARITY 4
+/* Tick length of the short timeout wheel. Defaults to LIBUS_TIMEOUT_GRANULARITY, but may be
+ * defined lower (e.g. 250) to get sub-second resolution from us_socket_timeout_ms */
+#ifndef LIBUS_TIMEOUT_RESOLUTION_MS
+#define LIBUS_TIMEOUT_RESOLUTION_MS (LIBUS_TIMEOUT_GRANULARITY * 1000)
+#endif
 /* 32 byte padding of receive buffer ends */
 #define LIBUS_RECV_BUFFER_PADDING 32
 /* Guaranteed alignment of extension memory */
@@ -102,6 +107,8 @@ enum {
     LIBUS_SOCKET_IPV6_ONLY = 8,
     LIBUS_LISTEN_REUSE_ADDR = 16,
     LIBUS_LISTEN_DISALLOW_REUSE_PORT_FAILURE = 32,
+    /* Let the kernel coalesce received UDP datagrams (Linux UDP_GRO), see us_udp_packet_buffer_segment_size */
+    LIBUS_SOCKET_UDP_GRO = 64,
 };
 
 /* Library types publicly available */
@@ -126,6 +133,10 @@ struct us_cert_string_t {
 char *us_udp_packet_buffer_payload(struct us_udp_packet_buffer_t *buf, int index);
 int us_udp_packet_buffer_payload_length(struct us_udp_packet_buffer_t *buf, int index);
 
+/* Non-zero if the payload is several datagrams of this size back to back (the last may be shorter),
+ * which only happens on sockets created with LIBUS_SOCKET_UDP_GRO */
+int us_udp_packet_buffer_segment_size(struct us_udp_packet_buffer_t *buf, int index);
+
 /* Copies out local (received destination) ip (4 or 16 bytes) of received packet */
 int us_udp_packet_buffer_local_ip(struct us_udp_packet_buffer_t *buf, int index, char *ip);
 
@@ -245,6 +256,8 @@ unsigned short us_socket_context_timestamp(int ssl, us_socket_context_r context)
 /* Adds SNI domain and cert in asn1 format */
 void us_socket_context_add_server_name(int ssl, us_socket_context_r context, const char *hostname_pattern, struct us_socket_context_options_t options, void *user);
 int us_bun_socket_context_add_server_name(int ssl, us_socket_context_r context, const char *hostname_pattern, struct us_bun_socket_context_options_t options, void *user);
+/* Swaps in a new certificate for a name without dropping it, or adds it */
+int us_bun_socket_context_replace_server_name(int ssl, us_socket_context_r context, const char *hostname_pattern, struct us_bun_socket_context_options_t options, void *user);
 void us_socket_context_remove_server_name(int ssl, us_socket_context_r context, const char *hostname_pattern);
 void us_socket_context_on_server_name(int ssl, us_socket_context_r context, void (*cb)(us_socket_context_r context, const char *hostname));
 void *us_socket_server_name_userdata(int ssl, us_socket_r s);
@@ -253,6 +266,21 @@ void *us_socket_context_find_server_name_userdata(int ssl, us_socket_context_r c
 /* Returns the underlying SSL native handle, such as SSL_CTX or nullptr */
 void *us_socket_context_get_native_handle(int ssl, us_socket_context_r context);
 
+/* Session resumption counters of an SSL context, all zero for non-SSL */
+struct us_socket_context_session_stats_t {
+    unsigned long long full_handshakes;
+    unsigned long long resumed_handshakes;
+    unsigned long long tickets_issued;
+    unsigned long long shared_cache_hits;
+    unsigned long long shared_cache_misses;
+};
+void us_socket_context_session_stats(int ssl, us_socket_context_r context, struct us_socket_context_session_stats_t *stats);
+
+/* Encrypts session tickets with the given keys instead of per-context random ones, so processes
+ * sharing them resume each other's sessions. 1 to 4 keys of 48 bytes in Node's ticketKeys layout,
+ * the first used for new tickets. Returns 0 if the length is wrong or this is not an SSL context */
+int us_socket_context_set_ticket_keys(int ssl, us_socket_context_r context, const unsigned char *keys, unsigned int length);
+
 /* A socket context holds shared callbacks and user data extension for associated sockets */
 struct us_socket_context_t *us_create_socket_context(int ssl, us_loop_r loop,
     int ext_size, struct us_socket_context_options_t options) nonnull_fn_decl;
@@ -426,6 +454,9 @@ int us_socket_write2(int ssl, us_socket_r s, const char *header, int header_leng
  * at any given point in time. Will remove any such pre set timer */
 void us_socket_timeout(int ssl, us_socket_r s, unsigned int seconds) nonnull_fn_decl;
 
+/* Same as us_socket_timeout, rounded up to LIBUS_TIMEOUT_RESOLUTION_MS */
+void us_socket_timeout_ms(int ssl, us_socket_r s, unsigned int milliseconds) nonnull_fn_decl;
+
 /* Set a low precision, high performance timer on a socket. Suitable for per-minute precision. */
 void us_socket_long_timeout(int ssl, us_socket_r s, unsigned int minutes) nonnull_fn_decl;
 
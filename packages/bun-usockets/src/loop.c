@@ -57,6 +57,71 @@ void us_internal_loop_data_free(struct us_loop_t *loop) {
 
     us_timer_close(loop->data.sweep_timer, 0);
     us_internal_async_close(loop->data.wakeup_async);
+
+    struct us_internal_socket_pool_t *pool = loop->data.socket_pool;
+    if (pool) {
+        for (int i = 0; i < LIBUS_SOCKET_POOL_CLASSES; i++) {
+            for (struct us_socket_t *s = pool->classes[i].head; s; ) {
+                struct us_socket_t *next = s->next;
+                us_free(s);
+                s = next;
+            }
+        }
+        us_free(pool);
+        loop->data.socket_pool = 0;
+    }
+}
+
+/* Accepting and closing sockets at a high rate is dominated by malloc and free of the socket memory,
+ * so we recycle it. Only the epoll/kqueue backends allocate a poll as one block we can reuse as is */
+struct us_socket_t *us_internal_socket_pool_alloc(struct us_loop_t *loop, unsigned int ext_size) {
+#ifndef LIBUS_USE_LIBUV
+    int index = 0;
+    while (index < LIBUS_SOCKET_POOL_CLASSES && ext_size > (LIBUS_SOCKET_POOL_MIN_EXT << index)) {
+        index++;
+    }
+
+    if (index < LIBUS_SOCKET_POOL_CLASSES) {
+        struct us_internal_socket_pool_t *pool = loop->data.socket_pool;
+        if (!pool) {
+            pool = loop->data.socket_pool = us_calloc(1, sizeof(struct us_internal_socket_pool_t));
+        }
+
+        struct us_socket_t *s = pool->classes[index].head;
+        if (s) {
+            pool->classes[index].head = s->next;
+            pool->classes[index].num_free--;
+            loop->num_polls++;
+        } else {
+            s = (struct us_socket_t *) us_create_poll(loop, 0, sizeof(struct us_socket_t) - sizeof(struct us_poll_t) + (LIBUS_SOCKET_POOL_MIN_EXT << index));
+        }
+        s->pool_index = index + 1;
+        return s;
+    }
+#endif
+
+    struct us_socket_t *s = (struct us_socket_t *) us_create_poll(loop, 0, sizeof(struct us_socket_t) - sizeof(struct us_poll_t) + ext_size);
+    s->pool_index = 0;
+    return s;
+}
+
+void us_internal_socket_pool_free(struct us_loop_t *loop, struct us_socket_t *s) {
+    struct us_internal_socket_pool_t *pool = loop->data.socket_pool;
+    if (s->pool_index && pool && pool->classes[s->pool_index - 1].num_free < LIBUS_SOCKET_POOL_MAX_FREE) {
+        int index = s->pool_index - 1;
+        s->next = pool->classes[index].head;
+        pool->classes[index].head = s;
+        pool->classes[index].num_free++;
+        loop->num_polls--;
+        return;
+    }
+
+    us_poll_free((struct us_poll_t *) s, loop);
+}
+
+/* Whether resizing the socket to this ext size can keep its current memory */
+int us_internal_socket_pool_fits(struct us_socket_t *s, unsigned int ext_size) {
+    return s->pool_index && ext_size <= (LIBUS_SOCKET_POOL_MIN_EXT << (s->pool_index - 1));
 }
 
 void us_wakeup_loop(struct us_loop_t *loop) {
@@ -88,6 +153,103 @@ void us_internal_loop_unlink(struct us_loop_t *loop, struct us_socket_context_t
     }
 }
 
+/* Every socket context has two timing wheels of LIBUS_TIMEOUT_WHEEL_SLOTS buckets, one ticking
+ * every LIBUS_TIMEOUT_RESOLUTION_MS and one ticking every minute. A socket with an armed timeout sits
+ * in the bucket of the tick it expires on, so a sweep only ever touches sockets that are due,
+ * instead of walking every socket of every context. Returns 0 if the wheel cannot be allocated */
+static struct us_socket_t **us_internal_timeout_bucket(struct us_socket_context_t *context, int is_long, unsigned char slot) {
+    if (!context->timeout_wheel) {
+        context->timeout_wheel = us_calloc(2 * LIBUS_TIMEOUT_WHEEL_SLOTS, sizeof(struct us_socket_t *));
+        if (!context->timeout_wheel) {
+            return 0;
+        }
+    }
+    return &context->timeout_wheel[is_long * LIBUS_TIMEOUT_WHEEL_SLOTS + slot];
+}
+
+static void us_internal_timeout_node_insert(struct us_socket_t *s, struct us_timeout_node_t *node, int is_long, struct us_socket_t **head) {
+    node->next = *head;
+    node->pprev = head;
+    if (*head) {
+        struct us_timeout_node_t *head_node = is_long ? &(*head)->long_timeout_node : &(*head)->timeout_node;
+        head_node->pprev = &node->next;
+    }
+    *head = s;
+}
+
+static void us_internal_timeout_node_remove(struct us_timeout_node_t *node, int is_long) {
+    if (!node->pprev) {
+        return;
+    }
+    *node->pprev = node->next;
+    if (node->next) {
+        struct us_timeout_node_t *next_node = is_long ? &node->next->long_timeout_node : &node->next->timeout_node;
+        next_node->pprev = node->pprev;
+    }
+    node->next = 0;
+    node->pprev = 0;
+}
+
+/* Puts the socket in the buckets of its armed timeouts. Only sockets linked in their context are swept.
+ * Out of memory for the wheel, the timeouts are dropped as if never armed */
+void us_internal_timeout_wheel_link(struct us_socket_t *s) {
+    if (!s->is_linked) {
+        return;
+    }
+    struct us_socket_t **bucket;
+    if (s->timeout < LIBUS_TIMEOUT_WHEEL_SLOTS && !s->timeout_node.pprev) {
+        if ((bucket = us_internal_timeout_bucket(s->context, 0, s->timeout))) {
+            us_internal_timeout_node_insert(s, &s->timeout_node, 0, bucket);
+        } else {
+            s->timeout = 255;
+        }
+    }
+    if (s->long_timeout < LIBUS_TIMEOUT_WHEEL_SLOTS && !s->long_timeout_node.pprev) {
+        if ((bucket = us_internal_timeout_bucket(s->context, 1, s->long_timeout))) {
+            us_internal_timeout_node_insert(s, &s->long_timeout_node, 1, bucket);
+        } else {
+            s->long_timeout = 255;
+        }
+    }
+}
+
+void us_internal_timeout_wheel_unlink(struct us_socket_t *s) {
+    us_internal_timeout_node_remove(&s->timeout_node, 0);
+    us_internal_timeout_node_remove(&s->long_timeout_node, 1);
+}
+
+/* Emits the timeouts of one bucket. The bucket is first moved aside, so sockets that are re-armed into
+ * the same slot by their handler wait for the next revolution. Handlers may freely close or unlink any
+ * other socket of the moved list, since removal goes through pprev */
+static void us_internal_timeout_wheel_expire(struct us_socket_context_t *context, int is_long, unsigned char slot) {
+    struct us_socket_t **bucket = &context->timeout_wheel[is_long * LIBUS_TIMEOUT_WHEEL_SLOTS + slot];
+    struct us_socket_t *expiring = *bucket;
+    if (!expiring) {
+        return;
+    }
+    *bucket = 0;
+    (is_long ? &expiring->long_timeout_node : &expiring->timeout_node)->pprev = &expiring;
+
+    struct us_socket_t *s;
+    while ((s = expiring)) {
+        if (is_long) {
+            us_internal_timeout_node_remove(&s->long_timeout_node, 1);
+            s->long_timeout = 255;
+            if (context->on_socket_long_timeout != NULL) context->on_socket_long_timeout(s);
+        } else {
+            us_internal_timeout_node_remove(&s->timeout_node, 0);
+            if (s->timeout_rounds) {
+                /* Not due yet, come back after another revolution */
+                s->timeout_rounds--;
+                us_internal_timeout_node_insert(s, &s->timeout_node, 0, bucket);
+                continue;
+            }
+            s->timeout = 255;
+            if (context->on_socket_timeout != NULL) context->on_socket_timeout(s);
+        }
+    }
+}
+
 /* This functions should never run recursively */
 void us_internal_timer_sweep(struct us_loop_t *loop) {
     struct us_internal_loop_data_t *loop_data = &loop->data;
@@ -98,49 +260,20 @@ void us_internal_timer_sweep(struct us_loop_t *loop) {
 
         /* Update this context's timestamps (this could be moved to loop and done once) */
         context->global_tick++;
-        unsigned char short_ticks = context->timestamp = context->global_tick % 240;
-        unsigned char long_ticks = context->long_timestamp = (context->global_tick / 15) % 240;
-
-        /* Begin at head */
-        struct us_socket_t *s = context->head_sockets;
-        while (s) {
-            /* Seek until end or timeout found (tightest loop) */
-            while (1) {
-                /* We only read from 1 random cache line here */
-                if (short_ticks == s->timeout || long_ticks == s->long_timeout) {
-                    break;
-                }
+        unsigned char short_ticks = context->timestamp = context->global_tick % LIBUS_TIMEOUT_WHEEL_SLOTS;
+        unsigned char long_ticks = context->long_timestamp = (context->global_tick / LIBUS_TIMEOUT_TICKS_PER_MINUTE) % LIBUS_TIMEOUT_WHEEL_SLOTS;
 
-                /* Did we reach the end without a find? */
-                if ((s = s->next) == 0) {
-                    goto next_context;
-                }
-            }
-
-            /* Here we have a timeout to emit (slow path) */
-            context->iterator = s;
-
-            if (short_ticks == s->timeout) {
-                s->timeout = 255;
-                if (context->on_socket_timeout != NULL) context->on_socket_timeout(s);
-            }
+        /* No socket of this context ever armed a timeout */
+        if (!context->timeout_wheel) {
+            continue;
+        }
 
-            if (context->iterator == s && long_ticks == s->long_timeout) {
-                s->long_timeout = 255;
-                if (context->on_socket_long_timeout != NULL) context->on_socket_long_timeout(s);
-            }   
+        us_internal_timeout_wheel_expire(context, 0, short_ticks);
 
-            /* Check for unlink / link (if the event handler did not modify the chain, we step 1) */
-            if (s == context->iterator) {
-                s = s->next;
-            } else {
-                /* The iterator was changed by event handler */
-                s = context->iterator;
-            }
+        /* The long wheel only moves once a minute */
+        if (context->global_tick % LIBUS_TIMEOUT_TICKS_PER_MINUTE == 0) {
+            us_internal_timeout_wheel_expire(context, 1, long_ticks);
         }
-        /* We always store a 0 to context->iterator here since we are no longer iterating this context */
-        next_context:
-        context->iterator = 0;
     }
 }
 
@@ -210,7 +343,7 @@ void us_internal_free_closed_sockets(struct us_loop_t *loop) {
     /* Free all closed sockets (maybe it is better to reverse order?) */
     for (struct us_socket_t *s = loop->data.closed_head; s; ) {
         struct us_socket_t *next = s->next;
-        us_poll_free((struct us_poll_t *) s, loop);
+        us_internal_socket_pool_free(loop, s);
         s = next;
     }
     loop->data.closed_head = 0;
@@ -233,6 +366,7 @@ void us_internal_free_closed_sockets(struct us_loop_t *loop) {
 void us_internal_free_closed_contexts(struct us_loop_t *loop) {
     for (struct us_socket_context_t *ctx = loop->data.closed_context_head; ctx; ) {
         struct us_socket_context_t *next = ctx->next;
+        us_free(ctx->timeout_wheel);
         us_free(ctx);
         ctx = next;
     }
@@ -268,6 +402,67 @@ void us_internal_loop_post(struct us_loop_t *loop) {
 #define us_ioctl ioctl
 #endif
 
+/* Sets up an accepted socket and emits on_open, returns whether the listen socket was closed by the handler */
+int us_internal_accept_socket(struct us_listen_socket_t *listen_socket, LIBUS_SOCKET_DESCRIPTOR client_fd, struct bsd_addr_t *addr) {
+    struct us_poll_t *accepted_p = (struct us_poll_t *) us_internal_socket_pool_alloc(us_socket_context(0, &listen_socket->s)->loop, listen_socket->socket_ext_size);
+    us_poll_init(accepted_p, client_fd, POLL_TYPE_SOCKET);
+    us_poll_start(accepted_p, listen_socket->s.context->loop, LIBUS_SOCKET_READABLE);
+
+    struct us_socket_t *s = (struct us_socket_t *) accepted_p;
+
+    s->context = listen_socket->s.context;
+    s->connect_state = NULL;
+    s->timeout = 255;
+    s->long_timeout = 255;
+    s->timeout_rounds = 0;
+    s->low_prio_state = 0;
+    s->allow_half_open = listen_socket->s.allow_half_open;
+
+    /* We always use nodelay. On Linux accepted sockets inherit it from a listen socket that has it */
+    if (!listen_socket->accepts_nodelay) {
+        bsd_socket_nodelay(client_fd, 1);
+    }
+
+    us_internal_socket_context_link_socket(listen_socket->s.context, s);
+
+    listen_socket->s.context->on_open(s, 0, addr ? bsd_addr_get_ip(addr) : NULL, addr ? bsd_addr_get_ip_length(addr) : 0);
+
+    return us_socket_is_closed(0, &listen_socket->s);
+}
+
+/* Contexts may prioritize down sockets that are currently readable, e.g. when SSL handshake has to be done.
+ * SSL handshakes are CPU intensive, so we limit the number of handshakes per loop iteration, and move the rest
+ * to the low-priority queue. Returns 1 if the socket was moved there and must not be read this iteration */
+int us_internal_socket_defer_low_prio(struct us_socket_t *s) {
+    if (!s->context->is_low_prio(s)) {
+        return 0;
+    }
+
+    if (s->low_prio_state == 2) {
+        s->low_prio_state = 0; /* Socket has been delayed and now it's time to process incoming data for one iteration */
+        return 0;
+    }
+    if (s->context->loop->data.low_prio_budget > 0) {
+        s->context->loop->data.low_prio_budget--; /* Still having budget for this iteration - do normal processing */
+        return 0;
+    }
+
+    us_poll_change(&s->p, us_socket_context(0, s)->loop, us_poll_events(&s->p) & LIBUS_SOCKET_WRITABLE);
+    us_socket_context_ref(0,  s->context);
+    us_internal_socket_context_unlink_socket(0, s->context, s);
+
+    /* Link this socket to the low-priority queue - we use a LIFO queue, to prioritize newer clients that are
+     * maybe not already timeouted - sounds unfair, but works better in real-life with smaller client-timeouts
+     * under high load */
+    s->prev = 0;
+    s->next = s->context->loop->data.low_prio_head;
+    if (s->next) s->next->prev = s;
+    s->context->loop->data.low_prio_head = s;
+
+    s->low_prio_state = 1;
+    return 1;
+}
+
 void us_internal_dispatch_ready_poll(struct us_poll_t *p, int error, int eof, int events) {
     switch (us_internal_poll_type(p)) {
     case POLL_TYPE_CALLBACK: {
@@ -299,33 +494,12 @@ void us_internal_dispatch_ready_poll(struct us_poll_t *p, int error, int eof, in
 
                     /* Todo: stop timer if any */
 
+                    /* Drain the whole accept backlog in one go, recycling the memory of closed sockets */
                     do {
-                        struct us_poll_t *accepted_p = us_create_poll(us_socket_context(0, &listen_socket->s)->loop, 0, sizeof(struct us_socket_t) - sizeof(struct us_poll_t) + listen_socket->socket_ext_size);
-                        us_poll_init(accepted_p, client_fd, POLL_TYPE_SOCKET);
-                        us_poll_start(accepted_p, listen_socket->s.context->loop, LIBUS_SOCKET_READABLE);
-
-                        struct us_socket_t *s = (struct us_socket_t *) accepted_p;
-
-                        s->context = listen_socket->s.context;
-                        s->connect_state = NULL;
-                        s->timeout = 255;
-                        s->long_timeout = 255;
-                        s->low_prio_state = 0;
-                        s->allow_half_open = listen_socket->s.allow_half_open;
-
-
-                        /* We always use nodelay */
-                        bsd_socket_nodelay(client_fd, 1);
-
-                        us_internal_socket_context_link_socket(listen_socket->s.context, s);
-
-                        listen_socket->s.context->on_open(s, 0, bsd_addr_get_ip(&addr), bsd_addr_get_ip_length(&addr));
-
                         /* Exit accept loop if listen socket was closed in on_open handler */
-                        if (us_socket_is_closed(0, &listen_socket->s)) {
+                        if (us_internal_accept_socket(listen_socket, client_fd, &addr)) {
                             break;
                         }
-
                     } while ((client_fd = bsd_accept_socket(us_poll_fd(p), &addr)) != LIBUS_SOCKET_ERROR);
                 }
             }
@@ -354,31 +528,8 @@ void us_internal_dispatch_ready_poll(struct us_poll_t *p, int error, int eof, in
             }
 
             if (events & LIBUS_SOCKET_READABLE) {
-                /* Contexts may prioritize down sockets that are currently readable, e.g. when SSL handshake has to be done.
-                 * SSL handshakes are CPU intensive, so we limit the number of handshakes per loop iteration, and move the rest
-                 * to the low-priority queue */
-                if (s->context->is_low_prio(s)) {
-                    if (s->low_prio_state == 2) {
-                        s->low_prio_state = 0; /* Socket has been delayed and now it's time to process incoming data for one iteration */
-                    } else if (s->context->loop->data.low_prio_budget > 0) {
-                        s->context->loop->data.low_prio_budget--; /* Still having budget for this iteration - do normal processing */
-                    } else {
-                        us_poll_change(&s->p, us_socket_context(0, s)->loop, us_poll_events(&s->p) & LIBUS_SOCKET_WRITABLE);
-                        us_socket_context_ref(0,  s->context);
-                        us_internal_socket_context_unlink_socket(0, s->context, s);
-
-                        /* Link this socket to the low-priority queue - we use a LIFO queue, to prioritize newer clients that are
-                         * maybe not already timeouted - sounds unfair, but works better in real-life with smaller client-timeouts
-                         * under high load */
-                        s->prev = 0;
-                        s->next = s->context->loop->data.low_prio_head;
-                        if (s->next) s->next->prev = s;
-                        s->context->loop->data.low_prio_head = s;
-
-                        s->low_prio_state = 1;
-
-                        break;
-                    }
+                if (us_internal_socket_defer_low_prio(s)) {
+                    break;
                 }
 
                 size_t repeat_recv_count = 0;
@@ -509,7 +660,7 @@ void us_internal_dispatch_ready_poll(struct us_poll_t *p, int error, int eof, in
 
 /* Integration only requires the timer to be set up */
 void us_loop_integrate(struct us_loop_t *loop) {
-    us_timer_set(loop->data.sweep_timer, (void (*)(struct us_timer_t *)) sweep_timer_cb, LIBUS_TIMEOUT_GRANULARITY * 1000, LIBUS_TIMEOUT_GRANULARITY * 1000);
+    us_timer_set(loop->data.sweep_timer, (void (*)(struct us_timer_t *)) sweep_timer_cb, LIBUS_TIMEOUT_RESOLUTION_MS, LIBUS_TIMEOUT_RESOLUTION_MS);
 }
 
 void *us_loop_ext(struct us_loop_t *loop) {
@@ -74,33 +74,52 @@ struct us_socket_context_t *us_connecting_socket_context(int ssl, struct us_conn
     return c->context;
 }
 
-void us_socket_timeout(int ssl, struct us_socket_t *s, unsigned int seconds) {
-    if (seconds) {
-        s->timeout = ((unsigned int)s->context->timestamp + ((seconds + 3) >> 2)) % 240;
+/* Converts a timeout to short wheel ticks, rounding up. Timeouts longer than one
+ * revolution of the wheel are spread over extra rounds instead of wrapping around early */
+static unsigned int us_internal_timeout_ticks(unsigned int milliseconds, unsigned char *rounds) {
+    unsigned long long ticks = ((unsigned long long) milliseconds + LIBUS_TIMEOUT_RESOLUTION_MS - 1) / LIBUS_TIMEOUT_RESOLUTION_MS;
+    unsigned long long extra_rounds = (ticks - 1) / LIBUS_TIMEOUT_WHEEL_SLOTS;
+    *rounds = extra_rounds > 255 ? 255 : (unsigned char) extra_rounds;
+    return (unsigned int) (ticks % LIBUS_TIMEOUT_WHEEL_SLOTS);
+}
+
+void us_socket_timeout_ms(int ssl, struct us_socket_t *s, unsigned int milliseconds) {
+    us_internal_timeout_wheel_unlink(s);
+    if (milliseconds) {
+        unsigned int ticks = us_internal_timeout_ticks(milliseconds, &s->timeout_rounds);
+        s->timeout = ((unsigned int)s->context->timestamp + ticks) % LIBUS_TIMEOUT_WHEEL_SLOTS;
     } else {
         s->timeout = 255;
     }
+    us_internal_timeout_wheel_link(s);
+}
+
+void us_socket_timeout(int ssl, struct us_socket_t *s, unsigned int seconds) {
+    us_socket_timeout_ms(ssl, s, seconds > UINT32_MAX / 1000 ? UINT32_MAX : seconds * 1000);
 }
 
 void us_connecting_socket_timeout(int ssl, struct us_connecting_socket_t *c, unsigned int seconds) {
     if (seconds) {
-        c->timeout = ((unsigned int)c->context->timestamp + ((seconds + 3) >> 2)) % 240;
+        unsigned int ticks = us_internal_timeout_ticks(seconds > UINT32_MAX / 1000 ? UINT32_MAX : seconds * 1000, &c->timeout_rounds);
+        c->timeout = ((unsigned int)c->context->timestamp + ticks) % LIBUS_TIMEOUT_WHEEL_SLOTS;
     } else {
         c->timeout = 255;
     }
 }
 
 void us_socket_long_timeout(int ssl, struct us_socket_t *s, unsigned int minutes) {
+    us_internal_timeout_wheel_unlink(s);
     if (minutes) {
-        s->long_timeout = ((unsigned int)s->context->long_timestamp + minutes) % 240;
+        s->long_timeout = ((unsigned int)s->context->long_timestamp + minutes) % LIBUS_TIMEOUT_WHEEL_SLOTS;
     } else {
         s->long_timeout = 255;
     }
+    us_internal_timeout_wheel_link(s);
 }
 
 void us_connecting_socket_long_timeout(int ssl, struct us_connecting_socket_t *c, unsigned int minutes) {
     if (minutes) {
-        c->long_timeout = ((unsigned int)c->context->long_timestamp + minutes) % 240;
+        c->long_timeout = ((unsigned int)c->context->long_timestamp + minutes) % LIBUS_TIMEOUT_WHEEL_SLOTS;
     } else {
         c->long_timeout = 255;
     }
@@ -206,6 +225,10 @@ struct us_socket_t *us_socket_close(int ssl, struct us_socket_t *s, int code, vo
             setsockopt(us_poll_fd((struct us_poll_t *)s), SOL_SOCKET, SO_LINGER, (const char*)&l, sizeof(l));
         }
 
+#ifdef LIBUS_USE_IO_URING
+        /* Data still queued in the ring is sent before the ring closes the fd, like the kernel would do with its own buffer */
+        if (!us_internal_ring_detach((struct us_poll_t *) s, 1, code == LIBUS_SOCKET_CLOSE_CODE_CONNECTION_RESET))
+#endif
         bsd_close_socket(us_poll_fd((struct us_poll_t *) s));
 
 
@@ -253,6 +276,9 @@ struct us_socket_t *us_socket_detach(int ssl, struct us_socket_t *s) {
             us_internal_socket_context_unlink_socket(ssl, s->context, s);
         }
         us_poll_stop((struct us_poll_t *) s, s->context->loop);
+#ifdef LIBUS_USE_IO_URING
+        us_internal_ring_detach((struct us_poll_t *) s, 0, 0);
+#endif
 
         /* Link this socket to the close-list and let it be deleted after this iteration */
         s->next = s->context->loop->data.closed_head;
@@ -276,7 +302,10 @@ struct us_socket_t *us_socket_attach(int ssl, LIBUS_SOCKET_DESCRIPTOR client_fd,
 
     s->context = ctx;
     s->timeout = 0;
+    s->long_timeout = 255;
+    s->timeout_rounds = 0;
     s->low_prio_state = 0;
+    s->pool_index = 0;
 
     /* We always use nodelay */
     bsd_socket_nodelay(client_fd, 1);
@@ -305,7 +334,12 @@ int us_socket_write2(int ssl, struct us_socket_t *s, const char *header, int hea
         return 0;
     }
 
+#ifdef LIBUS_USE_IO_URING
+    int written = us_internal_ring_serves_writes(s) ? us_internal_ring_write(s, header, header_length, payload, payload_length)
+        : bsd_write2(us_poll_fd(&s->p), header, header_length, payload, payload_length);
+#else
     int written = bsd_write2(us_poll_fd(&s->p), header, header_length, payload, payload_length);
+#endif
     if (written != header_length + payload_length) {
         us_poll_change(&s->p, s->context->loop, LIBUS_SOCKET_READABLE | LIBUS_SOCKET_WRITABLE);
     }
@@ -329,7 +363,9 @@ struct us_socket_t *us_socket_from_fd(struct us_socket_context_t *ctx, int socke
     s->context = ctx;
     s->timeout = 0;
     s->long_timeout = 0;
+    s->timeout_rounds = 0;
     s->low_prio_state = 0;
+    s->pool_index = 0;
 
     /* We always use nodelay */
     bsd_socket_nodelay(fd, 1);
@@ -378,7 +414,13 @@ int us_socket_write(int ssl, struct us_socket_t *s, const char *data, int length
         return 0;
     }
 
+#ifdef LIBUS_USE_IO_URING
+    /* The ring batches all sends of an iteration into one submission, msg_more is implied */
+    int written = us_internal_ring_serves_writes(s) ? us_internal_ring_write(s, data, length, NULL, 0)
+        : bsd_send(us_poll_fd(&s->p), data, length, msg_more);
+#else
     int written = bsd_send(us_poll_fd(&s->p), data, length, msg_more);
+#endif
     if (written != length) {
         s->context->loop->data.last_write_failed = 1;
         us_poll_change(&s->p, s->context->loop, LIBUS_SOCKET_READABLE | LIBUS_SOCKET_WRITABLE);
@@ -433,6 +475,12 @@ void us_socket_shutdown(int ssl, struct us_socket_t *s) {
     if (!us_socket_is_closed(ssl, s) && !us_socket_is_shut_down(ssl, s)) {
         us_internal_poll_set_type(&s->p, POLL_TYPE_SOCKET_SHUT_DOWN);
         us_poll_change(&s->p, s->context->loop, us_poll_events(&s->p) & LIBUS_SOCKET_READABLE);
+#ifdef LIBUS_USE_IO_URING
+        /* The FIN has to wait for whatever the ring has not sent yet */
+        if (us_internal_ring_shutdown(s)) {
+            return;
+        }
+#endif
         bsd_shutdown_socket(us_poll_fd((struct us_poll_t *) s));
     }
 }
@@ -19,6 +19,9 @@
 #include "internal/internal.h"
 
 #include <string.h>
+#ifdef __linux__
+#include <errno.h>
+#endif
 
 // int us_udp_packet_buffer_ecn(struct us_udp_packet_buffer_t *buf, int index) {
 //     return bsd_udp_packet_buffer_ecn((struct udp_recvbuf *)buf, index);
@@ -40,6 +43,10 @@ int us_udp_packet_buffer_payload_length(struct us_udp_packet_buffer_t *buf, int
     return bsd_udp_packet_buffer_payload_length((struct udp_recvbuf *)buf, index);
 }
 
+int us_udp_packet_buffer_segment_size(struct us_udp_packet_buffer_t *buf, int index) {
+    return bsd_udp_packet_buffer_segment_size((struct udp_recvbuf *)buf, index);
+}
+
 int us_udp_socket_send(struct us_udp_socket_t *s, void** payloads, size_t* lengths, void** addresses, int num) {
     if (num == 0) return 0;
     int fd = us_poll_fd((struct us_poll_t *) s);
@@ -47,21 +54,30 @@ int us_udp_socket_send(struct us_udp_socket_t *s, void** payloads, size_t* lengt
     struct udp_sendbuf *buf = (struct udp_sendbuf *)s->loop->data.send_buf;
 
     int total_sent = 0;
-    while (total_sent < num) {
-        int count = bsd_udp_setup_sendbuf(buf, LIBUS_SEND_BUFFER_LENGTH, payloads, lengths, addresses, num);
-        payloads += count;
-        lengths += count;
-        addresses += count;
-        num -= count;
+    while (num > 0) {
+        int count = bsd_udp_setup_sendbuf(buf, LIBUS_SEND_BUFFER_LENGTH, payloads, lengths, addresses, num, !s->no_gso);
         // TODO nohang flag?
         int sent = bsd_sendmmsg(fd, buf, MSG_DONTWAIT);
+#ifdef __linux__
+        if (sent < 0 && buf->has_segments && (errno == EIO || errno == EINVAL || errno == EMSGSIZE || errno == ENOPROTOOPT)) {
+            // no segmentation offload for this socket (old kernel, no checksum offload, small path mtu), retry one by one
+            s->no_gso = 1;
+            continue;
+        }
+#endif
         if (sent < 0) {
             return sent;
         }
+        sent = bsd_udp_sendbuf_payloads(buf, sent);
+        payloads += count;
+        lengths += count;
+        addresses += count;
+        num -= count;
         total_sent += sent;
-        if (0 <= sent && sent < num) {
+        if (sent < count) {
             // if we couldn't send all packets, register a writable event so we can call the drain callback
             us_poll_change((struct us_poll_t *) s, s->loop, LIBUS_SOCKET_READABLE | LIBUS_SOCKET_WRITABLE);
+            break;
         }
     }
     return total_sent;
@@ -179,6 +195,7 @@ struct us_udp_socket_t *us_create_udp_socket(
 
     udp->closed = 0;
     udp->connected = 0;
+    udp->no_gso = 0;
     udp->on_data = data_cb;
     udp->on_drain = drain_cb;
     udp->on_close = close_cb;
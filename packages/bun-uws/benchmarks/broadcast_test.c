@@ -6,6 +6,10 @@
    3. Once received all expected bytes, repeat by going to step 1.
 
    Every 4 seconds we print the current average "iterations per second".
+
+   In deflate mode the clients negotiate permessage-deflate and send compressed
+   messages, so a server publishing them with compression on measures the cost of
+   compressed fan-out (one publish compressed for every subscriber).
    */
 
 #include <libusockets.h>
@@ -15,14 +19,41 @@ int SSL;
 #include <stdlib.h>
 #include <string.h>
 
-unsigned char web_socket_request[26] = {130, 128 | 20, 1, 2, 3, 4};
+/* Whatever type we selected (compressed or not) */
+unsigned char *web_socket_request;
+int web_socket_request_size;
+
+char *request;
+int request_size;
+
+/* Not compressed */
+unsigned char web_socket_request_text[26] = {130, 128 | 20, 1, 2, 3, 4};
+
+/* Compressed "Hello" */
+unsigned char web_socket_request_deflate[13] = {
+    130 | 64, 128 | 7,
+    0, 0, 0, 0,
+    0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00
+};
+
+char request_text[] = "GET / HTTP/1.1\r\n"
+                 "Upgrade: websocket\r\n"
+                 "Connection: Upgrade\r\n"
+                 "Sec-WebSocket-Key: x3JJHMbDL1EzLkh9GBhXDw==\r\n"
+                 "Host: server.example.com\r\n"
+                 "Sec-WebSocket-Version: 13\r\n\r\n";
 
-char request[] = "GET / HTTP/1.1\r\n"
+char request_deflate[] = "GET / HTTP/1.1\r\n"
                  "Upgrade: websocket\r\n"
                  "Connection: Upgrade\r\n"
                  "Sec-WebSocket-Key: x3JJHMbDL1EzLkh9GBhXDw==\r\n"
+                 "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n"
                  "Host: server.example.com\r\n"
                  "Sec-WebSocket-Version: 13\r\n\r\n";
+
+/* Size of every frame we receive. Compressed frames are as big as the server makes them,
+ * so we learn it from the first frame (every subscriber gets the very same one) */
+int response_frame_size;
 char *host;
 int port;
 int connections;
@@ -58,7 +89,7 @@ void start_iteration() {
         struct us_socket_t *s = (struct us_socket_t *) web_sockets[i];
         struct http_socket *http_socket = (struct http_socket *) us_socket_ext(SSL, s);
 
-        http_socket->offset = us_socket_write(SSL, s, (char *) web_socket_request, sizeof(web_socket_request), 0);
+        http_socket->offset = us_socket_write(SSL, s, (char *) web_socket_request, web_socket_request_size, 0);
     }
 }
 
@@ -81,11 +112,11 @@ struct us_socket_t *on_http_socket_writable(struct us_socket_t *s) {
     struct http_socket *http_socket = (struct http_socket *) us_socket_ext(SSL, s);
 
     /* Are we still not upgraded yet? */
-    if (http_socket->upgrade_offset < sizeof(request) - 1) {
-        http_socket->upgrade_offset += us_socket_write(SSL, s, request + http_socket->upgrade_offset, sizeof(request) - 1 - http_socket->upgrade_offset, 0);
+    if (http_socket->upgrade_offset < request_size) {
+        http_socket->upgrade_offset += us_socket_write(SSL, s, request + http_socket->upgrade_offset, request_size - http_socket->upgrade_offset, 0);
     } else {
         /* Stream whatever is remaining of the request */
-        http_socket->offset += us_socket_write(SSL, s, (char *) web_socket_request + http_socket->offset, sizeof(web_socket_request) - http_socket->offset, 0);
+        http_socket->offset += us_socket_write(SSL, s, (char *) web_socket_request + http_socket->offset, web_socket_request_size - http_socket->offset, 0);
     }
 
     return s;
@@ -109,9 +140,14 @@ struct us_socket_t *on_http_socket_data(struct us_socket_t *s, char *data, int l
 
     /* Are we already upgraded? */
     if (http_socket->is_upgraded) {
+        /* We assume small frames (less than 126 bytes) */
+        if (!response_frame_size && length >= 2) {
+            response_frame_size = 2 + (data[1] & 127);
+        }
+
         http_socket->bytes_received += length;
 
-        if (http_socket->bytes_received == (sizeof(web_socket_request) - 4) * num_web_sockets) {
+        if (http_socket->bytes_received == response_frame_size * num_web_sockets) {
             satisfied_sockets++;
             http_socket->bytes_received = 0;
 
@@ -142,7 +178,7 @@ struct us_socket_t *on_http_socket_open(struct us_socket_t *s, int is_client, ch
     http_socket->bytes_received = 0;
 
     /* Send an upgrade request */
-    http_socket->upgrade_offset = us_socket_write(SSL, s, request, sizeof(request) - 1, 0);
+    http_socket->upgrade_offset = us_socket_write(SSL, s, request, request_size, 0);
 
     return s;
 }
@@ -160,8 +196,8 @@ struct us_socket_t *on_http_socket_timeout(struct us_socket_t *s) {
 int main(int argc, char **argv) {
 
     /* Parse host and port */
-    if (argc != 5) {
-        printf("Usage: connections host port ssl\n");
+    if (argc != 5 && argc != 6) {
+        printf("Usage: connections host port ssl [deflate]\n");
         return 0;
     }
 
@@ -171,6 +207,21 @@ int main(int argc, char **argv) {
     connections = atoi(argv[1]);
     SSL = atoi(argv[4]);
 
+    if (argc == 6 && atoi(argv[5])) {
+        web_socket_request = web_socket_request_deflate;
+        web_socket_request_size = sizeof(web_socket_request_deflate);
+        request = request_deflate;
+        request_size = sizeof(request_deflate) - 1;
+    } else {
+        web_socket_request = web_socket_request_text;
+        web_socket_request_size = sizeof(web_socket_request_text);
+        request = request_text;
+        request_size = sizeof(request_text) - 1;
+
+        /* The server strips the 4 byte mask */
+        response_frame_size = sizeof(web_socket_request_text) - 4;
+    }
+
     /* Allocate room for every socket */
     web_sockets = (void **) malloc(sizeof(void *) * connections);
 
@@ -0,0 +1,163 @@
+/* This is a benchmark of connection churn: accepting and closing short-lived connections as fast as possible */
+
+#include <libusockets.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Both ends run in the same loop, the server is what we measure */
+char *host = "127.0.0.1";
+int port;
+int connections;
+
+/* Whether each connection sends one request and waits for the response before closing */
+int with_request;
+
+char request[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+
+struct us_socket_context_t *client_context;
+
+long long accepted;
+
+/* We don't need any of these */
+void on_wakeup(struct us_loop_t *loop) {
+
+}
+
+void on_pre(struct us_loop_t *loop) {
+
+}
+
+void on_post(struct us_loop_t *loop) {
+
+}
+
+void connect_one() {
+    int is_connecting = 0;
+    if (!us_socket_context_connect(0, client_context, host, port, 0, 0, &is_connecting)) {
+        printf("Error: cannot connect to %s:%d\n", host, port);
+        exit(0);
+    }
+}
+
+/* Server side */
+struct us_socket_t *on_server_open(struct us_socket_t *s, int is_client, char *ip, int ip_length) {
+    accepted++;
+
+    if (!with_request) {
+        return us_socket_close(0, s, 0, NULL);
+    }
+    return s;
+}
+
+struct us_socket_t *on_server_data(struct us_socket_t *s, char *data, int length) {
+    /* We assume the whole request arrives in one chunk */
+    us_socket_write(0, s, response, sizeof(response) - 1, 0);
+    return us_socket_close(0, s, 0, NULL);
+}
+
+struct us_socket_t *on_server_end(struct us_socket_t *s) {
+    return us_socket_close(0, s, 0, NULL);
+}
+
+struct us_socket_t *on_server_close(struct us_socket_t *s, int code, void *reason) {
+    return s;
+}
+
+struct us_socket_t *on_server_writable(struct us_socket_t *s) {
+    return s;
+}
+
+/* Client side, every closed connection is immediately replaced by a new one */
+struct us_socket_t *on_client_open(struct us_socket_t *s, int is_client, char *ip, int ip_length) {
+    if (with_request) {
+        us_socket_write(0, s, request, sizeof(request) - 1, 0);
+    }
+    return s;
+}
+
+struct us_socket_t *on_client_data(struct us_socket_t *s, char *data, int length) {
+    return s;
+}
+
+struct us_socket_t *on_client_end(struct us_socket_t *s) {
+    return us_socket_close(0, s, 0, NULL);
+}
+
+struct us_socket_t *on_client_close(struct us_socket_t *s, int code, void *reason) {
+    connect_one();
+    return s;
+}
+
+struct us_socket_t *on_client_writable(struct us_socket_t *s) {
+    return s;
+}
+
+struct us_connecting_socket_t *on_client_connect_error(struct us_connecting_socket_t *c, int code) {
+    printf("Error: connection failed (%d)\n", code);
+    exit(0);
+}
+
+struct us_socket_t *on_client_socket_connect_error(struct us_socket_t *s, int code) {
+    printf("Error: connection failed (%d)\n", code);
+    exit(0);
+}
+
+void on_timer(struct us_timer_t *t) {
+    /* Print current statistics */
+    printf("Connections/sec: %f\n", ((float) accepted) / LIBUS_TIMEOUT_GRANULARITY);
+    accepted = 0;
+}
+
+int main(int argc, char **argv) {
+
+    /* Parse connections and port */
+    if (argc != 3 && argc != 4) {
+        printf("Usage: connections port [with_request]\n");
+        return 0;
+    }
+
+    connections = atoi(argv[1]);
+    port = atoi(argv[2]);
+    with_request = argc == 4 && atoi(argv[3]);
+
+    /* Create the event loop */
+    struct us_loop_t *loop = us_create_loop(0, on_wakeup, on_pre, on_post, 0);
+
+    /* The server closes every connection right after accepting it, or after answering its request */
+    struct us_socket_context_options_t options = {};
+    struct us_socket_context_t *server_context = us_create_socket_context(0, loop, 0, options);
+    us_socket_context_on_open(0, server_context, on_server_open);
+    us_socket_context_on_data(0, server_context, on_server_data);
+    us_socket_context_on_writable(0, server_context, on_server_writable);
+    us_socket_context_on_close(0, server_context, on_server_close);
+    us_socket_context_on_end(0, server_context, on_server_end);
+
+    int error = 0;
+    if (!us_socket_context_listen(0, server_context, host, port, 0, 0, &error)) {
+        printf("Error: cannot listen to port %d\n", port);
+        return 0;
+    }
+
+    client_context = us_create_socket_context(0, loop, 0, options);
+    us_socket_context_on_open(0, client_context, on_client_open);
+    us_socket_context_on_data(0, client_context, on_client_data);
+    us_socket_context_on_writable(0, client_context, on_client_writable);
+    us_socket_context_on_close(0, client_context, on_client_close);
+    us_socket_context_on_end(0, client_context, on_client_end);
+    us_socket_context_on_connect_error(0, client_context, on_client_connect_error);
+    us_socket_context_on_socket_connect_error(0, client_context, on_client_socket_connect_error);
+
+    /* Keep this many connections in flight */
+    for (int i = 0; i < connections; i++) {
+        connect_one();
+    }
+
+    struct us_timer_t *timer = us_create_timer(loop, 0, 0);
+    us_timer_set(timer, on_timer, LIBUS_TIMEOUT_GRANULARITY * 1000, LIBUS_TIMEOUT_GRANULARITY * 1000);
+
+    printf("Running benchmark now...\n");
+    us_loop_run(loop);
+}
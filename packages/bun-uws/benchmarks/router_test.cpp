@@ -0,0 +1,75 @@
+/* This is a microbenchmark of the router, matching requests against a table of a few thousand routes like an API gateway would */
+
+#include "../src/HttpRouter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* How many times we route the whole request list */
+int ROUNDS = 200;
+
+/* Services times resources times operations gives the size of the route table */
+const char *services[] = {"users", "orders", "payments", "inventory", "shipping", "catalog", "reviews", "search",
+    "billing", "accounts", "notifications", "analytics", "media", "auth", "sessions", "carts", "coupons",
+    "invoices", "refunds", "subscriptions"};
+
+const char *resources[] = {"items", "events", "settings", "history", "tags", "comments", "exports", "imports",
+    "members", "webhooks", "keys", "limits", "reports", "jobs", "files", "logs", "audits", "metrics", "labels",
+    "notes"};
+
+long long matched;
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        ROUNDS = atoi(argv[1]);
+    }
+
+    uWS::HttpRouter<int> r;
+    std::vector<std::pair<std::string, std::string>> requests;
+    int routes = 0;
+
+    for (const char *service : services) {
+        for (const char *resource : resources) {
+            std::string base = std::string("/api/v1/") + service + "/" + resource;
+
+            /* Collection, item and a nested item, each with a handful of methods */
+            r.add({"GET", "POST"}, base, [](auto *) { matched++; return true; });
+            r.add({"GET", "PUT", "DELETE"}, base + "/:id", [](auto *r) { matched += r->getParameters().first + 1; return true; });
+            r.add({"GET"}, base + "/:id/versions/:version", [](auto *r) { matched += r->getParameters().first + 1; return true; });
+            r.add({"POST"}, base + "/:id/actions/archive", [](auto *) { matched++; return true; });
+            r.add({"GET"}, base + "/export.csv", [](auto *) { matched++; return true; });
+            routes += 5;
+
+            requests.push_back({"GET", base});
+            requests.push_back({"PUT", base + "/42"});
+            requests.push_back({"GET", base + "/42/versions/7"});
+            requests.push_back({"POST", base + "/42/actions/archive"});
+            requests.push_back({"GET", base + "/export.csv"});
+        }
+    }
+
+    /* Static assets and a catch-all like most gateways have */
+    for (int i = 0; i < 100; i++) {
+        std::string path = "/static/js/chunk-" + std::to_string(i) + ".js";
+        r.add({"GET"}, path, [](auto *) { matched++; return true; });
+        requests.push_back({"GET", path});
+        routes++;
+    }
+    r.add({"*"}, "/*", [](auto *) { return true; }, r.LOW_PRIORITY);
+    requests.push_back({"GET", "/api/v2/unknown/route"});
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (auto &[method, url] : requests) {
+            r.route(method, url);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%d routes, %6.2f M routes/s\n", routes, (double) requests.size() * ROUNDS / seconds / 1e6);
+
+    /* Keep the handlers from being optimized away */
+    return matched == 0;
+}
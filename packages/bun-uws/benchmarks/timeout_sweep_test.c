@@ -0,0 +1,111 @@
+/* This is a benchmark of the socket timeout sweep, measuring its cost against the number of idle connections */
+
+#include <libusockets.h>
+/* We drive the sweep directly, without any real connections or waiting for the timer */
+#include "internal/internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Idle keep-alive timeout of every connection, in seconds */
+int IDLE_TIMEOUT = 120;
+
+/* Out of 1000 connections, this many are busy and re-arm a short timeout on every tick */
+int BUSY_PER_MILLE = 10;
+
+long long expirations;
+
+/* We don't need any of these */
+void on_wakeup(struct us_loop_t *loop) {
+
+}
+
+void on_pre(struct us_loop_t *loop) {
+
+}
+
+void on_post(struct us_loop_t *loop) {
+
+}
+
+struct us_socket_t *on_socket_timeout(struct us_socket_t *s) {
+    expirations++;
+
+    /* Like any idle timeout handler that keeps the connection, re-arm */
+    us_socket_timeout(0, s, IDLE_TIMEOUT);
+    return s;
+}
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+void run(struct us_loop_t *loop, int connections) {
+    struct us_socket_context_options_t options = {};
+    struct us_socket_context_t *context = us_create_socket_context(0, loop, 0, options);
+    us_socket_context_on_timeout(0, context, on_socket_timeout);
+
+    /* Sockets are never polled, so we only need their memory */
+    struct us_socket_t *sockets = calloc(connections, sizeof(struct us_socket_t));
+    for (int i = 0; i < connections; i++) {
+        struct us_socket_t *s = &sockets[i];
+        s->timeout = 255;
+        s->long_timeout = 255;
+        us_internal_socket_context_link_socket(context, s);
+
+        if (i % 1000 < BUSY_PER_MILLE) {
+            us_socket_timeout_ms(0, s, LIBUS_TIMEOUT_RESOLUTION_MS);
+        } else {
+            us_socket_timeout(0, s, IDLE_TIMEOUT);
+        }
+    }
+
+    /* Run one full revolution of the wheel so that every idle connection expires once */
+    expirations = 0;
+    double worst = 0, start = now_ns();
+    for (int tick = 0; tick < LIBUS_TIMEOUT_WHEEL_SLOTS; tick++) {
+        double tick_start = now_ns();
+        us_internal_timer_sweep(loop);
+        double elapsed = now_ns() - tick_start;
+        if (elapsed > worst) {
+            worst = elapsed;
+        }
+
+        /* Busy connections see traffic on every tick and push their timeout forward */
+        for (int i = 0; i < connections; i += 1000) {
+            for (int j = i; j < i + BUSY_PER_MILLE && j < connections; j++) {
+                us_socket_timeout_ms(0, &sockets[j], LIBUS_TIMEOUT_RESOLUTION_MS);
+            }
+        }
+    }
+    double total = now_ns() - start;
+
+    printf("%8d connections: %10.0f ns/sweep avg, %10.0f ns worst, %lld expirations\n",
+        connections, total / LIBUS_TIMEOUT_WHEEL_SLOTS, worst, expirations);
+
+    for (int i = 0; i < connections; i++) {
+        us_internal_socket_context_unlink_socket(0, context, &sockets[i]);
+    }
+    free(sockets);
+    us_socket_context_free(0, context);
+}
+
+int main(int argc, char **argv) {
+
+    /* Parse connection counts, default to a sweep from 1k to 1M */
+    int default_counts[] = {1000, 10000, 100000, 300000, 800000};
+    int num_counts = argc > 1 ? argc - 1 : (int) (sizeof(default_counts) / sizeof(int));
+
+    struct us_loop_t *loop = us_create_loop(0, on_wakeup, on_pre, on_post, 0);
+
+    printf("Timeout resolution: %d ms, idle timeout: %d s\n", LIBUS_TIMEOUT_RESOLUTION_MS, IDLE_TIMEOUT);
+    for (int i = 0; i < num_counts; i++) {
+        run(loop, argc > 1 ? atoi(argv[i + 1]) : default_counts[i]);
+    }
+
+    us_loop_free(loop);
+}
@@ -178,7 +178,7 @@ public:
                 auto *ws = (WebSocket<SSL, true, int> *) s->user;
 
                 /* Send will drain if needed */
-                ws->send(message.message, (OpCode)message.opCode, message.compress);
+                ws->sendPublished(message);
             });
         } else {
             return topicTree->publish(nullptr, topic, {std::string(message), opCode, compress});
@@ -345,7 +345,7 @@ public:
                 }
 
                 /* If we ever overstep maxBackpresure, exit immediately */
-                if (WebSocket<SSL, true, int>::SendStatus::DROPPED == ws->send(message.message, (OpCode)message.opCode, message.compress)) {
+                if (WebSocket<SSL, true, int>::SendStatus::DROPPED == ws->sendPublished(message)) {
                     if (needsUncork) {
                         ((AsyncSocket<SSL> *)ws)->uncork();
                         needsUncork = false;
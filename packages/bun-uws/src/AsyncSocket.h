@@ -234,19 +234,20 @@ public:
         LoopData *loopData = getLoopData();
         AsyncSocketData<SSL> *asyncSocketData = getAsyncSocketData();
 
-        /* We are limited if we have a per-socket buffer */
-        if (asyncSocketData->buffer.length()) {
-            size_t buffer_len = asyncSocketData->buffer.length();
+        /* We are limited if we have a per-socket buffer, written off one contiguous part at a time */
+        while (asyncSocketData->buffer.length()) {
+            std::string_view pending = asyncSocketData->buffer.front();
             // we cannot not flush more than INT_MAX bytes at a time
-            int max_flush_len = std::min(buffer_len, (size_t)INT_MAX);
+            int max_flush_len = (int) std::min(pending.length(), (size_t)INT_MAX);
+            bool more = length || asyncSocketData->buffer.length() > pending.length();
 
             /* Write off as much as we can */
-            int written = us_socket_write(SSL, (us_socket_t *) this, asyncSocketData->buffer.data(), max_flush_len, /*nextLength != 0 | */length);
-            /* On failure return, otherwise continue down the function */
-            if ((unsigned int) written < buffer_len) {
-                /* Update buffering (todo: we can do better here if we keep track of what happens to this guy later on) */
+            int written = us_socket_write(SSL, (us_socket_t *) this, pending.data(), max_flush_len, /*nextLength != 0 | */more);
+            if (written > 0) {
                 asyncSocketData->buffer.erase((unsigned int) written);
-
+            }
+            /* On failure return, otherwise continue with the next part */
+            if (written < max_flush_len) {
                 if (optionally) {
                     /* Thankfully we can exit early here */
                     return {0, true};
@@ -256,8 +257,10 @@ public:
                     return {length, true};
                 }
             }
+        }
 
-            /* At this point we simply have no buffer and can continue as normal */
+        /* At this point we simply have no buffer and can continue as normal */
+        if (asyncSocketData->buffer.totalLength()) {
             asyncSocketData->buffer.clear();
         }
 
@@ -20,21 +20,69 @@
 #define UWS_ASYNCSOCKETDATA_H
 
 #include <string>
+#include <string_view>
+#include <deque>
+#include <memory>
 
 namespace uWS {
 
+/* Bytes a socket could not send yet. Owned bytes are kept contiguous in buffer, frames shared with
+ * other sockets (every subscriber of a publish gets the same bytes) are queued after it by reference,
+ * so congested subscribers do not each copy them. Bytes appended behind shared frames become a
+ * frame of their own to keep the order. */
 struct BackPressure {
     std::string buffer;
     unsigned int pendingRemoval = 0;
+    std::deque<std::shared_ptr<const std::string>> shared;
+    /* Bytes of shared.front() already sent */
+    size_t sharedOffset = 0;
+    /* Unsent bytes in shared */
+    size_t sharedLength = 0;
     BackPressure(BackPressure &&other) {
         buffer = std::move(other.buffer);
         pendingRemoval = other.pendingRemoval;
+        shared = std::move(other.shared);
+        sharedOffset = other.sharedOffset;
+        sharedLength = other.sharedLength;
+        other.sharedOffset = other.sharedLength = 0;
     }
     BackPressure() = default;
     void append(const char *data, size_t length) {
+        if (shared.size()) {
+            appendShared(std::make_shared<const std::string>(data, length));
+            return;
+        }
         buffer.append(data, length);
     }
+    /* Queues frame, minus the first offset bytes which were already sent. Only the first queued frame can have an offset */
+    void appendShared(std::shared_ptr<const std::string> frame, size_t offset = 0) {
+        if (frame->length() == offset) {
+            return;
+        }
+        if (shared.empty()) {
+            sharedOffset = offset;
+        }
+        sharedLength += frame->length() - offset;
+        shared.push_back(std::move(frame));
+    }
+    /* The next contiguous bytes to send */
+    std::string_view front() {
+        if (buffer.length() > pendingRemoval || shared.empty()) {
+            return {buffer.data() + pendingRemoval, buffer.length() - pendingRemoval};
+        }
+        return std::string_view(*shared.front()).substr(sharedOffset);
+    }
+    /* Removes length sent bytes, at most front().length() */
     void erase(unsigned int length) {
+        if (buffer.length() == pendingRemoval && shared.size()) {
+            sharedOffset += length;
+            sharedLength -= length;
+            if (sharedOffset == shared.front()->length()) {
+                shared.pop_front();
+                sharedOffset = 0;
+            }
+            return;
+        }
         pendingRemoval += length;
         /* Always erase a minimum of 1/32th the current backpressure */
         if (pendingRemoval > (buffer.length() >> 5)) {
@@ -44,17 +92,21 @@ struct BackPressure {
         }
     }
     size_t length() {
-        return buffer.length() - pendingRemoval;
+        return buffer.length() - pendingRemoval + sharedLength;
     }
     void clear() {
         pendingRemoval = 0;
         buffer.clear();
         buffer.shrink_to_fit();
+        shared.clear();
+        sharedOffset = sharedLength = 0;
     }
     void reserve(size_t length) {
         buffer.reserve(length + pendingRemoval);
     }
+    /* Writing into data() needs every byte in buffer, so shared frames are copied in first */
     void resize(size_t length) {
+        flatten();
         buffer.resize(length + pendingRemoval);
     }
     const char *data() {
@@ -65,7 +117,16 @@ struct BackPressure {
     }
     /* The total length, incuding pending removal */
     size_t totalLength() {
-        return buffer.length();
+        return buffer.length() + sharedLength;
+    }
+
+private:
+    void flatten() {
+        for (size_t i = 0; i < shared.size(); i++) {
+            buffer.append(*shared[i], i ? 0 : sharedOffset);
+        }
+        shared.clear();
+        sharedOffset = sharedLength = 0;
     }
 };
 
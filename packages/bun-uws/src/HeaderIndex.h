@@ -0,0 +1,100 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+
+ *     http://www.apache.org/licenses/LICENSE-2.0
+
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UWS_HEADERINDEX_H
+#define UWS_HEADERINDEX_H
+
+/* Header names hash into 256 slots, each holding the position of the first header that landed there.
+ * The hash is perfect for the well-known header names, so common requests find every header with a
+ * single read and only unusual names can collide, those go in the bloom filter as before */
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace uWS {
+
+/* The HTTPHeaderNames.gperf set, lower cased */
+static constexpr std::string_view KNOWN_HEADER_NAMES[] = {
+    "accept", "accept-charset", "accept-encoding", "accept-language", "accept-ranges",
+    "access-control-allow-credentials", "access-control-allow-headers", "access-control-allow-methods",
+    "access-control-allow-origin", "access-control-expose-headers", "access-control-max-age",
+    "access-control-request-headers", "access-control-request-method", "age", "authorization", "cache-control",
+    "connection", "content-disposition", "content-encoding", "content-language", "content-length",
+    "content-location", "content-range", "content-security-policy", "content-security-policy-report-only",
+    "content-type", "cookie", "cookie2", "cross-origin-embedder-policy",
+    "cross-origin-embedder-policy-report-only", "cross-origin-opener-policy",
+    "cross-origin-opener-policy-report-only", "cross-origin-resource-policy", "dnt", "date", "default-style",
+    "etag", "expect", "expires", "host", "icy-metaint", "icy-metadata", "if-match", "if-modified-since",
+    "if-none-match", "if-range", "if-unmodified-since", "keep-alive", "last-event-id", "last-modified", "link",
+    "location", "origin", "ping-from", "ping-to", "pragma", "proxy-authorization", "purpose", "range", "referer",
+    "referrer-policy", "refresh", "report-to", "sec-fetch-dest", "sec-fetch-mode", "sec-websocket-accept",
+    "sec-websocket-extensions", "sec-websocket-key", "sec-websocket-protocol", "sec-websocket-version",
+    "server-timing", "service-worker", "service-worker-allowed", "service-worker-navigation-preload", "set-cookie",
+    "set-cookie2", "sourcemap", "strict-transport-security", "te", "timing-allow-origin", "trailer",
+    "transfer-encoding", "upgrade", "upgrade-insecure-requests", "user-agent", "vary", "via",
+    "x-content-type-options", "x-dns-prefetch-control", "x-frame-options", "x-sourcemap", "x-temp-tablet",
+    "x-xss-protection"
+};
+
+/* First, last, second to last and middle letter plus length, scrambled by a multiplier found by search.
+ * Keys must not be empty */
+static constexpr unsigned int headerSlot(std::string_view key) {
+    size_t length = key.length();
+    uint64_t features = (uint64_t) (unsigned char) key[0] | (uint64_t) (unsigned char) key[length - 1] << 8
+        | (uint64_t) (unsigned char) key[length - (length > 1 ? 2 : 1)] << 16 | (uint64_t) (unsigned char) key[length >> 1] << 24
+        | (uint64_t) length << 32;
+    return (unsigned int) ((features * 13031199880831625759ull) >> 56);
+}
+
+static_assert([] {
+    bool taken[256] = {};
+    for (std::string_view name : KNOWN_HEADER_NAMES) {
+        if (taken[headerSlot(name)]) {
+            return false;
+        }
+        taken[headerSlot(name)] = true;
+    }
+    return true;
+}(), "Well-known header names must not collide, search for a new multiplier");
+
+struct HeaderIndex {
+private:
+    /* Index into HttpRequest::headers, 0 if no header landed in this slot */
+    unsigned char positions[256];
+
+public:
+    /* Returns the position of the first header whose name hashes like this one, or 0 */
+    unsigned int get(std::string_view key) {
+        return positions[headerSlot(key)];
+    }
+
+    /* Returns false if an earlier header already took the slot */
+    bool add(std::string_view key, unsigned int position) {
+        unsigned char &slot = positions[headerSlot(key)];
+        if (slot) {
+            return false;
+        }
+        slot = (unsigned char) position;
+        return true;
+    }
+
+    void reset() {
+        memset(positions, 0, sizeof(positions));
+    }
+};
+
+}
+
+#endif // UWS_HEADERINDEX_H
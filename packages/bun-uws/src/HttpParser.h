@@ -35,10 +35,20 @@
 #include "ChunkedEncoding.h"
 
 #include "BloomFilter.h"
+#include "HeaderIndex.h"
 #include "ProxyParser.h"
 #include "QueryParser.h"
 #include "HttpErrors.h"
 
+/* Header scanning goes 16 bytes at a time where there are vectors, 8 bytes at a time (SWAR) elsewhere */
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UWS_HTTP_PARSER_SSE2
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define UWS_HTTP_PARSER_NEON
+#endif
+
 extern "C" size_t BUN_DEFAULT_MAX_HTTP_HEADER_SIZE;
 
 namespace uWS
@@ -48,6 +58,9 @@ namespace uWS
     static const unsigned int MINIMUM_HTTP_POST_PADDING = 32;
     static void *FULLPTR = (void *)~(uintptr_t)0;
 
+    /* HeaderIndex stores header positions in a byte */
+    static_assert(UWS_HTTP_MAX_HEADERS_COUNT <= 256);
+
     struct HttpRequest
     {
 
@@ -61,6 +74,8 @@ namespace uWS
         bool ancientHttp;
         unsigned int querySeparator;
         bool didYield;
+        /* Headers are indexed by name, the bloom filter only holds those that collided */
+        HeaderIndex headerIndex;
         BloomFilter bf;
         std::pair<int, std::string_view *> currentParameters;
         std::map<std::string, unsigned short, std::less<>> *currentParameterOffsets = nullptr;
@@ -121,6 +136,23 @@ namespace uWS
 
         std::string_view getHeader(std::string_view lowerCasedHeader)
         {
+            if (!lowerCasedHeader.length())
+            {
+                return std::string_view(nullptr, 0);
+            }
+
+            /* Nothing in the slot means no header by this name */
+            unsigned int position = headerIndex.get(lowerCasedHeader);
+            if (!position)
+            {
+                return std::string_view(nullptr, 0);
+            }
+            if (headers[position].key == lowerCasedHeader)
+            {
+                return headers[position].value;
+            }
+
+            /* Another name took the slot first, so this one is in the bloom filter if present at all */
             if (bf.mightHave(lowerCasedHeader))
             {
                 for (Header *h = headers; (++h)->key.length();)
@@ -260,6 +292,55 @@ namespace uWS
             hasMore(x, 'z');
         }
 
+#if defined(UWS_HTTP_PARSER_SSE2)
+        /* Unsigned lo <= x <= hi per byte */
+        static inline __m128i inRange(__m128i x, char lo, char hi) {
+            __m128i offset = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+            return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8((char) (hi - lo))), offset);
+        }
+#elif defined(UWS_HTTP_PARSER_NEON)
+        static inline uint8x16_t inRange(uint8x16_t x, unsigned char lo, unsigned char hi) {
+            return vcleq_u8(vsubq_u8(x, vdupq_n_u8(lo)), vdupq_n_u8((unsigned char) (hi - lo)));
+        }
+
+        /* NEON has no movemask, narrowing leaves 4 bits per byte instead */
+        static inline uint64_t nibbleMask(uint8x16_t x) {
+            return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(x), 4)), 0);
+        }
+#endif
+
+        /* Returns the first byte (unsigned) less than n. There always is one as we are fenced by \r,
+         * and vector loads stay within the post padding since they start at or before the fence */
+        static inline char *findLessThan(char *p, unsigned char n) {
+#if defined(UWS_HTTP_PARSER_SSE2)
+            const __m128i limit = _mm_set1_epi8((char) (n - 1));
+            for (; true; p += 16) {
+                __m128i word = _mm_loadu_si128((const __m128i *) p);
+                unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(word, limit), limit));
+                if (mask) {
+                    return p + __builtin_ctz(mask);
+                }
+            }
+#elif defined(UWS_HTTP_PARSER_NEON)
+            const uint8x16_t limit = vdupq_n_u8(n);
+            for (; true; p += 16) {
+                uint64_t mask = nibbleMask(vcltq_u8(vld1q_u8((const uint8_t *) p), limit));
+                if (mask) {
+                    return p + (__builtin_ctzll(mask) >> 2);
+                }
+            }
+#else
+            for (; true; p += 8) {
+                uint64_t word;
+                memcpy(&word, p, sizeof(uint64_t));
+                if (hasLess(word, n)) {
+                    while (*(unsigned char *)p >= n) p++;
+                    return p;
+                }
+            }
+#endif
+        }
+
         /* RFC 9110 5.6.2. Tokens */
         /* Hyphen is not checked here as it is very common */
         static inline bool isUnlikelyFieldNameByte(unsigned char c)
@@ -285,7 +366,48 @@ namespace uWS
         }
 
         static inline void *consumeFieldName(char *p) {
-            /* Best case fast path (particularly useful with clang) */
+            /* Best case fast path: skip letters and hyphens 16 at a time, then lower case the few upper case
+             * letters one by one. A vector store here would stall the loads of the field value that follows */
+#if defined(UWS_HTTP_PARSER_SSE2)
+            while (true) {
+                __m128i word = _mm_loadu_si128((const __m128i *) p);
+                __m128i upper = inRange(word, 'A', 'Z');
+                __m128i lower = _mm_or_si128(word, _mm_and_si128(upper, _mm_set1_epi8(32)));
+                __m128i name = _mm_or_si128(inRange(lower, 'a', 'z'), _mm_cmpeq_epi8(lower, _mm_set1_epi8('-')));
+                unsigned int stop = ~(unsigned int) _mm_movemask_epi8(name) & 0xFFFF;
+                unsigned int length = stop ? (unsigned int) __builtin_ctz(stop) : 16;
+                for (unsigned int mask = (unsigned int) _mm_movemask_epi8(upper) & ((1u << length) - 1); mask; mask &= mask - 1) {
+                    p[__builtin_ctz(mask)] |= 32;
+                }
+                p += length;
+                if (stop) {
+                    if (*p == ':') {
+                        return (void *)p;
+                    }
+                    break;
+                }
+            }
+#elif defined(UWS_HTTP_PARSER_NEON)
+            while (true) {
+                uint8x16_t word = vld1q_u8((const uint8_t *) p);
+                uint8x16_t upper = inRange(word, 'A', 'Z');
+                uint8x16_t lower = vorrq_u8(word, vandq_u8(upper, vdupq_n_u8(32)));
+                uint8x16_t name = vorrq_u8(inRange(lower, 'a', 'z'), vceqq_u8(lower, vdupq_n_u8('-')));
+                uint64_t stop = ~nibbleMask(name);
+                unsigned int length = stop ? (unsigned int) __builtin_ctzll(stop) >> 2 : 16;
+                uint64_t mask = nibbleMask(upper) & (length == 16 ? ~0ull : (1ull << (length * 4)) - 1);
+                for (; mask; mask &= ~(0xFull << (__builtin_ctzll(mask) & ~3))) {
+                    p[__builtin_ctzll(mask) >> 2] |= 32;
+                }
+                p += length;
+                if (stop) {
+                    if (*p == ':') {
+                        return (void *)p;
+                    }
+                    break;
+                }
+            }
+#else
             while (true) {
                 while ((*p >= 65) & (*p <= 90)) [[likely]] {
                     *p |= 32;
@@ -304,6 +426,7 @@ namespace uWS
                     break;
                 }
             }
+#endif
 
             /* Generic */
             while (isFieldNameByteFastLowercased(*(unsigned char *)p)) {
@@ -367,38 +490,32 @@ namespace uWS
                 data++;
                 /* Scan for less than 33 (catches post padded CR and fails) */
                 start = data;
-                for (; true; data += 8) {
-                    uint64_t word;
-                    memcpy(&word, data, sizeof(uint64_t));
-                    if (hasLess(word, 33)) {
-                        while (*(unsigned char *)data > 32) data++;
-                        /* Now we stand on space */
-                        header.value = {start, (size_t) (data - start)};
-                        /* Check that the following is http 1.1 */
-                        if (data + 11 >= end) {
-                            /* Whatever we have must be part of the version string */
-                            if (memcmp(" HTTP/1.1\r\n", data, std::min<unsigned int>(11, (unsigned int) (end - data))) == 0) {
-                                return nullptr;
-                            } else if (memcmp(" HTTP/1.0\r\n", data, std::min<unsigned int>(11, (unsigned int) (end - data))) == 0) {
-                                isAncientHTTP = true;
-                                return data + 11;
-                            }
-                            return (char *) 0x1;
-                        }
-                        if (memcmp(" HTTP/1.1\r\n", data, 11) == 0) {
-                            return data + 11;
-                        } else if (memcmp(" HTTP/1.0\r\n", data, 11) == 0) {
-                            isAncientHTTP = true;
-                            return data + 11;
-                        }
-                        /* If we stand at the post padded CR, we have fragmented input so try again later */
-                        if (data[0] == '\r') {
-                            return nullptr;
-                        }
-                        /* This is an error */
-                        return (char *) 0x1;
+                data = findLessThan(data, 33);
+                /* Now we stand on space */
+                header.value = {start, (size_t) (data - start)};
+                /* Check that the following is http 1.1 */
+                if (data + 11 >= end) {
+                    /* Whatever we have must be part of the version string */
+                    if (memcmp(" HTTP/1.1\r\n", data, std::min<unsigned int>(11, (unsigned int) (end - data))) == 0) {
+                        return nullptr;
+                    } else if (memcmp(" HTTP/1.0\r\n", data, std::min<unsigned int>(11, (unsigned int) (end - data))) == 0) {
+                        isAncientHTTP = true;
+                        return data + 11;
                     }
+                    return (char *) 0x1;
+                }
+                if (memcmp(" HTTP/1.1\r\n", data, 11) == 0) {
+                    return data + 11;
+                } else if (memcmp(" HTTP/1.0\r\n", data, 11) == 0) {
+                    isAncientHTTP = true;
+                    return data + 11;
                 }
+                /* If we stand at the post padded CR, we have fragmented input so try again later */
+                if (data[0] == '\r') {
+                    return nullptr;
+                }
+                /* This is an error */
+                return (char *) 0x1;
             }
 
             /* If we stand at the post padded CR, we have fragmented input so try again later */
@@ -425,19 +542,16 @@ namespace uWS
         * Field values containing CR, LF, or NUL characters are invalid and dangerous [...]
         * Field values containing other CTL characters are also invalid. */
         static inline void *tryConsumeFieldValue(char *p) {
-            for (; true; p += 8) {
-                uint64_t word;
-                memcpy(&word, p, sizeof(uint64_t));
-                if (hasLess(word, 32)) {
-                    while (*(unsigned char *)p > 31) p++;
-                    return (void *)p;
-                }
-            }
+            return (void *) findLessThan(p, 32);
         }
 
         /* End is only used for the proxy parser. The HTTP parser recognizes "\ra" as invalid "\r\n" scan and breaks. */
-        static unsigned int getHeaders(char *postPaddedBuffer, char *end, struct HttpRequest::Header *headers, void *reserved, unsigned int &err, bool &isAncientHTTP) {
+        /* Headers are indexed as they are parsed, those that collide go in the bloom filter */
+        static unsigned int getHeaders(char *postPaddedBuffer, char *end, HttpRequest *req, void *reserved, unsigned int &err, bool &isAncientHTTP) {
             char *preliminaryKey, *preliminaryValue, *start = postPaddedBuffer;
+            struct HttpRequest::Header *headers = req->headers;
+            req->headerIndex.reset();
+            req->bf.reset();
 
             #ifdef UWS_WITH_PROXY
                 /* ProxyParser is passed as reserved parameter */
@@ -491,8 +605,9 @@ namespace uWS
                 postPaddedBuffer = (char *) consumeFieldName(postPaddedBuffer);
                 headers->key = std::string_view(preliminaryKey, (size_t) (postPaddedBuffer - preliminaryKey));
 
-                /* We should not accept whitespace between key and colon, so colon must foloow immediately */
-                if (postPaddedBuffer[0] != ':') {
+                /* We should not accept whitespace between key and colon, so colon must foloow immediately.
+                 * An empty field name would also end the header list early, RFC 9110 requires a token */
+                if (postPaddedBuffer[0] != ':' || postPaddedBuffer == preliminaryKey) {
                     /* If we stand at the end, we are fragmented */
                     if (postPaddedBuffer == end) {
                         return 0;
@@ -537,6 +652,10 @@ namespace uWS
                         headers->value.remove_prefix(1);
                     }
 
+                    if (!req->headerIndex.add(headers->key, i)) {
+                        req->bf.add(headers->key);
+                    }
+
                     headers++;
 
                     /* We definitely have at least one header (or request line), so check if we are done */
@@ -580,7 +699,7 @@ namespace uWS
         data[length + 1] = 'a'; /* Anything that is not \n, to trigger "invalid request" */
         bool isAncientHTTP = false;
 
-        for (unsigned int consumed; length && (consumed = getHeaders(data, data + length, req->headers, reserved, err, isAncientHTTP)); ) {
+        for (unsigned int consumed; length && (consumed = getHeaders(data, data + length, req, reserved, err, isAncientHTTP)); ) {
             data += consumed;
             length -= consumed;
             consumedTotal += consumed;
@@ -593,12 +712,6 @@ namespace uWS
             /* Store HTTP version (ancient 1.0 or 1.1) */
             req->ancientHttp = isAncientHTTP;
 
-            /* Add all headers to bloom filter */
-            req->bf.reset();
-            for (HttpRequest::Header *h = req->headers; (++h)->key.length(); ) {
-                req->bf.add(h->key);
-            }
-
             /* Break if no host header (but we can have empty string which is different from nullptr) */
             if (!req->getHeader("host").data()) {
                 return {HTTP_ERROR_400_BAD_REQUEST, FULLPTR};
@@ -721,8 +834,7 @@ namespace uWS
 public:
     std::pair<unsigned int, void *> consumePostPadded(char *data, unsigned int length, void *user, void *reserved, MoveOnlyFunction<void *(void *, HttpRequest *)> &&requestHandler, MoveOnlyFunction<void *(void *, std::string_view, bool)> &&dataHandler) {
 
-        /* This resets BloomFilter by construction, but later we also reset it again.
-        * Optimize this to skip resetting twice (req could be made global) */
+        /* The header index and bloom filter are reset by getHeaders */
         HttpRequest req;
         if (remainingStreamingBytes) {
 
@@ -42,6 +42,9 @@ private:
     USERDATA userData;
     static const unsigned int MAX_URL_SEGMENTS = 100;
 
+    /* Static siblings up to this many are scanned rather than bisected */
+    static const unsigned int MAX_SCANNED_RUN = 64;
+
     /* Handler ids are 32-bit */
     static const uint32_t HANDLER_MASK = 0x0fffffff;
 
@@ -163,43 +166,179 @@ private:
         return {urlSegmentVector[urlSegment], false};
     }
 
-    /* Executes as many handlers it can */
-    bool executeHandlers(Node *parent, int urlSegment, USERDATA &userData) {
+    /* The matching tree compiled into contiguous arrays, rebuilt by the first route after any change.
+     * Siblings sit next to each other, chains of static nodes without handlers or branches are merged
+     * into one prefix and neighbouring static siblings are sorted by their first segment so that we
+     * can binary search them. Only static siblings that compare equal can match the same URL, and
+     * those keep their order, so we execute handlers in the same order as the tree would */
+    enum : unsigned char {
+        STATIC_NODE,
+        PARAMETER_NODE,
+        WILDCARD_NODE
+    };
+
+    struct CompiledNode {
+        /* Offset and length in compiledNames, the first segment of the name is the sort key */
+        uint32_t name;
+        uint32_t nameLength;
+        uint32_t firstSegmentLength;
+        /* How many URL segments a static node spans */
+        uint32_t segments;
+        /* How many static siblings follow in the same sorted run, counting this one */
+        uint32_t staticRun;
+        uint32_t children;
+        uint32_t numChildren;
+        uint32_t handlers;
+        uint32_t numHandlers;
+        unsigned char type;
+    };
+
+    std::vector<CompiledNode> compiledNodes;
+    std::vector<uint32_t> compiledHandlers;
+    std::string compiledNames;
+    bool isCompiled = false;
+
+    static unsigned char nodeType(std::string_view name) {
+        if (name.starts_with('*')) {
+            return WILDCARD_NODE;
+        }
+        if (name.starts_with(':')) {
+            return PARAMETER_NODE;
+        }
+        return STATIC_NODE;
+    }
 
-        auto [segment, isStop] = getUrlSegment(urlSegment);
+    /* Lays out the children of node next to each other, then recurses into each of them */
+    void compileChildren(Node *node, uint32_t index) {
+        std::vector<Node *> children;
+        for (const std::unique_ptr<Node> &child : node->children) {
+            children.push_back(child.get());
+        }
 
-        /* If we are on STOP, return where we may stand */
-        if (isStop) {
-            /* We have reached accross the entire URL with no stoppage, execute */
-            for (uint32_t handler : parent->handlers) {
-                if (handlers[handler & HANDLER_MASK](this)) {
-                    return true;
+        /* Methods are looked up linearly with ANY last, everything else gets its static runs sorted */
+        uint32_t runStart = 0;
+        for (uint32_t i = 0; i <= children.size(); i++) {
+            if (i < children.size() && node != &root && nodeType(children[i]->name) == STATIC_NODE) {
+                continue;
+            }
+            std::stable_sort(children.begin() + runStart, children.begin() + i, [](Node *a, Node *b) {
+                return a->name < b->name;
+            });
+            runStart = i + 1;
+        }
+
+        uint32_t first = (uint32_t) compiledNodes.size();
+        compiledNodes.resize(first + children.size());
+        compiledNodes[index].children = first;
+        compiledNodes[index].numChildren = (uint32_t) children.size();
+
+        for (uint32_t i = 0; i < children.size(); i++) {
+            Node *child = children[i];
+            CompiledNode compiled = {};
+            compiled.type = nodeType(child->name);
+            compiled.name = (uint32_t) compiledNames.length();
+            compiled.firstSegmentLength = (uint32_t) child->name.length();
+            compiled.segments = 1;
+            compiledNames.append(child->name);
+
+            if (node != &root && compiled.type == STATIC_NODE) {
+                /* A static node we would only pass through on the way to its single static child is the same thing as a longer prefix */
+                while (child->handlers.empty() && child->children.size() == 1 && nodeType(child->children[0]->name) == STATIC_NODE) {
+                    child = child->children[0].get();
+                    compiledNames.append(1, '/').append(child->name);
+                    compiled.segments++;
+                }
+
+                for (uint32_t j = i; j < children.size() && nodeType(children[j]->name) == STATIC_NODE; j++) {
+                    compiled.staticRun++;
                 }
             }
-            /* We reached the end, so go back */
-            return false;
+            compiled.nameLength = (uint32_t) compiledNames.length() - compiled.name;
+
+            compiled.handlers = (uint32_t) compiledHandlers.size();
+            compiled.numHandlers = (uint32_t) child->handlers.size();
+            compiledHandlers.insert(compiledHandlers.end(), child->handlers.begin(), child->handlers.end());
+
+            compiledNodes[first + i] = compiled;
+            compileChildren(child, first + i);
         }
+    }
+
+    void compile() {
+        compiledNodes.clear();
+        compiledHandlers.clear();
+        compiledNames.clear();
 
-        for (auto &p : parent->children) {
-            if (p->name.starts_with('*')) {
+        compiledNodes.resize(1);
+        compileChildren(&root, 0);
+        isCompiled = true;
+    }
+
+    inline std::string_view firstSegment(const CompiledNode &node) {
+        return {compiledNames.data() + node.name, node.firstSegmentLength};
+    }
+
+    inline bool executeNodeHandlers(const CompiledNode &node) {
+        for (uint32_t i = node.handlers; i < node.handlers + node.numHandlers; i++) {
+            if (handlers[compiledHandlers[i] & HANDLER_MASK](this)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Executes as many handlers it can, url is what remains after the segments matched so far */
+    bool executeHandlers(uint32_t index, std::string_view url, unsigned int urlSegment) {
+        const CompiledNode &parent = compiledNodes[index];
+
+        /* Signal as STOP when we have no more URL or stack space */
+        if (!url.length() || urlSegment > MAX_URL_SEGMENTS - 1) {
+            /* We have reached accross the entire URL with no stoppage, execute */
+            return executeNodeHandlers(parent);
+        }
+
+        /* We always stand on a slash here, so step over it */
+        url.remove_prefix(1);
+        std::string_view segment = url.substr(0, url.find('/'));
+
+        for (uint32_t i = parent.children; i < parent.children + parent.numChildren; i++) {
+            const CompiledNode &p = compiledNodes[i];
+            if (p.type == WILDCARD_NODE) {
                 /* Wildcard match (can be seen as a shortcut) */
-                for (uint32_t handler : p->handlers) {
-                    if (handlers[handler & HANDLER_MASK](this)) {
+                if (executeNodeHandlers(p)) {
+                    return true;
+                }
+            } else if (p.type == PARAMETER_NODE) {
+                /* Parameter match */
+                if (!segment.empty()) {
+                    routeParameters.push(segment);
+                    if (executeHandlers(i, url.substr(segment.length()), urlSegment + 1)) {
                         return true;
                     }
+                    routeParameters.pop();
                 }
-            } else if (p->name.starts_with(':') && !segment.empty()) {
-                /* Parameter match */
-                routeParameters.push(segment);
-                if (executeHandlers(p.get(), urlSegment + 1, userData)) {
-                    return true;
+            } else {
+                /* Static match of one or more whole segments, we only ever stand on the first node of a run here.
+                 * Short runs are faster to scan than to bisect, long runs we bisect down to the names equal to segment */
+                uint32_t runEnd = i + p.staticRun, end = runEnd;
+                if (p.staticRun > MAX_SCANNED_RUN) {
+                    i = (uint32_t) (std::partition_point(compiledNodes.begin() + i, compiledNodes.begin() + runEnd, [this, segment](const CompiledNode &n) {
+                        return firstSegment(n) < segment;
+                    }) - compiledNodes.begin());
+                    for (end = i; end < runEnd && firstSegment(compiledNodes[end]) == segment; end++);
                 }
-                routeParameters.pop();
-            } else if (p->name == segment) {
-                /* Static match */
-                if (executeHandlers(p.get(), urlSegment + 1, userData)) {
-                    return true;
+
+                for (; i < end; i++) {
+                    const CompiledNode &s = compiledNodes[i];
+                    if (url.length() >= s.nameLength && (url.length() == s.nameLength || url[s.nameLength] == '/')
+                        && (!s.nameLength || url[0] == compiledNames[s.name]) && urlSegment + s.segments <= MAX_URL_SEGMENTS
+                        && !memcmp(url.data(), compiledNames.data() + s.name, s.nameLength)) {
+                        if (executeHandlers(i, url.substr(s.nameLength), urlSegment + s.segments)) {
+                            return true;
+                        }
+                    }
                 }
+                i = runEnd - 1;
             }
         }
         return false;
@@ -213,7 +352,7 @@ private:
                 Node *n = node.get();
                 for (int i = 0; !getUrlSegment(i).second; i++) {
                     /* Go to next segment or quit */
-                    std::string segment(getUrlSegment(i).first);
+                    std::string_view segment = getUrlSegment(i).first;
                     Node *next = nullptr;
                     for (const std::unique_ptr<Node> &child : n->children) {
                         if (((segment.starts_with(':') && child->name.starts_with(':')) || child->name == segment) && child->isHighPriority == (priority == HIGH_PRIORITY)) {
@@ -254,15 +393,18 @@ public:
 
     /* Fast path */
     bool route(std::string_view method, std::string_view url) {
-        /* Reset url parsing cache */
-        setUrl(url);
+        if (!isCompiled) [[unlikely]] {
+            compile();
+        }
         routeParameters.reset();
 
         /* Begin by finding the method node */
-        for (auto &p : root.children) {
-            if (p->name == method) {
+        const CompiledNode &methods = compiledNodes[0];
+        for (uint32_t i = methods.children; i < methods.children + methods.numChildren; i++) {
+            const CompiledNode &p = compiledNodes[i];
+            if (method.length() == p.nameLength && !memcmp(method.data(), compiledNames.data() + p.name, p.nameLength)) {
                 /* Then route the url */
-                if (executeHandlers(p.get(), 0, userData)) {
+                if (executeHandlers(i, url, 0)) {
                     return true;
                 } else {
                     break;
@@ -271,16 +413,17 @@ public:
         }
 
         /* Always test any route last (this check should not be necessary if we always have at least one handler) */
-        if (root.children.empty()) [[unlikely]] {
+        if (!methods.numChildren) [[unlikely]] {
             return false;
         }
-        return executeHandlers(root.children.back().get(), 0, userData);
+        return executeHandlers(methods.children + methods.numChildren - 1, url, 0);
     }
 
     /* Adds the corresponding entires in matching tree and handler list */
     void add(const std::vector<std::string> &methods, std::string_view pattern, MoveOnlyFunction<bool(HttpRouter *)> &&handler, uint32_t priority = MEDIUM_PRIORITY) {
         /* First remove existing handler */
         remove(methods[0], pattern, priority);
+        isCompiled = false;
 
         for (const std::string &method : methods) {
             /* Lookup method */
@@ -366,6 +509,8 @@ public:
             return false;
         }
 
+        isCompiled = false;
+
         /* Cull the entire tree */
         /* For all nodes in depth first tree traveral;
          * if node contains handler - remove the handler -
@@ -189,6 +189,77 @@ public:
         return SUCCESS;
     }
 
+    /* Send a published message (TopicTreeMessage or TopicTreeBigMessage). Every subscriber of a publish receives
+     * the same bytes unless it has a dedicated (sliding window) compressor, so the frame is formatted and compressed
+     * with the shared compressor once and cached in the message. Subscribers copy it into the cork buffer or write
+     * it straight to the socket, and only hold a reference to it for what they have to buffer. */
+    template <typename PublishedMessage>
+    SendStatus sendPublished(PublishedMessage &message) {
+        static_assert(isServer, "Only servers publish, clients would need a fresh mask per frame");
+
+        WebSocketData *webSocketData = (WebSocketData *) Super::getAsyncSocketData();
+
+        /* Same compress hint correction as in send */
+        bool compress = message.compress && message.message.length() && message.opCode < 3 && webSocketData->compressionStatus == WebSocketData::ENABLED;
+        if (compress && webSocketData->deflationStream) {
+            /* Output of a dedicated compressor depends on what this socket sent before */
+            return send(message.message, (OpCode) message.opCode, true);
+        }
+
+        std::shared_ptr<const std::string> &frame = message.frames[compress];
+        if (!frame) {
+            std::string_view payload = message.message;
+            if (compress) {
+                LoopData *loopData = Super::getLoopData();
+                payload = loopData->deflationStream->deflate(loopData->zlibContext, payload, true);
+            }
+            auto formatted = std::make_shared<std::string>(protocol::messageFrameSize(payload.length()), '\0');
+            protocol::formatMessage<isServer>(formatted->data(), payload.data(), payload.length(), (OpCode) message.opCode, payload.length(), compress, true);
+            frame = std::move(formatted);
+        }
+
+        return sendFrame(frame);
+    }
+
+    /* Send an already formatted frame, with the same backpressure and timeout behavior as send. What the
+     * socket does not take is buffered as a reference to frame, which must not change afterwards */
+    SendStatus sendFrame(const std::shared_ptr<const std::string> &frame) {
+        WebSocketContextData<SSL, USERDATA> *webSocketContextData = (WebSocketContextData<SSL, USERDATA> *) us_socket_context_ext(SSL,
+            (us_socket_context_t *) us_socket_context(SSL, (us_socket_t *) this)
+        );
+
+        /* Skip sending and report success if we are over the limit of maxBackpressure */
+        if (webSocketContextData->maxBackpressure && webSocketContextData->maxBackpressure < getBufferedAmount()) {
+            /* Also defer a close if we should */
+            if (webSocketContextData->closeOnBackpressureLimit) {
+                us_socket_shutdown_read(SSL, (us_socket_t *) this);
+            }
+            return DROPPED;
+        }
+
+        WebSocketData *webSocketData = (WebSocketData *) Super::getAsyncSocketData();
+        if (webSocketData->subscriber) {
+            /* This will call back into us, send. */
+            webSocketContextData->topicTree->drain(webSocketData->subscriber);
+        }
+
+        /* Goes to the cork buffer if we are corked and it fits, otherwise straight to the socket.
+         * Written optionally, so the tail the socket does not take is queued by reference instead of copied */
+        auto [written, failed] = Super::write(frame->data(), (int) frame->length(), true);
+        if (failed) {
+            webSocketData->buffer.appendShared(frame, written > 0 ? (size_t) written : 0);
+            return BACKPRESSURE;
+        }
+
+        /* Every successful send resets the timeout */
+        if (webSocketContextData->resetIdleTimeoutOnSend) {
+            Super::timeout(webSocketContextData->idleTimeoutComponents.first);
+            webSocketData->hasTimedOut = false;
+        }
+
+        return SUCCESS;
+    }
+
     /* Send websocket close frame, emit close event, send FIN if successful.
      * Will not append a close reason if code is 0 or 1005. */
     void end(int code = 0, std::string_view message = {}) {
@@ -370,7 +441,7 @@ public:
             return webSocketContextData->topicTree->publishBig(webSocketData->subscriber, topic, {message, opCode, compress}, [](Subscriber *s, TopicTreeBigMessage &message) {
                 auto *ws = (WebSocket<SSL, true, int> *) s->user;
 
-                ws->send(message.message, (OpCode)message.opCode, message.compress);
+                ws->sendPublished(message);
             });
         } else {
             return webSocketContextData->topicTree->publish(webSocketData->subscriber, topic, {std::string(message), opCode, compress});
@@ -24,6 +24,7 @@
 #include "MoveOnlyFunction.h"
 #include <string_view>
 #include <vector>
+#include <memory>
 
 #include "WebSocketProtocol.h"
 #include "TopicTree.h"
@@ -36,11 +37,15 @@ struct TopicTreeMessage {
     std::string message;
     /*OpCode*/ int opCode;
     bool compress;
+    /* Uncompressed and shared-compressor frames, formatted once by the first subscriber needing them
+     * and shared by every subscriber that has to buffer them */
+    std::shared_ptr<const std::string> frames[2];
 };
 struct TopicTreeBigMessage {
     std::string_view message;
     /*OpCode*/ int opCode;
     bool compress;
+    std::shared_ptr<const std::string> frames[2];
 };
 
 template <bool, bool, typename> struct WebSocket;
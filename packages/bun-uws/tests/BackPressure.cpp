@@ -0,0 +1,105 @@
+#include "../src/AsyncSocketData.h"
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <iostream>
+
+/* Drains backpressure like AsyncSocket::write does, at most chunk bytes per write */
+std::string drain(uWS::BackPressure &backPressure, size_t chunk) {
+    std::string sent;
+    while (backPressure.length()) {
+        std::string_view pending = backPressure.front();
+        assert(pending.length());
+        size_t written = std::min(pending.length(), chunk);
+        sent.append(pending.data(), written);
+        backPressure.erase((unsigned int) written);
+    }
+    return sent;
+}
+
+int main() {
+    /* Shared frames are queued after owned bytes, and owned bytes appended after them keep their place */
+    for (size_t chunk : {1, 3, 7, 1000}) {
+        auto frame = std::make_shared<const std::string>("FRAME-one");
+        uWS::BackPressure backPressure;
+        backPressure.append("head|", 5);
+        backPressure.appendShared(frame);
+        backPressure.append("|middle|", 8);
+        backPressure.appendShared(frame);
+        backPressure.append("|tail", 5);
+
+        assert(backPressure.length() == 5 + 9 + 8 + 9 + 5);
+        assert(backPressure.totalLength() == backPressure.length());
+        assert(frame.use_count() == 3);
+        assert(drain(backPressure, chunk) == "head|FRAME-one|middle|FRAME-one|tail");
+        assert(frame.use_count() == 1);
+    }
+
+    /* A frame the socket took part of is queued without the part it took */
+    {
+        auto frame = std::make_shared<const std::string>("0123456789");
+        uWS::BackPressure backPressure;
+        backPressure.appendShared(frame, 4);
+        backPressure.appendShared(std::make_shared<const std::string>("abc"), 0);
+        assert(backPressure.length() == 9);
+        assert(backPressure.front() == "456789");
+        assert(drain(backPressure, 2) == "456789abc");
+
+        /* Nothing is queued for a frame that was sent in full */
+        backPressure.appendShared(frame, frame->length());
+        assert(backPressure.length() == 0);
+    }
+
+    /* Many subscribers buffering the same frame share one copy */
+    {
+        auto frame = std::make_shared<const std::string>(64 * 1024, 'x');
+        std::vector<uWS::BackPressure> subscribers(100);
+        for (auto &backPressure : subscribers) {
+            backPressure.appendShared(frame, 100);
+        }
+        assert(frame.use_count() == 101);
+        for (auto &backPressure : subscribers) {
+            assert(backPressure.length() == frame->length() - 100);
+            assert(backPressure.buffer.capacity() < 1024);
+        }
+        subscribers.clear();
+        assert(frame.use_count() == 1);
+    }
+
+    /* Writing into data() after resize sees every pending byte in order */
+    {
+        uWS::BackPressure backPressure;
+        backPressure.append("ab", 2);
+        backPressure.appendShared(std::make_shared<const std::string>("cdef"), 0);
+        backPressure.erase(1);
+        size_t existing = backPressure.length();
+        assert(existing == 5);
+        backPressure.resize(existing + 2);
+        memcpy((char *) backPressure.data() + existing, "gh", 2);
+        assert(std::string(backPressure.data(), backPressure.length()) == "bcdefgh");
+        assert(drain(backPressure, 3) == "bcdefgh");
+    }
+
+    /* Moving keeps the queue, clearing drops it */
+    {
+        auto frame = std::make_shared<const std::string>("shared");
+        uWS::BackPressure backPressure;
+        backPressure.append("owned", 5);
+        backPressure.appendShared(frame, 2);
+        uWS::BackPressure moved(std::move(backPressure));
+        assert(backPressure.length() == 0);
+        assert(moved.length() == 9);
+        assert(drain(moved, 4) == "ownedared");
+
+        moved.appendShared(frame);
+        moved.clear();
+        assert(moved.length() == 0 && moved.totalLength() == 0);
+        assert(frame.use_count() == 1);
+    }
+
+    std::cout << "ALL BITS ARE GOOD" << std::endl;
+}
@@ -0,0 +1,39 @@
+#include "../src/HeaderIndex.h"
+
+#include <cassert>
+#include <iostream>
+
+int main() {
+    uWS::HeaderIndex index;
+    index.reset();
+
+    /* Every well-known header gets its own slot */
+    unsigned int position = 1;
+    for (std::string_view name : uWS::KNOWN_HEADER_NAMES) {
+        assert(index.get(name) == 0);
+        assert(index.add(name, position));
+        assert(index.get(name) == position);
+        position++;
+    }
+
+    /* Repeated headers keep the first one */
+    unsigned int hostPosition = index.get("host");
+    assert(!index.add("host", position));
+    assert(index.get("host") == hostPosition);
+
+    /* Other names may have to share a slot, the parser puts those in the bloom filter */
+    unsigned int collisions = 0;
+    for (std::string_view name : {"x-request-id", "x-forwarded-for", "x-forwarded-proto", "traceparent", "sec-ch-ua", "a", "ab"}) {
+        if (!index.add(name, position++)) {
+            collisions++;
+        }
+    }
+    std::cout << "Collisions with well-known headers: " << collisions << std::endl;
+
+    index.reset();
+    for (std::string_view name : uWS::KNOWN_HEADER_NAMES) {
+        assert(index.get(name) == 0);
+    }
+
+    std::cout << "HEADER INDEX DONE" << std::endl;
+}
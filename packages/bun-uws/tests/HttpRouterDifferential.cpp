@@ -0,0 +1,262 @@
+/* Checks the compiled router against the tree walking one it replaced, on fixed cases and on random
+ * route sets. Both get the same routes added and removed, then must call the same handlers in the
+ * same order with the same parameters for every URL. */
+
+#include "../src/HttpRouter.h"
+#include "HttpRouterReference.h"
+
+#include <cassert>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+
+struct Call {
+    int handler;
+    std::vector<std::string> parameters;
+
+    bool operator==(const Call &other) const {
+        return handler == other.handler && parameters == other.parameters;
+    }
+};
+
+template <typename Router>
+struct Traced {
+    Router router;
+    std::vector<Call> calls;
+
+    /* Handler label returns stop, and records itself when called */
+    void add(const std::vector<std::string> &methods, std::string_view pattern, int label, bool stop, uint32_t priority) {
+        router.add(methods, pattern, [this, label, stop](Router *r) {
+            auto [top, parameters] = r->getParameters();
+            calls.push_back({label, std::vector<std::string>(parameters, parameters + top + 1)});
+            return stop;
+        }, priority);
+    }
+
+    std::pair<bool, std::vector<Call>> route(std::string_view method, std::string_view url) {
+        calls.clear();
+        bool handled = router.route(method, url);
+        return {handled, calls};
+    }
+};
+
+struct Routers {
+    Traced<uWS::HttpRouter<int>> compiled;
+    Traced<uWSReference::HttpRouter<int>> reference;
+    int nextLabel = 0;
+
+    int add(const std::vector<std::string> &methods, std::string_view pattern, bool stop = false, uint32_t priority = uWS::HttpRouter<int>::MEDIUM_PRIORITY) {
+        int label = nextLabel++;
+        compiled.add(methods, pattern, label, stop, priority);
+        reference.add(methods, pattern, label, stop, priority);
+        return label;
+    }
+
+    bool remove(std::string_view method, std::string_view pattern, uint32_t priority = uWS::HttpRouter<int>::MEDIUM_PRIORITY) {
+        bool removed = compiled.router.remove(method, pattern, priority);
+        assert(removed == reference.router.remove(method, pattern, priority));
+        return removed;
+    }
+
+    /* Routes on both and returns the labels the compiled router called */
+    std::vector<int> route(std::string_view method, std::string_view url) {
+        auto [handled, calls] = compiled.route(method, url);
+        auto [expectedHandled, expectedCalls] = reference.route(method, url);
+        if (handled != expectedHandled || !(calls == expectedCalls)) {
+            std::cout << "Mismatch routing " << method << " " << url << std::endl;
+            assert(false);
+        }
+        std::vector<int> labels;
+        for (const Call &call : calls) {
+            labels.push_back(call.handler);
+        }
+        return labels;
+    }
+};
+
+void testPrecedence() {
+    std::cout << "TestPrecedence" << std::endl;
+    Routers r;
+    int wildcard = r.add({"GET"}, "/a/*");
+    int parameter = r.add({"GET"}, "/a/:p");
+    int staticRoute = r.add({"GET"}, "/a/b");
+    int any = r.add({"*"}, "/a/b", false, uWS::HttpRouter<int>::LOW_PRIORITY);
+    int high = r.add({"GET"}, "/a/:q", false, uWS::HttpRouter<int>::HIGH_PRIORITY);
+    int deep = r.add({"GET"}, "/a/:p/c");
+
+    /* High priority first, then static, parameter and wildcard, then the ANY method */
+    assert((r.route("GET", "/a/b") == std::vector<int>{high, staticRoute, parameter, wildcard, any}));
+    assert((r.route("GET", "/a/x") == std::vector<int>{high, parameter, wildcard}));
+    assert((r.route("GET", "/a/x/c") == std::vector<int>{deep, wildcard}));
+    assert((r.route("POST", "/a/b") == std::vector<int>{any}));
+    /* Parameters never match empty segments, wildcards do */
+    assert((r.route("GET", "/a/") == std::vector<int>{wildcard}));
+    assert((r.route("GET", "/a") == std::vector<int>{}));
+}
+
+void testRemoveAndReAdd() {
+    std::cout << "TestRemoveAndReAdd" << std::endl;
+    Routers r;
+    /* Keeps the ANY method node, which removing its last route would cull */
+    r.add({"*"}, "/health");
+    int first = r.add({"GET", "POST"}, "/users/:id/posts");
+    int other = r.add({"GET"}, "/users/me/posts");
+    assert((r.route("GET", "/users/me/posts") == std::vector<int>{other, first}));
+
+    /* Removing through one method removes it for every method it was added with */
+    assert(r.remove("POST", "/users/:name/posts"));
+    assert(!r.remove("GET", "/users/:id/posts"));
+    assert((r.route("GET", "/users/me/posts") == std::vector<int>{other}));
+    assert((r.route("POST", "/users/me/posts") == std::vector<int>{}));
+
+    /* Adding again, then replacing the same pattern */
+    int again = r.add({"POST"}, "/users/:id/posts");
+    assert((r.route("POST", "/users/1/posts") == std::vector<int>{again}));
+    int replaced = r.add({"POST"}, "/users/:id/posts", true);
+    assert((r.route("POST", "/users/1/posts") == std::vector<int>{replaced}));
+
+    /* Removing the last route under a prefix drops the merged static chain */
+    assert(r.remove("GET", "/users/me/posts"));
+    assert((r.route("GET", "/users/me/posts") == std::vector<int>{}));
+    int shorter = r.add({"GET"}, "/users/me");
+    assert((r.route("GET", "/users/me") == std::vector<int>{shorter}));
+    assert((r.route("GET", "/users/me/posts") == std::vector<int>{}));
+}
+
+void testLongUrls() {
+    std::cout << "TestLongUrls" << std::endl;
+    Routers r;
+    std::string deepPattern;
+    for (int i = 0; i < 120; i++) {
+        deepPattern += "/s";
+    }
+    int wildcard = r.add({"GET"}, "/s/*");
+    int deep = r.add({"GET"}, deepPattern);
+    int parameters = r.add({"GET"}, "/s/:a/:b/:c");
+
+    /* Past the segment limit the rest of the URL is ignored, like in the tree */
+    for (int segments : {1, 3, 4, 50, 99, 100, 101, 119, 120, 121, 500}) {
+        std::string url;
+        for (int i = 0; i < segments; i++) {
+            url += "/s";
+        }
+        std::vector<int> labels = r.route("GET", url);
+        /* Only the first 100 segments of the deep pattern were added */
+        bool isDeep = std::find(labels.begin(), labels.end(), deep) != labels.end();
+        assert(isDeep == (segments >= 100));
+        assert((std::find(labels.begin(), labels.end(), parameters) != labels.end()) == (segments == 4));
+        assert(segments < 2 || labels.back() == wildcard);
+    }
+
+    /* A URL much longer than every compiled name */
+    std::string longSegment(100000, 'x');
+    r.route("GET", "/s/" + longSegment);
+    r.route("GET", "/" + longSegment);
+}
+
+void testLongStaticRuns() {
+    std::cout << "TestLongStaticRuns" << std::endl;
+    Routers r;
+    /* More siblings than are scanned, with duplicates and shared prefixes, so runs get bisected */
+    for (int i = 0; i < 200; i++) {
+        r.add({"GET"}, "/api/r" + std::to_string(i % 150));
+        r.add({"GET"}, "/api/r" + std::to_string(i) + "/x", false, i % 3 ? uWS::HttpRouter<int>::MEDIUM_PRIORITY : uWS::HttpRouter<int>::HIGH_PRIORITY);
+    }
+    r.add({"GET"}, "/api/:p");
+    r.add({"GET"}, "/api/r1*");
+    for (int i = 0; i < 220; i++) {
+        r.route("GET", "/api/r" + std::to_string(i));
+        r.route("GET", "/api/r" + std::to_string(i) + "/x");
+        r.route("GET", "/api/r" + std::to_string(i) + "/y");
+    }
+    r.route("GET", "/api/");
+    r.route("GET", "/api/r");
+}
+
+void testRandom(unsigned int seed) {
+    std::mt19937 rng(seed);
+    auto pick = [&rng](auto &values) -> auto & {
+        return values[std::uniform_int_distribution<size_t>(0, values.size() - 1)(rng)];
+    };
+    auto chance = [&rng](int percent) {
+        return std::uniform_int_distribution<int>(0, 99)(rng) < percent;
+    };
+
+    std::vector<std::string> segments = {"a", "b", "ab", "ba", "a1", "", "users", "u", "z"};
+    std::vector<std::string> parameters = {":id", ":x", ":"};
+    std::vector<std::vector<std::string>> methodSets = {{"GET"}, {"POST"}, {"GET", "POST"}, {"*"}, {"PATCH", "GET"}};
+    std::vector<std::string> methods = {"GET", "POST", "PATCH", "PUT"};
+    std::vector<uint32_t> priorities = {uWS::HttpRouter<int>::HIGH_PRIORITY, uWS::HttpRouter<int>::MEDIUM_PRIORITY, uWS::HttpRouter<int>::LOW_PRIORITY};
+
+    auto randomPattern = [&]() {
+        std::string pattern;
+        int length = std::uniform_int_distribution<int>(0, 5)(rng);
+        for (int i = 0; i < length; i++) {
+            pattern += "/";
+            if (chance(25)) {
+                pattern += pick(parameters);
+            } else {
+                pattern += pick(segments);
+            }
+        }
+        if (chance(20)) {
+            pattern += "/*";
+        }
+        return pattern.empty() ? std::string("/") : pattern;
+    };
+    auto randomUrl = [&]() {
+        std::string url;
+        int length = std::uniform_int_distribution<int>(0, 7)(rng);
+        for (int i = 0; i < length; i++) {
+            url += "/" + pick(segments);
+        }
+        if (chance(5)) {
+            for (int i = 0; i < 110; i++) {
+                url += "/a";
+            }
+        }
+        return url.empty() ? std::string("/") : url;
+    };
+
+    Routers r;
+    struct Added {
+        std::vector<std::string> methods;
+        std::string pattern;
+        uint32_t priority;
+    };
+    std::vector<Added> added;
+
+    for (int step = 0; step < 150; step++) {
+        if (added.size() && chance(25)) {
+            Added &route = pick(added);
+            r.remove(pick(route.methods), route.pattern, route.priority);
+        } else if (added.size() && chance(10)) {
+            /* Replacing an existing route */
+            Added &route = pick(added);
+            r.add(route.methods, route.pattern, chance(30), route.priority);
+        } else {
+            Added route = {pick(methodSets), randomPattern(), pick(priorities)};
+            r.add(route.methods, route.pattern, chance(30), route.priority);
+            added.push_back(route);
+        }
+
+        for (int i = 0; i < 20; i++) {
+            r.route(pick(methods), randomUrl());
+        }
+    }
+}
+
+int main() {
+    testPrecedence();
+    testRemoveAndReAdd();
+    testLongUrls();
+    testLongStaticRuns();
+
+    std::cout << "TestRandom" << std::endl;
+    for (unsigned int seed = 0; seed < 60; seed++) {
+        testRandom(seed);
+    }
+
+    std::cout << "ALL BITS ARE GOOD" << std::endl;
+}
@@ -0,0 +1,386 @@
+/* Needs BoringSSL: make session-cache BORINGSSL=/path/to/boringssl */
+#define LIBUS_USE_OPENSSL
+#include "../../bun-usockets/src/crypto/session_cache.cpp"
+
+#include <openssl/ec_key.h>
+#include <openssl/err.h>
+#include <openssl/nid.h>
+#include <openssl/x509.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/time.h>
+
+EVP_PKEY *key;
+X509 *certificate;
+
+/* A throwaway self signed certificate for every server context */
+void makeCertificate() {
+    EC_KEY *ec = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+    assert(ec && EC_KEY_generate_key(ec));
+    key = EVP_PKEY_new();
+    assert(EVP_PKEY_assign_EC_KEY(key, ec));
+
+    certificate = X509_new();
+    X509_set_version(certificate, X509_VERSION_3);
+    ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+    X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+    X509_gmtime_adj(X509_getm_notAfter(certificate), 3600);
+    X509_set_pubkey(certificate, key);
+    X509_NAME *name = X509_get_subject_name(certificate);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const uint8_t *) "localhost", -1, -1, 0);
+    X509_set_issuer_name(certificate, name);
+    assert(X509_sign(certificate, key, EVP_sha256()));
+}
+
+/* What us_internal_create_ssl_socket_context does for the store */
+SSL_CTX *serverContext(uint16_t maxVersion = TLS1_3_VERSION) {
+    SSL_CTX *ssl_context = SSL_CTX_new(TLS_method());
+    assert(SSL_CTX_use_certificate(ssl_context, certificate));
+    assert(SSL_CTX_use_PrivateKey(ssl_context, key));
+    SSL_CTX_set_max_proto_version(ssl_context, maxVersion);
+    us_internal_ssl_session_store_attach(ssl_context);
+    return ssl_context;
+}
+
+/* The last session the client was handed, tickets in TLS 1.3 only arrive after the handshake */
+SSL_SESSION *lastSession;
+
+int clientNewSession(SSL *, SSL_SESSION *session) {
+    SSL_SESSION_free(lastSession);
+    lastSession = session;
+    return 1;
+}
+
+SSL_CTX *clientContext(uint16_t maxVersion = TLS1_3_VERSION) {
+    SSL_CTX *ssl_context = SSL_CTX_new(TLS_method());
+    SSL_CTX_set_max_proto_version(ssl_context, maxVersion);
+    SSL_CTX_set_session_cache_mode(ssl_context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL);
+    SSL_CTX_sess_set_new_cb(ssl_context, clientNewSession);
+    return ssl_context;
+}
+
+/* Runs a handshake over a memory BIO pair, offering session if given, and returns whether the
+ * server resumed it. The client's new session, if any, is left in lastSession */
+bool handshake(SSL_CTX *client_context, SSL_CTX *server_context, SSL_SESSION *session = nullptr) {
+    /* Offered as a copy, so one session can be tried against several servers */
+    SSL_SESSION *offered = nullptr;
+    if (session) {
+        uint8_t *data = nullptr;
+        int length = i2d_SSL_SESSION(session, &data);
+        const uint8_t *cursor = data;
+        offered = d2i_SSL_SESSION(nullptr, &cursor, length);
+        OPENSSL_free(data);
+        assert(offered);
+    }
+    SSL_SESSION_free(lastSession);
+    lastSession = nullptr;
+
+    SSL *client = SSL_new(client_context);
+    SSL *server = SSL_new(server_context);
+    BIO *clientBio, *serverBio;
+    assert(BIO_new_bio_pair(&clientBio, 0, &serverBio, 0));
+    SSL_set_bio(client, clientBio, clientBio);
+    SSL_set_bio(server, serverBio, serverBio);
+    SSL_set_connect_state(client);
+    SSL_set_accept_state(server);
+    if (offered) SSL_set_session(client, offered);
+
+    bool clientDone = false, serverDone = false;
+    for (int i = 0; i < 20 && !(clientDone && serverDone); i++) {
+        if (!clientDone) {
+            int result = SSL_do_handshake(client);
+            clientDone = result == 1;
+            assert(clientDone || SSL_get_error(client, result) == SSL_ERROR_WANT_READ);
+        }
+        if (!serverDone) {
+            int result = SSL_do_handshake(server);
+            serverDone = result == 1;
+            assert(serverDone || SSL_get_error(server, result) == SSL_ERROR_WANT_READ);
+        }
+    }
+    assert(clientDone && serverDone);
+    us_internal_ssl_session_store_count_handshake(server);
+
+    /* Lets the client read the tickets the server sent after its Finished */
+    uint8_t byte;
+    assert(SSL_read(client, &byte, 1) == -1 && SSL_get_error(client, -1) == SSL_ERROR_WANT_READ);
+
+    bool resumed = SSL_session_reused(server);
+    assert(resumed == (bool) SSL_session_reused(client));
+
+    /* Closed cleanly, so no library drops the session as one from a broken connection */
+    SSL_set_shutdown(client, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    SSL_set_shutdown(server, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    SSL_free(client);
+    SSL_free(server);
+    SSL_SESSION_free(offered);
+    return resumed;
+}
+
+/* A fresh session from a handshake that had to be full */
+SSL_SESSION *newSession(SSL_CTX *client_context, SSL_CTX *server_context) {
+    assert(!handshake(client_context, server_context));
+    assert(lastSession);
+    SSL_SESSION *session = lastSession;
+    lastSession = nullptr;
+    return session;
+}
+
+us_socket_context_session_stats_t stats(SSL_CTX *ssl_context) {
+    us_socket_context_session_stats_t stats;
+    us_internal_ssl_session_store_stats(ssl_context, &stats);
+    return stats;
+}
+
+/* Keys whose every byte is seed, in Node's layout */
+std::string ticketKey(uint8_t seed) {
+    return std::string(sizeof(ticket_key), (char) seed);
+}
+
+bool setTicketKeys(SSL_CTX *ssl_context, const std::string &keys) {
+    return us_internal_ssl_session_store_set_ticket_keys(ssl_context, (const unsigned char *) keys.data(), (unsigned int) keys.length());
+}
+
+/* The name of the key a TLS 1.3 ticket was encrypted with */
+std::string ticketKeyName(SSL_SESSION *session) {
+    const uint8_t *ticket;
+    size_t length;
+    SSL_SESSION_get0_ticket(session, &ticket, &length);
+    assert(length >= 16);
+    return std::string((const char *) ticket, 16);
+}
+
+void testSetTicketKeysValidation() {
+    SSL_CTX *ssl_context = serverContext();
+
+    for (unsigned int length : {0u, 1u, 47u, 49u, 95u, 5u * 48u}) {
+        assert(!setTicketKeys(ssl_context, std::string(length, 'k')));
+    }
+    for (unsigned int count = 1; count <= 4; count++) {
+        assert(setTicketKeys(ssl_context, std::string(count * 48, 'k')));
+        session_store *store = (session_store *) SSL_CTX_get_ex_data(ssl_context, ssl_ctx_store_index());
+        assert(store->key_count == count);
+    }
+
+    /* A rejected call keeps the keys it had */
+    assert(!setTicketKeys(ssl_context, std::string(47, 'x')));
+    session_store *store = (session_store *) SSL_CTX_get_ex_data(ssl_context, ssl_ctx_store_index());
+    assert(store->key_count == 4 && store->keys[0].name[0] == 'k');
+
+    /* Contexts without a store, like client ones, refuse */
+    SSL_CTX *bare = SSL_CTX_new(TLS_method());
+    assert(!us_internal_ssl_session_store_set_ticket_keys(bare, (const unsigned char *) ticketKey(1).data(), 48));
+    us_socket_context_session_stats_t empty = stats(bare);
+    assert(!empty.full_handshakes && !empty.tickets_issued);
+
+    SSL_CTX_free(bare);
+    SSL_CTX_free(ssl_context);
+}
+
+void testSharedKeysAndStats() {
+    SSL_CTX *client = clientContext();
+    SSL_CTX *first = serverContext();
+    SSL_CTX *second = serverContext();
+    SSL_CTX *other = serverContext();
+    assert(setTicketKeys(first, ticketKey(1)));
+    assert(setTicketKeys(second, ticketKey(1)));
+    assert(setTicketKeys(other, ticketKey(2)));
+
+    SSL_SESSION *session = newSession(client, first);
+    assert(ticketKeyName(session) == ticketKey(1).substr(0, 16));
+    us_socket_context_session_stats_t firstStats = stats(first);
+    assert(firstStats.full_handshakes == 1 && firstStats.resumed_handshakes == 0);
+    assert(firstStats.tickets_issued >= 1);
+
+    /* Another context, as in another process, resumes it */
+    assert(handshake(client, second, session));
+    us_socket_context_session_stats_t secondStats = stats(second);
+    assert(secondStats.full_handshakes == 0 && secondStats.resumed_handshakes == 1);
+
+    /* One with other keys cannot */
+    assert(!handshake(client, other, session));
+    us_socket_context_session_stats_t otherStats = stats(other);
+    assert(otherStats.full_handshakes == 1 && otherStats.resumed_handshakes == 0);
+
+    /* The first context's counters are its own */
+    assert(stats(first).full_handshakes == 1 && stats(first).resumed_handshakes == 0);
+
+    SSL_SESSION_free(session);
+    SSL_CTX_free(client);
+    SSL_CTX_free(first);
+    SSL_CTX_free(second);
+    SSL_CTX_free(other);
+}
+
+void testSetTicketKeysRotation() {
+    SSL_CTX *client = clientContext();
+    SSL_CTX *server = serverContext();
+    assert(setTicketKeys(server, ticketKey(1)));
+    SSL_SESSION *session = newSession(client, server);
+
+    /* A retired key still decrypts, and the ticket is renewed under the current one */
+    assert(setTicketKeys(server, ticketKey(2) + ticketKey(1)));
+    assert(handshake(client, server, session));
+    assert(lastSession && ticketKeyName(lastSession) == ticketKey(2).substr(0, 16));
+
+    /* Once dropped, it does not */
+    assert(setTicketKeys(server, ticketKey(3)));
+    assert(!handshake(client, server, session));
+
+    SSL_SESSION_free(session);
+    SSL_CTX_free(client);
+    SSL_CTX_free(server);
+}
+
+void writeFile(const char *path, const std::string &data, time_t mtime) {
+    FILE *file = fopen(path, "wb");
+    assert(file && fwrite(data.data(), 1, data.length(), file) == data.length());
+    fclose(file);
+    /* Distinct modification times, however fast the test runs */
+    struct timeval times[2] = {{mtime, 0}, {mtime, 0}};
+    assert(utimes(path, times) == 0);
+}
+
+/* The file is only looked at every few seconds, so tests pretend the time has passed */
+void expireKeysFileCheck(SSL_CTX *ssl_context) {
+    session_store *store = (session_store *) SSL_CTX_get_ex_data(ssl_context, ssl_ctx_store_index());
+    store->keys_file_checked = 0;
+}
+
+void testKeysFileRotation() {
+    char path[] = "/tmp/ticket-keys-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    writeFile(path, ticketKey(1), 1000000);
+    setenv("BUN_TLS_TICKET_KEYS_FILE", path, 1);
+    SSL_CTX *client = clientContext();
+    SSL_CTX *server = serverContext();
+    SSL_CTX *peer = serverContext();
+    unsetenv("BUN_TLS_TICKET_KEYS_FILE");
+
+    /* Every context reading the file shares its keys */
+    SSL_SESSION *session = newSession(client, server);
+    assert(ticketKeyName(session) == ticketKey(1).substr(0, 16));
+    assert(handshake(client, peer, session));
+
+    /* Not re-read until the check interval passes */
+    writeFile(path, ticketKey(3), 1000001);
+    assert(handshake(client, server, session));
+
+    /* Prepending a key: new tickets use it, old ones still resume */
+    writeFile(path, ticketKey(2) + ticketKey(1), 1000002);
+    expireKeysFileCheck(server);
+    assert(handshake(client, server, session));
+    assert(lastSession && ticketKeyName(lastSession) == ticketKey(2).substr(0, 16));
+    SSL_SESSION *renewed = lastSession;
+    lastSession = nullptr;
+
+    /* A file that is not whole keys is ignored and the keys stay */
+    writeFile(path, ticketKey(4).substr(0, 47), 1000003);
+    expireKeysFileCheck(server);
+    assert(handshake(client, server, renewed));
+
+    /* Dropping the old key ends its tickets */
+    writeFile(path, ticketKey(2), 1000004);
+    expireKeysFileCheck(server);
+    assert(!handshake(client, server, session));
+    assert(handshake(client, server, renewed));
+
+    /* Explicit keys win over the file from then on */
+    assert(setTicketKeys(server, ticketKey(5)));
+    writeFile(path, ticketKey(2), 1000005);
+    expireKeysFileCheck(server);
+    assert(!handshake(client, server, renewed));
+
+    SSL_SESSION_free(session);
+    SSL_SESSION_free(renewed);
+    SSL_CTX_free(client);
+    SSL_CTX_free(server);
+    SSL_CTX_free(peer);
+    unlink(path);
+}
+
+void testSharedSessionCache() {
+    std::string name = "/bun-session-cache-test-" + std::to_string(getpid());
+    shm_unlink(name.c_str());
+    setenv("BUN_TLS_SESSION_CACHE_SHM", name.c_str(), 1);
+    SSL_CTX *client = clientContext(TLS1_2_VERSION);
+    SSL_CTX *first = serverContext(TLS1_2_VERSION);
+    SSL_CTX *second = serverContext(TLS1_2_VERSION);
+    unsetenv("BUN_TLS_SESSION_CACHE_SHM");
+
+    /* Session IDs only */
+    SSL_CTX_set_options(first, SSL_OP_NO_TICKET);
+    SSL_CTX_set_options(second, SSL_OP_NO_TICKET);
+
+    SSL_SESSION *session = newSession(client, first);
+    assert(handshake(client, second, session));
+    assert(stats(second).shared_cache_hits == 1 && stats(second).resumed_handshakes == 1);
+
+    /* It is in shared memory only, private to this user */
+    struct stat info;
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    assert(fd >= 0 && fstat(fd, &info) == 0);
+    assert(info.st_uid == geteuid() && !(info.st_mode & 077));
+    close(fd);
+
+    /* Unknown IDs miss */
+    SSL_CTX *stranger = serverContext(TLS1_2_VERSION);
+    SSL_CTX_set_options(stranger, SSL_OP_NO_TICKET);
+    SSL_SESSION *unknown = newSession(client, stranger);
+    assert(!handshake(client, second, unknown));
+    assert(stats(second).shared_cache_misses == 1);
+
+    SSL_SESSION_free(session);
+    SSL_SESSION_free(unknown);
+    SSL_CTX_free(client);
+    SSL_CTX_free(first);
+    SSL_CTX_free(second);
+    SSL_CTX_free(stranger);
+    shm_unlink(name.c_str());
+
+    /* An object others can read is refused */
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    assert(fd >= 0);
+    fchmod(fd, 0644);
+    close(fd);
+    setenv("BUN_TLS_SESSION_CACHE_SHM", name.c_str(), 1);
+    client = clientContext(TLS1_2_VERSION);
+    first = serverContext(TLS1_2_VERSION);
+    second = serverContext(TLS1_2_VERSION);
+    unsetenv("BUN_TLS_SESSION_CACHE_SHM");
+    SSL_CTX_set_options(first, SSL_OP_NO_TICKET);
+    SSL_CTX_set_options(second, SSL_OP_NO_TICKET);
+    session = newSession(client, first);
+    assert(!handshake(client, second, session));
+    assert(stats(second).shared_cache_hits == 0);
+
+    SSL_SESSION_free(session);
+    SSL_CTX_free(client);
+    SSL_CTX_free(first);
+    SSL_CTX_free(second);
+    shm_unlink(name.c_str());
+}
+
+int main() {
+    makeCertificate();
+
+    testSetTicketKeysValidation();
+    testSharedKeysAndStats();
+    testSetTicketKeysRotation();
+    testKeysFileRotation();
+    testSharedSessionCache();
+
+    SSL_SESSION_free(lastSession);
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+
+    std::cout << "ALL BITS ARE GOOD" << std::endl;
+    return 0;
+}
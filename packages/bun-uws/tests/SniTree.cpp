@@ -0,0 +1,140 @@
+#include "../../bun-usockets/src/crypto/sni_tree.cpp"
+
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/* Distinct user pointers to tell entries apart */
+char users[1024];
+
+void *user(int i) {
+    return &users[i];
+}
+
+void testWildcardOrder() {
+    void *sni = sni_new();
+
+    assert(sni_add(sni, "*.b.c", user(1)) == 0);
+    assert(sni_add(sni, "a.*.c", user(2)) == 0);
+    assert(sni_add(sni, "*.*.c", user(3)) == 0);
+    assert(sni_add(sni, "*.b.c", user(4)) == 1);
+
+    /* At each label from the left, the label itself before the wildcard */
+    assert(sni_find(sni, "a.b.c") == user(2));
+    assert(sni_find(sni, "x.b.c") == user(1));
+    assert(sni_find(sni, "x.y.c") == user(3));
+    assert(sni_find(sni, "a.b.d") == nullptr);
+
+    /* A wildcard is one label, never zero or two */
+    assert(sni_find(sni, "b.c") == nullptr);
+    assert(sni_find(sni, "w.x.b.c") == nullptr);
+
+    /* The exact name goes before any pattern */
+    assert(sni_add(sni, "a.b.c", user(5)) == 0);
+    assert(sni_find(sni, "a.b.c") == user(5));
+    assert(sni_remove(sni, "a.b.c") == user(5));
+
+    /* Removing patterns falls through to the next candidate */
+    assert(sni_remove(sni, "a.*.c") == user(2));
+    assert(sni_find(sni, "a.b.c") == user(1));
+    assert(sni_remove(sni, "*.b.c") == user(1));
+    assert(sni_find(sni, "a.b.c") == user(3));
+    assert(sni_remove(sni, "*.*.c") == user(3));
+    assert(sni_find(sni, "a.b.c") == nullptr);
+
+    /* Wildcards in the middle and at the end, with other label counts present */
+    assert(sni_add(sni, "api.*.example.com", user(6)) == 0);
+    assert(sni_add(sni, "*.example.com", user(7)) == 0);
+    assert(sni_add(sni, "host.*", user(8)) == 0);
+    assert(sni_find(sni, "api.eu.example.com") == user(6));
+    assert(sni_find(sni, "web.eu.example.com") == nullptr);
+    assert(sni_find(sni, "eu.example.com") == user(7));
+    assert(sni_find(sni, "host.local") == user(8));
+    assert(sni_find(sni, "host.local.") == user(8));
+
+    /* Removing treats the asterisk verbatim */
+    assert(sni_remove(sni, "api.eu.example.com") == nullptr);
+    assert(sni_find(sni, "api.eu.example.com") == user(6));
+
+    sni_free(sni, [](void *) {});
+}
+
+void testReplace() {
+    void *sni = sni_new();
+
+    /* Adds a missing name */
+    assert(sni_replace(sni, "*.example.com", user(1)) == nullptr);
+    assert(sni_find(sni, "www.example.com") == user(1));
+
+    /* Swaps an existing one and hands back the old user */
+    assert(sni_replace(sni, "*.example.com", user(2)) == user(1));
+    assert(sni_find(sni, "www.example.com") == user(2));
+
+    /* Keys the same way sni_add does */
+    assert(sni_replace(sni, "*.example.com.", user(3)) == user(2));
+    assert(sni_add(sni, "*.example.com", user(4)) == 1);
+    assert(sni_find(sni, "www.example.com") == user(3));
+
+    assert(sni_remove(sni, "*.example.com") == user(3));
+    assert(sni_find(sni, "www.example.com") == nullptr);
+
+    sni_free(sni, [](void *) {});
+}
+
+/* Random adds and removes over few names keep long probe runs in a small table, so removals have to
+ * shift entries back across the end of the table */
+void testErase() {
+    std::mt19937 rng(1234);
+
+    for (int round = 0; round < 50; round++) {
+        void *sni = sni_new();
+        std::map<std::string, void *> expected;
+
+        unsigned int names = 4 + rng() % 60;
+        for (int step = 0; step < 2000; step++) {
+            unsigned int i = rng() % names;
+            std::string name = "host" + std::to_string(i) + ".example.com";
+
+            if (rng() % 2) {
+                int added = sni_add(sni, name.c_str(), user(i));
+                assert(added == (expected.count(name) ? 1 : 0));
+                expected.emplace(name, user(i));
+            } else {
+                auto it = expected.find(name);
+                void *removed = sni_remove(sni, name.c_str());
+                assert(removed == (it == expected.end() ? nullptr : it->second));
+                if (it != expected.end()) {
+                    expected.erase(it);
+                }
+            }
+
+            sni_table *table = (sni_table *) sni;
+            assert(table->size == expected.size());
+            assert(table->size * 2 <= table->capacity || !table->capacity);
+
+            /* Every remaining name is still reachable from its home slot, every removed one is gone */
+            for (unsigned int j = 0; j < names; j++) {
+                std::string other = "host" + std::to_string(j) + ".example.com";
+                auto it = expected.find(other);
+                assert(sni_find(sni, other.c_str()) == (it == expected.end() ? nullptr : it->second));
+            }
+        }
+
+        static int remaining;
+        remaining = 0;
+        sni_free(sni, [](void *) { remaining++; });
+        assert(remaining == (int) expected.size());
+    }
+}
+
+int main() {
+    testWildcardOrder();
+    testReplace();
+    testErase();
+
+    std::cout << "ALL BITS ARE GOOD" << std::endl;
+    return 0;
+}
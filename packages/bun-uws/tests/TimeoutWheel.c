@@ -0,0 +1,190 @@
+/* Tests the socket timeout wheels by driving the sweep directly, without real connections or waiting */
+
+#include <libusockets.h>
+#include "internal/internal.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+
+/* Implemented by Bun in Zig and never reached here */
+void Bun__lock(zig_mutex_t *lock) {}
+void Bun__unlock(zig_mutex_t *lock) {}
+int Bun__addrinfo_get(struct us_loop_t *loop, const char *host, struct addrinfo_request **ptr) { abort(); }
+int Bun__addrinfo_set(struct addrinfo_request *ptr, struct us_connecting_socket_t *socket) { abort(); }
+void Bun__addrinfo_freeRequest(struct addrinfo_request *addrinfo_req, int error) { abort(); }
+struct addrinfo_result *Bun__addrinfo_getRequestResult(struct addrinfo_request *addrinfo_req) { abort(); }
+void Bun__internal_dispatch_ready_poll(void *loop, void *poll) { abort(); }
+int Bun__isEpollPwait2SupportedOnLinuxKernel() { return 0; }
+ssize_t sys_epoll_pwait2(int epfd, struct epoll_event *events, int maxevents, const struct timespec *timeout, const sigset_t *sigmask) { abort(); }
+void Bun__JSC_onBeforeWait(void *vm) {}
+void Bun__JSC_onAfterWait(void *vm) {}
+int us_internal_raw_root_certs(struct us_cert_string_t **out) { abort(); }
+struct us_internal_ssl_socket_t *us_internal_ssl_socket_close(struct us_internal_ssl_socket_t *s, int code, void *reason) { abort(); }
+int us_internal_ssl_socket_is_closed(struct us_internal_ssl_socket_t *s) { abort(); }
+struct us_internal_ssl_socket_t *us_internal_ssl_socket_open(struct us_internal_ssl_socket_t *s, int is_client, char *ip, int ip_length) { abort(); }
+struct us_internal_ssl_socket_t *us_internal_ssl_socket_wrap_with_tls(struct us_socket_t *s, struct us_bun_socket_context_options_t options, struct us_socket_events_t events, int socket_ext_size) { abort(); }
+
+#define SOCKETS 8
+/* Short wheel ticks of a timeout in seconds */
+#define TICKS(seconds) (((seconds) * 1000LL + LIBUS_TIMEOUT_RESOLUTION_MS - 1) / LIBUS_TIMEOUT_RESOLUTION_MS)
+
+struct us_socket_t sockets[SOCKETS];
+/* The sweep each socket's last timeout fired on, 0 if none did */
+long long fired[SOCKETS], long_fired[SOCKETS];
+long long sweeps;
+/* Seconds to re-arm with from the timeout handler, 0 to leave it disarmed */
+unsigned int rearm[SOCKETS];
+
+void on_wakeup(struct us_loop_t *loop) {}
+void on_pre(struct us_loop_t *loop) {}
+void on_post(struct us_loop_t *loop) {}
+
+struct us_socket_t *on_timeout(struct us_socket_t *s) {
+    int i = (int) (s - sockets);
+    fired[i] = sweeps;
+    if (rearm[i]) {
+        us_socket_timeout(0, s, rearm[i]);
+    }
+    return s;
+}
+
+struct us_socket_t *on_long_timeout(struct us_socket_t *s) {
+    long_fired[s - sockets] = sweeps;
+    return s;
+}
+
+void sweep(struct us_loop_t *loop, long long count) {
+    for (long long i = 0; i < count; i++) {
+        sweeps++;
+        us_internal_timer_sweep(loop);
+    }
+}
+
+void reset() {
+    for (int i = 0; i < SOCKETS; i++) {
+        us_socket_timeout(0, &sockets[i], 0);
+        us_socket_long_timeout(0, &sockets[i], 0);
+        fired[i] = long_fired[i] = 0;
+        rearm[i] = 0;
+    }
+}
+
+/* Arms timeouts of 1 tick up to more than one revolution from wherever the wheel is */
+void test_short(struct us_loop_t *loop) {
+    reset();
+    unsigned int milliseconds[SOCKETS] = {
+        1, LIBUS_TIMEOUT_RESOLUTION_MS, LIBUS_TIMEOUT_RESOLUTION_MS + 1, 10 * LIBUS_TIMEOUT_RESOLUTION_MS,
+        (LIBUS_TIMEOUT_WHEEL_SLOTS - 1) * LIBUS_TIMEOUT_RESOLUTION_MS, LIBUS_TIMEOUT_WHEEL_SLOTS * LIBUS_TIMEOUT_RESOLUTION_MS,
+        (LIBUS_TIMEOUT_WHEEL_SLOTS + 1) * LIBUS_TIMEOUT_RESOLUTION_MS, (3 * LIBUS_TIMEOUT_WHEEL_SLOTS + 7) * LIBUS_TIMEOUT_RESOLUTION_MS,
+    };
+    long long start = sweeps;
+    for (int i = 0; i < SOCKETS; i++) {
+        us_socket_timeout_ms(0, &sockets[i], milliseconds[i]);
+    }
+    sweep(loop, 4 * LIBUS_TIMEOUT_WHEEL_SLOTS);
+    for (int i = 0; i < SOCKETS; i++) {
+        /* Rounded up to whole ticks, never early and never late */
+        long long ticks = (milliseconds[i] + LIBUS_TIMEOUT_RESOLUTION_MS - 1) / LIBUS_TIMEOUT_RESOLUTION_MS;
+        assert(fired[i] == start + ticks);
+    }
+}
+
+/* Re-arming moves the timeout, from outside and from inside its handler */
+void test_rearm(struct us_loop_t *loop) {
+    reset();
+    long long start = sweeps;
+    for (int i = 0; i < SOCKETS; i++) {
+        us_socket_timeout(0, &sockets[i], 10 * LIBUS_TIMEOUT_GRANULARITY);
+    }
+
+    /* Pushed back halfway through */
+    sweep(loop, TICKS(5 * LIBUS_TIMEOUT_GRANULARITY));
+    us_socket_timeout(0, &sockets[0], 10 * LIBUS_TIMEOUT_GRANULARITY);
+    /* Pulled in */
+    us_socket_timeout(0, &sockets[1], LIBUS_TIMEOUT_GRANULARITY);
+    /* Disarmed */
+    us_socket_timeout(0, &sockets[2], 0);
+    /* Re-armed to the same moment */
+    us_socket_timeout(0, &sockets[3], 5 * LIBUS_TIMEOUT_GRANULARITY);
+    /* Keeps itself alive every time it fires */
+    rearm[4] = LIBUS_TIMEOUT_GRANULARITY;
+
+    long long ten = TICKS(10 * LIBUS_TIMEOUT_GRANULARITY);
+    sweep(loop, ten / 2);
+    assert(fired[0] == 0);
+    assert(fired[1] == start + ten / 2 + TICKS(LIBUS_TIMEOUT_GRANULARITY));
+    assert(fired[2] == 0);
+    assert(fired[3] == start + ten);
+    assert(fired[4] == start + ten);
+    assert(fired[5] == start + ten);
+
+    sweep(loop, ten / 2);
+    assert(fired[0] == start + ten + ten / 2);
+    assert(fired[4] == start + ten + ten / 2);
+    assert(fired[5] == start + ten);
+
+    /* A handler that re-arms into the bucket being expired waits a whole revolution */
+    reset();
+    rearm[6] = LIBUS_TIMEOUT_WHEEL_SLOTS * LIBUS_TIMEOUT_RESOLUTION_MS / 1000;
+    us_socket_timeout_ms(0, &sockets[6], LIBUS_TIMEOUT_RESOLUTION_MS);
+    long long armed = sweeps;
+    sweep(loop, 1);
+    assert(fired[6] == armed + 1);
+    sweep(loop, LIBUS_TIMEOUT_WHEEL_SLOTS);
+    assert(fired[6] == armed + 1 + LIBUS_TIMEOUT_WHEEL_SLOTS);
+}
+
+/* Long timeouts fire on the first minute boundary at least that many minutes after being armed */
+void test_long(struct us_loop_t *loop) {
+    reset();
+    unsigned int minutes[SOCKETS] = {1, 2, 5, 59, 60, 61, 200, LIBUS_TIMEOUT_WHEEL_SLOTS - 1};
+    long long start = sweeps;
+    for (int i = 0; i < SOCKETS; i++) {
+        us_socket_long_timeout(0, &sockets[i], minutes[i]);
+    }
+    /* Re-armed later, which moves it */
+    sweep(loop, LIBUS_TIMEOUT_TICKS_PER_MINUTE / 2);
+    us_socket_long_timeout(0, &sockets[2], 3);
+    long long rearmed = sweeps;
+
+    sweep(loop, (long long) LIBUS_TIMEOUT_WHEEL_SLOTS * LIBUS_TIMEOUT_TICKS_PER_MINUTE);
+    for (int i = 0; i < SOCKETS; i++) {
+        long long armed = i == 2 ? rearmed : start;
+        long long minute = armed / LIBUS_TIMEOUT_TICKS_PER_MINUTE + (i == 2 ? 3 : minutes[i]);
+        assert(long_fired[i] == minute * LIBUS_TIMEOUT_TICKS_PER_MINUTE);
+    }
+}
+
+int main() {
+    struct us_loop_t *loop = us_create_loop(0, on_wakeup, on_pre, on_post, 0);
+    struct us_socket_context_options_t options = {};
+    struct us_socket_context_t *context = us_create_socket_context(0, loop, 0, options);
+    us_socket_context_on_timeout(0, context, on_timeout);
+    us_socket_context_on_long_timeout(0, context, on_long_timeout);
+
+    /* Sockets are never polled, so we only need their memory */
+    for (int i = 0; i < SOCKETS; i++) {
+        sockets[i].timeout = 255;
+        sockets[i].long_timeout = 255;
+        us_internal_socket_context_link_socket(context, &sockets[i]);
+    }
+
+    /* From a fresh wheel, then from every offset across several wraparounds of both wheels */
+    test_short(loop);
+    test_rearm(loop);
+    test_long(loop);
+    for (int offset = 0; offset < 3 * LIBUS_TIMEOUT_WHEEL_SLOTS; offset += 37) {
+        sweep(loop, offset);
+        test_short(loop);
+        test_rearm(loop);
+    }
+    for (int offset = 0; offset < 3; offset++) {
+        sweep(loop, LIBUS_TIMEOUT_TICKS_PER_MINUTE * 97 + 13);
+        test_long(loop);
+    }
+
+    printf("ALL BITS ARE GOOD\n");
+    return 0;
+}
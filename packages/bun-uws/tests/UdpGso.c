@@ -0,0 +1,336 @@
+/* Tests how us_udp_socket_send merges datagrams into UDP_SEGMENT messages, and that every datagram
+ * still arrives on its own and in order over loopback, including after the kernel refuses a
+ * segmented send */
+
+#include <libusockets.h>
+#include "internal/internal.h"
+
+#include <assert.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* Implemented by Bun in Zig and never reached here */
+void Bun__lock(zig_mutex_t *lock) {}
+void Bun__unlock(zig_mutex_t *lock) {}
+int Bun__addrinfo_get(struct us_loop_t *loop, const char *host, struct addrinfo_request **ptr) { abort(); }
+int Bun__addrinfo_set(struct addrinfo_request *ptr, struct us_connecting_socket_t *socket) { abort(); }
+void Bun__addrinfo_freeRequest(struct addrinfo_request *addrinfo_req, int error) { abort(); }
+struct addrinfo_result *Bun__addrinfo_getRequestResult(struct addrinfo_request *addrinfo_req) { abort(); }
+void Bun__internal_dispatch_ready_poll(void *loop, void *poll) { abort(); }
+int Bun__isEpollPwait2SupportedOnLinuxKernel() { return 0; }
+ssize_t sys_epoll_pwait2(int epfd, struct epoll_event *events, int maxevents, const struct timespec *timeout, const sigset_t *sigmask) { abort(); }
+void Bun__JSC_onBeforeWait(void *vm) {}
+void Bun__JSC_onAfterWait(void *vm) {}
+int us_internal_raw_root_certs(struct us_cert_string_t **out) { abort(); }
+struct us_internal_ssl_socket_t *us_internal_ssl_socket_close(struct us_internal_ssl_socket_t *s, int code, void *reason) { abort(); }
+int us_internal_ssl_socket_is_closed(struct us_internal_ssl_socket_t *s) { abort(); }
+struct us_internal_ssl_socket_t *us_internal_ssl_socket_open(struct us_internal_ssl_socket_t *s, int is_client, char *ip, int ip_length) { abort(); }
+struct us_internal_ssl_socket_t *us_internal_ssl_socket_wrap_with_tls(struct us_socket_t *s, struct us_bun_socket_context_options_t options, struct us_socket_events_t events, int socket_ext_size) { abort(); }
+
+#define MAX_DATAGRAMS 256
+#define PEERS 2
+
+struct peer {
+    int fd;
+    struct sockaddr_in addr;
+};
+
+struct peer peers[PEERS];
+struct udp_sendbuf *sendbuf;
+
+/* A batch of datagrams; each one starts with its index in the batch so the receiver can tell which
+ * it got, and the rest is a pattern of that index */
+struct batch {
+    int num;
+    void *payloads[MAX_DATAGRAMS];
+    size_t lengths[MAX_DATAGRAMS];
+    void *addresses[MAX_DATAGRAMS];
+    int peer[MAX_DATAGRAMS];
+    char data[MAX_DATAGRAMS][LIBUS_UDP_GSO_MAX_SEGMENT_SIZE + 100];
+};
+
+void on_data(struct us_udp_socket_t *s, void *buf, int packets) {}
+void on_drain(struct us_udp_socket_t *s) {}
+void on_close(struct us_udp_socket_t *s) {}
+void on_wakeup(struct us_loop_t *loop) {}
+void on_pre(struct us_loop_t *loop) {}
+void on_post(struct us_loop_t *loop) {}
+
+void fill(struct batch *b, int i) {
+    char *data = b->data[i];
+    for (size_t k = 0; k < b->lengths[i]; k++) {
+        data[k] = (char) (i * 7 + k);
+    }
+    if (b->lengths[i] >= sizeof(int)) {
+        memcpy(data, &i, sizeof(int));
+    }
+}
+
+/* Appends count datagrams of length bytes to peer, or to no address at all if peer is -1 */
+void add(struct batch *b, int count, size_t length, int peer) {
+    for (int c = 0; c < count; c++) {
+        int i = b->num++;
+        assert(i < MAX_DATAGRAMS);
+        b->payloads[i] = b->data[i];
+        b->lengths[i] = length;
+        b->peer[i] = peer;
+        b->addresses[i] = peer < 0 ? NULL : &peers[peer].addr;
+        fill(b, i);
+    }
+}
+
+/* Sets up the send buffer like us_udp_socket_send would and checks which datagrams went into which
+ * message: expected lists the number of datagrams per message, ending with 0 */
+void expect_messages(struct batch *b, int gso, const int *expected) {
+    int count = bsd_udp_setup_sendbuf(sendbuf, LIBUS_SEND_BUFFER_LENGTH, b->payloads, b->lengths, b->addresses, b->num, gso);
+    assert(count == b->num);
+
+    int first = 0, messages = 0;
+    for (; expected[messages]; messages++) {
+        struct msghdr *mh = &sendbuf->msgvec[messages].msg_hdr;
+        assert((int) mh->msg_iovlen == expected[messages]);
+        for (int k = 0; k < expected[messages]; k++) {
+            assert(mh->msg_iov[k].iov_base == b->payloads[first + k]);
+            assert(mh->msg_iov[k].iov_len == b->lengths[first + k]);
+        }
+        assert(mh->msg_name == b->addresses[first]);
+
+        struct cmsghdr *cmsg = mh->msg_controllen ? CMSG_FIRSTHDR(mh) : NULL;
+        if (expected[messages] > 1) {
+            /* Segmented by the size of its first datagram */
+            uint16_t segment_size;
+            assert(cmsg && cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_SEGMENT);
+            memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+            assert(segment_size == b->lengths[first]);
+        } else {
+            assert(!cmsg);
+        }
+        first += expected[messages];
+    }
+    assert(first == b->num);
+    assert((int) sendbuf->num == messages);
+    assert(bsd_udp_sendbuf_payloads(sendbuf, messages) == b->num);
+}
+
+/* Receives everything that was sent to each peer and checks it is exactly the batch's datagrams
+ * for that peer, one per recv, in order */
+void expect_received(struct batch *b) {
+    char received[LIBUS_UDP_MAX_SIZE];
+    for (int p = 0; p < PEERS; p++) {
+        for (int i = 0; i < b->num; i++) {
+            if (b->peer[i] != p) {
+                continue;
+            }
+            ssize_t length = recv(peers[p].fd, received, sizeof(received), 0);
+            assert(length == (ssize_t) b->lengths[i]);
+            assert(memcmp(received, b->data[i], length) == 0);
+        }
+        /* And nothing more */
+        assert(recv(peers[p].fd, received, sizeof(received), MSG_DONTWAIT) < 0);
+    }
+}
+
+/* Runs of equal sizes to one peer are merged, anything else starts a new message */
+void test_mixed(struct us_udp_socket_t *s) {
+    static struct batch b;
+    b.num = 0;
+    add(&b, 5, 1000, 0);
+    add(&b, 3, 1000, 1);
+    add(&b, 2, 500, 0);
+    /* The largest mergeable size, then one too large to merge */
+    add(&b, 2, LIBUS_UDP_GSO_MAX_SEGMENT_SIZE, 1);
+    add(&b, 2, LIBUS_UDP_GSO_MAX_SEGMENT_SIZE + 1, 1);
+    /* Empty datagrams are never merged */
+    add(&b, 2, 0, 0);
+    add(&b, 1, 3, 0);
+    /* Alternating peers */
+    add(&b, 1, 200, 0);
+    add(&b, 1, 200, 1);
+    add(&b, 1, 200, 0);
+    /* A larger datagram can not follow a smaller one */
+    add(&b, 1, 100, 1);
+    add(&b, 1, 101, 1);
+
+    int expected[] = {5, 3, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0};
+    expect_messages(&b, 1, expected);
+
+    int unmerged[MAX_DATAGRAMS + 1] = {0};
+    for (int i = 0; i < b.num; i++) {
+        unmerged[i] = 1;
+    }
+    expect_messages(&b, 0, unmerged);
+
+    assert(us_udp_socket_send(s, b.payloads, b.lengths, b.addresses, b.num) == b.num);
+    expect_received(&b);
+}
+
+/* A shorter datagram ends its run as the last segment */
+void test_short_last_segment(struct us_udp_socket_t *s) {
+    static struct batch b;
+    b.num = 0;
+    add(&b, 5, 1000, 0);
+    add(&b, 1, 300, 0);
+    add(&b, 1, 1000, 0);
+    add(&b, 4, 64, 1);
+    add(&b, 1, 1, 1);
+    add(&b, 1, 1, 1);
+
+    int expected[] = {6, 1, 5, 1, 0};
+    expect_messages(&b, 1, expected);
+    assert(us_udp_socket_send(s, b.payloads, b.lengths, b.addresses, b.num) == b.num);
+    expect_received(&b);
+}
+
+/* At most 64 segments and 64KiB go into one message */
+void test_limits(struct us_udp_socket_t *s) {
+    static struct batch b;
+
+    b.num = 0;
+    add(&b, LIBUS_UDP_GSO_MAX_SEGMENTS, 100, 0);
+    int exactly[] = {LIBUS_UDP_GSO_MAX_SEGMENTS, 0};
+    expect_messages(&b, 1, exactly);
+    assert(us_udp_socket_send(s, b.payloads, b.lengths, b.addresses, b.num) == b.num);
+    expect_received(&b);
+
+    b.num = 0;
+    add(&b, LIBUS_UDP_GSO_MAX_SEGMENTS + 1, 100, 1);
+    int one_more[] = {LIBUS_UDP_GSO_MAX_SEGMENTS, 1, 0};
+    expect_messages(&b, 1, one_more);
+    assert(us_udp_socket_send(s, b.payloads, b.lengths, b.addresses, b.num) == b.num);
+    expect_received(&b);
+
+    /* 46 of these fit in 64KiB, 47 do not */
+    b.num = 0;
+    add(&b, 50, 1400, 0);
+    int bytes[] = {LIBUS_UDP_GSO_MAX_BYTES / 1400, 50 - LIBUS_UDP_GSO_MAX_BYTES / 1400, 0};
+    assert(bytes[0] == 46);
+    expect_messages(&b, 1, bytes);
+    assert(us_udp_socket_send(s, b.payloads, b.lengths, b.addresses, b.num) == b.num);
+    expect_received(&b);
+}
+
+/* SO_NO_CHECK makes the kernel refuse every segmented send with EINVAL, like a device without
+ * checksum offload would. The socket then sends one datagram at a time from there on */
+void test_fallback(struct us_loop_t *loop) {
+    static struct batch b;
+    int err = 0;
+    struct us_udp_socket_t *s = us_create_udp_socket(loop, on_data, on_drain, on_close, "127.0.0.1", 0, 0, &err, NULL);
+    assert(s);
+    int enabled = 1;
+    assert(setsockopt(us_poll_fd((struct us_poll_t *) s), SOL_SOCKET, SO_NO_CHECK, &enabled, sizeof(enabled)) == 0);
+
+    /* The first message is segmented, so the whole send fails and is redone */
+    b.num = 0;
+    add(&b, 10, 500, 0);
+    add(&b, 3, 500, 1);
+    add(&b, 1, 20, 0);
+    assert(!s->no_gso);
+    assert(us_udp_socket_send(s, b.payloads, b.lengths, b.addresses, b.num) == b.num);
+    assert(s->no_gso);
+    assert(!sendbuf->has_segments);
+    expect_received(&b);
+
+    /* And stays that way */
+    assert(us_udp_socket_send(s, b.payloads, b.lengths, b.addresses, b.num) == b.num);
+    assert(!sendbuf->has_segments);
+    expect_received(&b);
+    us_udp_socket_close(s);
+
+    /* Here the segmented message is not the first, so sendmmsg reports the one before it as sent.
+     * The caller sends the rest again, which is where segmentation gets turned off */
+    s = us_create_udp_socket(loop, on_data, on_drain, on_close, "127.0.0.1", 0, 0, &err, NULL);
+    assert(s);
+    assert(setsockopt(us_poll_fd((struct us_poll_t *) s), SOL_SOCKET, SO_NO_CHECK, &enabled, sizeof(enabled)) == 0);
+    b.num = 0;
+    add(&b, 1, 20, 1);
+    add(&b, 8, 300, 1);
+    add(&b, 1, 20, 0);
+    int sent = us_udp_socket_send(s, b.payloads, b.lengths, b.addresses, b.num);
+    assert(sent == 1);
+    assert(!s->no_gso);
+    assert(us_udp_socket_send(s, b.payloads + sent, b.lengths + sent, b.addresses + sent, b.num - sent) == b.num - sent);
+    assert(s->no_gso);
+    expect_received(&b);
+    us_udp_socket_close(s);
+}
+
+/* A receiver that asked for GRO gets a merged send back as one payload with its segment size */
+void test_gro(struct us_loop_t *loop, struct us_udp_socket_t *sender) {
+    static struct batch b;
+    int err = 0;
+    struct us_udp_socket_t *r = us_create_udp_socket(loop, on_data, on_drain, on_close, "127.0.0.1", 0, LIBUS_SOCKET_UDP_GRO, &err, NULL);
+    assert(r);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(us_udp_socket_bound_port(r)), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+
+    b.num = 0;
+    add(&b, 6, 700, -1);
+    add(&b, 1, 100, -1);
+    for (int i = 0; i < b.num; i++) {
+        b.addresses[i] = &addr;
+    }
+    assert(us_udp_socket_send(sender, b.payloads, b.lengths, b.addresses, b.num) == b.num);
+
+    static char data[LIBUS_UDP_MAX_SIZE * LIBUS_UDP_RECV_COUNT];
+    static struct udp_recvbuf recvbuf;
+    bsd_udp_setup_recvbuf(&recvbuf, data, sizeof(data));
+    struct pollfd readable = {.fd = us_poll_fd((struct us_poll_t *) r), .events = POLLIN};
+    assert(poll(&readable, 1, 1000) == 1);
+    assert(bsd_recvmmsg(readable.fd, &recvbuf, 0) == 1);
+
+    struct us_udp_packet_buffer_t *packets = (struct us_udp_packet_buffer_t *) &recvbuf;
+    assert(us_udp_packet_buffer_segment_size(packets, 0) == 700);
+    assert(us_udp_packet_buffer_payload_length(packets, 0) == 6 * 700 + 100);
+    char *payload = us_udp_packet_buffer_payload(packets, 0);
+    for (int i = 0; i < b.num; i++) {
+        assert(memcmp(payload + i * 700, b.data[i], b.lengths[i]) == 0);
+    }
+    us_udp_socket_close(r);
+}
+
+int main() {
+    struct us_loop_t *loop = us_create_loop(0, on_wakeup, on_pre, on_post, 0);
+    sendbuf = (struct udp_sendbuf *) loop->data.send_buf;
+
+    for (int p = 0; p < PEERS; p++) {
+        peers[p].fd = socket(AF_INET, SOCK_DGRAM, 0);
+        assert(peers[p].fd >= 0);
+        peers[p].addr.sin_family = AF_INET;
+        peers[p].addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        assert(bind(peers[p].fd, (struct sockaddr *) &peers[p].addr, sizeof(peers[p].addr)) == 0);
+        socklen_t len = sizeof(peers[p].addr);
+        getsockname(peers[p].fd, (struct sockaddr *) &peers[p].addr, &len);
+        int size = 4 * 1024 * 1024;
+        setsockopt(peers[p].fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        struct timeval timeout = {.tv_sec = 1};
+        setsockopt(peers[p].fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    int err = 0;
+    struct us_udp_socket_t *s = us_create_udp_socket(loop, on_data, on_drain, on_close, "127.0.0.1", 0, 0, &err, NULL);
+    assert(s);
+
+    test_mixed(s);
+    test_short_last_segment(s);
+    test_limits(s);
+    /* Nothing above may have made the kernel refuse segmentation */
+    assert(!s->no_gso);
+    test_fallback(loop);
+    test_gro(loop, s);
+
+    us_udp_socket_close(s);
+    us_internal_free_closed_sockets(loop);
+    us_loop_free(loop);
+    for (int p = 0; p < PEERS; p++) {
+        close(peers[p].fd);
+    }
+
+    printf("ALL BITS ARE GOOD\n");
+    return 0;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "root.h"
+#include <wtf/NotFound.h>
+#include <wtf/SIMDHelpers.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+
+// Substring search behind Buffer.prototype.indexOf, lastIndexOf and includes.
+//
+// Most searches go through a SIMD filter: every candidate position is tested against the needle's
+// first and last code unit a whole vector at a time, and only positions where both match are
+// verified with memcmp. Long needles in cache-sized haystacks use Boyer-Moore-Horspool instead,
+// which skips up to the needle's length per comparison.
+//
+// Both return an index in code units, or WTF::notFound.
+namespace Bun {
+
+namespace BufferSearch {
+
+// Horspool only pays off once its skips are long, and only while the haystack is cache resident:
+// on a buffer streaming in from memory its strided reads defeat the prefetcher and the filter,
+// which reads every line in order anyway, keeps up with memory bandwidth.
+static constexpr size_t horspoolMinimumNeedleLength = 128;
+static constexpr size_t horspoolMaximumHaystackBytes = 1 << 20;
+
+template<typename CharType>
+ALWAYS_INLINE bool shouldUseHorspool(size_t haystackLength, size_t needleLength)
+{
+    return needleLength >= horspoolMinimumNeedleLength && haystackLength * sizeof(CharType) <= horspoolMaximumHaystackBytes;
+}
+
+template<typename CharType>
+ALWAYS_INLINE bool matchesAt(const CharType* position, std::span<const CharType> needle)
+{
+    return !memcmp(position, needle.data(), needle.size_bytes());
+}
+
+// The skip table is keyed on the window's last two code units rather than one: text drawn from a
+// small alphabet has nearly every byte somewhere in a long needle, so single-unit shifts stay short.
+// Pairs are hashed into a fixed table, which can only make a shift shorter, never skip a match.
+static constexpr size_t horspoolTableSize = 4096;
+
+template<typename CharType>
+ALWAYS_INLINE size_t horspoolKey(CharType a, CharType b)
+{
+    return (static_cast<size_t>(a) * 67 + static_cast<size_t>(b)) & (horspoolTableSize - 1);
+}
+
+ALWAYS_INLINE uint16_t horspoolShift(size_t shift)
+{
+    return static_cast<uint16_t>(std::min<size_t>(shift, UINT16_MAX));
+}
+
+template<typename CharType>
+size_t find(std::span<const CharType> haystack, std::span<const CharType> needle)
+{
+    const size_t n = haystack.size();
+    const size_t m = needle.size();
+    if (!m)
+        return 0;
+    if (m > n)
+        return WTF::notFound;
+
+    const CharType* text = haystack.data();
+    const size_t lastStart = n - m;
+
+    if (shouldUseHorspool<CharType>(n, m)) {
+        std::array<uint16_t, horspoolTableSize> shift;
+        shift.fill(horspoolShift(m - 1));
+        for (size_t i = 1; i < m - 1; ++i)
+            shift[horspoolKey(needle[i - 1], needle[i])] = horspoolShift(m - 1 - i);
+
+        const CharType last = needle[m - 1];
+        for (size_t i = 0; i <= lastStart;) {
+            const CharType* tail = text + i + m - 2;
+            if (tail[1] == last && matchesAt(text + i, needle))
+                return i;
+            i += shift[horspoolKey(tail[0], tail[1])];
+        }
+        return WTF::notFound;
+    }
+
+    constexpr size_t stride = SIMD::stride<CharType>;
+    const CharType first = needle[0];
+    const CharType last = needle[m - 1];
+    auto firstVector = SIMD::splat<CharType>(first);
+    auto lastVector = SIMD::splat<CharType>(last);
+
+    size_t i = 0;
+    for (; i + stride - 1 <= lastStart; i += stride) {
+        auto candidates = SIMD::bitAnd(SIMD::equal(SIMD::load(text + i), firstVector), SIMD::equal(SIMD::load(text + i + m - 1), lastVector));
+        if (!SIMD::isNonZero(candidates)) [[likely]]
+            continue;
+        for (size_t lane = 0; lane < stride; ++lane) {
+            const CharType* position = text + i + lane;
+            if (position[0] == first && position[m - 1] == last && matchesAt(position, needle))
+                return i + lane;
+        }
+    }
+    for (; i <= lastStart; ++i) {
+        if (text[i] == first && text[i + m - 1] == last && matchesAt(text + i, needle))
+            return i;
+    }
+    return WTF::notFound;
+}
+
+// Finds the last match that starts at or before the end of haystack minus the needle's length.
+template<typename CharType>
+size_t reverseFind(std::span<const CharType> haystack, std::span<const CharType> needle)
+{
+    const size_t n = haystack.size();
+    const size_t m = needle.size();
+    if (!m)
+        return n;
+    if (m > n)
+        return WTF::notFound;
+
+    const CharType* text = haystack.data();
+    const size_t lastStart = n - m;
+
+    if (shouldUseHorspool<CharType>(n, m)) {
+        // Mirror image of the forward table: the window is keyed on its first code unit, and shifts
+        // back to the nearest earlier occurrence of it in needle[1..m).
+        std::array<uint16_t, horspoolTableSize> shift;
+        shift.fill(horspoolShift(m - 1));
+        for (size_t i = m - 2; i > 0; --i)
+            shift[horspoolKey(needle[i], needle[i + 1])] = horspoolShift(i);
+
+        const CharType first = needle[0];
+        for (size_t i = lastStart;;) {
+            const CharType* head = text + i;
+            if (head[0] == first && matchesAt(head, needle))
+                return i;
+            size_t step = shift[horspoolKey(head[0], head[1])];
+            if (step > i)
+                return WTF::notFound;
+            i -= step;
+        }
+    }
+
+    constexpr size_t stride = SIMD::stride<CharType>;
+    const CharType first = needle[0];
+    const CharType last = needle[m - 1];
+    auto firstVector = SIMD::splat<CharType>(first);
+    auto lastVector = SIMD::splat<CharType>(last);
+
+    // Positions [0, end) are still unsearched.
+    size_t end = lastStart + 1;
+    for (; end >= stride; end -= stride) {
+        size_t base = end - stride;
+        auto candidates = SIMD::bitAnd(SIMD::equal(SIMD::load(text + base), firstVector), SIMD::equal(SIMD::load(text + base + m - 1), lastVector));
+        if (!SIMD::isNonZero(candidates)) [[likely]]
+            continue;
+        for (size_t lane = stride; lane-- > 0;) {
+            const CharType* position = text + base + lane;
+            if (position[0] == first && position[m - 1] == last && matchesAt(position, needle))
+                return base + lane;
+        }
+    }
+    while (end-- > 0) {
+        if (text[end] == first && text[end + m - 1] == last && matchesAt(text + end, needle))
+            return end;
+    }
+    return WTF::notFound;
+}
+
+} // namespace BufferSearch
+
+} // namespace Bun
@@ -54,6 +54,7 @@
 #include <JavaScriptCore/BuiltinNames.h>
 
 #include "JSBufferEncodingType.h"
+#include "BufferSearch.h"
 #include "ErrorCode.h"
 #include "NodeValidator.h"
 #include "wtf/Assertions.h"
@@ -259,6 +260,51 @@ static JSUint8Array* allocBufferUnsafe(JSC::JSGlobalObject* lexicalGlobalObject,
     return result;
 }
 
+// https://github.com/nodejs/node/blob/v22.9.0/lib/buffer.js#L158
+// Small allocations are sliced out of one shared ArrayBuffer instead of getting their own, so
+// `buffer` is the pool and `byteOffset` points into it. Returns false when length can't come
+// from the pool: it is empty, at least half of Buffer.poolSize, or a new pool couldn't be made.
+static bool ensureBufferPoolCapacity(Zig::GlobalObject* globalObject, size_t length)
+{
+    if (!length || length >= (globalObject->m_bufferPoolSize >> 1))
+        return false;
+
+    auto& pool = globalObject->m_bufferPool;
+    if (pool && globalObject->m_bufferPoolOffset + length <= pool->byteLength())
+        return true;
+
+    size_t poolSize = globalObject->m_bufferPoolSize;
+    auto newPool = Bun__Node__ZeroFillBuffers ? ArrayBuffer::tryCreate(poolSize, 1) : ArrayBuffer::tryCreateUninitialized(poolSize, 1);
+    if (UNLIKELY(!newPool))
+        return false;
+    // Like Node's markAsUntransferable(): detaching the pool would take the memory out from
+    // under every other Buffer sliced from it.
+    newPool->pinAndLock();
+    pool = WTFMove(newPool);
+    globalObject->m_bufferPoolOffset = 0;
+    return true;
+}
+
+// Call ensureBufferPoolCapacity() first. Returns the next length bytes of the pool as a Buffer.
+static JSUint8Array* takeFromBufferPool(JSC::JSGlobalObject* lexicalGlobalObject, Zig::GlobalObject* globalObject, size_t length)
+{
+    size_t offset = globalObject->m_bufferPoolOffset;
+    ASSERT(offset + length <= globalObject->m_bufferPool->byteLength());
+    auto* uint8Array = JSC::JSUint8Array::create(lexicalGlobalObject, globalObject->JSBufferSubclassStructure(), Ref { *globalObject->m_bufferPool }, offset, length);
+    if (LIKELY(uint8Array))
+        globalObject->m_bufferPoolOffset = WTF::roundUpToMultipleOf<8>(offset + length);
+    return uint8Array;
+}
+
+// Buffer.allocUnsafe() draws small allocations from the pool; allocUnsafeSlow() never does.
+static JSUint8Array* allocPooledBufferUnsafe(JSC::JSGlobalObject* lexicalGlobalObject, size_t byteLength)
+{
+    auto* globalObject = defaultGlobalObject(lexicalGlobalObject);
+    if (ensureBufferPoolCapacity(globalObject, byteLength))
+        return takeFromBufferPool(lexicalGlobalObject, globalObject, byteLength);
+    return allocBufferUnsafe(lexicalGlobalObject, byteLength);
+}
+
 // Normalize val to be an integer in the range of [1, -1] since
 // implementations of memcmp() can vary by platform.
 static int normalizeCompareVal(int val, size_t a_length, size_t b_length)
@@ -479,7 +525,7 @@ extern "C" JSC::EncodedJSValue JSBuffer__bufferFromLength(JSC::JSGlobalObject* l
 }
 
 // https://github.com/nodejs/node/blob/v22.9.0/lib/buffer.js#L404
-static JSC::EncodedJSValue jsBufferConstructorFunction_allocUnsafeBody(JSC::JSGlobalObject* lexicalGlobalObject, JSC::CallFrame* callFrame)
+static JSC::EncodedJSValue allocUnsafe(JSC::JSGlobalObject* lexicalGlobalObject, JSC::CallFrame* callFrame, bool usePool)
 {
     auto& vm = JSC::getVM(lexicalGlobalObject);
     auto throwScope = DECLARE_THROW_SCOPE(vm);
@@ -487,12 +533,17 @@ static JSC::EncodedJSValue jsBufferConstructorFunction_allocUnsafeBody(JSC::JSGl
     Bun::V::validateNumber(throwScope, lexicalGlobalObject, lengthValue, "size"_s, jsNumber(0), jsNumber(Bun::Buffer::kMaxLength));
     RETURN_IF_EXCEPTION(throwScope, {});
     size_t length = lengthValue.toLength(lexicalGlobalObject);
-    auto result = allocBufferUnsafe(lexicalGlobalObject, length);
+    auto result = usePool ? allocPooledBufferUnsafe(lexicalGlobalObject, length) : allocBufferUnsafe(lexicalGlobalObject, length);
     RETURN_IF_EXCEPTION(throwScope, {});
     if (Bun__Node__ZeroFillBuffers) memset(result->typedVector(), 0, length);
     RELEASE_AND_RETURN(throwScope, JSValue::encode(result));
 }
 
+static JSC::EncodedJSValue jsBufferConstructorFunction_allocUnsafeBody(JSC::JSGlobalObject* lexicalGlobalObject, JSC::CallFrame* callFrame)
+{
+    return allocUnsafe(lexicalGlobalObject, callFrame, true);
+}
+
 // new Buffer()
 static JSC::EncodedJSValue constructBufferEmpty(JSGlobalObject* lexicalGlobalObject)
 {
@@ -575,6 +626,46 @@ JSC::EncodedJSValue constructFromEncoding(JSGlobalObject* lexicalGlobalObject, W
     return result;
 }
 
+// https://github.com/nodejs/node/blob/v22.9.0/lib/buffer.js#L444
+// Encodes short strings straight into the Buffer pool. Returns nullptr when the string is too
+// long for the pool and the caller should allocate a Buffer of its own.
+static JSC::JSUint8Array* constructPooledBufferFromString(JSC::JSGlobalObject* lexicalGlobalObject, JSString* str, WTF::StringView view, WebCore::BufferEncodingType encoding)
+{
+    auto* globalObject = defaultGlobalObject(lexicalGlobalObject);
+    size_t maxLength = globalObject->m_bufferPoolSize >> 1;
+    size_t length = str->length();
+    if (length >= maxLength)
+        return nullptr;
+
+    // No encoding produces more than 4 bytes per code unit; only measure exactly when that bound
+    // doesn't already fit.
+    length *= 4;
+    if (length >= maxLength) {
+        auto byteLength = Bun::byteLength(str, lexicalGlobalObject, encoding);
+        if (!byteLength)
+            return nullptr;
+        length = static_cast<size_t>(*byteLength);
+        if (length >= maxLength)
+            return nullptr;
+    }
+    if (!length || !ensureBufferPoolCapacity(globalObject, length))
+        return nullptr;
+
+    auto* destination = static_cast<uint8_t*>(globalObject->m_bufferPool->data()) + globalObject->m_bufferPoolOffset;
+    size_t written = 0;
+    if (view.is8Bit()) {
+        const auto span = view.span8();
+        written = Bun__encoding__writeLatin1(span.data(), span.size(), destination, length, static_cast<uint8_t>(encoding));
+    } else {
+        const auto span = view.span16();
+        written = Bun__encoding__writeUTF16(span.data(), span.size(), destination, length, static_cast<uint8_t>(encoding));
+    }
+    if (!written)
+        return createEmptyBuffer(lexicalGlobalObject);
+
+    return takeFromBufferPool(lexicalGlobalObject, globalObject, written);
+}
+
 static JSC::EncodedJSValue constructBufferFromStringAndEncoding(JSC::JSGlobalObject* lexicalGlobalObject, JSValue arg0, JSValue arg1)
 {
     auto& vm = JSC::getVM(lexicalGlobalObject);
@@ -603,6 +694,11 @@ static JSC::EncodedJSValue constructBufferFromStringAndEncoding(JSC::JSGlobalObj
     if (str->length() == 0)
         return constructBufferEmpty(lexicalGlobalObject);
 
+    auto* pooled = constructPooledBufferFromString(lexicalGlobalObject, str, view, encoding);
+    RETURN_IF_EXCEPTION(scope, {});
+    if (pooled)
+        return JSValue::encode(pooled);
+
     JSC::EncodedJSValue result = constructFromEncoding(lexicalGlobalObject, view, encoding);
 
     RELEASE_AND_RETURN(scope, result);
@@ -707,7 +803,7 @@ static JSC::EncodedJSValue jsBufferConstructorFunction_allocBody(JSC::JSGlobalOb
 
 static JSC::EncodedJSValue jsBufferConstructorFunction_allocUnsafeSlowBody(JSC::JSGlobalObject* lexicalGlobalObject, JSC::CallFrame* callFrame)
 {
-    return jsBufferConstructorFunction_allocUnsafeBody(lexicalGlobalObject, callFrame);
+    return allocUnsafe(lexicalGlobalObject, callFrame, false);
 }
 
 // new SlowBuffer(size)
@@ -1387,9 +1483,9 @@ static int64_t indexOf(const uint8_t* thisPtr, int64_t thisLength, const uint8_t
 {
     auto haystack = std::span<const uint8_t>(thisPtr, thisLength).subspan(byteOffset);
     auto needle = std::span<const uint8_t>(valuePtr, valueLength);
-    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end());
-    if (it == haystack.end()) return -1;
-    return byteOffset + std::distance(haystack.begin(), it);
+    auto result = Bun::BufferSearch::find(haystack, needle);
+    if (result == WTF::notFound) return -1;
+    return byteOffset + result;
 }
 
 static int64_t indexOf16(const uint8_t* thisPtr, int64_t thisLength, const uint8_t* valuePtr, int64_t valueLength, int64_t byteOffset)
@@ -1401,21 +1497,32 @@ static int64_t indexOf16(const uint8_t* thisPtr, int64_t thisLength, const uint8
     byteOffset /= 2;
     auto haystack = std::span<const uint16_t>((const uint16_t*)(thisPtr), thisLength).subspan(byteOffset);
     auto needle = std::span<const uint16_t>((const uint16_t*)(valuePtr), valueLength);
-    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end());
-    if (it == haystack.end()) return -1;
-    auto idx = byteOffset + std::distance(haystack.begin(), it);
-    return idx * 2;
+    auto result = Bun::BufferSearch::find(haystack, needle);
+    if (result == WTF::notFound) return -1;
+    return (byteOffset + result) * 2;
 }
 
 static int64_t lastIndexOf(const uint8_t* thisPtr, int64_t thisLength, const uint8_t* valuePtr, int64_t valueLength, int64_t byteOffset)
 {
-    auto start = thisPtr;
-    auto end = thisPtr + std::min(thisLength, byteOffset + valueLength);
-    auto it = std::find_end(start, end, valuePtr, valuePtr + valueLength);
-    if (it != end) {
-        return it - thisPtr;
-    }
-    return -1;
+    auto haystack = std::span<const uint8_t>(thisPtr, std::min(thisLength, byteOffset + valueLength));
+    auto needle = std::span<const uint8_t>(valuePtr, valueLength);
+    auto result = Bun::BufferSearch::reverseFind(haystack, needle);
+    if (result == WTF::notFound) return -1;
+    return result;
+}
+
+static int64_t lastIndexOf16(const uint8_t* thisPtr, int64_t thisLength, const uint8_t* valuePtr, int64_t valueLength, int64_t byteOffset)
+{
+    if (thisLength == 1) return -1;
+    if (valueLength == 1) return -1;
+    thisLength /= 2;
+    valueLength /= 2;
+    byteOffset /= 2;
+    auto haystack = std::span<const uint16_t>((const uint16_t*)(thisPtr), std::min(thisLength, byteOffset + valueLength));
+    auto needle = std::span<const uint16_t>((const uint16_t*)(valuePtr), valueLength);
+    auto result = Bun::BufferSearch::reverseFind(haystack, needle);
+    if (result == WTF::notFound) return -1;
+    return result * 2;
 }
 
 static int64_t indexOfNumber(JSC::JSGlobalObject* lexicalGlobalObject, bool last, const uint8_t* typedVector, size_t byteLength, double byteOffsetD, uint8_t byteValue)
@@ -1435,9 +1542,7 @@ static int64_t indexOfNumber(JSC::JSGlobalObject* lexicalGlobalObject, bool last
 
 static int64_t indexOfString(JSC::JSGlobalObject* lexicalGlobalObject, bool last, const uint8_t* typedVector, size_t byteLength, double byteOffsetD, JSString* str, BufferEncodingType encoding)
 {
-    ssize_t byteOffset = indexOfOffset(byteLength, byteOffsetD, str->length(), !last);
-    if (byteOffset == -1) return -1;
-    if (str->length() == 0) return byteOffset;
+    if (str->length() == 0) return indexOfOffset(byteLength, byteOffsetD, 0, !last);
 
     VM& vm = lexicalGlobalObject->vm();
     auto scope = DECLARE_THROW_SCOPE(vm);
@@ -1449,15 +1554,22 @@ static int64_t indexOfString(JSC::JSGlobalObject* lexicalGlobalObject, bool last
 
     auto* arrayValue = JSC::jsCast<JSC::JSUint8Array*>(JSC::JSValue::decode(encodedBuffer));
     auto lengthValue = static_cast<int64_t>(arrayValue->byteLength());
+    // Offsets are normalized against the needle's encoded length, like Node.
+    ssize_t byteOffset = indexOfOffset(byteLength, byteOffsetD, lengthValue, !last);
+    if (byteOffset == -1) return -1;
     if (lengthValue == 0) return byteOffset;
+    if ((!last && byteOffset + lengthValue > static_cast<int64_t>(byteLength)) || lengthValue > static_cast<int64_t>(byteLength)) return -1;
 
     const uint8_t* typedVectorValue = arrayValue->typedVector();
-    if (last) {
-        return lastIndexOf(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
-    }
     if (encoding == BufferEncodingType::ucs2) {
+        if (last) {
+            return lastIndexOf16(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
+        }
         return indexOf16(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
     }
+    if (last) {
+        return lastIndexOf(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
+    }
 
     return indexOf(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
 }
@@ -1468,13 +1580,19 @@ static int64_t indexOfBuffer(JSC::JSGlobalObject* lexicalGlobalObject, bool last
     ssize_t byteOffset = indexOfOffset(byteLength, byteOffsetD, lengthValue, !last);
     if (byteOffset == -1) return -1;
     if (lengthValue == 0) return byteOffset;
+    // Like Node, a needle running past the end never matches, even where a ucs2 search from an odd
+    // offset would round down onto one.
+    if ((!last && static_cast<size_t>(byteOffset) + lengthValue > byteLength) || lengthValue > byteLength) return -1;
     const uint8_t* typedVectorValue = array->typedVector();
-    if (last) {
-        return lastIndexOf(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
-    }
     if (encoding == BufferEncodingType::ucs2) {
+        if (last) {
+            return lastIndexOf16(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
+        }
         return indexOf16(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
     }
+    if (last) {
+        return lastIndexOf(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
+    }
     return indexOf(typedVector, byteLength, typedVectorValue, lengthValue, byteOffset);
 }
 
@@ -2242,7 +2360,7 @@ JSC_DEFINE_JIT_OPERATION(jsBufferConstructorAllocUnsafeWithoutTypeChecks, JSUint
     CallFrame* callFrame = DECLARE_CALL_FRAME(vm);
     IGNORE_WARNINGS_END
     JSC::JITOperationPrologueCallFrameTracer tracer(vm, callFrame);
-    return { allocBufferUnsafe(lexicalGlobalObject, byteLength) };
+    return { allocPooledBufferUnsafe(lexicalGlobalObject, byteLength) };
 }
 
 JSC_DEFINE_JIT_OPERATION(jsBufferConstructorAllocUnsafeSlowWithoutTypeChecks, JSUint8Array*, (JSC::JSGlobalObject * lexicalGlobalObject, void* thisValue, int byteLength))
@@ -2724,6 +2842,23 @@ const ClassInfo JSBufferPrototype::s_info = {
 */
 #include "JSBuffer.lut.h"
 
+// Behaves like a plain data property, but writes take effect on the pool the next time one is created.
+JSC_DEFINE_CUSTOM_GETTER(jsBufferConstructor_poolSizeGetter, (JSGlobalObject * lexicalGlobalObject, EncodedJSValue thisValue, PropertyName))
+{
+    return JSValue::encode(jsNumber(defaultGlobalObject(lexicalGlobalObject)->m_bufferPoolSize));
+}
+
+JSC_DEFINE_CUSTOM_SETTER(jsBufferConstructor_poolSizeSetter, (JSGlobalObject * lexicalGlobalObject, EncodedJSValue thisValue, EncodedJSValue encodedValue, PropertyName))
+{
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    // Node only ever reads it through `>>> 1`, so coerce the same way; anything that becomes 0 turns the pool off.
+    uint32_t poolSize = JSValue::decode(encodedValue).toUInt32(lexicalGlobalObject);
+    RETURN_IF_EXCEPTION(scope, false);
+    defaultGlobalObject(lexicalGlobalObject)->m_bufferPoolSize = poolSize;
+    return true;
+}
+
 const ClassInfo JSBufferConstructor::s_info = { "Buffer"_s, &Base::s_info, &jsBufferConstructorTable, nullptr, CREATE_METHOD_TABLE(JSBufferConstructor) };
 
 void JSBufferConstructor::finishCreation(VM& vm, JSGlobalObject* globalObject, JSC::JSObject* prototype)
@@ -2731,7 +2866,7 @@ void JSBufferConstructor::finishCreation(VM& vm, JSGlobalObject* globalObject, J
     Base::finishCreation(vm, 3, "Buffer"_s, PropertyAdditionMode::WithoutStructureTransition);
     putDirectWithoutTransition(vm, vm.propertyNames->prototype, prototype, PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly);
     prototype->putDirect(vm, vm.propertyNames->speciesSymbol, this, PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly);
-    putDirectWithoutTransition(vm, Identifier::fromString(vm, "poolSize"_s), jsNumber(8192));
+    putDirectCustomAccessor(vm, Identifier::fromString(vm, "poolSize"_s), CustomGetterSetter::create(vm, jsBufferConstructor_poolSizeGetter, jsBufferConstructor_poolSizeSetter), PropertyAttribute::CustomValue);
 }
 
 JSC::Structure* createBufferStructure(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::JSValue prototype)
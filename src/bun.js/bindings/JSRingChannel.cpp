@@ -0,0 +1,786 @@
+#include "root.h"
+#include "JSRingChannel.h"
+
+#include "ContextDestructionObserver.h"
+#include "ErrorCode.h"
+#include "JSDOMConvertBufferSource.h"
+#include "ScriptExecutionContext.h"
+#include "ZigGlobalObject.h"
+#include <JavaScriptCore/JSArrayBufferView.h>
+#include <JavaScriptCore/JSPromise.h>
+#include <JavaScriptCore/JSTypedArrays.h>
+#include <JavaScriptCore/Lookup.h>
+#include <JavaScriptCore/Protect.h>
+#include <JavaScriptCore/ReleaseHeapAccessScope.h>
+#include <wtf/ParkingLot.h>
+#include <wtf/Threading.h>
+#include <atomic>
+
+namespace WebCore {
+
+using namespace JSC;
+
+static JSC_DECLARE_HOST_FUNCTION(jsRingChannelPrototypeFunction_write);
+static JSC_DECLARE_HOST_FUNCTION(jsRingChannelPrototypeFunction_writeSync);
+static JSC_DECLARE_HOST_FUNCTION(jsRingChannelPrototypeFunction_tryRead);
+static JSC_DECLARE_HOST_FUNCTION(jsRingChannelPrototypeFunction_readSync);
+static JSC_DECLARE_HOST_FUNCTION(jsRingChannelPrototypeFunction_read);
+static JSC_DECLARE_HOST_FUNCTION(jsRingChannelPrototypeFunction_close);
+
+static JSC_DECLARE_CUSTOM_GETTER(jsRingChannel_buffer);
+static JSC_DECLARE_CUSTOM_GETTER(jsRingChannel_capacity);
+static JSC_DECLARE_CUSTOM_GETTER(jsRingChannel_byteLength);
+static JSC_DECLARE_CUSTOM_GETTER(jsRingChannel_closed);
+
+// Lives at the start of the SharedArrayBuffer, followed by `capacity` bytes of ring. Positions
+// are free-running byte counters, so `tail - head` is the number of bytes queued. Each message is
+// a 32-bit length followed by the payload, padded to 4 bytes so that lengths never wrap.
+struct RingChannelHeader {
+    static constexpr uint32_t expectedMagic = 0x676e6952; // "Ring"
+
+    // Written by readers
+    alignas(64) std::atomic<uint32_t> head;
+    std::atomic<uint32_t> readerLock;
+    std::atomic<uint32_t> sleepingWriters;
+
+    // Written by writers
+    alignas(64) std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> writerLock;
+    std::atomic<uint32_t> sleepingReaders;
+    std::atomic<uint32_t> asyncReaders;
+
+    alignas(64) uint32_t magic;
+    uint32_t capacity;
+    std::atomic<uint32_t> closed;
+};
+
+static_assert(sizeof(RingChannelHeader) == 192);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+static constexpr uint32_t defaultRingCapacity = 1024 * 1024;
+static constexpr uint32_t minimumRingCapacity = 64;
+static constexpr uint32_t maximumRingCapacity = 1u << 30;
+static constexpr uint32_t messageHeaderSize = sizeof(uint32_t);
+
+static uint64_t messageSize(uint64_t length)
+{
+    return messageHeaderSize + roundUpToMultipleOf<4>(length);
+}
+
+// Nobody holds a side's lock for longer than one copy into or out of the ring.
+static constexpr Seconds ringLockTimeout { 1 };
+
+// Writers share one lock and readers another, so a single writer and a single reader never
+// contend with each other; more of either just take turns on their side. The lock word is in
+// memory that any script holding the buffer can write to, so one that stays taken is treated
+// like the rest of a damaged header rather than waited on forever.
+class RingSideLocker {
+public:
+    explicit RingSideLocker(std::atomic<uint32_t>& word)
+        : m_word(word)
+    {
+        if (!m_word.exchange(1, std::memory_order_acquire)) {
+            m_isLocked = true;
+            return;
+        }
+
+        MonotonicTime deadline = MonotonicTime::now() + ringLockTimeout;
+        do {
+            Thread::yield();
+            if (!m_word.exchange(1, std::memory_order_acquire)) {
+                m_isLocked = true;
+                return;
+            }
+        } while (MonotonicTime::now() < deadline);
+    }
+
+    ~RingSideLocker()
+    {
+        if (m_isLocked)
+            m_word.store(0, std::memory_order_release);
+    }
+
+    bool isLocked() const { return m_isLocked; }
+
+private:
+    std::atomic<uint32_t>& m_word;
+    bool m_isLocked { false };
+};
+
+static void throwRingCorrupted(JSGlobalObject* globalObject, ThrowScope& scope)
+{
+    throwException(globalObject, scope, createError(globalObject, "RingChannel shared memory is corrupted"_s));
+}
+
+static void copyIntoRing(uint8_t* ring, uint32_t capacity, uint32_t position, std::span<const uint8_t> bytes)
+{
+    uint32_t offset = position & (capacity - 1);
+    size_t first = std::min<size_t>(bytes.size(), capacity - offset);
+    memcpy(ring + offset, bytes.data(), first);
+    memcpy(ring, bytes.data() + first, bytes.size() - first);
+}
+
+static void copyFromRing(const uint8_t* ring, uint32_t capacity, uint32_t position, std::span<uint8_t> bytes)
+{
+    uint32_t offset = position & (capacity - 1);
+    size_t first = std::min<size_t>(bytes.size(), capacity - offset);
+    memcpy(bytes.data(), ring + offset, first);
+    memcpy(bytes.data() + first, ring, bytes.size() - first);
+}
+
+// Readers blocked in read() on some thread's event loop. The channel protects itself from GC
+// while it is in here, so only the raw pointer needs to travel to the waking thread. Entries are
+// dropped when their channel is destroyed or their context goes away.
+struct RingAsyncReader {
+    const RingChannelHeader* ring;
+    Ref<ScriptExecutionContextMailbox> mailbox;
+    ScriptExecutionContextIdentifier context;
+    JSRingChannel* channel;
+};
+
+static Lock ringAsyncReadersLock;
+static Vector<RingAsyncReader>& ringAsyncReaders() WTF_REQUIRES_LOCK(ringAsyncReadersLock)
+{
+    static NeverDestroyed<Vector<RingAsyncReader>> readers;
+    return readers;
+}
+
+template<typename Predicate>
+static void removeAsyncReaders(const Predicate& predicate) WTF_REQUIRES_LOCK(ringAsyncReadersLock)
+{
+    ringAsyncReaders().removeAllMatching([&](auto& reader) {
+        if (!predicate(reader))
+            return false;
+        const_cast<RingChannelHeader*>(reader.ring)->asyncReaders.fetch_sub(1);
+        return true;
+    });
+}
+
+// One per context that has ever waited in read(), so a torn down Worker leaves nothing behind.
+class RingAsyncReaderContext final : public ContextDestructionObserver {
+    WTF_MAKE_FAST_ALLOCATED;
+
+public:
+    explicit RingAsyncReaderContext(ScriptExecutionContext& context)
+        : ContextDestructionObserver(&context)
+        , identifier(context.identifier())
+    {
+    }
+
+    void contextDestroyed() final;
+
+    ScriptExecutionContextIdentifier identifier;
+};
+
+static HashMap<ScriptExecutionContextIdentifier, RingAsyncReaderContext*>& ringAsyncReaderContexts() WTF_REQUIRES_LOCK(ringAsyncReadersLock)
+{
+    static NeverDestroyed<HashMap<ScriptExecutionContextIdentifier, RingAsyncReaderContext*>> contexts;
+    return contexts;
+}
+
+void RingAsyncReaderContext::contextDestroyed()
+{
+    {
+        Locker locker { ringAsyncReadersLock };
+        removeAsyncReaders([&](auto& reader) { return reader.context == identifier; });
+        ringAsyncReaderContexts().remove(identifier);
+    }
+
+    ContextDestructionObserver::contextDestroyed();
+    delete this;
+}
+
+static void resumeAsyncReaders(RingChannelHeader& header)
+{
+    Vector<RingAsyncReader> ready;
+    {
+        Locker locker { ringAsyncReadersLock };
+        auto& readers = ringAsyncReaders();
+        for (size_t i = 0; i < readers.size();) {
+            if (readers[i].ring != &header) {
+                ++i;
+                continue;
+            }
+            ready.append(WTFMove(readers[i]));
+            readers.remove(i);
+        }
+        header.asyncReaders.fetch_sub(ready.size());
+    }
+
+    for (auto& reader : ready) {
+        reader.mailbox->post([channel = reader.channel](ScriptExecutionContext& context) {
+            channel->settlePendingReads(context.jsGlobalObject());
+        });
+    }
+}
+
+static void wakeRingReaders(RingChannelHeader& header)
+{
+    if (header.sleepingReaders.load())
+        ParkingLot::unparkAll(&header.tail);
+    if (header.asyncReaders.load())
+        resumeAsyncReaders(header);
+}
+
+static void wakeRingWriters(RingChannelHeader& header)
+{
+    if (header.sleepingWriters.load())
+        ParkingLot::unparkAll(&header.head);
+}
+
+// Sleeps until `word` moves away from `observed` or the channel closes. Returns false once the
+// deadline has passed.
+static bool parkOnRing(VM& vm, std::atomic<uint32_t>& word, uint32_t observed, std::atomic<uint32_t>& sleepers, const std::atomic<uint32_t>& closed, MonotonicTime deadline)
+{
+    sleepers.fetch_add(1);
+    {
+        ReleaseHeapAccessScope releaseHeapAccessScope(vm.heap);
+        ParkingLot::parkConditionally(
+            &word,
+            [&]() -> bool { return word.load() == observed && !closed.load(); },
+            [] {},
+            deadline);
+    }
+    sleepers.fetch_sub(1);
+    return MonotonicTime::now() < deadline;
+}
+
+static MonotonicTime deadlineFromTimeout(JSGlobalObject* globalObject, ThrowScope& scope, JSValue timeoutValue)
+{
+    if (timeoutValue.isUndefined())
+        return MonotonicTime::infinity();
+
+    double milliseconds = timeoutValue.toNumber(globalObject);
+    RETURN_IF_EXCEPTION(scope, {});
+    if (std::isnan(milliseconds) || milliseconds < 0) {
+        Bun::ERR::OUT_OF_RANGE(scope, globalObject, "timeout"_s, 0, std::numeric_limits<double>::infinity(), timeoutValue);
+        return {};
+    }
+    return MonotonicTime::now() + Seconds::fromMilliseconds(milliseconds);
+}
+
+JSRingChannel::~JSRingChannel()
+{
+    Locker locker { ringAsyncReadersLock };
+    removeAsyncReaders([&](auto& reader) { return reader.channel == this; });
+}
+
+RingChannelHeader& JSRingChannel::header() const
+{
+    return *static_cast<RingChannelHeader*>(m_buffer->data());
+}
+
+uint32_t JSRingChannel::capacity() const
+{
+    return m_capacity;
+}
+
+uint8_t* JSRingChannel::data() const
+{
+    return static_cast<uint8_t*>(m_buffer->data()) + sizeof(RingChannelHeader);
+}
+
+JSArrayBuffer* JSRingChannel::jsBuffer(JSGlobalObject* globalObject)
+{
+    // Reuses the wrapper we were attached through, so `channel.buffer` is that same object.
+    if (!m_jsBuffer)
+        m_jsBuffer.set(globalObject->vm(), this, jsCast<JSArrayBuffer*>(toJS(globalObject, defaultGlobalObject(globalObject), m_buffer.get())));
+    return m_jsBuffer.get();
+}
+
+JSRingChannel::WriteResult JSRingChannel::write(std::span<const uint8_t> bytes)
+{
+    auto& header = this->header();
+    uint32_t capacity = this->capacity();
+    {
+        RingSideLocker locker { header.writerLock };
+        if (!locker.isLocked())
+            return WriteResult::Corrupted;
+        if (header.closed.load(std::memory_order_acquire))
+            return WriteResult::Closed;
+
+        uint32_t tail = header.tail.load(std::memory_order_relaxed);
+        uint32_t used = tail - header.head.load(std::memory_order_acquire);
+        if (used > capacity || capacity - used < messageSize(bytes.size()))
+            return WriteResult::Full;
+
+        uint32_t length = static_cast<uint32_t>(bytes.size());
+        copyIntoRing(data(), capacity, tail, { reinterpret_cast<const uint8_t*>(&length), sizeof(length) });
+        copyIntoRing(data(), capacity, tail + messageHeaderSize, bytes);
+        header.tail.store(tail + static_cast<uint32_t>(messageSize(length)));
+    }
+
+    wakeRingReaders(header);
+    return WriteResult::Written;
+}
+
+JSUint8Array* JSRingChannel::tryRead(JSGlobalObject* globalObject)
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto& header = this->header();
+    uint32_t capacity = this->capacity();
+
+    // Allocating may collect garbage or throw, which must not happen while other readers spin on
+    // readerLock. The array is sized from a peek at the next message before taking the lock, and
+    // the message is only taken if no other reader got to it in between.
+    for (;;) {
+        uint32_t peekedHead = header.head.load(std::memory_order_acquire);
+        uint32_t peekedUsed = header.tail.load(std::memory_order_acquire) - peekedHead;
+        if (!peekedUsed)
+            return nullptr;
+
+        uint32_t peekedLength = 0;
+        if (peekedUsed >= messageHeaderSize && peekedUsed <= capacity)
+            copyFromRing(data(), capacity, peekedHead, { reinterpret_cast<uint8_t*>(&peekedLength), sizeof(peekedLength) });
+
+        JSUint8Array* result = nullptr;
+        if (messageSize(peekedLength) <= capacity) {
+            result = JSUint8Array::createUninitialized(globalObject, globalObject->m_typedArrayUint8.get(globalObject), peekedLength);
+            RETURN_IF_EXCEPTION(scope, nullptr);
+        }
+
+        bool isCorrupted = false;
+        {
+            RingSideLocker locker { header.readerLock };
+            if (!locker.isLocked()) {
+                throwRingCorrupted(globalObject, scope);
+                return nullptr;
+            }
+            uint32_t head = header.head.load(std::memory_order_relaxed);
+            if (head != peekedHead)
+                continue;
+
+            uint32_t used = header.tail.load(std::memory_order_acquire) - head;
+            uint32_t length = 0;
+            if (used >= messageHeaderSize && used <= capacity)
+                copyFromRing(data(), capacity, head, { reinterpret_cast<uint8_t*>(&length), sizeof(length) });
+            isCorrupted = used < messageHeaderSize || used > capacity || messageSize(length) > used || !result || length != peekedLength;
+            if (!isCorrupted) {
+                copyFromRing(data(), capacity, head + messageHeaderSize, { result->typedVector(), length });
+                header.head.store(head + static_cast<uint32_t>(messageSize(length)));
+            }
+        }
+
+        if (isCorrupted) {
+            throwRingCorrupted(globalObject, scope);
+            return nullptr;
+        }
+
+        wakeRingWriters(header);
+        return result;
+    }
+}
+
+void JSRingChannel::close()
+{
+    auto& header = this->header();
+    header.closed.store(1);
+    ParkingLot::unparkAll(&header.tail);
+    ParkingLot::unparkAll(&header.head);
+    if (header.asyncReaders.load())
+        resumeAsyncReaders(header);
+}
+
+void JSRingChannel::enqueueRead(VM& vm, JSPromise* promise)
+{
+    {
+        Locker locker { cellLock() };
+        m_pendingReads.append(WriteBarrier<JSPromise>(vm, this, promise));
+    }
+
+    if (m_pendingReads.size() == 1) {
+        gcProtect(this);
+        registerAsyncReader();
+    }
+}
+
+void JSRingChannel::registerAsyncReader()
+{
+    auto& header = this->header();
+    auto* context = defaultGlobalObject(globalObject())->scriptExecutionContext();
+    {
+        Locker locker { ringAsyncReadersLock };
+        ringAsyncReaderContexts().ensure(context->identifier(), [&] {
+            return new RingAsyncReaderContext(*context);
+        });
+        ringAsyncReaders().append(RingAsyncReader { &header, context->mailbox(), context->identifier(), this });
+        header.asyncReaders.fetch_add(1);
+    }
+
+    // A write or close() that landed before we were registered could not have woken us.
+    if (header.tail.load() != header.head.load() || header.closed.load())
+        resumeAsyncReaders(header);
+}
+
+void JSRingChannel::settlePendingReads(JSGlobalObject* globalObject)
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+
+    while (!m_pendingReads.isEmpty()) {
+        auto* bytes = tryRead(globalObject);
+        JSPromise* promise = nullptr;
+        if (!bytes && !scope.exception() && !header().closed.load())
+            break;
+
+        {
+            Locker locker { cellLock() };
+            promise = m_pendingReads.first().get();
+            m_pendingReads.remove(0);
+        }
+
+        if (UNLIKELY(scope.exception())) {
+            promise->rejectWithCaughtException(globalObject, scope);
+            continue;
+        }
+        promise->resolve(globalObject, bytes ? JSValue(bytes) : jsNull());
+    }
+
+    if (m_pendingReads.isEmpty())
+        gcUnprotect(this);
+    else
+        registerAsyncReader();
+}
+
+template<typename Visitor>
+void JSRingChannel::visitChildrenImpl(JSCell* cell, Visitor& visitor)
+{
+    JSRingChannel* thisObject = jsCast<JSRingChannel*>(cell);
+    ASSERT_GC_OBJECT_INHERITS(thisObject, info());
+    Base::visitChildren(thisObject, visitor);
+
+    visitor.append(thisObject->m_jsBuffer);
+
+    WTF::Locker locker { thisObject->cellLock() };
+    for (auto& promise : thisObject->m_pendingReads)
+        visitor.append(promise);
+}
+
+DEFINE_VISIT_CHILDREN(JSRingChannel);
+
+static JSRingChannel* jsRingChannelThis(JSGlobalObject* globalObject, ThrowScope& scope, JSValue thisValue, ASCIILiteral functionName)
+{
+    if (auto* channel = jsDynamicCast<JSRingChannel*>(thisValue); LIKELY(channel))
+        return channel;
+
+    throwThisTypeError(*globalObject, scope, JSRingChannel::info()->className, functionName);
+    return nullptr;
+}
+
+// Views and ArrayBuffers are copied in as they are, strings as UTF-8.
+template<typename Functor>
+static JSValue withMessageBytes(JSGlobalObject* globalObject, ThrowScope& scope, JSRingChannel* channel, JSValue message, const Functor& functor)
+{
+    std::span<const uint8_t> bytes;
+    CString utf8;
+    if (auto* view = jsDynamicCast<JSArrayBufferView*>(message)) {
+        if (UNLIKELY(view->isDetached()))
+            return throwTypeError(globalObject, scope, "Cannot write a detached buffer"_s);
+        bytes = view->span();
+    } else if (auto* arrayBuffer = jsDynamicCast<JSArrayBuffer*>(message)) {
+        auto* impl = arrayBuffer->impl();
+        if (UNLIKELY(!impl || impl->isDetached()))
+            return throwTypeError(globalObject, scope, "Cannot write a detached buffer"_s);
+        bytes = { static_cast<const uint8_t*>(impl->data()), impl->byteLength() };
+    } else if (message.isString()) {
+        auto string = message.toWTFString(globalObject);
+        RETURN_IF_EXCEPTION(scope, {});
+        utf8 = string.utf8();
+        bytes = { reinterpret_cast<const uint8_t*>(utf8.data()), utf8.length() };
+    } else {
+        Bun::ERR::INVALID_ARG_TYPE(scope, globalObject, "message"_s, "string, ArrayBuffer, or ArrayBufferView"_s, message);
+        return {};
+    }
+
+    if (UNLIKELY(messageSize(bytes.size()) > channel->capacity())) {
+        Bun::ERR::OUT_OF_RANGE(scope, globalObject, "message.byteLength"_s, 0, channel->capacity() - messageHeaderSize, jsNumber(bytes.size()));
+        return {};
+    }
+
+    RELEASE_AND_RETURN(scope, functor(bytes));
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsRingChannelPrototypeFunction_write, (JSGlobalObject * globalObject, CallFrame* callFrame))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, callFrame->thisValue(), "write"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+
+    return JSValue::encode(withMessageBytes(globalObject, scope, channel, callFrame->argument(0), [&](std::span<const uint8_t> bytes) -> JSValue {
+        auto result = channel->write(bytes);
+        if (UNLIKELY(result == JSRingChannel::WriteResult::Corrupted)) {
+            throwRingCorrupted(globalObject, scope);
+            return {};
+        }
+        return jsBoolean(result == JSRingChannel::WriteResult::Written);
+    }));
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsRingChannelPrototypeFunction_writeSync, (JSGlobalObject * globalObject, CallFrame* callFrame))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, callFrame->thisValue(), "writeSync"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+    MonotonicTime deadline = deadlineFromTimeout(globalObject, scope, callFrame->argument(1));
+    RETURN_IF_EXCEPTION(scope, {});
+
+    return JSValue::encode(withMessageBytes(globalObject, scope, channel, callFrame->argument(0), [&](std::span<const uint8_t> bytes) -> JSValue {
+        auto& header = channel->header();
+        for (;;) {
+            auto result = channel->write(bytes);
+            if (UNLIKELY(result == JSRingChannel::WriteResult::Corrupted)) {
+                throwRingCorrupted(globalObject, scope);
+                return {};
+            }
+            if (result != JSRingChannel::WriteResult::Full)
+                return jsBoolean(result == JSRingChannel::WriteResult::Written);
+
+            // Readers may have made room since write() looked
+            uint32_t head = header.head.load();
+            uint32_t used = header.tail.load() - head;
+            if (used <= channel->capacity() && channel->capacity() - used >= messageSize(bytes.size()))
+                continue;
+
+            if (!parkOnRing(vm, header.head, head, header.sleepingWriters, header.closed, deadline)) {
+                result = channel->write(bytes);
+                if (UNLIKELY(result == JSRingChannel::WriteResult::Corrupted)) {
+                    throwRingCorrupted(globalObject, scope);
+                    return {};
+                }
+                return jsBoolean(result == JSRingChannel::WriteResult::Written);
+            }
+        }
+    }));
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsRingChannelPrototypeFunction_tryRead, (JSGlobalObject * globalObject, CallFrame* callFrame))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, callFrame->thisValue(), "tryRead"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+
+    auto* bytes = channel->tryRead(globalObject);
+    RETURN_IF_EXCEPTION(scope, {});
+    return JSValue::encode(bytes ? JSValue(bytes) : jsNull());
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsRingChannelPrototypeFunction_readSync, (JSGlobalObject * globalObject, CallFrame* callFrame))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, callFrame->thisValue(), "readSync"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+    MonotonicTime deadline = deadlineFromTimeout(globalObject, scope, callFrame->argument(0));
+    RETURN_IF_EXCEPTION(scope, {});
+
+    auto& header = channel->header();
+    for (;;) {
+        auto* bytes = channel->tryRead(globalObject);
+        RETURN_IF_EXCEPTION(scope, {});
+        if (bytes)
+            return JSValue::encode(bytes);
+        if (header.closed.load())
+            return JSValue::encode(jsNull());
+
+        // A writer may have slipped in since tryRead() looked
+        uint32_t tail = header.tail.load();
+        if (tail != header.head.load())
+            continue;
+
+        if (!parkOnRing(vm, header.tail, tail, header.sleepingReaders, header.closed, deadline)) {
+            bytes = channel->tryRead(globalObject);
+            RETURN_IF_EXCEPTION(scope, {});
+            return JSValue::encode(bytes ? JSValue(bytes) : jsNull());
+        }
+    }
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsRingChannelPrototypeFunction_read, (JSGlobalObject * globalObject, CallFrame* callFrame))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, callFrame->thisValue(), "read"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+
+    auto* promise = JSPromise::create(vm, globalObject->promiseStructure());
+    auto* bytes = channel->tryRead(globalObject);
+    if (UNLIKELY(scope.exception()))
+        return JSValue::encode(promise->rejectWithCaughtException(globalObject, scope));
+
+    if (bytes)
+        promise->resolve(globalObject, bytes);
+    else if (channel->header().closed.load())
+        promise->resolve(globalObject, jsNull());
+    else
+        channel->enqueueRead(vm, promise);
+
+    return JSValue::encode(promise);
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsRingChannelPrototypeFunction_close, (JSGlobalObject * globalObject, CallFrame* callFrame))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, callFrame->thisValue(), "close"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+
+    channel->close();
+    return JSValue::encode(jsUndefined());
+}
+
+JSC_DEFINE_CUSTOM_GETTER(jsRingChannel_buffer, (JSGlobalObject * globalObject, EncodedJSValue thisValue, PropertyName))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, JSValue::decode(thisValue), "buffer"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+    return JSValue::encode(channel->jsBuffer(globalObject));
+}
+
+JSC_DEFINE_CUSTOM_GETTER(jsRingChannel_capacity, (JSGlobalObject * globalObject, EncodedJSValue thisValue, PropertyName))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, JSValue::decode(thisValue), "capacity"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+    return JSValue::encode(jsNumber(channel->capacity()));
+}
+
+JSC_DEFINE_CUSTOM_GETTER(jsRingChannel_byteLength, (JSGlobalObject * globalObject, EncodedJSValue thisValue, PropertyName))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, JSValue::decode(thisValue), "byteLength"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+    auto& header = channel->header();
+    uint32_t used = header.tail.load() - header.head.load();
+    return JSValue::encode(jsNumber(std::min(used, channel->capacity())));
+}
+
+JSC_DEFINE_CUSTOM_GETTER(jsRingChannel_closed, (JSGlobalObject * globalObject, EncodedJSValue thisValue, PropertyName))
+{
+    auto& vm = globalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* channel = jsRingChannelThis(globalObject, scope, JSValue::decode(thisValue), "closed"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+    return JSValue::encode(jsBoolean(channel->header().closed.load()));
+}
+
+const ClassInfo JSRingChannel::s_info = { "RingChannel"_s, &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(JSRingChannel) };
+
+JSC::GCClient::IsoSubspace* JSRingChannel::subspaceForImpl(JSC::VM& vm)
+{
+    return WebCore::subspaceForImpl<JSRingChannel, UseCustomHeapCellType::No>(
+        vm,
+        [](auto& spaces) { return spaces.m_clientSubspaceForRingChannel.get(); },
+        [](auto& spaces, auto&& space) { spaces.m_clientSubspaceForRingChannel = std::forward<decltype(space)>(space); },
+        [](auto& spaces) { return spaces.m_subspaceForRingChannel.get(); },
+        [](auto& spaces, auto&& space) { spaces.m_subspaceForRingChannel = std::forward<decltype(space)>(space); });
+}
+
+STATIC_ASSERT_ISO_SUBSPACE_SHARABLE(JSRingChannelPrototype, JSRingChannelPrototype::Base);
+
+static const HashTableValue JSRingChannelPrototypeTableValues[]
+    = {
+          { "buffer"_s, static_cast<unsigned>(JSC::PropertyAttribute::DontDelete | JSC::PropertyAttribute::ReadOnly | JSC::PropertyAttribute::CustomAccessor | JSC::PropertyAttribute::DOMAttribute), NoIntrinsic, { HashTableValue::GetterSetterType, jsRingChannel_buffer, 0 } },
+          { "capacity"_s, static_cast<unsigned>(JSC::PropertyAttribute::DontDelete | JSC::PropertyAttribute::ReadOnly | JSC::PropertyAttribute::CustomAccessor | JSC::PropertyAttribute::DOMAttribute), NoIntrinsic, { HashTableValue::GetterSetterType, jsRingChannel_capacity, 0 } },
+          { "byteLength"_s, static_cast<unsigned>(JSC::PropertyAttribute::DontDelete | JSC::PropertyAttribute::ReadOnly | JSC::PropertyAttribute::CustomAccessor | JSC::PropertyAttribute::DOMAttribute), NoIntrinsic, { HashTableValue::GetterSetterType, jsRingChannel_byteLength, 0 } },
+          { "closed"_s, static_cast<unsigned>(JSC::PropertyAttribute::DontDelete | JSC::PropertyAttribute::ReadOnly | JSC::PropertyAttribute::CustomAccessor | JSC::PropertyAttribute::DOMAttribute), NoIntrinsic, { HashTableValue::GetterSetterType, jsRingChannel_closed, 0 } },
+          { "write"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsRingChannelPrototypeFunction_write, 1 } },
+          { "writeSync"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsRingChannelPrototypeFunction_writeSync, 2 } },
+          { "tryRead"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsRingChannelPrototypeFunction_tryRead, 0 } },
+          { "readSync"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsRingChannelPrototypeFunction_readSync, 1 } },
+          { "read"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsRingChannelPrototypeFunction_read, 0 } },
+          { "close"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsRingChannelPrototypeFunction_close, 0 } },
+      };
+
+void JSRingChannelPrototype::finishCreation(VM& vm, JSC::JSGlobalObject* globalThis)
+{
+    Base::finishCreation(vm);
+    reifyStaticProperties(vm, JSRingChannel::info(), JSRingChannelPrototypeTableValues, *this);
+    JSC_TO_STRING_TAG_WITHOUT_TRANSITION();
+}
+
+const ClassInfo JSRingChannelPrototype::s_info = { "RingChannel"_s, &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(JSRingChannelPrototype) };
+
+void JSRingChannelConstructor::finishCreation(VM& vm, JSC::JSGlobalObject* globalObject, JSRingChannelPrototype* prototype)
+{
+    Base::finishCreation(vm, 1, "RingChannel"_s, PropertyAdditionMode::WithoutStructureTransition);
+    putDirectWithoutTransition(vm, vm.propertyNames->prototype, prototype, PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly);
+    ASSERT(inherits(info()));
+}
+
+JSRingChannelConstructor* JSRingChannelConstructor::create(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::Structure* structure, JSRingChannelPrototype* prototype)
+{
+    JSRingChannelConstructor* ptr = new (NotNull, JSC::allocateCell<JSRingChannelConstructor>(vm)) JSRingChannelConstructor(vm, structure, call, construct);
+    ptr->finishCreation(vm, globalObject, prototype);
+    return ptr;
+}
+
+JSC::EncodedJSValue JSRingChannelConstructor::call(JSC::JSGlobalObject* globalObject, JSC::CallFrame*)
+{
+    auto& vm = JSC::getVM(globalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    throwConstructorCannotBeCalledAsFunctionTypeError(globalObject, scope, "RingChannel"_s);
+    return {};
+}
+
+// new RingChannel(capacity) allocates a new ring; new RingChannel(channel.buffer) attaches to one
+// that was created on another thread and posted here.
+JSC::EncodedJSValue JSRingChannelConstructor::construct(JSC::JSGlobalObject* lexicalGlobalObject, JSC::CallFrame* callFrame)
+{
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* globalObject = defaultGlobalObject(lexicalGlobalObject);
+    JSValue argument = callFrame->argument(0);
+
+    if (auto* sharedBuffer = jsDynamicCast<JSArrayBuffer*>(argument)) {
+        RefPtr impl = sharedBuffer->impl();
+        if (!impl || !impl->isShared())
+            return Bun::ERR::INVALID_ARG_TYPE(scope, globalObject, "buffer"_s, "SharedArrayBuffer"_s, argument);
+        // The ring's layout is fixed when it is created, a buffer that can grow is not one of ours
+        if (impl->isResizableOrGrowableShared())
+            return Bun::ERR::INVALID_ARG_VALUE(scope, globalObject, "buffer"_s, argument, "is not a RingChannel buffer"_s);
+
+        size_t byteLength = impl->byteLength();
+        auto* header = byteLength >= sizeof(RingChannelHeader) ? static_cast<RingChannelHeader*>(impl->data()) : nullptr;
+        // The header lives in shared memory, so its capacity is read once and that copy is what we keep
+        uint32_t capacity = header ? header->capacity : 0;
+        if (!header || header->magic != RingChannelHeader::expectedMagic || capacity != byteLength - sizeof(RingChannelHeader) || !hasOneBitSet(capacity))
+            return Bun::ERR::INVALID_ARG_VALUE(scope, globalObject, "buffer"_s, argument, "is not a RingChannel buffer"_s);
+
+        auto* channel = JSRingChannel::create(vm, globalObject->JSRingChannelStructure(), impl.releaseNonNull(), capacity);
+        channel->jsBuffer(globalObject);
+        return JSValue::encode(channel);
+    }
+
+    double requested = defaultRingCapacity;
+    if (!argument.isUndefined()) {
+        requested = argument.toNumber(globalObject);
+        RETURN_IF_EXCEPTION(scope, {});
+        if (std::isnan(requested) || requested < minimumRingCapacity || requested > maximumRingCapacity)
+            return Bun::ERR::OUT_OF_RANGE(scope, globalObject, "capacity"_s, minimumRingCapacity, maximumRingCapacity, argument);
+    }
+    uint32_t capacity = roundUpToPowerOfTwo(static_cast<uint32_t>(std::ceil(requested)));
+
+    auto buffer = ArrayBuffer::tryCreate(sizeof(RingChannelHeader) + capacity, 1);
+    if (!buffer) {
+        throwOutOfMemoryError(globalObject, scope);
+        return {};
+    }
+    buffer->makeShared();
+
+    auto* header = static_cast<RingChannelHeader*>(buffer->data());
+    header->magic = RingChannelHeader::expectedMagic;
+    header->capacity = capacity;
+
+    return JSValue::encode(JSRingChannel::create(vm, globalObject->JSRingChannelStructure(), buffer.releaseNonNull(), capacity));
+}
+
+const ClassInfo JSRingChannelConstructor::s_info = { "RingChannel"_s, &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(JSRingChannelConstructor) };
+
+} // namespace WebCore
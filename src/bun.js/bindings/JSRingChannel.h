@@ -0,0 +1,150 @@
+#pragma once
+
+#include "root.h"
+#include <JavaScriptCore/ArrayBuffer.h>
+#include <JavaScriptCore/JSArrayBuffer.h>
+#include <span>
+
+namespace WebCore {
+using namespace JSC;
+
+struct RingChannelHeader;
+
+// A byte channel whose state lives entirely inside a SharedArrayBuffer, so every thread that
+// attaches to the same buffer talks to the same ring. Writes and reads copy straight in and out
+// of shared memory; nothing is serialized and no task is posted unless a reader is asleep.
+class JSRingChannel : public JSC::JSDestructibleObject {
+    using Base = JSC::JSDestructibleObject;
+
+public:
+    JSRingChannel(JSC::VM& vm, JSC::Structure* structure, Ref<JSC::ArrayBuffer>&& buffer, uint32_t capacity)
+        : Base(vm, structure)
+        , m_buffer(WTFMove(buffer))
+        , m_capacity(capacity)
+    {
+    }
+
+    DECLARE_INFO;
+    DECLARE_VISIT_CHILDREN;
+
+    static constexpr unsigned StructureFlags = Base::StructureFlags;
+
+    template<typename, JSC::SubspaceAccess mode> static JSC::GCClient::IsoSubspace* subspaceFor(JSC::VM& vm)
+    {
+        if constexpr (mode == JSC::SubspaceAccess::Concurrently)
+            return nullptr;
+        return subspaceForImpl(vm);
+    }
+
+    static JSC::GCClient::IsoSubspace* subspaceForImpl(JSC::VM& vm);
+
+    static JSC::Structure* createStructure(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::JSValue prototype)
+    {
+        return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::ObjectType, StructureFlags), info());
+    }
+
+    // capacity must already be checked against the buffer's fixed byte length
+    static JSRingChannel* create(JSC::VM& vm, JSC::Structure* structure, Ref<JSC::ArrayBuffer>&& buffer, uint32_t capacity)
+    {
+        JSRingChannel* channel = new (NotNull, JSC::allocateCell<JSRingChannel>(vm)) JSRingChannel(vm, structure, WTFMove(buffer), capacity);
+        channel->finishCreation(vm);
+        return channel;
+    }
+
+    ~JSRingChannel();
+
+    static void destroy(JSCell* thisObject)
+    {
+        static_cast<JSRingChannel*>(thisObject)->~JSRingChannel();
+    }
+
+    enum class WriteResult : uint8_t {
+        Written,
+        Full,
+        Closed,
+        // The writer lock stayed taken, the header was scribbled over
+        Corrupted,
+    };
+
+    RingChannelHeader& header() const;
+    // The header's capacity as validated when the channel was created, never re-read from shared memory.
+    uint32_t capacity() const;
+    JSC::JSArrayBuffer* jsBuffer(JSC::JSGlobalObject*);
+
+    WriteResult write(std::span<const uint8_t>);
+    // Returns nullptr when the ring is empty. Throws if the shared memory was scribbled over.
+    JSC::JSUint8Array* tryRead(JSC::JSGlobalObject*);
+    void close();
+
+    // Reads that found the ring empty wait here until a write or close() wakes this thread.
+    void enqueueRead(JSC::VM&, JSC::JSPromise*);
+    void settlePendingReads(JSC::JSGlobalObject*);
+
+private:
+    uint8_t* data() const;
+    void registerAsyncReader();
+
+    Ref<JSC::ArrayBuffer> m_buffer;
+    uint32_t m_capacity;
+    JSC::WriteBarrier<JSC::JSArrayBuffer> m_jsBuffer;
+    Vector<JSC::WriteBarrier<JSC::JSPromise>> m_pendingReads;
+};
+
+class JSRingChannelPrototype : public JSC::JSNonFinalObject {
+public:
+    using Base = JSC::JSNonFinalObject;
+    static JSRingChannelPrototype* create(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::Structure* structure)
+    {
+        JSRingChannelPrototype* ptr = new (NotNull, JSC::allocateCell<JSRingChannelPrototype>(vm)) JSRingChannelPrototype(vm, structure);
+        ptr->finishCreation(vm, globalObject);
+        return ptr;
+    }
+
+    DECLARE_INFO;
+    template<typename CellType, JSC::SubspaceAccess>
+    static JSC::GCClient::IsoSubspace* subspaceFor(JSC::VM& vm)
+    {
+        STATIC_ASSERT_ISO_SUBSPACE_SHARABLE(JSRingChannelPrototype, Base);
+        return &vm.plainObjectSpace();
+    }
+    static JSC::Structure* createStructure(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::JSValue prototype)
+    {
+        return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::ObjectType, StructureFlags), info());
+    }
+
+private:
+    JSRingChannelPrototype(JSC::VM& vm, JSC::Structure* structure)
+        : Base(vm, structure)
+    {
+    }
+
+    void finishCreation(JSC::VM&, JSC::JSGlobalObject*);
+};
+
+class JSRingChannelConstructor final : public JSC::InternalFunction {
+public:
+    using Base = JSC::InternalFunction;
+    static JSRingChannelConstructor* create(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::Structure* structure, JSRingChannelPrototype* prototype);
+
+    static constexpr unsigned StructureFlags = Base::StructureFlags;
+    static constexpr JSC::DestructionMode needsDestruction = DoesNotNeedDestruction;
+
+    static JSC::Structure* createStructure(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::JSValue prototype)
+    {
+        return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::InternalFunctionType, StructureFlags), info());
+    }
+
+    static JSC::EncodedJSValue JSC_HOST_CALL_ATTRIBUTES call(JSC::JSGlobalObject*, JSC::CallFrame*);
+    static JSC::EncodedJSValue JSC_HOST_CALL_ATTRIBUTES construct(JSC::JSGlobalObject*, JSC::CallFrame*);
+    DECLARE_EXPORT_INFO;
+
+private:
+    JSRingChannelConstructor(JSC::VM& vm, JSC::Structure* structure, JSC::NativeFunction call, JSC::NativeFunction construct)
+        : Base(vm, structure, call, construct)
+    {
+    }
+
+    void finishCreation(JSC::VM&, JSC::JSGlobalObject* globalObject, JSRingChannelPrototype* prototype);
+};
+
+}
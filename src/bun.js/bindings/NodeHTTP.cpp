@@ -21,6 +21,7 @@
 #include <JavaScriptCore/LazyPropertyInlines.h>
 #include <JavaScriptCore/VMTrapsInlines.h>
 #include "JSSocketAddressDTO.h"
+#include "NodeHTTPHeaderCache.h"
 
 extern "C" uint64_t uws_res_get_remote_address_info(void* res, const char** dest, int* port, bool* is_ipv6);
 
@@ -503,162 +504,136 @@ static EncodedJSValue assignHeadersFromFetchHeaders(FetchHeaders& impl, JSObject
     return JSValue::encode(tuple);
 }
 
-static void assignHeadersFromUWebSocketsForCall(uWS::HttpRequest* request, MarkedArgumentBuffer& args, JSC::JSGlobalObject* globalObject, JSC::VM& vm)
+// Builds IncomingMessage's headers object and rawHeaders array. Well-known names come from the
+// per-global cache, and a request whose names all are well-known reuses the Structure of the last
+// request with the same names in the same order, filling in values by offset.
+static std::pair<JSObject*, JSArray*> createHeadersFromUWebSockets(uWS::HttpRequest* request, JSObject* prototype, JSC::JSGlobalObject* lexicalGlobalObject, JSC::VM& vm)
 {
     auto scope = DECLARE_THROW_SCOPE(vm);
-    std::string_view fullURLStdStr = request->getFullUrl();
-    String fullURL = String::fromUTF8ReplacingInvalidSequences({ reinterpret_cast<const LChar*>(fullURLStdStr.data()), fullURLStdStr.length() });
-
-    // Get the URL.
-    {
-        args.append(jsString(vm, fullURL));
+    auto* globalObject = defaultGlobalObject(lexicalGlobalObject);
+    auto& cache = globalObject->nodeHTTPHeaderCache();
+
+    struct Header {
+        std::string_view name;
+        std::string_view value;
+        std::optional<HTTPHeaderName> knownName;
+    };
+    Vector<Header, 32> headers;
+    for (auto it = request->begin(); it != request->end(); ++it) {
+        auto pair = *it;
+        HTTPHeaderName name;
+        bool isKnown = WebCore::findHTTPHeaderName(StringView(std::span { reinterpret_cast<const LChar*>(pair.first.data()), pair.first.length() }), name);
+        headers.append({ pair.first, pair.second, isKnown ? std::optional { name } : std::nullopt });
     }
 
-    // Get the method.
-    {
-        std::string_view methodView = request->getMethod();
-        WTF::String methodString;
-        switch (methodView.length()) {
-        case 3: {
-            if (methodView == std::string_view("get", 3)) {
-                methodString = "GET"_s;
-                break;
-            }
-            if (methodView == std::string_view("put", 3)) {
-                methodString = "PUT"_s;
-                break;
-            }
-
+    size_t size = headers.size();
+    unsigned inlineCapacity = std::min(size, static_cast<size_t>(JSFinalObject::maxInlineCapacity));
+
+    // Offset of each well-known name in the headers object, in order of first appearance.
+    std::array<uint8_t, WebCore::numHTTPHeaderNames> slots;
+    slots.fill(UINT8_MAX);
+    NodeHTTPHeaderCache::Shape shape;
+    shape.inlineCapacity = inlineCapacity;
+    bool isCacheableShape = prototype == globalObject->objectPrototype();
+    for (const auto& header : headers) {
+        if (!isCacheableShape)
             break;
-        }
-        case 4: {
-            if (methodView == std::string_view("post", 4)) {
-                methodString = "POST"_s;
-                break;
-            }
-            if (methodView == std::string_view("head", 4)) {
-                methodString = "HEAD"_s;
-                break;
-            }
-
-            if (methodView == std::string_view("copy", 4)) {
-                methodString = "COPY"_s;
-                break;
-            }
-        }
-
-        case 5: {
-            if (methodView == std::string_view("patch", 5)) {
-                methodString = "PATCH"_s;
-                break;
-            }
-            if (methodView == std::string_view("merge", 5)) {
-                methodString = "MERGE"_s;
-                break;
-            }
-            if (methodView == std::string_view("trace", 5)) {
-                methodString = "TRACE"_s;
-                break;
-            }
-            if (methodView == std::string_view("fetch", 5)) {
-                methodString = "FETCH"_s;
-                break;
-            }
-            if (methodView == std::string_view("purge", 5)) {
-                methodString = "PURGE"_s;
-                break;
-            }
-
+        if (!header.knownName) {
+            isCacheableShape = false;
             break;
         }
-
-        case 6: {
-            if (methodView == std::string_view("delete", 6)) {
-                methodString = "DELETE"_s;
-                break;
-            }
-
+        auto& slot = slots[static_cast<size_t>(*header.knownName)];
+        if (slot != UINT8_MAX)
+            continue;
+        if (shape.length == NodeHTTPHeaderCache::maxShapeLength) {
+            isCacheableShape = false;
             break;
         }
-
-        case 7: {
-            if (methodView == std::string_view("connect", 7)) {
-                methodString = "CONNECT"_s;
-                break;
-            }
-            if (methodView == std::string_view("options", 7)) {
-                methodString = "OPTIONS"_s;
-                break;
-            }
-
-            break;
-        }
-        }
-
-        if (methodString.isNull()) {
-            methodString = String::fromUTF8ReplacingInvalidSequences({ reinterpret_cast<const LChar*>(methodView.data()), methodView.length() });
-        }
-
-        args.append(jsString(vm, methodString));
-    }
-
-    size_t size = 0;
-    for (auto it = request->begin(); it != request->end(); ++it) {
-        size++;
+        slot = shape.length;
+        shape.names[shape.length++] = *header.knownName;
     }
 
-    JSC::JSObject* headersObject = JSC::constructEmptyObject(globalObject, globalObject->objectPrototype(), std::min(size, static_cast<size_t>(JSFinalObject::maxInlineCapacity)));
-    RETURN_IF_EXCEPTION(scope, void());
-    JSC::JSArray* array = constructEmptyArray(globalObject, nullptr, size * 2);
+    Structure* structure = isCacheableShape ? cache.structureForShape(shape) : nullptr;
+    JSC::JSObject* headersObject = structure
+        ? JSC::constructEmptyObject(vm, structure)
+        : JSC::constructEmptyObject(lexicalGlobalObject, prototype, inlineCapacity);
+    RETURN_IF_EXCEPTION(scope, {});
+    JSC::JSArray* array = constructEmptyArray(lexicalGlobalObject, nullptr, size * 2);
+    RETURN_IF_EXCEPTION(scope, {});
     JSC::JSArray* setCookiesHeaderArray = nullptr;
     JSC::JSString* setCookiesHeaderString = nullptr;
 
-    args.append(headersObject);
-    args.append(array);
-
     unsigned i = 0;
-
-    for (auto it = request->begin(); it != request->end(); ++it) {
-        auto pair = *it;
-        StringView nameView = StringView(std::span { reinterpret_cast<const LChar*>(pair.first.data()), pair.first.length() });
+    for (const auto& header : headers) {
         std::span<LChar> data;
-        auto value = String::createUninitialized(pair.second.length(), data);
-        if (pair.second.length() > 0)
-            memcpy(data.data(), pair.second.data(), pair.second.length());
+        auto value = String::tryCreateUninitialized(header.value.length(), data);
+        if (UNLIKELY(value.isNull())) {
+            throwOutOfMemoryError(lexicalGlobalObject, scope);
+            return {};
+        }
+        if (header.value.length() > 0)
+            memcpy(data.data(), header.value.data(), header.value.length());
+        JSString* jsValue = jsString(vm, value);
 
-        HTTPHeaderName name;
         WTF::String nameString;
-        WTF::String lowercasedNameString;
+        if (!header.knownName)
+            nameString = StringView(std::span { reinterpret_cast<const LChar*>(header.name.data()), header.name.length() }).toString();
+        JSString* jsName = header.knownName ? cache.nameString(vm, globalObject, *header.knownName) : jsString(vm, nameString);
+        Identifier identifier = header.knownName ? cache.nameIdentifier(vm, *header.knownName) : Identifier::fromString(vm, nameString.convertToASCIILowercase());
 
-        if (WebCore::findHTTPHeaderName(nameView, name)) {
-            nameString = WTF::httpHeaderNameStringImpl(name);
-            lowercasedNameString = nameString;
+        if (header.knownName == WebCore::HTTPHeaderName::SetCookie) {
+            if (!setCookiesHeaderArray) {
+                setCookiesHeaderArray = constructEmptyArray(lexicalGlobalObject, nullptr);
+                RETURN_IF_EXCEPTION(scope, {});
+                setCookiesHeaderString = jsName;
+                if (structure)
+                    headersObject->putDirectOffset(vm, slots[static_cast<size_t>(*header.knownName)], setCookiesHeaderArray);
+                else
+                    headersObject->putDirect(vm, identifier, setCookiesHeaderArray, 0);
+            }
+            array->putDirectIndex(lexicalGlobalObject, i++, setCookiesHeaderString);
+            array->putDirectIndex(lexicalGlobalObject, i++, jsValue);
+            setCookiesHeaderArray->push(lexicalGlobalObject, jsValue);
+            RETURN_IF_EXCEPTION(scope, {});
         } else {
-            nameString = nameView.toString();
-            lowercasedNameString = nameString.convertToASCIILowercase();
+            if (structure)
+                headersObject->putDirectOffset(vm, slots[static_cast<size_t>(*header.knownName)], jsValue);
+            else
+                headersObject->putDirect(vm, identifier, jsValue, 0);
+            array->putDirectIndex(lexicalGlobalObject, i++, jsName);
+            array->putDirectIndex(lexicalGlobalObject, i++, jsValue);
+            RETURN_IF_EXCEPTION(scope, {});
         }
+    }
 
-        JSString* jsValue = jsString(vm, value);
+    if (isCacheableShape && !structure)
+        cache.addStructureForShape(vm, globalObject, shape, headersObject->structure());
 
-        if (name == WebCore::HTTPHeaderName::SetCookie) {
-            if (!setCookiesHeaderArray) {
-                setCookiesHeaderArray = constructEmptyArray(globalObject, nullptr);
-                setCookiesHeaderString = jsString(vm, nameString);
-                headersObject->putDirect(vm, Identifier::fromString(vm, lowercasedNameString), setCookiesHeaderArray, 0);
-                RETURN_IF_EXCEPTION(scope, void());
-            }
-            array->putDirectIndex(globalObject, i++, setCookiesHeaderString);
-            array->putDirectIndex(globalObject, i++, jsValue);
-            setCookiesHeaderArray->push(globalObject, jsValue);
-            RETURN_IF_EXCEPTION(scope, void());
+    return { headersObject, array };
+}
 
-        } else {
-            headersObject->putDirect(vm, Identifier::fromString(vm, lowercasedNameString), jsValue, 0);
-            array->putDirectIndex(globalObject, i++, jsString(vm, nameString));
-            array->putDirectIndex(globalObject, i++, jsValue);
-            RETURN_IF_EXCEPTION(scope, void());
-        }
+static void assignHeadersFromUWebSocketsForCall(uWS::HttpRequest* request, MarkedArgumentBuffer& args, JSC::JSGlobalObject* globalObject, JSC::VM& vm)
+{
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    std::string_view fullURLStdStr = request->getFullUrl();
+    String fullURL = String::fromUTF8ReplacingInvalidSequences({ reinterpret_cast<const LChar*>(fullURLStdStr.data()), fullURLStdStr.length() });
+
+    // Get the URL.
+    {
+        args.append(jsString(vm, fullURL));
+    }
+
+    // Get the method.
+    {
+        auto* zigGlobalObject = defaultGlobalObject(globalObject);
+        args.append(zigGlobalObject->nodeHTTPHeaderCache().methodString(vm, zigGlobalObject, request->getMethod()));
     }
+
+    auto [headersObject, array] = createHeadersFromUWebSockets(request, globalObject->objectPrototype(), globalObject, vm);
+    RETURN_IF_EXCEPTION(scope, void());
+
+    args.append(headersObject);
+    args.append(array);
 }
 
 // This is an 8% speedup.
@@ -677,150 +652,14 @@ static EncodedJSValue assignHeadersFromUWebSockets(uWS::HttpRequest* request, JS
 
     {
         PutPropertySlot slot(objectValue, false);
-        std::string_view methodView = request->getMethod();
-        WTF::String methodString;
-        switch (methodView.length()) {
-        case 3: {
-            if (methodView == std::string_view("get", 3)) {
-                methodString = "GET"_s;
-                break;
-            }
-            if (methodView == std::string_view("put", 3)) {
-                methodString = "PUT"_s;
-                break;
-            }
-
-            break;
-        }
-        case 4: {
-            if (methodView == std::string_view("post", 4)) {
-                methodString = "POST"_s;
-                break;
-            }
-            if (methodView == std::string_view("head", 4)) {
-                methodString = "HEAD"_s;
-                break;
-            }
-
-            if (methodView == std::string_view("copy", 4)) {
-                methodString = "COPY"_s;
-                break;
-            }
-        }
-
-        case 5: {
-            if (methodView == std::string_view("patch", 5)) {
-                methodString = "PATCH"_s;
-                break;
-            }
-            if (methodView == std::string_view("merge", 5)) {
-                methodString = "MERGE"_s;
-                break;
-            }
-            if (methodView == std::string_view("trace", 5)) {
-                methodString = "TRACE"_s;
-                break;
-            }
-            if (methodView == std::string_view("fetch", 5)) {
-                methodString = "FETCH"_s;
-                break;
-            }
-            if (methodView == std::string_view("purge", 5)) {
-                methodString = "PURGE"_s;
-                break;
-            }
-
-            break;
-        }
-
-        case 6: {
-            if (methodView == std::string_view("delete", 6)) {
-                methodString = "DELETE"_s;
-                break;
-            }
-
-            break;
-        }
-
-        case 7: {
-            if (methodView == std::string_view("connect", 7)) {
-                methodString = "CONNECT"_s;
-                break;
-            }
-            if (methodView == std::string_view("options", 7)) {
-                methodString = "OPTIONS"_s;
-                break;
-            }
-
-            break;
-        }
-        }
-
-        if (methodString.isNull()) {
-            methodString = String::fromUTF8ReplacingInvalidSequences({ reinterpret_cast<const LChar*>(methodView.data()), methodView.length() });
-        }
-        objectValue->put(objectValue, globalObject, builtinNames.methodPublicName(), jsString(vm, methodString), slot);
+        auto* zigGlobalObject = defaultGlobalObject(globalObject);
+        JSString* method = zigGlobalObject->nodeHTTPHeaderCache().methodString(vm, zigGlobalObject, request->getMethod());
+        objectValue->put(objectValue, globalObject, builtinNames.methodPublicName(), method, slot);
         RETURN_IF_EXCEPTION(scope, {});
     }
 
-    size_t size = 0;
-    for (auto it = request->begin(); it != request->end(); ++it) {
-        size++;
-    }
-
-    JSC::JSObject* headersObject = JSC::constructEmptyObject(globalObject, prototype, std::min(size, static_cast<size_t>(JSFinalObject::maxInlineCapacity)));
+    auto [headersObject, array] = createHeadersFromUWebSockets(request, prototype, globalObject, vm);
     RETURN_IF_EXCEPTION(scope, {});
-    JSC::JSArray* array = constructEmptyArray(globalObject, nullptr, size * 2);
-    JSC::JSArray* setCookiesHeaderArray = nullptr;
-    JSC::JSString* setCookiesHeaderString = nullptr;
-
-    unsigned i = 0;
-
-    for (auto it = request->begin(); it != request->end(); ++it) {
-        auto pair = *it;
-        StringView nameView = StringView(std::span { reinterpret_cast<const LChar*>(pair.first.data()), pair.first.length() });
-        std::span<LChar> data;
-        auto value = String::tryCreateUninitialized(pair.second.length(), data);
-        if (UNLIKELY(value.isNull())) {
-            throwOutOfMemoryError(globalObject, scope);
-            return JSValue::encode({});
-        }
-        if (pair.second.length() > 0)
-            memcpy(data.data(), pair.second.data(), pair.second.length());
-
-        HTTPHeaderName name;
-        WTF::String nameString;
-        WTF::String lowercasedNameString;
-
-        if (WebCore::findHTTPHeaderName(nameView, name)) {
-            nameString = WTF::httpHeaderNameStringImpl(name);
-            lowercasedNameString = nameString;
-        } else {
-            nameString = nameView.toString();
-            lowercasedNameString = nameString.convertToASCIILowercase();
-        }
-
-        JSString* jsValue = jsString(vm, value);
-
-        if (name == WebCore::HTTPHeaderName::SetCookie) {
-            if (!setCookiesHeaderArray) {
-                setCookiesHeaderArray = constructEmptyArray(globalObject, nullptr);
-                setCookiesHeaderString = jsString(vm, nameString);
-                headersObject->putDirect(vm, Identifier::fromString(vm, lowercasedNameString), setCookiesHeaderArray, 0);
-                RETURN_IF_EXCEPTION(scope, {});
-            }
-            array->putDirectIndex(globalObject, i++, setCookiesHeaderString);
-            array->putDirectIndex(globalObject, i++, jsValue);
-            setCookiesHeaderArray->push(globalObject, jsValue);
-            RETURN_IF_EXCEPTION(scope, {});
-
-        } else {
-            headersObject->putDirect(vm, Identifier::fromString(vm, lowercasedNameString), jsValue, 0);
-            array->putDirectIndex(globalObject, i++, jsString(vm, nameString));
-            array->putDirectIndex(globalObject, i++, jsValue);
-            RETURN_IF_EXCEPTION(scope, {});
-        }
-    }
 
     tuple->putInternalField(vm, 0, headersObject);
     tuple->putInternalField(vm, 1, array);
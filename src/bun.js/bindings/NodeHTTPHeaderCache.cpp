@@ -0,0 +1,104 @@
+#include "root.h"
+#include "NodeHTTPHeaderCache.h"
+#include <JavaScriptCore/JSCInlines.h>
+#include <JavaScriptCore/SlotVisitorInlines.h>
+
+namespace Bun {
+using namespace JSC;
+
+// uWS lower-cases the method, Node reports it upper-cased.
+static constexpr std::pair<std::string_view, ASCIILiteral> standardMethods[] = {
+    { "get", "GET"_s },
+    { "post", "POST"_s },
+    { "put", "PUT"_s },
+    { "delete", "DELETE"_s },
+    { "head", "HEAD"_s },
+    { "options", "OPTIONS"_s },
+    { "patch", "PATCH"_s },
+    { "connect", "CONNECT"_s },
+    { "trace", "TRACE"_s },
+    { "copy", "COPY"_s },
+    { "merge", "MERGE"_s },
+    { "fetch", "FETCH"_s },
+    { "purge", "PURGE"_s },
+};
+
+unsigned NodeHTTPHeaderCache::Shape::hash() const
+{
+    // FNV-1a
+    unsigned hash = 2166136261u;
+    hash = (hash ^ inlineCapacity) * 16777619u;
+    for (auto name : span())
+        hash = (hash ^ static_cast<uint8_t>(name)) * 16777619u;
+    return hash;
+}
+
+const Identifier& NodeHTTPHeaderCache::nameIdentifier(VM& vm, WebCore::HTTPHeaderName name)
+{
+    auto& identifier = m_identifiers[static_cast<size_t>(name)];
+    if (UNLIKELY(identifier.isNull()))
+        identifier = Identifier::fromString(vm, WTF::httpHeaderNameStringImpl(name));
+    return identifier;
+}
+
+JSString* NodeHTTPHeaderCache::nameString(VM& vm, JSGlobalObject* owner, WebCore::HTTPHeaderName name)
+{
+    auto& string = m_names[static_cast<size_t>(name)];
+    if (UNLIKELY(!string))
+        string.set(vm, owner, jsString(vm, nameIdentifier(vm, name).string()));
+    return string.get();
+}
+
+JSString* NodeHTTPHeaderCache::methodString(VM& vm, JSGlobalObject* owner, std::string_view method)
+{
+    static_assert(std::size(standardMethods) <= std::tuple_size_v<decltype(m_methods)>);
+    for (size_t i = 0; i < std::size(standardMethods); ++i) {
+        if (standardMethods[i].first != method)
+            continue;
+        auto& string = m_methods[i];
+        if (UNLIKELY(!string))
+            string.set(vm, owner, jsOwnedString(vm, String(standardMethods[i].second)));
+        return string.get();
+    }
+    return jsString(vm, String::fromUTF8ReplacingInvalidSequences({ reinterpret_cast<const LChar*>(method.data()), method.length() }));
+}
+
+Structure* NodeHTTPHeaderCache::structureForShape(const Shape& shape) const
+{
+    const auto& entry = m_shapes[shape.hash() % numberOfShapes];
+    if (!entry.structure || entry.shape.inlineCapacity != shape.inlineCapacity || entry.shape.length != shape.length)
+        return nullptr;
+    if (!std::ranges::equal(entry.shape.span(), shape.span()))
+        return nullptr;
+    return entry.structure.get();
+}
+
+void NodeHTTPHeaderCache::addStructureForShape(VM& vm, JSGlobalObject* owner, const Shape& shape, Structure* structure)
+{
+    if (structure->isDictionary() || structure->inlineCapacity() != shape.inlineCapacity)
+        return;
+    for (unsigned i = 0; i < shape.length; ++i) {
+        if (structure->get(vm, nameIdentifier(vm, shape.names[i])) != static_cast<PropertyOffset>(i))
+            return;
+    }
+
+    auto& entry = m_shapes[shape.hash() % numberOfShapes];
+    entry.shape = shape;
+    entry.structure.set(vm, owner, structure);
+}
+
+template<typename Visitor>
+void NodeHTTPHeaderCache::visit(Visitor& visitor)
+{
+    for (auto& name : m_names)
+        visitor.append(name);
+    for (auto& method : m_methods)
+        visitor.append(method);
+    for (auto& entry : m_shapes)
+        visitor.append(entry.structure);
+}
+
+template void NodeHTTPHeaderCache::visit(JSC::AbstractSlotVisitor&);
+template void NodeHTTPHeaderCache::visit(JSC::SlotVisitor&);
+
+} // namespace Bun
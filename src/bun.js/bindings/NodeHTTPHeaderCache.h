@@ -0,0 +1,65 @@
+#pragma once
+
+#include "root.h"
+#include "HTTPHeaderNames.h"
+#include <JavaScriptCore/JSObject.h>
+#include <JavaScriptCore/JSString.h>
+#include <JavaScriptCore/WriteBarrier.h>
+#include <array>
+#include <span>
+
+namespace Bun {
+
+// Per-global state that lets node:http build IncomingMessage's url, method, headers and rawHeaders
+// without allocating a name string or walking structure transitions per request.
+//
+// Well-known header names and request methods are atomized once and handed out as shared JSStrings.
+// The headers object's Structure is remembered per shape, i.e. the ordered list of distinct header
+// names, so a request shaped like an earlier one gets its object with every property already in
+// place and only the values left to store.
+class NodeHTTPHeaderCache {
+    WTF_MAKE_FAST_ALLOCATED;
+
+public:
+    // A request with more distinct headers than this always builds its object one property at a time.
+    static constexpr unsigned maxShapeLength = JSC::JSFinalObject::maxInlineCapacity;
+
+    struct Shape {
+        uint8_t inlineCapacity { 0 };
+        uint8_t length { 0 };
+        std::array<WebCore::HTTPHeaderName, maxShapeLength> names;
+
+        std::span<const WebCore::HTTPHeaderName> span() const { return std::span { names }.first(length); }
+        unsigned hash() const;
+    };
+
+    JSC::JSString* nameString(JSC::VM&, JSC::JSGlobalObject* owner, WebCore::HTTPHeaderName);
+    const JSC::Identifier& nameIdentifier(JSC::VM&, WebCore::HTTPHeaderName);
+
+    // Upper-cases the method uWS lower-cased, reusing one JSString for each standard method.
+    JSC::JSString* methodString(JSC::VM&, JSC::JSGlobalObject* owner, std::string_view method);
+
+    // A Structure whose properties are shape's names at offsets 0, 1, 2... or nullptr.
+    JSC::Structure* structureForShape(const Shape&) const;
+    // Remembers structure for shape if its properties sit at those offsets.
+    void addStructureForShape(JSC::VM&, JSC::JSGlobalObject* owner, const Shape&, JSC::Structure*);
+
+    template<typename Visitor>
+    void visit(Visitor&);
+
+private:
+    static constexpr unsigned numberOfShapes = 64;
+
+    struct ShapeEntry {
+        Shape shape;
+        JSC::WriteBarrier<JSC::Structure> structure;
+    };
+
+    std::array<JSC::WriteBarrier<JSC::JSString>, WebCore::numHTTPHeaderNames> m_names;
+    std::array<JSC::Identifier, WebCore::numHTTPHeaderNames> m_identifiers;
+    std::array<JSC::WriteBarrier<JSC::JSString>, 13> m_methods;
+    // Direct-mapped on the shape's hash; a new shape just replaces whatever was in its slot.
+    std::array<ShapeEntry, numberOfShapes> m_shapes;
+};
+
+} // namespace Bun
@@ -8,6 +8,7 @@
 #include "BunClientData.h"
 #include "EventLoopTask.h"
 #include "BunBroadcastChannelRegistry.h"
+#include "ZigGlobalObject.h"
 #include <wtf/LazyRef.h>
 extern "C" void Bun__startLoop(us_loop_t* loop);
 
@@ -39,6 +40,7 @@ ScriptExecutionContext::ScriptExecutionContext(JSC::VM* vm, JSC::JSGlobalObject*
     : m_vm(vm)
     , m_globalObject(globalObject)
     , m_identifier(initialIdentifier())
+    , m_mailbox(ScriptExecutionContextMailbox::create())
     , m_broadcastChannelRegistry([](auto& owner, auto& lazyRef) {
         lazyRef.set(BunBroadcastChannelRegistry::create());
     })
@@ -51,6 +53,7 @@ ScriptExecutionContext::ScriptExecutionContext(JSC::VM* vm, JSC::JSGlobalObject*
     : m_vm(vm)
     , m_globalObject(globalObject)
     , m_identifier(identifier == std::numeric_limits<int32_t>::max() ? ++lastUniqueIdentifier : identifier)
+    , m_mailbox(ScriptExecutionContextMailbox::create())
     , m_broadcastChannelRegistry([](auto& owner, auto& lazyRef) {
         lazyRef.set(BunBroadcastChannelRegistry::create());
     })
@@ -134,6 +137,8 @@ ScriptExecutionContext::~ScriptExecutionContext()
     m_inScriptExecutionContextDestructor = true;
 #endif // ASSERT_ENABLED
 
+    m_mailbox->detach();
+
     auto postMessageCompletionHandlers = WTFMove(m_processMessageWithMessagePortsSoonHandlers);
     for (auto& completionHandler : postMessageCompletionHandlers)
         completionHandler();
@@ -147,17 +152,124 @@ ScriptExecutionContext::~ScriptExecutionContext()
 }
 
 bool ScriptExecutionContext::postTaskTo(ScriptExecutionContextIdentifier identifier, Function<void(ScriptExecutionContext&)>&& task)
+{
+    auto mailbox = mailboxFor(identifier);
+    if (!mailbox)
+        return false;
+
+    return mailbox->post(WTFMove(task));
+}
+
+RefPtr<ScriptExecutionContextMailbox> ScriptExecutionContext::mailboxFor(ScriptExecutionContextIdentifier identifier)
 {
     Locker locker { allScriptExecutionContextsMapLock };
     auto* context = allScriptExecutionContextsMap().get(identifier);
-
     if (!context)
+        return nullptr;
+
+    return &context->mailbox();
+}
+
+ScriptExecutionContextMailbox::~ScriptExecutionContextMailbox()
+{
+    deleteNodes(m_head.exchange(nullptr, std::memory_order_acquire));
+}
+
+void ScriptExecutionContextMailbox::deleteNodes(Node* node)
+{
+    while (node) {
+        auto* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+bool ScriptExecutionContextMailbox::post(Function<void(ScriptExecutionContext&)>&& task)
+{
+    if (!m_isAttached.load(std::memory_order_acquire))
         return false;
 
-    context->postTaskConcurrently(WTFMove(task));
+    auto* node = new Node;
+    node->task = WTFMove(task);
+
+    Node* head = m_head.load(std::memory_order_relaxed);
+    do {
+        node->next = head;
+    } while (!m_head.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+
+    // The post that made the mailbox non-empty owes the context its one wakeup, later posts
+    // ride along until the drain takes the whole list.
+    if (!head)
+        scheduleDrain();
+
     return true;
 }
 
+void ScriptExecutionContextMailbox::scheduleDrain()
+{
+    Node* orphans = nullptr;
+    {
+        // Holding the lock keeps the context from being removed while we queue onto its loop.
+        Locker locker { m_contextLock };
+        if (m_context) {
+            m_context->postTaskConcurrently([protectedThis = Ref { *this }](ScriptExecutionContext& context) {
+                protectedThis->drain(context);
+            });
+            return;
+        }
+
+        orphans = m_head.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    deleteNodes(orphans);
+}
+
+void ScriptExecutionContextMailbox::drain(ScriptExecutionContext& context)
+{
+    Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+    // Posts from any one thread must run in the order they were made.
+    Node* ordered = nullptr;
+    while (node) {
+        auto* next = node->next;
+        node->next = ordered;
+        ordered = node;
+        node = next;
+    }
+
+    // Only the wakeup is shared. Each task still runs like its own event loop task, with the
+    // microtasks it queued settled before the next one starts.
+    while (ordered) {
+        if (!m_isAttached.load(std::memory_order_acquire) || context.isJSExecutionForbidden() || context.vm().hasTerminationRequest()) {
+            // The context is going away, what is left would never be delivered anyway
+            deleteNodes(ordered);
+            return;
+        }
+
+        auto* next = ordered->next;
+        ordered->task(context);
+        delete ordered;
+        ordered = next;
+
+        if (auto* globalObject = context.jsGlobalObject())
+            defaultGlobalObject(globalObject)->drainMicrotasks();
+    }
+}
+
+void ScriptExecutionContextMailbox::attach(ScriptExecutionContext& context)
+{
+    Locker locker { m_contextLock };
+    m_context = &context;
+    m_isAttached.store(true, std::memory_order_release);
+}
+
+void ScriptExecutionContextMailbox::detach()
+{
+    Locker locker { m_contextLock };
+    m_context = nullptr;
+    m_isAttached.store(false, std::memory_order_release);
+}
+
 void ScriptExecutionContext::didCreateDestructionObserver(ContextDestructionObserver& observer)
 {
 #if ASSERT_ENABLED
@@ -197,10 +309,8 @@ bool ScriptExecutionContext::ensureOnContextThread(ScriptExecutionContextIdentif
         if (!context)
             return false;
 
-        if (!context->isContextThread()) {
-            context->postTaskConcurrently(WTFMove(task));
-            return true;
-        }
+        if (!context->isContextThread())
+            return context->mailbox().post(WTFMove(task));
     }
 
     task(*context);
@@ -215,8 +325,7 @@ bool ScriptExecutionContext::ensureOnMainThread(Function<void(ScriptExecutionCon
         return false;
     }
 
-    context->postTaskConcurrently(WTFMove(task));
-    return true;
+    return context->mailbox().post(WTFMove(task));
 }
 
 ScriptExecutionContext* ScriptExecutionContext::getMainThreadScriptExecutionContext()
@@ -347,6 +456,7 @@ void ScriptExecutionContext::addToContextsMap()
     Locker locker { allScriptExecutionContextsMapLock };
     ASSERT(!allScriptExecutionContextsMap().contains(m_identifier));
     allScriptExecutionContextsMap().add(m_identifier, this);
+    m_mailbox->attach(*this);
 }
 
 void ScriptExecutionContext::removeFromContextsMap()
@@ -354,6 +464,7 @@ void ScriptExecutionContext::removeFromContextsMap()
     Locker locker { allScriptExecutionContextsMapLock };
     ASSERT(allScriptExecutionContextsMap().contains(m_identifier));
     allScriptExecutionContextsMap().remove(m_identifier);
+    m_mailbox->detach();
 }
 
 ScriptExecutionContext* executionContext(JSC::JSGlobalObject* globalObject)
@@ -13,6 +13,9 @@
 #include "wtf/ThreadSafeWeakPtr.h"
 #include <wtf/URL.h>
 #include <wtf/LazyRef.h>
+#include <wtf/Lock.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <atomic>
 
 namespace uWS {
 template<bool isServer, bool isClient, typename UserData>
@@ -36,6 +39,46 @@ class ContextDestructionObserver;
 
 using ScriptExecutionContextIdentifier = uint32_t;
 
+// Tasks posted to a context from other threads. Senders hold on to the mailbox instead of
+// looking the context up by identifier for every post, and pushing is a single atomic
+// exchange. Only the post that finds the mailbox empty wakes the context's event loop; the
+// drain then runs everything that arrived in the meantime.
+class ScriptExecutionContextMailbox : public ThreadSafeRefCounted<ScriptExecutionContextMailbox> {
+    WTF_MAKE_FAST_ALLOCATED;
+
+public:
+    static Ref<ScriptExecutionContextMailbox> create() { return adoptRef(*new ScriptExecutionContextMailbox); }
+    ~ScriptExecutionContextMailbox();
+
+    // Returns false once the context has gone away, like ScriptExecutionContext::postTaskTo().
+    bool post(Function<void(ScriptExecutionContext&)>&&);
+
+private:
+    friend class ScriptExecutionContext;
+
+    struct Node {
+        WTF_MAKE_FAST_ALLOCATED;
+
+    public:
+        Function<void(ScriptExecutionContext&)> task;
+        Node* next { nullptr };
+    };
+
+    ScriptExecutionContextMailbox() = default;
+
+    void attach(ScriptExecutionContext&);
+    void detach();
+    void scheduleDrain();
+    void drain(ScriptExecutionContext&);
+    static void deleteNodes(Node*);
+
+    // Newest first; the drain reverses it.
+    std::atomic<Node*> m_head { nullptr };
+    std::atomic<bool> m_isAttached { false };
+    Lock m_contextLock;
+    ScriptExecutionContext* m_context WTF_GUARDED_BY_LOCK(m_contextLock) { nullptr };
+};
+
 #if ENABLE(MALLOC_BREAKDOWN)
 DECLARE_ALLOCATOR_WITH_HEAP_IDENTIFIER(ScriptExecutionContext);
 #endif
@@ -108,6 +151,9 @@ public:
     WEBCORE_EXPORT static bool postTaskTo(ScriptExecutionContextIdentifier identifier, Function<void(ScriptExecutionContext&)>&& task);
     WEBCORE_EXPORT static bool ensureOnContextThread(ScriptExecutionContextIdentifier, Function<void(ScriptExecutionContext&)>&& task);
     WEBCORE_EXPORT static bool ensureOnMainThread(Function<void(ScriptExecutionContext&)>&& task);
+    // Resolves the identifier once so that repeated posts skip the contexts map.
+    static RefPtr<ScriptExecutionContextMailbox> mailboxFor(ScriptExecutionContextIdentifier);
+    ScriptExecutionContextMailbox& mailbox() { return m_mailbox.get(); }
 
     WEBCORE_EXPORT JSC::JSGlobalObject* globalObject();
 
@@ -162,6 +208,7 @@ private:
     JSC::JSGlobalObject* m_globalObject = nullptr;
     WTF::URL m_url = WTF::URL();
     ScriptExecutionContextIdentifier m_identifier;
+    Ref<ScriptExecutionContextMailbox> m_mailbox;
 
     UncheckedKeyHashSet<MessagePort*> m_messagePorts;
     UncheckedKeyHashSet<ContextDestructionObserver*> m_destructionObservers;
@@ -116,6 +116,7 @@
 #include "JSSocketAddressDTO.h"
 #include "JSSQLStatement.h"
 #include "JSStringDecoder.h"
+#include "JSRingChannel.h"
 #include "JSTextEncoder.h"
 #include "JSTextEncoderStream.h"
 #include "JSTextDecoderStream.h"
@@ -134,6 +135,7 @@
 #include "napi_type_tag.h"
 #include "napi.h"
 #include "NodeHTTP.h"
+#include "NodeHTTPHeaderCache.h"
 #include "NodeVM.h"
 #include "Performance.h"
 #include "ProcessBindingConstants.h"
@@ -3474,6 +3476,18 @@ void GlobalObject::finishCreation(VM& vm)
             init.setConstructor(constructor);
         });
 
+    m_JSRingChannelClassStructure.initLater(
+        [](LazyClassStructure::Initializer& init) {
+            auto* prototype = JSRingChannelPrototype::create(
+                init.vm, init.global, JSRingChannelPrototype::createStructure(init.vm, init.global, init.global->objectPrototype()));
+            auto* structure = JSRingChannel::createStructure(init.vm, init.global, prototype);
+            auto* constructor = JSRingChannelConstructor::create(
+                init.vm, init.global, JSRingChannelConstructor::createStructure(init.vm, init.global, init.global->functionPrototype()), prototype);
+            init.setPrototype(prototype);
+            init.setStructure(structure);
+            init.setConstructor(constructor);
+        });
+
     m_JSFFIFunctionStructure.initLater(
         [](LazyClassStructure::Initializer& init) {
             init.setStructure(Zig::JSFFIFunction::createStructure(init.vm, init.global, init.global->functionPrototype()));
@@ -3988,6 +4002,8 @@ void GlobalObject::visitChildrenImpl(JSCell* cell, Visitor& visitor)
     thisObject->m_builtinInternalFunctions.visit(visitor);
     thisObject->m_commonStrings.visit<Visitor>(visitor);
     thisObject->m_http2_commongStrings.visit<Visitor>(visitor);
+    if (thisObject->m_nodeHTTPHeaderCache)
+        thisObject->m_nodeHTTPHeaderCache->visit<Visitor>(visitor);
     visitor.append(thisObject->m_assignToStream);
     visitor.append(thisObject->m_readableStreamToArrayBuffer);
     visitor.append(thisObject->m_readableStreamToArrayBufferResolve);
@@ -4046,6 +4062,7 @@ void GlobalObject::visitChildrenImpl(JSCell* cell, Visitor& visitor)
     thisObject->m_JSSQLStatementStructure.visit(visitor);
     thisObject->m_V8GlobalInternals.visit(visitor);
     thisObject->m_JSStringDecoderClassStructure.visit(visitor);
+    thisObject->m_JSRingChannelClassStructure.visit(visitor);
     thisObject->m_lazyPreloadTestModuleObject.visit(visitor);
     thisObject->m_lazyReadableStreamPrototypeMap.visit(visitor);
     thisObject->m_lazyRequireCacheObject.visit(visitor);
@@ -4156,6 +4173,13 @@ RefPtr<Performance> GlobalObject::performance()
     return m_performance;
 }
 
+Bun::NodeHTTPHeaderCache& GlobalObject::nodeHTTPHeaderCache()
+{
+    if (!m_nodeHTTPHeaderCache)
+        m_nodeHTTPHeaderCache = makeUnique<Bun::NodeHTTPHeaderCache>();
+    return *m_nodeHTTPHeaderCache;
+}
+
 void GlobalObject::queueTask(WebCore::EventLoopTask* task)
 {
     Bun__queueTask(this, task);
@@ -30,6 +30,7 @@ class Performance;
 namespace Bun {
 class InternalModuleRegistry;
 class NapiHandleScopeImpl;
+class NodeHTTPHeaderCache;
 } // namespace Bun
 
 namespace v8 {
@@ -226,6 +227,9 @@ public:
     JSC::JSObject* JSStringDecoder() const { return m_JSStringDecoderClassStructure.constructorInitializedOnMainThread(this); }
     JSC::JSValue JSStringDecoderPrototype() const { return m_JSStringDecoderClassStructure.prototypeInitializedOnMainThread(this); }
 
+    JSC::Structure* JSRingChannelStructure() const { return m_JSRingChannelClassStructure.getInitializedOnMainThread(this); }
+    JSC::JSObject* JSRingChannel() const { return m_JSRingChannelClassStructure.constructorInitializedOnMainThread(this); }
+
     JSC::Structure* NodeVMScriptStructure() const { return m_NodeVMScriptClassStructure.getInitializedOnMainThread(this); }
     JSC::JSObject* NodeVMScript() const { return m_NodeVMScriptClassStructure.constructorInitializedOnMainThread(this); }
     JSC::JSValue NodeVMScriptPrototype() const { return m_NodeVMScriptClassStructure.prototypeInitializedOnMainThread(this); }
@@ -490,6 +494,15 @@ public:
 
     Bun::CommonStrings& commonStrings() { return m_commonStrings; }
     Bun::Http2CommonStrings& http2CommonStrings() { return m_http2_commongStrings; }
+    Bun::NodeHTTPHeaderCache& nodeHTTPHeaderCache();
+
+    // Node's Buffer pool: small Buffer.allocUnsafe() and Buffer.from(string) results are slices
+    // of this ArrayBuffer. m_bufferPoolSize mirrors Buffer.poolSize and is read when the next
+    // pool is created.
+    RefPtr<JSC::ArrayBuffer> m_bufferPool;
+    size_t m_bufferPoolOffset { 0 };
+    uint32_t m_bufferPoolSize { 8 * 1024 };
+
 #include "ZigGeneratedClasses+lazyStructureHeader.h"
 
     void finishCreation(JSC::VM&);
@@ -506,6 +519,7 @@ private:
     Ref<WebCore::DOMWrapperWorld> m_world;
     Bun::CommonStrings m_commonStrings;
     Bun::Http2CommonStrings m_http2_commongStrings;
+    std::unique_ptr<Bun::NodeHTTPHeaderCache> m_nodeHTTPHeaderCache;
     RefPtr<WebCore::Performance> m_performance { nullptr };
 
     // JSC's hashtable code-generator tries to access these properties, so we make them public.
@@ -530,6 +544,7 @@ public:
     LazyClassStructure m_JSNetworkSinkClassStructure;
 
     LazyClassStructure m_JSStringDecoderClassStructure;
+    LazyClassStructure m_JSRingChannelClassStructure;
     LazyClassStructure m_NapiClassStructure;
     LazyClassStructure m_callSiteStructure;
     LazyClassStructure m_JSBufferClassStructure;
@@ -15,6 +15,12 @@
 #include <JavaScriptCore/SourceCodeKey.h>
 #include <mimalloc.h>
 #include <JavaScriptCore/CodeCache.h>
+#include <wtf/Condition.h>
+#include <wtf/FileSystem.h>
+#include <wtf/Lock.h>
+#include <wtf/ProcessID.h>
+#include <wtf/SHA1.h>
+#include <wtf/WorkQueue.h>
 
 extern "C" void RefString__free(void*, void*, unsigned);
 
@@ -72,6 +78,10 @@ extern "C" bool BunTest__shouldGenerateCodeCoverage(BunString sourceURL);
 extern "C" void Bun__addSourceProviderSourceMap(void* bun_vm, SourceProvider* opaque_source_provider, BunString* specifier);
 extern "C" void Bun__removeSourceProviderSourceMap(void* bun_vm, SourceProvider* opaque_source_provider, BunString* specifier);
 
+static RefPtr<JSC::CachedBytecode> readBytecodeCache(const String& path);
+static String bytecodeCachePath(const String& source, const String& sourceURL, SourceProviderSourceType);
+static void generateBytecodeCache(String&& path, const String& source, const String& sourceURL, SourceProviderSourceType);
+
 Ref<SourceProvider> SourceProvider::create(
     Zig::GlobalObject* globalObject,
     ResolvedSource& resolvedSource,
@@ -129,6 +139,14 @@ Ref<SourceProvider> SourceProvider::create(
 
     auto provider = getProvider();
 
+    if (!provider->m_cachedBytecode && !isBuiltin && !isCodeCoverageEnabled && !string.isEmpty()) {
+        if (auto path = bytecodeCachePath(string, sourceURLString, sourceType); !path.isNull()) {
+            provider->m_cachedBytecode = readBytecodeCache(path);
+            if (!provider->m_cachedBytecode)
+                generateBytecodeCache(WTFMove(path), string, sourceURLString, sourceType);
+        }
+    }
+
     if (shouldGenerateCodeCoverage) {
         ByteRangeMapping__generate(Bun::toString(provider->sourceURL()), Bun::toString(provider->source().toStringWithoutCopying()), provider->asID());
     }
@@ -171,28 +189,33 @@ static JSC::VM& getVMForBytecodeCache()
     return *vmForBytecodeCache;
 }
 
-extern "C" bool generateCachedModuleByteCodeFromSourceCode(BunString* sourceProviderURL, const LChar* inputSourceCode, size_t inputSourceCodeSize, const uint8_t** outputByteCode, size_t* outputByteCodeSize, JSC::CachedBytecode** cachedBytecodePtr)
+static RefPtr<JSC::CachedBytecode> generateCachedBytecode(const JSC::SourceCode& sourceCode, SourceProviderSourceType sourceType)
 {
-    std::span<const LChar> sourceCodeSpan(inputSourceCode, inputSourceCodeSize);
-    JSC::SourceCode sourceCode = JSC::makeSource(WTF::String(sourceCodeSpan), toSourceOrigin(sourceProviderURL->toWTFString(), false), JSC::SourceTaintedOrigin::Untainted);
-
     JSC::VM& vm = getVMForBytecodeCache();
 
     JSC::JSLockHolder locker(vm);
-    LexicallyScopedFeatures lexicallyScopedFeatures = StrictModeLexicallyScopedFeature;
-    JSParserScriptMode scriptMode = JSParserScriptMode::Module;
     EvalContextType evalContextType = EvalContextType::None;
-
     ParserError parserError;
-    UnlinkedModuleProgramCodeBlock* unlinkedCodeBlock = JSC::recursivelyGenerateUnlinkedCodeBlockForModuleProgram(vm, sourceCode, lexicallyScopedFeatures, scriptMode, {}, parserError, evalContextType);
-    if (parserError.isValid())
-        return false;
-    if (!unlinkedCodeBlock)
-        return false;
 
-    auto key = JSC::sourceCodeKeyForSerializedModule(vm, sourceCode);
+    if (sourceType == SourceProviderSourceType::Module) {
+        UnlinkedModuleProgramCodeBlock* unlinkedCodeBlock = JSC::recursivelyGenerateUnlinkedCodeBlockForModuleProgram(vm, sourceCode, StrictModeLexicallyScopedFeature, JSParserScriptMode::Module, {}, parserError, evalContextType);
+        if (parserError.isValid() || !unlinkedCodeBlock)
+            return nullptr;
+        return JSC::encodeCodeBlock(vm, JSC::sourceCodeKeyForSerializedModule(vm, sourceCode), unlinkedCodeBlock);
+    }
 
-    RefPtr<JSC::CachedBytecode> cachedBytecode = JSC::encodeCodeBlock(vm, key, unlinkedCodeBlock);
+    UnlinkedProgramCodeBlock* unlinkedCodeBlock = JSC::recursivelyGenerateUnlinkedCodeBlockForProgram(vm, sourceCode, NoLexicallyScopedFeatures, JSParserScriptMode::Classic, {}, parserError, evalContextType);
+    if (parserError.isValid() || !unlinkedCodeBlock)
+        return nullptr;
+    return JSC::encodeCodeBlock(vm, JSC::sourceCodeKeyForSerializedProgram(vm, sourceCode), unlinkedCodeBlock);
+}
+
+static bool generateCachedByteCodeFromSourceCode(BunString* sourceProviderURL, const LChar* inputSourceCode, size_t inputSourceCodeSize, SourceProviderSourceType sourceType, const uint8_t** outputByteCode, size_t* outputByteCodeSize, JSC::CachedBytecode** cachedBytecodePtr)
+{
+    std::span<const LChar> sourceCodeSpan(inputSourceCode, inputSourceCodeSize);
+    JSC::SourceCode sourceCode = JSC::makeSource(WTF::String(sourceCodeSpan), toSourceOrigin(sourceProviderURL->toWTFString(), false), JSC::SourceTaintedOrigin::Untainted);
+
+    RefPtr<JSC::CachedBytecode> cachedBytecode = generateCachedBytecode(sourceCode, sourceType);
     if (!cachedBytecode)
         return false;
 
@@ -204,37 +227,161 @@ extern "C" bool generateCachedModuleByteCodeFromSourceCode(BunString* sourceProv
     return true;
 }
 
+extern "C" bool generateCachedModuleByteCodeFromSourceCode(BunString* sourceProviderURL, const LChar* inputSourceCode, size_t inputSourceCodeSize, const uint8_t** outputByteCode, size_t* outputByteCodeSize, JSC::CachedBytecode** cachedBytecodePtr)
+{
+    return generateCachedByteCodeFromSourceCode(sourceProviderURL, inputSourceCode, inputSourceCodeSize, SourceProviderSourceType::Module, outputByteCode, outputByteCodeSize, cachedBytecodePtr);
+}
+
 extern "C" bool generateCachedCommonJSProgramByteCodeFromSourceCode(BunString* sourceProviderURL, const LChar* inputSourceCode, size_t inputSourceCodeSize, const uint8_t** outputByteCode, size_t* outputByteCodeSize, JSC::CachedBytecode** cachedBytecodePtr)
 {
-    std::span<const LChar> sourceCodeSpan(inputSourceCode, inputSourceCodeSize);
+    return generateCachedByteCodeFromSourceCode(sourceProviderURL, inputSourceCode, inputSourceCodeSize, SourceProviderSourceType::Program, outputByteCode, outputByteCodeSize, cachedBytecodePtr);
+}
 
-    JSC::SourceCode sourceCode = JSC::makeSource(WTF::String(sourceCodeSpan), toSourceOrigin(sourceProviderURL->toWTFString(), false), JSC::SourceTaintedOrigin::Untainted);
-    JSC::VM& vm = getVMForBytecodeCache();
+// Opt-in bytecode cache for modules loaded from disk, enabled by pointing BUN_BYTECODE_CACHE_PATH
+// at a directory. Entries are named by a hash of the Bun revision, the source type, the source URL
+// and the transpiled source, so an edit or an upgrade simply misses and old entries are never read
+// again. A miss is compiled and written on a background queue while the module loads normally. At
+// exit, writes that have not started are dropped and only the one in flight is waited for.
+static const String& bytecodeCacheDirectory()
+{
+    static NeverDestroyed<String> directory = [] {
+        const char* path = getenv("BUN_BYTECODE_CACHE_PATH");
+        if (!path || !*path)
+            return String();
+        String directory = String::fromUTF8(path);
+        if (!FileSystem::makeAllDirectories(directory))
+            return String();
+        return directory;
+    }();
+    return directory;
+}
 
-    JSC::JSLockHolder locker(vm);
-    LexicallyScopedFeatures lexicallyScopedFeatures = NoLexicallyScopedFeatures;
-    JSParserScriptMode scriptMode = JSParserScriptMode::Classic;
-    EvalContextType evalContextType = EvalContextType::None;
+static String bytecodeCachePath(const String& source, const String& sourceURL, SourceProviderSourceType sourceType)
+{
+    const auto& directory = bytecodeCacheDirectory();
+    if (directory.isNull())
+        return String();
+    if (sourceType != SourceProviderSourceType::Module && sourceType != SourceProviderSourceType::Program)
+        return String();
+
+    SHA1 sha1;
+    sha1.addBytes(std::span { reinterpret_cast<const uint8_t*>(Bun__version_sha), strlen(Bun__version_sha) });
+    uint8_t header[] = { static_cast<uint8_t>(sourceType), source.is8Bit() };
+    sha1.addBytes(std::span { header });
+    sha1.addUTF8Bytes(sourceURL);
+    if (source.is8Bit())
+        sha1.addBytes(source.span8());
+    else
+        sha1.addBytes(asBytes(source.span16()));
+    SHA1::Digest digest;
+    sha1.computeHash(digest);
+
+    return FileSystem::pathByAppendingComponent(directory, makeString(SHA1::hexDigest(digest).data(), ".jscbc"_s));
+}
 
-    ParserError parserError;
-    UnlinkedProgramCodeBlock* unlinkedCodeBlock = JSC::recursivelyGenerateUnlinkedCodeBlockForProgram(vm, sourceCode, lexicallyScopedFeatures, scriptMode, {}, parserError, evalContextType);
-    if (parserError.isValid())
-        return false;
-    if (!unlinkedCodeBlock)
-        return false;
+// Every entry starts with this header. JSC trusts the bytecode it decodes, so a truncated, damaged
+// or foreign file has to be turned away before any of it reaches the decoder.
+struct BytecodeCacheHeader {
+    static constexpr uint32_t expectedMagic = 0x4342534a; // "JSBC"
+    static constexpr uint32_t currentVersion = 1;
 
-    auto key = JSC::sourceCodeKeyForSerializedProgram(vm, sourceCode);
+    uint32_t magic;
+    uint32_t version;
+    uint64_t length;
+    SHA1::Digest checksum;
+};
 
-    RefPtr<JSC::CachedBytecode> cachedBytecode = JSC::encodeCodeBlock(vm, key, unlinkedCodeBlock);
-    if (!cachedBytecode)
-        return false;
+static SHA1::Digest bytecodeCacheChecksum(std::span<const uint8_t> bytecode)
+{
+    SHA1 sha1;
+    sha1.addBytes(bytecode);
+    SHA1::Digest digest;
+    sha1.computeHash(digest);
+    return digest;
+}
 
-    cachedBytecode->ref();
-    *cachedBytecodePtr = cachedBytecode.get();
-    *outputByteCode = cachedBytecode->span().data();
-    *outputByteCodeSize = cachedBytecode->span().size();
+static RefPtr<JSC::CachedBytecode> readBytecodeCache(const String& path)
+{
+    bool success = false;
+    FileSystem::MappedFileData mappedFile(path, FileSystem::MappedFileMode::Private, success);
+    if (!success || mappedFile.size() <= sizeof(BytecodeCacheHeader))
+        return nullptr;
+
+    auto contents = mappedFile.span();
+    BytecodeCacheHeader header;
+    memcpy(&header, contents.data(), sizeof(header));
+    auto bytecode = contents.subspan(sizeof(header));
+    if (header.magic != BytecodeCacheHeader::expectedMagic || header.version != BytecodeCacheHeader::currentVersion
+        || header.length != bytecode.size() || header.checksum != bytecodeCacheChecksum(bytecode))
+        return nullptr;
+
+    // The mapping can't be handed to JSC without its header, so the verified bytes are copied out.
+    auto* copy = static_cast<uint8_t*>(mi_malloc(bytecode.size()));
+    if (!copy)
+        return nullptr;
+    memcpy(copy, bytecode.data(), bytecode.size());
+    const auto destructor = [](const void* ptr) {
+        mi_free(const_cast<void*>(ptr));
+    };
+    return JSC::CachedBytecode::create(std::span<uint8_t>(copy, bytecode.size()), destructor, {});
+}
 
-    return true;
+static void generateBytecodeCache(String&& path, const String& source, const String& sourceURL, SourceProviderSourceType sourceType)
+{
+    static Lock writerLock;
+    static Condition writeFinished;
+    static bool isExiting = false;
+    static bool isWriting = false;
+    static NeverDestroyed<Ref<WorkQueue>> queue = [] {
+        // Let a write that has already started finish so its temporary file is not left behind,
+        // but don't hold up exit compiling modules nobody is waiting for.
+        std::atexit([] {
+            Locker locker { writerLock };
+            isExiting = true;
+            writeFinished.wait(writerLock, [] { return !isWriting; });
+        });
+        return WorkQueue::create("bun.bytecode-cache"_s);
+    }();
+    queue.get()->dispatch([path = WTFMove(path).isolatedCopy(), source = source.isolatedCopy(), sourceURL = sourceURL.isolatedCopy(), sourceType]() {
+        {
+            Locker locker { writerLock };
+            if (isExiting)
+                return;
+            isWriting = true;
+        }
+        auto finishWrite = makeScopeExit([] {
+            Locker locker { writerLock };
+            isWriting = false;
+            writeFinished.notifyAll();
+        });
+
+        JSC::SourceCode sourceCode = JSC::makeSource(source, toSourceOrigin(sourceURL, false), JSC::SourceTaintedOrigin::Untainted);
+        RefPtr<JSC::CachedBytecode> cachedBytecode = generateCachedBytecode(sourceCode, sourceType);
+        if (!cachedBytecode)
+            return;
+
+        // Written aside and renamed into place, so a reader never maps a partial file and a
+        // process that mapped the old entry keeps its inode.
+        auto bytecode = cachedBytecode->span();
+        BytecodeCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = BytecodeCacheHeader::expectedMagic;
+        header.version = BytecodeCacheHeader::currentVersion;
+        header.length = bytecode.size();
+        header.checksum = bytecodeCacheChecksum(bytecode);
+        Vector<uint8_t> contents;
+        contents.reserveInitialCapacity(sizeof(header) + bytecode.size());
+        contents.append(asBytes(std::span { &header, 1 }));
+        contents.append(bytecode);
+
+        auto temporaryPath = makeString(path, '.', getCurrentProcessID(), ".tmp"_s);
+        if (FileSystem::overwriteEntireFile(temporaryPath, contents.span()) != contents.size()) {
+            FileSystem::deleteFile(temporaryPath);
+            return;
+        }
+        if (!FileSystem::moveFile(temporaryPath, path))
+            FileSystem::deleteFile(temporaryPath);
+    });
 }
 
 unsigned SourceProvider::hash() const
@@ -633,13 +633,21 @@ extern "C" napi_status napi_set_named_property(napi_env env, napi_value object,
     JSC::EnsureStillAliveScope ensureAlive(jsValue);
     JSC::EnsureStillAliveScope ensureAlive2(target);
 
-    auto nameStr = WTF::String::fromUTF8({ utf8name, strlen(utf8name) });
-    auto identifier = JSC::Identifier::fromString(vm, WTFMove(nameStr));
+    auto* entry = env->propertyCache().entryFor(vm, utf8name);
+    if (LIKELY(entry) && Bun::NapiPropertyCache::tryReplace(vm, *entry, target, jsValue))
+        NAPI_RETURN_SUCCESS(env);
+
+    // Copied because a setter may call back into N-API and reuse the cache entry.
+    auto identifier = entry ? entry->identifier : JSC::Identifier::fromString(vm, WTF::String::fromUTF8({ utf8name, strlen(utf8name) }));
 
     PutPropertySlot slot(target, false);
 
     target->methodTable()->put(target, globalObject, identifier, jsValue, slot);
-    NAPI_RETURN_SUCCESS_UNLESS_EXCEPTION(env);
+    NAPI_RETURN_IF_EXCEPTION(env);
+
+    if (entry && !env->inGC())
+        Bun::NapiPropertyCache::cacheOwnProperty(vm, *entry, target);
+    NAPI_RETURN_SUCCESS(env);
 }
 
 extern "C" napi_status napi_create_arraybuffer(napi_env env,
@@ -721,6 +729,23 @@ extern "C" napi_status napi_has_named_property(napi_env env, napi_value object,
     JSObject* target = toJS(object).toObject(globalObject);
     NAPI_RETURN_IF_EXCEPTION(env);
 
+    auto* entry = env->propertyCache().entryFor(vm, utf8Name);
+    if (LIKELY(entry)) {
+        if (Bun::NapiPropertyCache::tryHas(*entry, target)) {
+            *result = true;
+            NAPI_RETURN_SUCCESS(env);
+        }
+
+        auto identifier = entry->identifier;
+        PropertySlot slot(target, PropertySlot::InternalMethodType::HasProperty);
+        *result = target->getPropertySlot(globalObject, identifier, slot);
+        NAPI_RETURN_IF_EXCEPTION(env);
+
+        if (*result && !env->inGC())
+            Bun::NapiPropertyCache::cacheOwnProperty(vm, *entry, target);
+        NAPI_RETURN_SUCCESS(env);
+    }
+
     PROPERTY_NAME_FROM_UTF8(name);
 
     PropertySlot slot(target, PropertySlot::InternalMethodType::HasProperty);
@@ -742,6 +767,25 @@ extern "C" napi_status napi_get_named_property(napi_env env, napi_value object,
     JSObject* target = toJS(object).toObject(globalObject);
     NAPI_RETURN_IF_EXCEPTION(env);
 
+    auto* entry = env->propertyCache().entryFor(vm, utf8Name);
+    if (LIKELY(entry)) {
+        JSValue value;
+        if (Bun::NapiPropertyCache::tryGet(*entry, target, value)) {
+            *result = toNapi(value, globalObject);
+            NAPI_RETURN_SUCCESS(env);
+        }
+
+        // Copied because a getter may call back into N-API and reuse the cache entry.
+        auto identifier = entry->identifier;
+        value = target->get(globalObject, identifier);
+        NAPI_RETURN_IF_EXCEPTION(env);
+
+        if (!env->inGC())
+            Bun::NapiPropertyCache::cacheOwnProperty(vm, *entry, target);
+        *result = toNapi(value, globalObject);
+        NAPI_RETURN_SUCCESS(env);
+    }
+
     PROPERTY_NAME_FROM_UTF8(name);
 
     *result = toNapi(target->get(globalObject, name), globalObject);
@@ -13,6 +13,7 @@
 #include "ZigGlobalObject.h"
 #include "napi_handle_scope.h"
 #include "napi_finalizer.h"
+#include "napi_property_cache.h"
 #include "wtf/Assertions.h"
 #include "napi_macros.h"
 
@@ -102,6 +103,10 @@ public:
 
         instanceDataFinalizer.call(this, instanceData, true);
         instanceDataFinalizer.clear();
+
+        // Last, since the hooks and finalizers above may still look up named properties. The
+        // Identifiers and Weak<Structure>s it holds can't outlive the VM, which the env does.
+        m_propertyCache.clear();
     }
 
     void removeFinalizer(napi_finalize callback, void* hint, void* data)
@@ -218,6 +223,8 @@ public:
 
     inline bool isFinishingFinalizers() const { return m_isFinishingFinalizers; }
 
+    inline Bun::NapiPropertyCache& propertyCache() { return m_propertyCache; }
+
     // Almost all NAPI functions should set error_code to the status they're returning right before
     // they return it
     napi_extended_error_info m_lastNapiErrorInfo = {
@@ -298,6 +305,7 @@ private:
     bool m_isFinishingFinalizers = false;
     std::list<std::pair<void (*)(void*), void*>> m_cleanupHooks;
     std::list<Napi::AsyncCleanupHook> m_asyncCleanupHooks;
+    Bun::NapiPropertyCache m_propertyCache;
 };
 
 extern "C" void napi_internal_cleanup_env_cpp(napi_env);
@@ -0,0 +1,93 @@
+#include "root.h"
+#include "napi_property_cache.h"
+#include <JavaScriptCore/JSCInlines.h>
+#include <JavaScriptCore/JSObjectInlines.h>
+#include <wtf/HashFunctions.h>
+#include <wtf/text/StringCommon.h>
+
+namespace Bun {
+using namespace JSC;
+
+static bool nameMatches(const Identifier& identifier, const char* utf8Name)
+{
+    auto* impl = identifier.impl();
+    ASSERT(impl->is8Bit());
+    auto characters = impl->span8();
+    // strncmp stops at the first difference, so this never reads past the end of a shorter utf8Name.
+    return !strncmp(utf8Name, reinterpret_cast<const char*>(characters.data()), characters.size()) && !utf8Name[characters.size()];
+}
+
+NapiPropertyCache::Entry* NapiPropertyCache::entryFor(VM& vm, const char* utf8Name)
+{
+    auto& entry = m_entries[WTF::intHash(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(utf8Name))) % numberOfEntries];
+    if (entry.name == utf8Name && nameMatches(entry.identifier, utf8Name))
+        return &entry;
+
+    auto name = std::span { reinterpret_cast<const LChar*>(utf8Name), strlen(utf8Name) };
+    if (UNLIKELY(!WTF::charactersAreAllASCII(name)))
+        return nullptr;
+
+    entry.name = utf8Name;
+    entry.identifier = Identifier::fromString(vm, name);
+    entry.structure.clear();
+    entry.offset = invalidOffset;
+    entry.attributes = 0;
+    return &entry;
+}
+
+bool NapiPropertyCache::tryGet(const Entry& entry, JSObject* object, JSValue& result)
+{
+    if (entry.structure.get() != object->structure())
+        return false;
+    result = object->getDirect(entry.offset);
+    return true;
+}
+
+bool NapiPropertyCache::tryHas(const Entry& entry, JSObject* object)
+{
+    return entry.structure.get() == object->structure();
+}
+
+bool NapiPropertyCache::tryReplace(VM& vm, const Entry& entry, JSObject* object, JSValue value)
+{
+    Structure* structure = object->structure();
+    if (entry.structure.get() != structure || (entry.attributes & PropertyAttribute::ReadOnly))
+        return false;
+    // Same bookkeeping as an ordinary replace, so code that constant-folded the old value is invalidated.
+    structure->didReplaceProperty(entry.offset);
+    object->putDirectOffset(vm, entry.offset, value);
+    return true;
+}
+
+void NapiPropertyCache::cacheOwnProperty(VM& vm, Entry& entry, JSObject* object)
+{
+    Structure* structure = object->structure();
+    if (entry.structure.get() == structure)
+        return;
+    // Dictionaries change in place, and objects that override get or put may not keep the property
+    // where their Structure says.
+    if (structure->isDictionary() || structure->typeInfo().overridesGetOwnPropertySlot() || structure->typeInfo().overridesPut())
+        return;
+
+    unsigned attributes = 0;
+    PropertyOffset offset = structure->get(vm, entry.identifier, attributes);
+    if (!isValidOffset(offset) || (attributes & PropertyAttribute::AccessorOrCustomAccessorOrValue))
+        return;
+
+    entry.structure = Weak<Structure>(structure);
+    entry.offset = offset;
+    entry.attributes = attributes;
+}
+
+void NapiPropertyCache::clear()
+{
+    for (auto& entry : m_entries) {
+        entry.name = nullptr;
+        entry.identifier = Identifier();
+        entry.structure.clear();
+        entry.offset = invalidOffset;
+        entry.attributes = 0;
+    }
+}
+
+} // namespace Bun
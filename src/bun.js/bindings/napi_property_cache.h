@@ -0,0 +1,50 @@
+#pragma once
+
+#include "root.h"
+#include <JavaScriptCore/Identifier.h>
+#include <JavaScriptCore/JSObject.h>
+#include <JavaScriptCore/Weak.h>
+#include <array>
+
+namespace Bun {
+
+// Per-env cache behind napi_{get,set,has}_named_property.
+//
+// Addons tend to pass the same string literal for the same property on every call, so entries are
+// found by the name's address and then checked against its contents, which the caller may have
+// rewritten since. Each entry holds the atomized Identifier, and the Structure and offset where the
+// property was last found as an own data property, which lets a later call on an object of that
+// Structure read or overwrite the slot directly.
+class NapiPropertyCache {
+    WTF_MAKE_FAST_ALLOCATED;
+
+public:
+    struct Entry {
+        const char* name = nullptr;
+        JSC::Identifier identifier;
+        JSC::Weak<JSC::Structure> structure;
+        JSC::PropertyOffset offset = JSC::invalidOffset;
+        unsigned attributes = 0;
+    };
+
+    // nullptr for a name that is not ASCII; those take the uncached path.
+    Entry* entryFor(JSC::VM&, const char* utf8Name);
+
+    // Each returns false, doing nothing, unless object has the entry's Structure.
+    static bool tryGet(const Entry&, JSC::JSObject*, JSC::JSValue& result);
+    static bool tryHas(const Entry&, JSC::JSObject*);
+    static bool tryReplace(JSC::VM&, const Entry&, JSC::JSObject*, JSC::JSValue);
+
+    // Remembers where object's Structure keeps the property, if it is a plain own data property.
+    static void cacheOwnProperty(JSC::VM&, Entry&, JSC::JSObject*);
+
+    // Drops every Identifier and Weak<Structure>. Must run while the VM is still alive.
+    void clear();
+
+private:
+    static constexpr size_t numberOfEntries = 128;
+
+    std::array<Entry, numberOfEntries> m_entries;
+};
+
+} // namespace Bun
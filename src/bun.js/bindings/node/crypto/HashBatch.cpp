@@ -0,0 +1,356 @@
+#include "HashBatch.h"
+#include "EventLoopTaskNoContext.h"
+#include "ncrypto.h"
+#include <openssl/sha.h>
+#include <wtf/Condition.h>
+#include <wtf/Lock.h>
+#include <wtf/NumberOfCores.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <atomic>
+
+#if CPU(X86_64) && !OS(WINDOWS)
+#include <cpuid.h>
+#include <immintrin.h>
+#define HASH_BATCH_SHA256_X8 1
+#endif
+
+namespace Bun {
+
+extern "C" void ConcurrentCppTask__createAndRun(EventLoopTaskNoContext* task);
+
+// Enough input for one task that handing it to another thread pays for itself
+static constexpr size_t bytesPerTask = 256 * 1024;
+// What setting up one digest costs, counted as that many bytes of input
+static constexpr size_t bytesPerMessage = 64;
+
+#if HASH_BATCH_SHA256_X8
+
+#define SHA256_AVX2 __attribute__((target("avx2")))
+
+static constexpr uint32_t sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static constexpr uint32_t sha256IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+// Lanes move in lockstep, so one long message at the end of a batch would leave the other seven idle
+static constexpr size_t sha256MultiBufferMaxLength = 16 * 1024;
+
+struct SHA256Lane {
+    const uint8_t* data;
+    uint8_t* digest;
+    size_t dataBlocks;
+    size_t blocks;
+    size_t block;
+    // The last partial block of data, the padding and the length
+    uint8_t tail[128];
+};
+
+template<int n>
+SHA256_AVX2 static inline __m256i rotateRight(__m256i x)
+{
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+SHA256_AVX2 static inline __m256i addWords(__m256i a, __m256i b)
+{
+    return _mm256_add_epi32(a, b);
+}
+
+SHA256_AVX2 static inline __m256i xor3(__m256i a, __m256i b, __m256i c)
+{
+    return _mm256_xor_si256(_mm256_xor_si256(a, b), c);
+}
+
+// Eight lanes' worth of 32 bytes in, eight big endian words each out, one vector per word
+SHA256_AVX2 static inline void loadTransposed(const uint8_t* const blocks[8], size_t offset, __m256i* words)
+{
+    const __m256i byteSwap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    __m256i r[8];
+    for (int lane = 0; lane < 8; lane++)
+        r[lane] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[lane] + offset)), byteSwap);
+
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]), t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]), t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]), t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]), t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+    words[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    words[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    words[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    words[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    words[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    words[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    words[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    words[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+// One block for each of eight lanes. state[i] holds word i of every lane
+SHA256_AVX2 static void sha256x8Compress(__m256i state[8], const uint8_t* const blocks[8])
+{
+    __m256i w[16];
+    loadTransposed(blocks, 0, w);
+    loadTransposed(blocks, 32, w + 8);
+
+    __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+    __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int t = 0; t < 64; t++) {
+        if (t >= 16) {
+            __m256i w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+            __m256i s0 = xor3(rotateRight<7>(w15), rotateRight<18>(w15), _mm256_srli_epi32(w15, 3));
+            __m256i s1 = xor3(rotateRight<17>(w2), rotateRight<19>(w2), _mm256_srli_epi32(w2, 10));
+            w[t & 15] = addWords(addWords(w[t & 15], s0), addWords(w[(t - 7) & 15], s1));
+        }
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = addWords(addWords(h, xor3(rotateRight<6>(e), rotateRight<11>(e), rotateRight<25>(e))), addWords(addWords(ch, _mm256_set1_epi32(sha256K[t])), w[t & 15]));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = addWords(xor3(rotateRight<2>(a), rotateRight<13>(a), rotateRight<22>(a)), maj);
+        h = g;
+        g = f;
+        f = e;
+        e = addWords(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = addWords(t1, t2);
+    }
+
+    state[0] = addWords(state[0], a);
+    state[1] = addWords(state[1], b);
+    state[2] = addWords(state[2], c);
+    state[3] = addWords(state[3], d);
+    state[4] = addWords(state[4], e);
+    state[5] = addWords(state[5], f);
+    state[6] = addWords(state[6], g);
+    state[7] = addWords(state[7], h);
+}
+
+static void startLane(SHA256Lane& lane, std::span<const uint8_t> input, uint8_t* digest)
+{
+    size_t length = input.size();
+    size_t rest = length % 64;
+    lane.data = input.data();
+    lane.digest = digest;
+    lane.dataBlocks = length / 64;
+    lane.blocks = lane.dataBlocks + (rest + 9 > 64 ? 2 : 1);
+    lane.block = 0;
+
+    memset(lane.tail, 0, sizeof(lane.tail));
+    if (rest)
+        memcpy(lane.tail, lane.data + lane.dataBlocks * 64, rest);
+    lane.tail[rest] = 0x80;
+    uint64_t bits = static_cast<uint64_t>(length) * 8;
+    size_t end = (lane.blocks - lane.dataBlocks) * 64;
+    for (int i = 0; i < 8; i++)
+        lane.tail[end - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+// Hashes eight messages at a time, giving a lane the next message as soon as its last one is done
+SHA256_AVX2 static void sha256x8(std::span<const std::span<const uint8_t>> inputs, uint8_t* out)
+{
+    static const uint8_t idleBlock[64] = {};
+    SHA256Lane lanes[8];
+    bool active[8];
+    alignas(32) uint32_t words[8][8];
+    __m256i state[8];
+    for (int i = 0; i < 8; i++)
+        state[i] = _mm256_set1_epi32(sha256IV[i]);
+
+    size_t next = 0;
+    auto startNext = [&](SHA256Lane& lane) -> bool {
+        while (next < inputs.size()) {
+            size_t index = next++;
+            uint8_t* digest = out + index * SHA256_DIGEST_LENGTH;
+            if (inputs[index].size() > sha256MultiBufferMaxLength) {
+                SHA256(inputs[index].data(), inputs[index].size(), digest);
+                continue;
+            }
+            startLane(lane, inputs[index], digest);
+            return true;
+        }
+        return false;
+    };
+
+    unsigned activeLanes = 0;
+    for (int lane = 0; lane < 8; lane++) {
+        active[lane] = startNext(lanes[lane]);
+        activeLanes += active[lane];
+    }
+
+    while (activeLanes) {
+        const uint8_t* blocks[8];
+        for (int lane = 0; lane < 8; lane++) {
+            SHA256Lane& current = lanes[lane];
+            if (!active[lane])
+                blocks[lane] = idleBlock;
+            else if (current.block < current.dataBlocks)
+                blocks[lane] = current.data + current.block * 64;
+            else
+                blocks[lane] = current.tail + (current.block - current.dataBlocks) * 64;
+        }
+
+        sha256x8Compress(state, blocks);
+
+        bool finished = false;
+        for (int lane = 0; lane < 8; lane++)
+            finished |= active[lane] && ++lanes[lane].block == lanes[lane].blocks;
+        if (!finished)
+            continue;
+
+        // Some lane finished: write its digest out and put the IV back for its next message
+        for (int i = 0; i < 8; i++)
+            _mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), state[i]);
+        for (int lane = 0; lane < 8; lane++) {
+            SHA256Lane& current = lanes[lane];
+            if (!active[lane] || current.block != current.blocks)
+                continue;
+            for (int i = 0; i < 8; i++) {
+                uint32_t word = words[i][lane];
+                current.digest[4 * i] = static_cast<uint8_t>(word >> 24);
+                current.digest[4 * i + 1] = static_cast<uint8_t>(word >> 16);
+                current.digest[4 * i + 2] = static_cast<uint8_t>(word >> 8);
+                current.digest[4 * i + 3] = static_cast<uint8_t>(word);
+                words[i][lane] = sha256IV[i];
+            }
+            active[lane] = startNext(current);
+            activeLanes -= !active[lane];
+        }
+        for (int i = 0; i < 8; i++)
+            state[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(words[i]));
+    }
+}
+
+// BoringSSL's SHA extensions code is faster than eight AVX2 lanes, so this is for CPUs without them
+static bool useSHA256x8()
+{
+    static const bool use = [] {
+        unsigned eax, ebx, ecx, edx;
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("avx2") || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            return false;
+        return !(ebx & bit_SHA);
+    }();
+    return use;
+}
+
+#endif
+
+static bool hashRange(const EVP_MD* md, std::span<const std::span<const uint8_t>> inputs, uint8_t* out)
+{
+#if HASH_BATCH_SHA256_X8
+    if (md == EVP_sha256() && useSHA256x8()) {
+        sha256x8(inputs, out);
+        return true;
+    }
+#endif
+
+    // One context for the whole range, only re-initialized between messages
+    auto ctx = ncrypto::EVPMDCtxPointer::New();
+    size_t digestSize = EVP_MD_size(md);
+    for (auto input : inputs) {
+        ncrypto::Buffer<void> digest {
+            .data = out,
+            .len = digestSize,
+        };
+        if (!ctx.digestInit(md) || !ctx.digestUpdate({ .data = input.data(), .len = input.size() }) || !ctx.digestFinalInto(&digest))
+            return false;
+        out += digestSize;
+    }
+    return true;
+}
+
+class HashBatchJob : public ThreadSafeRefCounted<HashBatchJob> {
+public:
+    HashBatchJob(const EVP_MD* md, std::span<const std::span<const uint8_t>> inputs, std::span<uint8_t> out, Vector<size_t>&& taskStarts)
+        : m_md(md)
+        , m_inputs(inputs)
+        , m_out(out)
+        , m_taskStarts(WTFMove(taskStarts))
+    {
+    }
+
+    // Takes tasks until none are left. A worker that only starts once the batch is done never
+    // gets one, so it does not touch inputs or out, which may be gone by then.
+    void work()
+    {
+        size_t taskCount = m_taskStarts.size() - 1;
+        size_t digestSize = EVP_MD_size(m_md);
+        for (size_t task; (task = m_nextTask.fetch_add(1, std::memory_order_relaxed)) < taskCount;) {
+            size_t begin = m_taskStarts[task];
+            size_t end = m_taskStarts[task + 1];
+            bool ok = hashRange(m_md, m_inputs.subspan(begin, end - begin), m_out.data() + begin * digestSize);
+
+            Locker locker { m_lock };
+            m_failed |= !ok;
+            if (++m_finishedTasks == taskCount)
+                m_condition.notifyAll();
+        }
+    }
+
+    bool wait()
+    {
+        Locker locker { m_lock };
+        while (m_finishedTasks < m_taskStarts.size() - 1)
+            m_condition.wait(m_lock);
+        return !m_failed;
+    }
+
+private:
+    const EVP_MD* m_md;
+    std::span<const std::span<const uint8_t>> m_inputs;
+    std::span<uint8_t> m_out;
+    Vector<size_t> m_taskStarts;
+    std::atomic<size_t> m_nextTask { 0 };
+
+    Lock m_lock;
+    Condition m_condition;
+    size_t m_finishedTasks { 0 };
+    bool m_failed { false };
+};
+
+bool hashBatch(JSC::JSGlobalObject* globalObject, const EVP_MD* md, std::span<const std::span<const uint8_t>> inputs, std::span<uint8_t> out)
+{
+    ASSERT(out.size() == inputs.size() * EVP_MD_size(md));
+
+    Vector<size_t> taskStarts;
+    taskStarts.append(0);
+    size_t taskBytes = 0;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        taskBytes += inputs[i].size() + bytesPerMessage;
+        if (taskBytes >= bytesPerTask || i + 1 == inputs.size()) {
+            taskStarts.append(i + 1);
+            taskBytes = 0;
+        }
+    }
+
+    size_t taskCount = taskStarts.size() - 1;
+    unsigned cores = WTF::numberOfProcessorCores();
+    if (taskCount <= 1 || cores <= 1)
+        return hashRange(md, inputs, out.data());
+
+    auto job = adoptRef(*new HashBatchJob(md, inputs, out, WTFMove(taskStarts)));
+    size_t helpers = std::min<size_t>(taskCount - 1, cores - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        ConcurrentCppTask__createAndRun(new EventLoopTaskNoContext(globalObject, [job = job.copyRef()] {
+            job->work();
+        }));
+    }
+    job->work();
+    return job->wait();
+}
+
+} // namespace Bun
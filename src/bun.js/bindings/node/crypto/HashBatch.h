@@ -0,0 +1,13 @@
+#pragma once
+
+#include "root.h"
+#include <openssl/evp.h>
+#include <span>
+
+namespace Bun {
+
+// Digests every input into out, EVP_MD_size(md) bytes each and in order. Large batches are split
+// into tasks for the work pool; the calling thread takes tasks too and returns once all are done.
+bool hashBatch(JSC::JSGlobalObject* globalObject, const EVP_MD* md, std::span<const std::span<const uint8_t>> inputs, std::span<uint8_t> out);
+
+} // namespace Bun
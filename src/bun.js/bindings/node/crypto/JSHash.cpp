@@ -1,6 +1,8 @@
 #include "JSHash.h"
 #include "CryptoUtil.h"
+#include "HashBatch.h"
 #include "BunClientData.h"
+#include <JavaScriptCore/ArgList.h>
 #include <JavaScriptCore/ArrayBuffer.h>
 #include <JavaScriptCore/Error.h>
 #include <JavaScriptCore/Exception.h>
@@ -385,6 +387,109 @@ JSC_DEFINE_HOST_FUNCTION(callHash, (JSC::JSGlobalObject * globalObject, JSC::Cal
     return JSC::encodedJSUndefined();
 }
 
+// hashBatch(algorithm, inputs) digests every buffer in an array; hashBatch(algorithm, buffer, offsets)
+// digests buffer[offsets[i], offsets[i + 1]) for each i. Either way the digests come back
+// concatenated in one Buffer.
+JSC_DEFINE_HOST_FUNCTION(jsHashBatch, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+{
+    JSC::VM& vm = lexicalGlobalObject->vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto* globalObject = defaultGlobalObject(lexicalGlobalObject);
+
+    JSValue algorithmValue = callFrame->argument(0);
+    Bun::V::validateString(scope, globalObject, algorithmValue, "algorithm"_s);
+    RETURN_IF_EXCEPTION(scope, {});
+
+    WTF::String algorithm = algorithmValue.toWTFString(globalObject);
+    RETURN_IF_EXCEPTION(scope, {});
+
+    // The hashers implemented in Zig have no batch path
+    const EVP_MD* md = ncrypto::getDigestByName(algorithm, true);
+    if (!md || EVP_MD_size(md) <= 0) {
+        throwCryptoError(globalObject, scope, 0, "Digest method not supported"_s);
+        return JSValue::encode({});
+    }
+    size_t digestSize = EVP_MD_size(md);
+
+    // Everything that can run JS (getters, index lookups) happens before any pointer into a buffer
+    // is taken, so nothing can be detached or resized underneath the hashing.
+    JSValue inputsValue = callFrame->argument(1);
+    JSArrayBufferView* buffer = jsDynamicCast<JSArrayBufferView*>(inputsValue);
+    MarkedArgumentBuffer views;
+    Vector<double> offsets;
+    if (buffer) {
+        JSValue offsetsValue = callFrame->argument(2);
+        if (auto* offsetsArray = jsDynamicCast<JSUint32Array*>(offsetsValue)) {
+            offsets.reserveInitialCapacity(offsetsArray->length());
+            for (size_t i = 0; i < offsetsArray->length(); i++)
+                offsets.append(offsetsArray->typedVector()[i]);
+        } else if (auto* offsetsArray = jsDynamicCast<JSArray*>(offsetsValue)) {
+            unsigned length = offsetsArray->length();
+            offsets.reserveInitialCapacity(length);
+            for (unsigned i = 0; i < length; i++) {
+                JSValue offset = offsetsArray->getIndex(globalObject, i);
+                RETURN_IF_EXCEPTION(scope, {});
+                if (!offset.isNumber()) {
+                    return Bun::ERR::INVALID_ARG_TYPE(scope, globalObject, makeString("offsets["_s, i, ']'), "number"_s, offset);
+                }
+                offsets.append(offset.asNumber());
+            }
+        } else {
+            return Bun::ERR::INVALID_ARG_TYPE(scope, globalObject, "offsets"_s, "an Array or an instance of Uint32Array"_s, offsetsValue);
+        }
+
+        if (offsets.isEmpty()) {
+            return Bun::ERR::INVALID_ARG_VALUE(scope, globalObject, "offsets"_s, offsetsValue, "must contain at least one offset"_s);
+        }
+    } else if (auto* inputsArray = jsDynamicCast<JSArray*>(inputsValue)) {
+        unsigned length = inputsArray->length();
+        for (unsigned i = 0; i < length; i++) {
+            JSValue input = inputsArray->getIndex(globalObject, i);
+            RETURN_IF_EXCEPTION(scope, {});
+            if (!input.inherits<JSArrayBufferView>()) {
+                return Bun::ERR::INVALID_ARG_TYPE(scope, globalObject, makeString("inputs["_s, i, ']'), "an instance of Buffer, TypedArray, or DataView"_s, input);
+            }
+            views.append(input);
+        }
+        if (UNLIKELY(views.hasOverflowed())) {
+            throwOutOfMemoryError(globalObject, scope);
+            return JSValue::encode({});
+        }
+    } else {
+        return Bun::ERR::INVALID_ARG_TYPE(scope, globalObject, "inputs"_s, "an Array or an instance of Buffer, TypedArray, or DataView"_s, inputsValue);
+    }
+
+    size_t count = buffer ? offsets.size() - 1 : views.size();
+    auto* result = WebCore::createUninitializedBuffer(globalObject, count * digestSize);
+    RETURN_IF_EXCEPTION(scope, {});
+
+    Vector<std::span<const uint8_t>> inputs;
+    inputs.reserveInitialCapacity(count);
+    if (buffer) {
+        std::span<const uint8_t> bytes { static_cast<const uint8_t*>(buffer->vector()), buffer->byteLength() };
+        for (size_t i = 0; i < offsets.size(); i++) {
+            double lower = i ? offsets[i - 1] : 0;
+            if (!(offsets[i] >= lower && offsets[i] <= bytes.size()) || offsets[i] != std::trunc(offsets[i])) {
+                return Bun::ERR::OUT_OF_RANGE(scope, globalObject, makeString("offsets["_s, i, ']'), lower, bytes.size(), jsNumber(offsets[i]));
+            }
+            if (i)
+                inputs.append(bytes.subspan(static_cast<size_t>(lower), static_cast<size_t>(offsets[i] - lower)));
+        }
+    } else {
+        for (size_t i = 0; i < views.size(); i++) {
+            auto* view = jsCast<JSArrayBufferView*>(views.at(i));
+            inputs.append(std::span { static_cast<const uint8_t*>(view->vector()), view->byteLength() });
+        }
+    }
+
+    if (!hashBatch(globalObject, md, inputs.span(), std::span { result->typedVector(), result->length() })) {
+        throwCryptoError(globalObject, scope, ERR_get_error(), "Failed to finalize digest"_s);
+        return JSValue::encode({});
+    }
+
+    return JSValue::encode(result);
+}
+
 JSC::Structure* JSHashConstructor::createStructure(JSC::VM& vm, JSC::JSGlobalObject* globalObject, JSC::JSValue prototype)
 {
     return JSC::Structure::create(vm, globalObject, prototype, JSC::TypeInfo(JSC::InternalFunctionType, StructureFlags), info());
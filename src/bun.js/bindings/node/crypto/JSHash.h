@@ -16,6 +16,7 @@ namespace Bun {
 
 JSC_DECLARE_HOST_FUNCTION(callHash);
 JSC_DECLARE_HOST_FUNCTION(constructHash);
+JSC_DECLARE_HOST_FUNCTION(jsHashBatch);
 
 class JSHash final : public JSC::JSDestructibleObject {
 public:
@@ -405,6 +405,8 @@ JSValue createNodeCryptoBinding(Zig::GlobalObject* globalObject)
 
     obj->putDirect(vm, PropertyName(Identifier::fromString(vm, "Hash"_s)),
         globalObject->m_JSHashClassStructure.constructor(globalObject));
+    obj->putDirect(vm, PropertyName(Identifier::fromString(vm, "hashBatch"_s)),
+        JSFunction::create(vm, globalObject, 3, "hashBatch"_s, jsHashBatch, ImplementationVisibility::Public, NoIntrinsic), 0);
 
     obj->putDirect(vm, PropertyName(Identifier::fromString(vm, "ECDH"_s)),
         globalObject->m_JSECDHClassStructure.constructor(globalObject));
@@ -45,8 +45,17 @@
 #include "wtf/BitVector.h"
 #include "wtf/FastBitVector.h"
 #include "wtf/Vector.h"
+#include "ContextDestructionObserver.h"
 #include <atomic>
 #include "wtf/LazyRef.h"
+#include <wtf/Condition.h>
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/Lock.h>
+#include <wtf/MonotonicTime.h>
+#include <wtf/Scope.h>
+#include <wtf/text/StringBuilder.h>
+#include <wtf/text/StringHash.h>
 #include "wtf/text/StringToIntegerConversion.h"
 #include <JavaScriptCore/InternalFieldTuple.h>
 
@@ -198,6 +207,190 @@ static inline JSC::JSValue jsBigIntFromSQLite(JSC::JSGlobalObject* globalObject,
         return {};                                                                                                 \
     }
 
+// Spells SQL the same way no matter how it was laid out: comments and runs of whitespace become
+// a single space, spaces next to parentheses and commas are dropped and trailing semicolons are
+// trimmed. Literals and quoted identifiers are copied as is. Case is kept, since the text of an
+// unaliased result column is its name.
+static String canonicalSQL(const String& sql)
+{
+    StringBuilder builder;
+    builder.reserveCapacity(sql.length());
+
+    unsigned length = sql.length();
+    bool pendingSpace = false;
+    auto isSpaceSensitive = [](UChar c) {
+        return c != '(' && c != ')' && c != ',';
+    };
+
+    for (unsigned i = 0; i < length;) {
+        UChar c = sql[i];
+
+        if (isASCIIWhitespace(c)) {
+            pendingSpace = true;
+            i++;
+            continue;
+        }
+
+        if (c == '-' && i + 1 < length && sql[i + 1] == '-') {
+            while (i < length && sql[i] != '\n')
+                i++;
+            pendingSpace = true;
+            continue;
+        }
+
+        if (c == '/' && i + 1 < length && sql[i + 1] == '*') {
+            size_t end = sql.find("*/"_s, i + 2);
+            i = end == notFound ? length : end + 2;
+            pendingSpace = true;
+            continue;
+        }
+
+        if (pendingSpace && !builder.isEmpty() && isSpaceSensitive(c) && isSpaceSensitive(builder[builder.length() - 1]))
+            builder.append(' ');
+        pendingSpace = false;
+
+        if (c == '\'' || c == '"' || c == '`' || c == '[') {
+            // A doubled quote closes and reopens the literal, which copies it correctly too
+            UChar close = c == '[' ? ']' : c;
+            unsigned start = i++;
+            while (i < length && sql[i] != close)
+                i++;
+            i = std::min(i + 1, length);
+            builder.append(StringView(sql).substring(start, i - start));
+            continue;
+        }
+
+        builder.append(c);
+        i++;
+    }
+
+    unsigned end = builder.length();
+    while (end > 0 && (builder[end - 1] == ';' || builder[end - 1] == ' '))
+        end--;
+    builder.shrink(end);
+    return builder.toString();
+}
+
+// Idle prepared statements of one database, least recently released first. A statement moves
+// from here to a JSSQLStatement on a hit and comes back when that statement is finalized or
+// collected, so no two JSSQLStatements ever share a sqlite3_stmt.
+class SQLiteStatementCache {
+    WTF_MAKE_FAST_ALLOCATED;
+
+public:
+    static constexpr unsigned defaultCapacity = 64;
+
+    struct Entry {
+        sqlite3_stmt* stmt = nullptr;
+        String sql;
+        int64_t memorySize = 0;
+    };
+
+    unsigned capacity = defaultCapacity;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    ~SQLiteStatementCache()
+    {
+        clear();
+    }
+
+    unsigned size() const { return m_entries.size(); }
+
+    static String keyFor(const String& sql, unsigned int prepareFlags)
+    {
+        return makeString(prepareFlags, ':', canonicalSQL(sql));
+    }
+
+    // Takes the idle statement for key, or returns an empty entry on a miss
+    Entry take(const String& key, const String& sql)
+    {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            misses++;
+            return {};
+        }
+
+        // Unaliased expression columns are named after their own spelling, so a differently
+        // spelled query only gets the statement when every name it gives also shows up in it.
+        // toString() expands parameters into the spelling the statement was compiled from, so
+        // that spelling can only stand in for the caller's when there are no parameters.
+        if (it->value.sql != sql) {
+            if (sqlite3_bind_parameter_count(it->value.stmt) > 0) {
+                misses++;
+                return {};
+            }
+            int count = sqlite3_column_count(it->value.stmt);
+            for (int i = 0; i < count; i++) {
+                const char* name = sqlite3_column_name(it->value.stmt, i);
+                if (!name)
+                    continue;
+                String columnName = String::fromUTF8({ name, strlen(name) });
+                if (it->value.sql.contains(columnName) && !sql.contains(columnName)) {
+                    misses++;
+                    return {};
+                }
+            }
+        }
+
+        hits++;
+        Entry entry = WTFMove(it->value);
+        m_entries.remove(it);
+        m_order.remove(key);
+        return entry;
+    }
+
+    // Takes ownership of stmt. Returns false if the statement could not be kept, in which case it
+    // was finalized.
+    bool put(String&& key, Entry&& entry)
+    {
+        if (!capacity || m_entries.contains(key)) {
+            sqlite3_finalize(entry.stmt);
+            return false;
+        }
+
+        sqlite3_reset(entry.stmt);
+        sqlite3_clear_bindings(entry.stmt);
+
+        while (m_entries.size() >= capacity) {
+            evictOldest();
+        }
+
+        m_order.add(key);
+        m_entries.add(WTFMove(key), WTFMove(entry));
+        return true;
+    }
+
+    void shrink(unsigned newCapacity)
+    {
+        capacity = newCapacity;
+        while (m_entries.size() > capacity) {
+            evictOldest();
+        }
+    }
+
+    void clear()
+    {
+        for (auto& entry : m_entries.values()) {
+            sqlite3_finalize(entry.stmt);
+        }
+        m_entries.clear();
+        m_order.clear();
+    }
+
+private:
+    void evictOldest()
+    {
+        String oldest = m_order.takeFirst();
+        sqlite3_finalize(m_entries.take(oldest).stmt);
+        evictions++;
+    }
+
+    HashMap<String, Entry> m_entries;
+    ListHashSet<String> m_order;
+};
+
 DECLARE_ALLOCATOR_WITH_HEAP_IDENTIFIER(VersionSqlite3);
 
 class VersionSqlite3 {
@@ -213,6 +406,7 @@ public:
     sqlite3* db;
     std::atomic<uint64_t> version;
     size_t reference_count;
+    SQLiteStatementCache statementCache;
 
     void release()
     {
@@ -222,6 +416,7 @@ public:
             if (!db) {
                 return;
             }
+            statementCache.clear();
             sqlite3_close_v2(db);
             db = nullptr;
         }
@@ -250,6 +445,229 @@ static Vector<VersionSqlite3*>& databases()
     return _instance->databases;
 }
 
+class SQLitePool;
+
+// A connection owned by a SQLitePool. Only the thread that borrowed it touches it,
+// including the statements it has prepared so far.
+class SQLitePooledConnection {
+    WTF_MAKE_FAST_ALLOCATED;
+
+public:
+    // Past this many distinct queries, statements are prepared and finalized per call
+    static constexpr unsigned maxCachedStatements = 128;
+
+    SQLitePooledConnection(SQLitePool& pool, sqlite3* db)
+        : pool(pool)
+        , db(db)
+    {
+    }
+
+    ~SQLitePooledConnection()
+    {
+        for (auto* stmt : statements.values()) {
+            sqlite3_finalize(stmt);
+        }
+        sqlite3_close_v2(db);
+    }
+
+    SQLitePool& pool;
+    sqlite3* db;
+    HashMap<String, sqlite3_stmt*> statements;
+    // When the statement that is waiting on SQLITE_BUSY gives up
+    MonotonicTime busyDeadline;
+};
+
+// One WAL database shared by every Worker in the process that opens it with openPool().
+// Reads borrow one of the read-only reader connections, writes take turns on the single
+// writer connection, so the page cache and prepared statements are built once per
+// connection instead of once per Worker.
+class SQLitePool {
+    WTF_MAKE_FAST_ALLOCATED;
+
+public:
+    static constexpr Seconds defaultBusyTimeout { 5 };
+    // Statements known to write, up to this many, skip borrowing a reader to find out
+    static constexpr unsigned maxKnownWrites = 1024;
+
+    String path;
+    size_t reference_count = 1;
+    // How long a query waits for a connection or for SQLITE_BUSY to clear before failing with SQLITE_BUSY
+    Seconds busyTimeout = defaultBusyTimeout;
+
+    Lock lock;
+    Condition readerReturned;
+    Vector<std::unique_ptr<SQLitePooledConnection>> readers;
+    Vector<SQLitePooledConnection*> idleReaders WTF_GUARDED_BY_LOCK(lock);
+
+    Condition writerReturned;
+    bool isWriterBorrowed WTF_GUARDED_BY_LOCK(lock) = false;
+    std::unique_ptr<SQLitePooledConnection> writer;
+    HashSet<String> knownWrites WTF_GUARDED_BY_LOCK(lock);
+
+    std::atomic<uint64_t> borrows = 0;
+    std::atomic<uint64_t> readerWaits = 0;
+    std::atomic<uint64_t> readerWaitNanoseconds = 0;
+    std::atomic<uint64_t> writes = 0;
+    std::atomic<uint64_t> writerWaits = 0;
+    std::atomic<uint64_t> writerWaitNanoseconds = 0;
+    std::atomic<uint64_t> statementHits = 0;
+    std::atomic<uint64_t> statementMisses = 0;
+    std::atomic<uint64_t> busyRetries = 0;
+
+    // Retries every millisecond until the pool's busy timeout passes, then sqlite3_step() fails with SQLITE_BUSY
+    static int busyHandler(void* ctx, int attempt)
+    {
+        auto* connection = static_cast<SQLitePooledConnection*>(ctx);
+        if (attempt == 0) {
+            connection->busyDeadline = MonotonicTime::now() + connection->pool.busyTimeout;
+        } else if (MonotonicTime::now() >= connection->busyDeadline) {
+            return 0;
+        }
+        connection->pool.busyRetries++;
+        sqlite3_sleep(1);
+        return 1;
+    }
+
+    // Returns nullptr if no reader came back before the busy timeout
+    SQLitePooledConnection* borrowReader()
+    {
+        borrows++;
+        Locker locker { lock };
+        if (idleReaders.isEmpty()) {
+            auto start = MonotonicTime::now();
+            bool returned = readerReturned.waitUntil(lock, start + busyTimeout, [&] {
+                assertIsHeld(lock);
+                return !idleReaders.isEmpty();
+            });
+            readerWaits++;
+            readerWaitNanoseconds += (MonotonicTime::now() - start).nanoseconds();
+            if (!returned) {
+                return nullptr;
+            }
+        }
+        return idleReaders.takeLast();
+    }
+
+    bool isKnownWrite(const String& sql)
+    {
+        Locker locker { lock };
+        return knownWrites.contains(sql);
+    }
+
+    void addKnownWrite(const String& sql)
+    {
+        Locker locker { lock };
+        if (knownWrites.size() < maxKnownWrites) {
+            knownWrites.add(sql.isolatedCopy());
+        }
+    }
+
+    void returnReader(SQLitePooledConnection* reader)
+    {
+        {
+            Locker locker { lock };
+            idleReaders.append(reader);
+        }
+        readerReturned.notifyOne();
+    }
+
+    // Returns false if the writer was not free before the busy timeout
+    bool lockWriter()
+    {
+        writes++;
+        Locker locker { lock };
+        if (isWriterBorrowed) {
+            auto start = MonotonicTime::now();
+            bool returned = writerReturned.waitUntil(lock, start + busyTimeout, [&] {
+                assertIsHeld(lock);
+                return !isWriterBorrowed;
+            });
+            writerWaits++;
+            writerWaitNanoseconds += (MonotonicTime::now() - start).nanoseconds();
+            if (!returned) {
+                return false;
+            }
+        }
+        isWriterBorrowed = true;
+        return true;
+    }
+
+    void unlockWriter()
+    {
+        {
+            Locker locker { lock };
+            isWriterBorrowed = false;
+        }
+        writerReturned.notifyOne();
+    }
+
+    // Returns the cached statement for sql on connection, preparing it on a miss.
+    // isCached is false when the cache is full and the caller must finalize it.
+    sqlite3_stmt* statementFor(SQLitePooledConnection& connection, const String& sql, const CString& utf8, bool& isCached, int& status)
+    {
+        auto it = connection.statements.find(sql);
+        if (it != connection.statements.end()) {
+            statementHits++;
+            isCached = true;
+            status = SQLITE_OK;
+            return it->value;
+        }
+
+        statementMisses++;
+        sqlite3_stmt* stmt = nullptr;
+        status = sqlite3_prepare_v3(connection.db, utf8.data(), utf8.length(), SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+        if (status != SQLITE_OK || !stmt) {
+            isCached = false;
+            return stmt;
+        }
+
+        isCached = connection.statements.size() < SQLitePooledConnection::maxCachedStatements;
+        if (isCached) {
+            connection.statements.add(sql.isolatedCopy(), stmt);
+        }
+        return stmt;
+    }
+};
+
+// The pools this thread is running a poolQuery() on, innermost first. A binding getter that
+// queries the same pool again would wait for the connection its caller holds.
+class SQLitePoolQueryScope {
+public:
+    explicit SQLitePoolQueryScope(SQLitePool& pool)
+        : m_pool(pool)
+        , m_outer(s_current)
+    {
+        s_current = this;
+    }
+
+    ~SQLitePoolQueryScope()
+    {
+        s_current = m_outer;
+    }
+
+    static bool isRunning(const SQLitePool& pool)
+    {
+        for (auto* scope = s_current; scope; scope = scope->m_outer) {
+            if (&scope->m_pool == &pool) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    SQLitePool& m_pool;
+    SQLitePoolQueryScope* m_outer;
+    static inline thread_local SQLitePoolQueryScope* s_current = nullptr;
+};
+
+static Lock sqlitePoolsLock;
+static Vector<SQLitePool*>& sqlitePools() WTF_REQUIRES_LOCK(sqlitePoolsLock)
+{
+    static NeverDestroyed<Vector<SQLitePool*>> pools;
+    return pools;
+}
+
 extern "C" void Bun__closeAllSQLiteDatabasesForTermination()
 {
     if (!_instance) {
@@ -258,6 +676,7 @@ extern "C" void Bun__closeAllSQLiteDatabasesForTermination()
     auto& dbs = _instance->databases;
 
     for (auto& db : dbs) {
+        db->statementCache.clear();
         if (db->db)
             sqlite3_close(db->db);
     }
@@ -275,10 +694,12 @@ JSC_DECLARE_HOST_FUNCTION(jsSQLStatementLoadExtensionFunction);
 
 JSC_DECLARE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunction);
 JSC_DECLARE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRun);
+JSC_DECLARE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRunMany);
 JSC_DECLARE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionGet);
 JSC_DECLARE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionAll);
 JSC_DECLARE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionIterate);
 JSC_DECLARE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRows);
+JSC_DECLARE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionColumnar);
 
 JSC_DECLARE_CUSTOM_GETTER(jsSqlStatementGetColumnNames);
 JSC_DECLARE_CUSTOM_GETTER(jsSqlStatementGetColumnCount);
@@ -330,6 +751,18 @@ static JSValue createSQLiteError(JSC::JSGlobalObject* globalObject, sqlite3* db)
     return object;
 }
 
+// For SQLITE_BUSY raised by a pool that ran out of time waiting for a connection of its own
+static JSValue createSQLiteBusyError(JSC::JSGlobalObject* globalObject, ASCIILiteral message)
+{
+    auto& vm = JSC::getVM(globalObject);
+    JSC::JSObject* object = JSC::createError(globalObject, message);
+    auto& builtinNames = WebCore::builtinNames(vm);
+    object->putDirect(vm, vm.propertyNames->name, jsString(vm, String("SQLiteError"_s)), JSC::PropertyAttribute::DontEnum | 0);
+    object->putDirect(vm, builtinNames.codePublicName(), jsString(vm, String("SQLITE_BUSY"_s)), PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly | 0);
+    object->putDirect(vm, builtinNames.errnoPublicName(), jsNumber(SQLITE_BUSY), PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly | 0);
+    return object;
+}
+
 class SQLiteBindingsMap {
 public:
     SQLiteBindingsMap() = default;
@@ -457,6 +890,8 @@ public:
 
     ~JSSQLStatement();
 
+    void finalizeStatement();
+
     sqlite3_stmt* stmt;
     VersionSqlite3* version_db;
     uint64_t version = 0;
@@ -468,6 +903,12 @@ public:
     mutable JSC::WriteBarrier<JSC::Structure> _structure;
     mutable JSC::WriteBarrier<JSC::JSObject> userPrototype;
     size_t extraMemorySize = 0;
+    // Set when the statement goes back to the database's statement cache once finalized
+    String cacheKey;
+    // The text the caller passed, and the text stmt was compiled from. They differ when the
+    // statement was taken from the cache for a differently spelled query.
+    String sql;
+    String preparedSql;
     SQLiteBindingsMap m_bindingNames = { 0, false };
     bool hasExecuted : 1 = false;
     bool useBigInt64 : 1 = false;
@@ -535,11 +976,13 @@ static JSValue toJS(JSC::VM& vm, JSC::JSGlobalObject* globalObject, sqlite3_stmt
 
 static const HashTableValue JSSQLStatementPrototypeTableValues[] = {
     { "run"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteStatementFunctionRun, 1 } },
+    { "runMany"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteStatementFunctionRunMany, 2 } },
     { "get"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteStatementFunctionGet, 1 } },
     { "all"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteStatementFunctionAll, 1 } },
     { "iterate"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteStatementFunctionIterate, 1 } },
     { "as"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementSetPrototypeFunction, 1 } },
     { "values"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteStatementFunctionRows, 1 } },
+    { "columnar"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteStatementFunctionColumnar, 1 } },
     { "finalize"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementFunctionFinalize, 0 } },
     { "toString"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementToStringFunction, 0 } },
     { "columns"_s, static_cast<unsigned>(JSC::PropertyAttribute::ReadOnly | JSC::PropertyAttribute::CustomAccessor), NoIntrinsic, { HashTableValue::GetterSetterType, jsSqlStatementGetColumnNames, 0 } },
@@ -1513,33 +1956,51 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementPrepareStatementFunction, (JSC::JSGlobalO
         flags = static_cast<unsigned int>(prepareFlags);
     }
 
-    sqlite3_stmt* statement = nullptr;
+    auto& statementCache = databases()[handle]->statementCache;
+    String cacheKey;
+    SQLiteStatementCache::Entry cached;
+    if (statementCache.capacity) {
+        cacheKey = SQLiteStatementCache::keyFor(sqlString, flags);
+        cached = statementCache.take(cacheKey, sqlString);
+    }
 
-    // This is inherently somewhat racy if using Worker
-    // but that should be okay.
-    int64_t currentMemoryUsage = sqlite_malloc_amount;
+    sqlite3_stmt* statement = cached.stmt;
+    int64_t memoryChange = cached.memorySize;
 
-    int rc = SQLITE_OK;
-    if (
-        // fast path: ascii latin1 string is utf8
-        sqlString.is8Bit() && simdutf::validate_ascii(reinterpret_cast<const char*>(sqlString.span8().data()), sqlString.length())) {
-        rc = sqlite3_prepare_v3(db, reinterpret_cast<const char*>(sqlString.span8().data()), sqlString.length(), flags, &statement, nullptr);
-    } else {
-        // slow path: utf16 or latin1 string with supplemental characters
-        CString utf8 = sqlString.utf8();
-        rc = sqlite3_prepare_v3(db, utf8.data(), utf8.length(), flags, &statement, nullptr);
-    }
+    if (!statement) {
+        // This is inherently somewhat racy if using Worker
+        // but that should be okay.
+        int64_t currentMemoryUsage = sqlite_malloc_amount;
 
-    if (rc != SQLITE_OK) {
-        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, db));
-        return {};
-    }
+        int rc = SQLITE_OK;
+        if (
+            // fast path: ascii latin1 string is utf8
+            sqlString.is8Bit() && simdutf::validate_ascii(reinterpret_cast<const char*>(sqlString.span8().data()), sqlString.length())) {
+            rc = sqlite3_prepare_v3(db, reinterpret_cast<const char*>(sqlString.span8().data()), sqlString.length(), flags, &statement, nullptr);
+        } else {
+            // slow path: utf16 or latin1 string with supplemental characters
+            CString utf8 = sqlString.utf8();
+            rc = sqlite3_prepare_v3(db, utf8.data(), utf8.length(), flags, &statement, nullptr);
+        }
 
-    int64_t memoryChange = sqlite_malloc_amount - currentMemoryUsage;
+        if (rc != SQLITE_OK) {
+            throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, db));
+            return {};
+        }
+
+        memoryChange = sqlite_malloc_amount - currentMemoryUsage;
+    }
 
     JSSQLStatement* sqlStatement = JSSQLStatement::create(
         reinterpret_cast<Zig::GlobalObject*>(lexicalGlobalObject), statement, databases()[handle], memoryChange);
 
+    // Empty statements have nothing worth keeping
+    if (!cacheKey.isNull() && statement) {
+        sqlStatement->cacheKey = WTFMove(cacheKey);
+        sqlStatement->preparedSql = cached.stmt ? WTFMove(cached.sql) : sqlString;
+        sqlStatement->sql = WTFMove(sqlString);
+    }
+
     if (internalFlagsValue.isInt32()) {
         const int32_t internalFlags = internalFlagsValue.asInt32();
         sqlStatement->m_bindingNames.trimLeadingPrefix = (internalFlags & kStrictFlag) != 0;
@@ -1682,6 +2143,8 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementCloseStatementFunction, (JSC::JSGlobalObj
         return JSValue::encode(jsUndefined());
     }
 
+    databases()[dbIndex]->statementCache.clear();
+
     // sqlite3_close_v2 is used for automatic GC cleanup
     int statusCode = shouldThrowOnError ? sqlite3_close(db) : sqlite3_close_v2(db);
     if (statusCode != SQLITE_OK) {
@@ -1778,84 +2241,701 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementFcntlFunction, (JSC::JSGlobalObject * lex
     return JSValue::encode(jsNumber(statusCode));
 }
 
-/* Hash table for constructor */
-static const HashTableValue JSSQLStatementConstructorTableValues[] = {
-    { "open"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementOpenStatementFunction, 2 } },
-    { "close"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementCloseStatementFunction, 1 } },
-    { "prepare"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementPrepareStatementFunction, 2 } },
-    { "run"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteFunction, 3 } },
-    { "isInTransaction"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementIsInTransactionFunction, 1 } },
-    { "loadExtension"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementLoadExtensionFunction, 2 } },
-    { "setCustomSQLite"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementSetCustomSQLite, 1 } },
-    { "serialize"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementSerialize, 1 } },
-    { "deserialize"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementDeserialize, 2 } },
-    { "fcntl"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementFcntlFunction, 2 } },
-};
-
-const ClassInfo JSSQLStatementConstructor::s_info = { "SQLStatement"_s, &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(JSSQLStatementConstructor) };
-
-void JSSQLStatementConstructor::finishCreation(VM& vm)
+static VersionSqlite3* databaseFor(JSC::JSGlobalObject* lexicalGlobalObject, JSC::ThrowScope& scope, JSValue handleValue)
 {
-    Base::finishCreation(vm);
+    if (!handleValue.isNumber()) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Expected number"_s));
+        return nullptr;
+    }
 
-    // TODO: use LazyClassStructure?
-    auto* instanceObject = JSSQLStatement::create(reinterpret_cast<Zig::GlobalObject*>(globalObject()), nullptr, nullptr);
-    JSValue proto = instanceObject->getPrototype(vm, globalObject());
+    int32_t handle = handleValue.toInt32(lexicalGlobalObject);
+    if (handle < 0 || static_cast<size_t>(handle) >= databases().size()) {
+        throwException(lexicalGlobalObject, scope, createRangeError(lexicalGlobalObject, "Invalid database handle"_s));
+        return nullptr;
+    }
+    return databases()[handle];
+}
 
-    this->putDirect(vm, vm.propertyNames->prototype, proto, PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly);
+// statementCacheStats(db) -> { size, capacity, hits, misses, evictions }
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementStatementCacheStatsFunction, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+{
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
 
-    reifyStaticProperties(vm, JSSQLStatementConstructor::info(), JSSQLStatementConstructorTableValues, *this);
-    JSC_TO_STRING_TAG_WITHOUT_TRANSITION();
+    VersionSqlite3* database = databaseFor(lexicalGlobalObject, scope, callFrame->argument(0));
+    RETURN_IF_EXCEPTION(scope, {});
 
-    ASSERT(inherits(info()));
+    const auto& cache = database->statementCache;
+    JSC::JSObject* stats = JSC::constructEmptyObject(lexicalGlobalObject);
+    stats->putDirect(vm, Identifier::fromString(vm, "size"_s), jsNumber(cache.size()), 0);
+    stats->putDirect(vm, Identifier::fromString(vm, "capacity"_s), jsNumber(cache.capacity), 0);
+    stats->putDirect(vm, Identifier::fromString(vm, "hits"_s), jsNumber(cache.hits), 0);
+    stats->putDirect(vm, Identifier::fromString(vm, "misses"_s), jsNumber(cache.misses), 0);
+    stats->putDirect(vm, Identifier::fromString(vm, "evictions"_s), jsNumber(cache.evictions), 0);
+    return JSValue::encode(stats);
 }
 
-template<bool useBigInt64>
-static inline JSC::JSValue constructResultObject(JSC::JSGlobalObject* lexicalGlobalObject, JSSQLStatement* castedThis)
+// setStatementCacheSize(db, size): 0 turns the cache off and finalizes what it holds
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementSetStatementCacheSizeFunction, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
 {
-    auto& columnNames = castedThis->columnNames->data()->propertyNameVector();
-    int count = columnNames.size();
     auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
 
-    // 64 is the maximum we can preallocate here
-    // see https://github.com/oven-sh/bun/issues/987
-    JSC::JSObject* result;
-
-    auto* stmt = castedThis->stmt;
+    VersionSqlite3* database = databaseFor(lexicalGlobalObject, scope, callFrame->argument(0));
+    RETURN_IF_EXCEPTION(scope, {});
 
-    if (auto* structure = castedThis->_structure.get()) {
-        result = JSC::constructEmptyObject(vm, structure);
+    JSValue sizeValue = callFrame->argument(1);
+    if (!sizeValue.isInt32() || sizeValue.asInt32() < 0 || sizeValue.asInt32() > 65535) {
+        throwException(lexicalGlobalObject, scope, createRangeError(lexicalGlobalObject, "Expected size to be an integer between 0 and 65535"_s));
+        return {};
+    }
 
-        // i: the index of columns returned from SQLite
-        // j: the index of object property
-        for (int i = 0, j = 0; j < count; i++, j++) {
-            if (!castedThis->validColumns.get(i)) {
-                // this column is duplicate, skip
-                j -= 1;
-                continue;
-            }
-            result->putDirectOffset(vm, j, toJS<useBigInt64>(vm, lexicalGlobalObject, stmt, i));
-        }
+    database->statementCache.shrink(sizeValue.asInt32());
+    return JSValue::encode(jsUndefined());
+}
 
-    } else {
-        if (count <= JSFinalObject::maxInlineCapacity) {
-            result = JSC::JSFinalObject::create(vm, castedThis->_prototype.get()->structure());
-        } else {
-            JSObject* prototype = castedThis->userPrototype ? castedThis->userPrototype.get() : lexicalGlobalObject->objectPrototype();
-            result = JSC::JSFinalObject::create(vm, JSC::JSFinalObject::createStructure(vm, lexicalGlobalObject, prototype, JSFinalObject::maxInlineCapacity));
-        }
+enum class SQLitePoolQueryMode : int32_t {
+    Run = 0,
+    All = 1,
+    Values = 2,
+    Get = 3,
+};
 
-        for (int i = 0, j = 0; j < count; i++, j++) {
-            if (!castedThis->validColumns.get(i)) {
-                j -= 1;
-                continue;
-            }
-            const auto& name = columnNames[j];
-            result->putDirect(vm, name, toJS<useBigInt64>(vm, lexicalGlobalObject, stmt, i), 0);
+static void releaseSQLitePool(size_t index)
+{
+    SQLitePool* pool = nullptr;
+    {
+        Locker locker { sqlitePoolsLock };
+        auto& pools = sqlitePools();
+        if (index >= pools.size() || !pools[index] || --pools[index]->reference_count > 0) {
+            return;
         }
+        pool = std::exchange(pools[index], nullptr);
     }
-
-    return JSValue(result);
+    delete pool;
+}
+
+// The openPool() references a ScriptExecutionContext holds. Whatever it did not closePool()
+// is released when the context goes away, so a Worker that exits does not keep pools open.
+class SQLitePoolReferences final : public ContextDestructionObserver {
+    WTF_MAKE_FAST_ALLOCATED;
+
+public:
+    explicit SQLitePoolReferences(ScriptExecutionContext& context)
+        : ContextDestructionObserver(&context)
+        , identifier(context.identifier())
+    {
+    }
+
+    void contextDestroyed() final;
+
+    ScriptExecutionContextIdentifier identifier;
+    Vector<size_t> pools WTF_GUARDED_BY_LOCK(sqlitePoolsLock);
+};
+
+static HashMap<ScriptExecutionContextIdentifier, SQLitePoolReferences*>& sqlitePoolReferences() WTF_REQUIRES_LOCK(sqlitePoolsLock)
+{
+    static NeverDestroyed<HashMap<ScriptExecutionContextIdentifier, SQLitePoolReferences*>> references;
+    return references;
+}
+
+void SQLitePoolReferences::contextDestroyed()
+{
+    Vector<size_t> held;
+    {
+        Locker locker { sqlitePoolsLock };
+        held = WTFMove(pools);
+        sqlitePoolReferences().remove(identifier);
+    }
+    for (size_t index : held) {
+        releaseSQLitePool(index);
+    }
+
+    ContextDestructionObserver::contextDestroyed();
+    delete this;
+}
+
+static void holdSQLitePool(ScriptExecutionContext* context, size_t index) WTF_REQUIRES_LOCK(sqlitePoolsLock)
+{
+    if (!context) {
+        return;
+    }
+    auto* references = sqlitePoolReferences().ensure(context->identifier(), [&] {
+        return new SQLitePoolReferences(*context);
+    }).iterator->value;
+    references->pools.append(index);
+}
+
+// Holds a reference for the duration of a call, so a Worker closing the pool cannot free it underneath us
+static SQLitePool* retainSQLitePool(JSC::JSGlobalObject* lexicalGlobalObject, JSC::ThrowScope& scope, JSValue handleValue, size_t& index)
+{
+    if (!handleValue.isInt32()) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Expected pool handle"_s));
+        return nullptr;
+    }
+
+    int32_t handle = handleValue.asInt32();
+    Locker locker { sqlitePoolsLock };
+    auto& pools = sqlitePools();
+    if (handle < 0 || static_cast<size_t>(handle) >= pools.size() || !pools[handle]) {
+        throwException(lexicalGlobalObject, scope, createRangeError(lexicalGlobalObject, "Cannot use a closed database pool"_s));
+        return nullptr;
+    }
+    index = handle;
+    pools[handle]->reference_count++;
+    return pools[handle];
+}
+
+static std::unique_ptr<SQLitePooledConnection> createPooledConnection(SQLitePool& pool, sqlite3* db)
+{
+    auto connection = makeUnique<SQLitePooledConnection>(pool, db);
+    sqlite3_extended_result_codes(db, 1);
+    sqlite3_db_config(db, SQLITE_DBCONFIG_DEFENSIVE, 1, NULL);
+    sqlite3_busy_handler(db, SQLitePool::busyHandler, connection.get());
+    return connection;
+}
+
+// Looks for a pool another Worker opened for path and adds a reference for context to it
+static std::optional<size_t> retainOpenSQLitePool(ScriptExecutionContext* context, const String& path) WTF_REQUIRES_LOCK(sqlitePoolsLock)
+{
+    auto& pools = sqlitePools();
+    for (size_t i = 0; i < pools.size(); i++) {
+        if (pools[i] && pools[i]->path == path) {
+            pools[i]->reference_count++;
+            holdSQLitePool(context, i);
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+// openPool(path, readers = 4, busyTimeoutMs = 5000): opens path in WAL mode with one writer and
+// `readers` read-only connections, or adds a reference to the pool another Worker already opened
+// for the same file, however its path was spelled. A query waits up to busyTimeoutMs for a connection or a lock held by another
+// process before failing with SQLITE_BUSY. References not given back with closePool() are released
+// when the Worker that took them exits.
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementOpenPoolFunction, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+{
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+
+    JSValue thisValue = callFrame->thisValue();
+    JSSQLStatementConstructor* constructor = jsDynamicCast<JSSQLStatementConstructor*>(thisValue.getObject());
+    if (!constructor) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Expected SQLStatement"_s));
+        return {};
+    }
+
+    JSValue pathValue = callFrame->argument(0);
+    if (!pathValue.isString()) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Expected string"_s));
+        return {};
+    }
+
+    int32_t readerCount = 4;
+    JSValue readersValue = callFrame->argument(1);
+    if (!readersValue.isUndefined()) {
+        if (!readersValue.isInt32() || readersValue.asInt32() < 1 || readersValue.asInt32() > 64) {
+            throwException(lexicalGlobalObject, scope, createRangeError(lexicalGlobalObject, "Expected readers to be an integer between 1 and 64"_s));
+            return {};
+        }
+        readerCount = readersValue.asInt32();
+    }
+
+    Seconds busyTimeout = SQLitePool::defaultBusyTimeout;
+    JSValue busyTimeoutValue = callFrame->argument(2);
+    if (!busyTimeoutValue.isUndefined()) {
+        if (!busyTimeoutValue.isInt32() || busyTimeoutValue.asInt32() < 0) {
+            throwException(lexicalGlobalObject, scope, createRangeError(lexicalGlobalObject, "Expected busyTimeout to be a non-negative integer"_s));
+            return {};
+        }
+        busyTimeout = Seconds::fromMilliseconds(busyTimeoutValue.asInt32());
+    }
+
+#if LAZY_LOAD_SQLITE
+    if (UNLIKELY(lazyLoadSQLite() < 0)) {
+        WTF::String msg = WTF::String::fromUTF8(dlerror());
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, msg));
+        return {};
+    }
+#endif
+    initializeSQLite();
+
+    String path = pathValue.toWTFString(lexicalGlobalObject);
+    RETURN_IF_EXCEPTION(scope, {});
+    CString utf8Path = path.utf8();
+    auto* context = defaultGlobalObject(lexicalGlobalObject)->scriptExecutionContext();
+
+    {
+        Locker locker { sqlitePoolsLock };
+        if (auto index = retainOpenSQLitePool(context, path)) {
+            return JSValue::encode(jsNumber(*index));
+        }
+    }
+
+    // Opening, switching to WAL and opening the readers touch the disk, so other Workers
+    // using or opening pools do not wait for it. The first pool published for a path wins.
+    auto pool = makeUnique<SQLitePool>();
+    pool->busyTimeout = busyTimeout;
+
+    sqlite3* db = nullptr;
+    int status = sqlite3_open_v2(utf8Path.data(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nullptr);
+    if (status != SQLITE_OK) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, db));
+        sqlite3_close_v2(db);
+        return {};
+    }
+    pool->writer = createPooledConnection(*pool, db);
+
+    // Relative paths, "./" and symlinks name the same file, so pools are keyed by the absolute
+    // path SQLite resolved for it
+    const char* filename = sqlite3_db_filename(db, "main");
+    pool->path = filename && *filename ? String::fromUTF8({ filename, strlen(filename) }) : path.isolatedCopy();
+    {
+        Locker locker { sqlitePoolsLock };
+        if (auto index = retainOpenSQLitePool(context, pool->path)) {
+            return JSValue::encode(jsNumber(*index));
+        }
+    }
+
+    // Readers only stay out of the writer's way in WAL mode
+    bool isWAL = false;
+    sqlite3_stmt* pragma = nullptr;
+    if (sqlite3_prepare_v3(db, "PRAGMA journal_mode=WAL", -1, 0, &pragma, nullptr) == SQLITE_OK && sqlite3_step(pragma) == SQLITE_ROW) {
+        const unsigned char* mode = sqlite3_column_text(pragma, 0);
+        isWAL = mode && !strcmp(reinterpret_cast<const char*>(mode), "wal");
+    }
+    sqlite3_finalize(pragma);
+    if (!isWAL) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Database pools need a database file that can use WAL mode"_s));
+        return {};
+    }
+
+    for (int32_t i = 0; i < readerCount; i++) {
+        sqlite3* reader = nullptr;
+        status = sqlite3_open_v2(utf8Path.data(), &reader, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+        if (status != SQLITE_OK) {
+            throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, reader));
+            sqlite3_close_v2(reader);
+            return {};
+        }
+        pool->readers.append(createPooledConnection(*pool, reader));
+    }
+
+    {
+        Locker poolLocker { pool->lock };
+        for (auto& reader : pool->readers) {
+            pool->idleReaders.append(reader.get());
+        }
+    }
+
+    size_t index;
+    {
+        Locker locker { sqlitePoolsLock };
+        if (auto existing = retainOpenSQLitePool(context, pool->path)) {
+            index = *existing;
+        } else {
+            auto& pools = sqlitePools();
+            index = pools.size();
+            pools.append(pool.release());
+            holdSQLitePool(context, index);
+        }
+    }
+
+    RELEASE_AND_RETURN(scope, JSValue::encode(jsNumber(index)));
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementClosePoolFunction, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+{
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+
+    JSValue handleValue = callFrame->argument(0);
+    if (!handleValue.isInt32() || handleValue.asInt32() < 0) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Expected pool handle"_s));
+        return {};
+    }
+
+    // Only give back references this context took, each at most once
+    size_t index = handleValue.asInt32();
+    bool isHeld = false;
+    if (auto* context = defaultGlobalObject(lexicalGlobalObject)->scriptExecutionContext()) {
+        Locker locker { sqlitePoolsLock };
+        auto it = sqlitePoolReferences().find(context->identifier());
+        isHeld = it != sqlitePoolReferences().end() && it->value->pools.removeFirst(index);
+    }
+    if (isHeld) {
+        releaseSQLitePool(index);
+    }
+    return JSValue::encode(jsUndefined());
+}
+
+template<bool useBigInt64>
+static JSValue executePooledStatement(JSC::VM& vm, JSC::JSGlobalObject* lexicalGlobalObject, JSC::ThrowScope& scope, SQLitePooledConnection& connection, sqlite3_stmt* stmt, SQLitePoolQueryMode mode)
+{
+    int total_changes_before = sqlite3_total_changes(connection.db);
+    int status = sqlite3_step(stmt);
+
+    JSValue result = jsUndefined();
+    switch (mode) {
+    case SQLitePoolQueryMode::Run: {
+        while (status == SQLITE_ROW) {
+            status = sqlite3_step(stmt);
+        }
+        if (status != SQLITE_DONE) {
+            break;
+        }
+
+        JSC::JSObject* object = JSC::constructEmptyObject(lexicalGlobalObject);
+        int64_t lastInsertRowid = sqlite3_last_insert_rowid(connection.db);
+        object->putDirect(vm, Identifier::fromString(vm, "changes"_s), jsNumber(sqlite3_total_changes(connection.db) - total_changes_before), 0);
+        object->putDirect(vm, Identifier::fromString(vm, "lastInsertRowid"_s), useBigInt64 ? JSValue(JSBigInt::createFrom(lexicalGlobalObject, lastInsertRowid)) : jsNumber(lastInsertRowid), 0);
+        result = object;
+        break;
+    }
+    case SQLitePoolQueryMode::Values: {
+        int columnCount = sqlite3_column_count(stmt);
+        JSC::JSArray* rows = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, 0);
+        RETURN_IF_EXCEPTION(scope, {});
+        while (status == SQLITE_ROW) {
+            JSC::JSArray* row = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, columnCount);
+            RETURN_IF_EXCEPTION(scope, {});
+            for (int i = 0; i < columnCount; i++) {
+                row->putDirectIndex(lexicalGlobalObject, i, toJS<useBigInt64>(vm, lexicalGlobalObject, stmt, i));
+                RETURN_IF_EXCEPTION(scope, {});
+            }
+            rows->push(lexicalGlobalObject, row);
+            RETURN_IF_EXCEPTION(scope, {});
+            status = sqlite3_step(stmt);
+        }
+        result = rows;
+        break;
+    }
+    case SQLitePoolQueryMode::All:
+    case SQLitePoolQueryMode::Get: {
+        // Later columns win over earlier ones with the same name, like in the statement objects
+        int columnCount = sqlite3_column_count(stmt);
+        Vector<Identifier> names;
+        Vector<int> columns;
+        for (int i = columnCount - 1; i >= 0; i--) {
+            const char* name = sqlite3_column_name(stmt, i);
+            Identifier identifier = Identifier::fromString(vm, WTF::String::fromUTF8({ name ? name : "", name ? strlen(name) : 0 }));
+            if (!names.contains(identifier)) {
+                names.append(WTFMove(identifier));
+                columns.append(i);
+            }
+        }
+        names.reverse();
+        columns.reverse();
+
+        Structure* structure = nullptr;
+        if (names.size() <= JSFinalObject::maxInlineCapacity) {
+            PropertyOffset offset;
+            structure = lexicalGlobalObject->structureCache().emptyObjectStructureForPrototype(lexicalGlobalObject, lexicalGlobalObject->objectPrototype(), names.size());
+            for (const auto& name : names) {
+                structure = Structure::addPropertyTransition(vm, structure, name, 0, offset);
+            }
+        }
+
+        auto constructRow = [&]() -> JSC::JSObject* {
+            JSC::JSObject* row = structure ? JSC::constructEmptyObject(vm, structure) : JSC::constructEmptyObject(lexicalGlobalObject);
+            for (size_t j = 0; j < names.size(); j++) {
+                JSValue value = toJS<useBigInt64>(vm, lexicalGlobalObject, stmt, columns[j]);
+                if (structure) {
+                    row->putDirectOffset(vm, j, value);
+                } else {
+                    row->putDirect(vm, names[j], value, 0);
+                }
+            }
+            return row;
+        };
+
+        if (mode == SQLitePoolQueryMode::Get) {
+            result = jsNull();
+            if (status == SQLITE_ROW) {
+                result = constructRow();
+                RETURN_IF_EXCEPTION(scope, {});
+            }
+            while (status == SQLITE_ROW) {
+                status = sqlite3_step(stmt);
+            }
+            break;
+        }
+
+        JSC::JSArray* rows = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, 0);
+        RETURN_IF_EXCEPTION(scope, {});
+        while (status == SQLITE_ROW) {
+            rows->push(lexicalGlobalObject, constructRow());
+            RETURN_IF_EXCEPTION(scope, {});
+            status = sqlite3_step(stmt);
+        }
+        result = rows;
+        break;
+    }
+    }
+
+    if (UNLIKELY(status != SQLITE_DONE && status != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, connection.db));
+        return {};
+    }
+    return result;
+}
+
+// poolQuery(pool, sql, bindings, mode, internalFlags): runs one statement on a borrowed connection.
+// Read-only statements run on a reader, anything else waits its turn on the writer, blocking the
+// calling thread for up to the pool's busy timeout. Each call is its own transaction, a statement
+// that would leave one open is rolled back with an error. Querying the same pool from a binding
+// getter throws rather than waiting on the connection the outer call holds.
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementPoolQueryFunction, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+{
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+
+    size_t poolIndex = 0;
+    SQLitePool* pool = retainSQLitePool(lexicalGlobalObject, scope, callFrame->argument(0), poolIndex);
+    RETURN_IF_EXCEPTION(scope, {});
+    auto releasePool = makeScopeExit([&] { releaseSQLitePool(poolIndex); });
+
+    if (UNLIKELY(SQLitePoolQueryScope::isRunning(*pool))) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Cannot query a database pool while another query on it is running on this thread"_s));
+        return {};
+    }
+    SQLitePoolQueryScope queryScope { *pool };
+
+    JSValue sqlValue = callFrame->argument(1);
+    if (UNLIKELY(!sqlValue.isString())) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Expected SQL string"_s));
+        return {};
+    }
+    String sql = sqlValue.toWTFString(lexicalGlobalObject);
+    RETURN_IF_EXCEPTION(scope, {});
+    if (UNLIKELY(sql.isEmpty())) {
+        throwException(lexicalGlobalObject, scope, createRangeError(lexicalGlobalObject, "Invalid SQL statement"_s));
+        return {};
+    }
+    CString utf8 = sql.utf8();
+
+    EnsureStillAliveScope bindings = callFrame->argument(2);
+    if (!bindings.value().isUndefinedOrNull() && !bindings.value().isObject()) {
+        throwException(lexicalGlobalObject, scope, createTypeError(lexicalGlobalObject, "Expected bindings to be an object or array"_s));
+        return {};
+    }
+
+    JSValue modeValue = callFrame->argument(3);
+    int32_t modeNumber = modeValue.isInt32() ? modeValue.asInt32() : static_cast<int32_t>(SQLitePoolQueryMode::All);
+    if (modeNumber < static_cast<int32_t>(SQLitePoolQueryMode::Run) || modeNumber > static_cast<int32_t>(SQLitePoolQueryMode::Get)) {
+        throwException(lexicalGlobalObject, scope, createRangeError(lexicalGlobalObject, "Invalid query mode"_s));
+        return {};
+    }
+    auto mode = static_cast<SQLitePoolQueryMode>(modeNumber);
+
+    JSValue internalFlagsValue = callFrame->argument(4);
+    bool strict = internalFlagsValue.isInt32() && (internalFlagsValue.asInt32() & kStrictFlag) != 0;
+    bool safeIntegers = internalFlagsValue.isInt32() && (internalFlagsValue.asInt32() & kSafeIntegersFlag) != 0;
+
+    bool isCached = false;
+    int status = SQLITE_OK;
+    SQLitePooledConnection* connection = nullptr;
+    sqlite3_stmt* stmt = nullptr;
+    bool isWriter = pool->isKnownWrite(sql);
+
+    if (!isWriter) {
+        connection = pool->borrowReader();
+        if (UNLIKELY(!connection)) {
+            throwException(lexicalGlobalObject, scope, createSQLiteBusyError(lexicalGlobalObject, "Timed out waiting for a pooled reader connection"_s));
+            return {};
+        }
+        stmt = pool->statementFor(*connection, sql, utf8, isCached, status);
+
+        // Only the writer caches writes, later calls go straight to it
+        if (stmt && !sqlite3_stmt_readonly(stmt)) {
+            if (isCached) {
+                connection->statements.remove(sql);
+            }
+            sqlite3_finalize(stmt);
+            pool->returnReader(connection);
+            pool->addKnownWrite(sql);
+            isWriter = true;
+        }
+    }
+
+    if (isWriter) {
+        if (UNLIKELY(!pool->lockWriter())) {
+            throwException(lexicalGlobalObject, scope, createSQLiteBusyError(lexicalGlobalObject, "Timed out waiting for the pooled writer connection"_s));
+            return {};
+        }
+        connection = pool->writer.get();
+        stmt = pool->statementFor(*connection, sql, utf8, isCached, status);
+    }
+
+    JSValue result;
+    if (status != SQLITE_OK || !stmt) {
+        if (status != SQLITE_OK) {
+            throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, connection->db));
+        } else {
+            throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Query contained no valid SQL statement; likely empty query."_s));
+        }
+    } else {
+        bool isBound = true;
+        if (bindings.value().isObject()) {
+            int count = sqlite3_bind_parameter_count(stmt);
+            SQLiteBindingsMap bindingsMap { static_cast<uint16_t>(count > -1 ? count : 0), strict };
+            JSValue reb = rebindStatement(lexicalGlobalObject, bindings.value(), scope, connection->db, stmt, true, bindingsMap, safeIntegers);
+            isBound = !scope.exception() && reb.isNumber();
+        }
+
+        if (isBound) {
+            result = safeIntegers ? executePooledStatement<true>(vm, lexicalGlobalObject, scope, *connection, stmt, mode)
+                                  : executePooledStatement<false>(vm, lexicalGlobalObject, scope, *connection, stmt, mode);
+        }
+
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        if (!isCached) {
+            sqlite3_finalize(stmt);
+        }
+
+        if (!sqlite3_get_autocommit(connection->db)) {
+            sqlite3_exec(connection->db, "ROLLBACK", nullptr, nullptr, nullptr);
+            if (!scope.exception()) {
+                throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Transactions cannot span pooled queries, it was rolled back"_s));
+            }
+        }
+    }
+
+    if (isWriter) {
+        pool->unlockWriter();
+    } else {
+        pool->returnReader(connection);
+    }
+
+    RETURN_IF_EXCEPTION(scope, {});
+    RELEASE_AND_RETURN(scope, JSValue::encode(result));
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementPoolStatsFunction, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+{
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+
+    size_t poolIndex = 0;
+    SQLitePool* pool = retainSQLitePool(lexicalGlobalObject, scope, callFrame->argument(0), poolIndex);
+    RETURN_IF_EXCEPTION(scope, {});
+    auto releasePool = makeScopeExit([&] { releaseSQLitePool(poolIndex); });
+
+    size_t idleReaders;
+    {
+        Locker locker { pool->lock };
+        idleReaders = pool->idleReaders.size();
+    }
+
+    uint64_t hits = pool->statementHits;
+    uint64_t misses = pool->statementMisses;
+
+    JSC::JSObject* stats = JSC::constructEmptyObject(lexicalGlobalObject);
+    auto put = [&](ASCIILiteral name, double value) {
+        stats->putDirect(vm, Identifier::fromString(vm, name), jsNumber(value), 0);
+    };
+    put("readers"_s, pool->readers.size());
+    put("idleReaders"_s, idleReaders);
+    put("reads"_s, pool->borrows.load());
+    put("readerWaits"_s, pool->readerWaits.load());
+    put("readerWaitMs"_s, pool->readerWaitNanoseconds.load() / 1e6);
+    put("writes"_s, pool->writes.load());
+    put("writerWaits"_s, pool->writerWaits.load());
+    put("writerWaitMs"_s, pool->writerWaitNanoseconds.load() / 1e6);
+    put("statementHits"_s, hits);
+    put("statementMisses"_s, misses);
+    put("statementHitRate"_s, hits + misses ? static_cast<double>(hits) / (hits + misses) : 0);
+    put("busyRetries"_s, pool->busyRetries.load());
+
+    return JSValue::encode(stats);
+}
+
+/* Hash table for constructor */
+static const HashTableValue JSSQLStatementConstructorTableValues[] = {
+    { "open"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementOpenStatementFunction, 2 } },
+    { "close"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementCloseStatementFunction, 1 } },
+    { "prepare"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementPrepareStatementFunction, 2 } },
+    { "run"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementExecuteFunction, 3 } },
+    { "isInTransaction"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementIsInTransactionFunction, 1 } },
+    { "loadExtension"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementLoadExtensionFunction, 2 } },
+    { "setCustomSQLite"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementSetCustomSQLite, 1 } },
+    { "serialize"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementSerialize, 1 } },
+    { "deserialize"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementDeserialize, 2 } },
+    { "fcntl"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementFcntlFunction, 2 } },
+    { "statementCacheStats"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementStatementCacheStatsFunction, 1 } },
+    { "setStatementCacheSize"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementSetStatementCacheSizeFunction, 2 } },
+    { "openPool"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementOpenPoolFunction, 3 } },
+    { "closePool"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementClosePoolFunction, 1 } },
+    { "poolQuery"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementPoolQueryFunction, 5 } },
+    { "poolStats"_s, static_cast<unsigned>(JSC::PropertyAttribute::Function), NoIntrinsic, { HashTableValue::NativeFunctionType, jsSQLStatementPoolStatsFunction, 1 } },
+};
+
+const ClassInfo JSSQLStatementConstructor::s_info = { "SQLStatement"_s, &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(JSSQLStatementConstructor) };
+
+void JSSQLStatementConstructor::finishCreation(VM& vm)
+{
+    Base::finishCreation(vm);
+
+    // TODO: use LazyClassStructure?
+    auto* instanceObject = JSSQLStatement::create(reinterpret_cast<Zig::GlobalObject*>(globalObject()), nullptr, nullptr);
+    JSValue proto = instanceObject->getPrototype(vm, globalObject());
+
+    this->putDirect(vm, vm.propertyNames->prototype, proto, PropertyAttribute::DontEnum | PropertyAttribute::DontDelete | PropertyAttribute::ReadOnly);
+
+    reifyStaticProperties(vm, JSSQLStatementConstructor::info(), JSSQLStatementConstructorTableValues, *this);
+    JSC_TO_STRING_TAG_WITHOUT_TRANSITION();
+
+    ASSERT(inherits(info()));
+}
+
+template<bool useBigInt64>
+static inline JSC::JSValue constructResultObject(JSC::JSGlobalObject* lexicalGlobalObject, JSSQLStatement* castedThis)
+{
+    auto& columnNames = castedThis->columnNames->data()->propertyNameVector();
+    int count = columnNames.size();
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+
+    // 64 is the maximum we can preallocate here
+    // see https://github.com/oven-sh/bun/issues/987
+    JSC::JSObject* result;
+
+    auto* stmt = castedThis->stmt;
+
+    if (auto* structure = castedThis->_structure.get()) {
+        result = JSC::constructEmptyObject(vm, structure);
+
+        // i: the index of columns returned from SQLite
+        // j: the index of object property
+        for (int i = 0, j = 0; j < count; i++, j++) {
+            if (!castedThis->validColumns.get(i)) {
+                // this column is duplicate, skip
+                j -= 1;
+                continue;
+            }
+            result->putDirectOffset(vm, j, toJS<useBigInt64>(vm, lexicalGlobalObject, stmt, i));
+        }
+
+    } else {
+        if (count <= JSFinalObject::maxInlineCapacity) {
+            result = JSC::JSFinalObject::create(vm, castedThis->_prototype.get()->structure());
+        } else {
+            JSObject* prototype = castedThis->userPrototype ? castedThis->userPrototype.get() : lexicalGlobalObject->objectPrototype();
+            result = JSC::JSFinalObject::create(vm, JSC::JSFinalObject::createStructure(vm, lexicalGlobalObject, prototype, JSFinalObject::maxInlineCapacity));
+        }
+
+        for (int i = 0, j = 0; j < count; i++, j++) {
+            if (!castedThis->validColumns.get(i)) {
+                j -= 1;
+                continue;
+            }
+            const auto& name = columnNames[j];
+            result->putDirect(vm, name, toJS<useBigInt64>(vm, lexicalGlobalObject, stmt, i), 0);
+        }
+    }
+
+    return JSValue(result);
 }
 
 static inline JSC::JSArray* constructResultRow(JSC::VM& vm, JSC::JSGlobalObject* lexicalGlobalObject, JSSQLStatement* castedThis, size_t columnCount)
@@ -2066,34 +3146,452 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionAll, (JSC::JSGlob
                     status = sqlite3_step(stmt);
                 } while (status == SQLITE_ROW);
             }
-            result = resultArray;
+            result = resultArray;
+        }
+    } else if (status == SQLITE_DONE) {
+        result = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, 0);
+    }
+
+    if (UNLIKELY(status != SQLITE_DONE && status != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
+        sqlite3_reset(stmt);
+        return {};
+    }
+
+    int64_t memoryChange = sqlite_malloc_amount - currentMemoryUsage;
+    if (memoryChange > 255) {
+        vm.heap.deprecatedReportExtraMemory(memoryChange);
+    }
+
+    RELEASE_AND_RETURN(scope, JSC::JSValue::encode(result));
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionGet, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+{
+
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto castedThis = jsDynamicCast<JSSQLStatement*>(callFrame->thisValue());
+
+    CHECK_THIS
+
+    auto* stmt = castedThis->stmt;
+    CHECK_PREPARED
+
+    int statusCode = sqlite3_reset(stmt);
+    if (UNLIKELY(statusCode != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
+        return {};
+    }
+
+    if (callFrame->argumentCount() > 0) {
+        auto arg0 = callFrame->argument(0);
+        DO_REBIND(arg0);
+    }
+
+    int status = sqlite3_step(stmt);
+    if (!sqlite3_stmt_readonly(stmt)) {
+        castedThis->version_db->version++;
+    }
+
+    if (!castedThis->hasExecuted || castedThis->need_update()) {
+        initializeColumnNames(lexicalGlobalObject, castedThis);
+    }
+
+    JSValue result = jsNull();
+    if (status == SQLITE_ROW) {
+        bool useBigInt64 = castedThis->useBigInt64;
+
+        result = useBigInt64 ? constructResultObject<true>(lexicalGlobalObject, castedThis)
+                             : constructResultObject<false>(lexicalGlobalObject, castedThis);
+        while (status == SQLITE_ROW) {
+            status = sqlite3_step(stmt);
+        }
+    }
+
+    if (status == SQLITE_DONE || status == SQLITE_OK) {
+        RELEASE_AND_RETURN(scope, JSValue::encode(result));
+    } else {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
+        sqlite3_reset(stmt);
+        return {};
+    }
+}
+
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRows, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+{
+
+    auto& vm = JSC::getVM(lexicalGlobalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    auto castedThis = jsDynamicCast<JSSQLStatement*>(callFrame->thisValue());
+
+    CHECK_THIS;
+
+    auto* stmt = castedThis->stmt;
+    CHECK_PREPARED
+
+    int statusCode = sqlite3_reset(stmt);
+    if (UNLIKELY(statusCode != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
+        sqlite3_reset(stmt);
+        return {};
+    }
+
+    int count = callFrame->argumentCount();
+    if (count > 0) {
+        auto arg0 = callFrame->argument(0);
+        DO_REBIND(arg0);
+    }
+
+    int status = sqlite3_step(stmt);
+    if (!sqlite3_stmt_readonly(stmt)) {
+        castedThis->version_db->version++;
+    }
+
+    if (!castedThis->hasExecuted || castedThis->need_update()) {
+        initializeColumnNames(lexicalGlobalObject, castedThis);
+    }
+
+    size_t columnCount = castedThis->columnNames->size();
+    JSValue result = jsNull();
+    if (status == SQLITE_ROW) {
+        // this is a count from UPDATE or another query like that
+        if (columnCount == 0) {
+            while (status == SQLITE_ROW) {
+                status = sqlite3_step(stmt);
+            }
+
+            result = jsNumber(sqlite3_column_count(stmt));
+
+        } else {
+
+            JSC::JSArray* resultArray = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, 0);
+            {
+                size_t columnCount = sqlite3_column_count(stmt);
+
+                do {
+                    JSC::JSArray* row = constructResultRow(vm, lexicalGlobalObject, castedThis, columnCount);
+                    if (UNLIKELY(!row || scope.exception())) {
+                        sqlite3_reset(stmt);
+                        RELEASE_AND_RETURN(scope, {});
+                    }
+                    resultArray->push(lexicalGlobalObject, row);
+                    status = sqlite3_step(stmt);
+                } while (status == SQLITE_ROW);
+            }
+
+            result = resultArray;
+        }
+    } else if (status == SQLITE_DONE && columnCount != 0) {
+        // breaking change in Bun v0.6.8
+        result = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, 0);
+    }
+
+    if (UNLIKELY(status != SQLITE_DONE && status != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
+        sqlite3_reset(stmt);
+        return {};
+    }
+
+    // sqlite3_reset(stmt);
+    RELEASE_AND_RETURN(scope, JSC::JSValue::encode(result));
+}
+
+// columnar() keeps one buffer per column instead of one JSValue per cell.
+// The first non-NULL value decides the layout of a column. A later value of another
+// storage class (other than an INTEGER in a number column) turns the column into a
+// plain array of what get() and all() return for each row.
+enum class SQLiteColumnLayout : uint8_t {
+    Pending,
+    Float64,
+    BigInt64,
+    Text,
+    Blob,
+    Mixed,
+};
+
+struct SQLiteColumnBuffer {
+    SQLiteColumnLayout layout = SQLiteColumnLayout::Pending;
+    bool hasNulls = false;
+    Vector<double> doubles;
+    Vector<int64_t> integers;
+    // offsets[row] to offsets[row + 1] is the row's range in bytes
+    Vector<uint32_t> offsets;
+    Vector<uint8_t> bytes;
+    Vector<uint8_t> nulls;
+    // Index of the column's JSArray in the caller's MarkedArgumentBuffer once Mixed
+    unsigned mixedIndex = 0;
+};
+
+static inline bool columnLayoutAccepts(SQLiteColumnLayout layout, int type, bool useBigInt64)
+{
+    switch (layout) {
+    case SQLiteColumnLayout::Float64:
+        return type == SQLITE_FLOAT || (type == SQLITE_INTEGER && !useBigInt64);
+    case SQLiteColumnLayout::BigInt64:
+        return type == SQLITE_INTEGER;
+    case SQLiteColumnLayout::Text:
+        return type == SQLITE3_TEXT;
+    case SQLiteColumnLayout::Blob:
+        return type == SQLITE_BLOB;
+    case SQLiteColumnLayout::Pending:
+    case SQLiteColumnLayout::Mixed:
+        return true;
+    }
+    return true;
+}
+
+// Converts the rows buffered so far into JSValues and moves the column to a JSArray
+// rooted in mixedColumns
+static void promoteColumnToMixed(JSC::JSGlobalObject* globalObject, SQLiteColumnBuffer& column, JSC::MarkedArgumentBuffer& mixedColumns, size_t rowCount)
+{
+    auto& vm = JSC::getVM(globalObject);
+    auto scope = DECLARE_THROW_SCOPE(vm);
+
+    JSC::JSArray* values = JSC::constructEmptyArray(globalObject, nullptr, rowCount);
+    RETURN_IF_EXCEPTION(scope, void());
+
+    for (size_t row = 0; row < rowCount; row++) {
+        JSValue value = jsNull();
+        if (!column.hasNulls || !column.nulls[row]) {
+            switch (column.layout) {
+            case SQLiteColumnLayout::Float64:
+                value = jsNumber(column.doubles[row]);
+                break;
+            case SQLiteColumnLayout::BigInt64:
+                value = JSC::JSBigInt::createFrom(globalObject, column.integers[row]);
+                RETURN_IF_EXCEPTION(scope, void());
+                break;
+            case SQLiteColumnLayout::Text: {
+                std::span<const uint8_t> text = column.bytes.span().subspan(column.offsets[row], column.offsets[row + 1] - column.offsets[row]);
+                value = text.empty() ? jsEmptyString(vm) : jsString(vm, WTF::String::fromUTF8(text));
+                break;
+            }
+            case SQLiteColumnLayout::Blob: {
+                size_t len = column.offsets[row + 1] - column.offsets[row];
+                auto* array = JSC::JSUint8Array::createUninitialized(globalObject, globalObject->m_typedArrayUint8.get(globalObject), len);
+                RETURN_IF_EXCEPTION(scope, void());
+                if (len > 0) {
+                    memcpy(array->vector(), column.bytes.data() + column.offsets[row], len);
+                }
+                value = array;
+                break;
+            }
+            case SQLiteColumnLayout::Pending:
+                break;
+            case SQLiteColumnLayout::Mixed:
+                RELEASE_ASSERT_NOT_REACHED();
+            }
+        }
+        values->putDirectIndex(globalObject, row, value);
+        RETURN_IF_EXCEPTION(scope, void());
+    }
+
+    column.mixedIndex = mixedColumns.size();
+    mixedColumns.append(values);
+    if (UNLIKELY(mixedColumns.hasOverflowed())) {
+        throwOutOfMemoryError(globalObject, scope);
+        return;
+    }
+
+    column.layout = SQLiteColumnLayout::Mixed;
+    column.doubles = {};
+    column.integers = {};
+    column.offsets = {};
+    column.bytes = {};
+}
+
+template<typename Adaptor, typename T>
+static JSC::JSValue createTypedArrayFromVector(JSC::JSGlobalObject* globalObject, const Vector<T>& vector)
+{
+    static_assert(sizeof(typename Adaptor::Type) == sizeof(T));
+    auto* array = JSC::JSGenericTypedArrayView<Adaptor>::createUninitialized(globalObject, globalObject->typedArrayStructureWithTypedArrayType<Adaptor::typeValue>(), vector.size());
+    if (UNLIKELY(!array)) {
+        return {};
+    }
+
+    if (vector.size() > 0) {
+        memcpy(array->vector(), vector.data(), vector.sizeInBytes());
+    }
+    return array;
+}
+
+// Returns false if the column outgrew the 32-bit offsets. Promoting a column to Mixed may throw
+static inline bool appendColumnValue(JSC::JSGlobalObject* globalObject, SQLiteColumnBuffer& column, JSC::MarkedArgumentBuffer& mixedColumns, sqlite3_stmt* stmt, int i, size_t row, bool useBigInt64)
+{
+    int type = sqlite3_column_type(stmt, i);
+    if (type == SQLITE_NULL) {
+        if (!column.hasNulls) {
+            column.hasNulls = true;
+            column.nulls.fill(0, row);
+        }
+        column.nulls.append(1);
+
+        switch (column.layout) {
+        case SQLiteColumnLayout::Pending:
+            break;
+        case SQLiteColumnLayout::Float64:
+            column.doubles.append(std::numeric_limits<double>::quiet_NaN());
+            break;
+        case SQLiteColumnLayout::BigInt64:
+            column.integers.append(0);
+            break;
+        case SQLiteColumnLayout::Text:
+        case SQLiteColumnLayout::Blob:
+            column.offsets.append(column.bytes.size());
+            break;
+        case SQLiteColumnLayout::Mixed:
+            JSC::asArray(mixedColumns.at(column.mixedIndex))->putDirectIndex(globalObject, row, jsNull());
+            break;
+        }
+        return true;
+    }
+
+    if (column.hasNulls) {
+        column.nulls.append(0);
+    }
+
+    if (UNLIKELY(!columnLayoutAccepts(column.layout, type, useBigInt64))) {
+        promoteColumnToMixed(globalObject, column, mixedColumns, row);
+        if (column.layout != SQLiteColumnLayout::Mixed) {
+            // Threw
+            return true;
+        }
+    }
+
+    if (column.layout == SQLiteColumnLayout::Pending) {
+        // Rows before this one were all NULL
+        switch (type) {
+        case SQLITE_INTEGER:
+            column.layout = useBigInt64 ? SQLiteColumnLayout::BigInt64 : SQLiteColumnLayout::Float64;
+            break;
+        case SQLITE_FLOAT:
+            column.layout = SQLiteColumnLayout::Float64;
+            break;
+        case SQLITE3_TEXT:
+            column.layout = SQLiteColumnLayout::Text;
+            break;
+        default:
+            column.layout = SQLiteColumnLayout::Blob;
+            break;
+        }
+
+        if (column.layout == SQLiteColumnLayout::Float64) {
+            column.doubles.fill(std::numeric_limits<double>::quiet_NaN(), row);
+        } else if (column.layout == SQLiteColumnLayout::BigInt64) {
+            column.integers.fill(0, row);
+        } else {
+            column.offsets.fill(0, row + 1);
+        }
+    }
+
+    switch (column.layout) {
+    case SQLiteColumnLayout::Float64:
+        column.doubles.append(sqlite3_column_double(stmt, i));
+        break;
+    case SQLiteColumnLayout::BigInt64:
+        column.integers.append(sqlite3_column_int64(stmt, i));
+        break;
+    case SQLiteColumnLayout::Text:
+    case SQLiteColumnLayout::Blob: {
+        // sqlite3_column_bytes() must come after the pointer so it measures the converted value
+        const uint8_t* data = column.layout == SQLiteColumnLayout::Text
+            ? sqlite3_column_text(stmt, i)
+            : static_cast<const uint8_t*>(sqlite3_column_blob(stmt, i));
+        size_t len = sqlite3_column_bytes(stmt, i);
+        if (len > 0 && data) {
+            if (UNLIKELY(column.bytes.size() + len > std::numeric_limits<uint32_t>::max())) {
+                return false;
+            }
+            column.bytes.append(std::span { data, len });
         }
-    } else if (status == SQLITE_DONE) {
-        result = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, 0);
+        column.offsets.append(column.bytes.size());
+        break;
+    }
+    case SQLiteColumnLayout::Mixed: {
+        JSValue value = useBigInt64 ? toJS<true>(JSC::getVM(globalObject), globalObject, stmt, i) : toJS<false>(JSC::getVM(globalObject), globalObject, stmt, i);
+        if (LIKELY(value)) {
+            JSC::asArray(mixedColumns.at(column.mixedIndex))->putDirectIndex(globalObject, row, value);
+        }
+        break;
+    }
+    case SQLiteColumnLayout::Pending:
+        RELEASE_ASSERT_NOT_REACHED();
     }
+    return true;
+}
 
-    if (UNLIKELY(status != SQLITE_DONE && status != SQLITE_OK)) {
-        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
-        sqlite3_reset(stmt);
-        return {};
+static JSC::JSValue constructResultColumn(JSC::VM& vm, JSC::JSGlobalObject* lexicalGlobalObject, sqlite3_stmt* stmt, int i, SQLiteColumnBuffer& column, const JSC::MarkedArgumentBuffer& mixedColumns, size_t rowCount)
+{
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    JSC::JSObject* object = JSC::constructEmptyObject(lexicalGlobalObject);
+
+    const char* name = sqlite3_column_name(stmt, i);
+    object->putDirect(vm, Identifier::fromString(vm, "name"_s), name ? jsString(vm, WTF::String::fromUTF8({ name, strlen(name) })) : jsEmptyString(vm), 0);
+
+    ASCIILiteral type = "null"_s;
+    switch (column.layout) {
+    case SQLiteColumnLayout::Pending:
+        // Every row was NULL
+        column.doubles.fill(std::numeric_limits<double>::quiet_NaN(), rowCount);
+        [[fallthrough]];
+    case SQLiteColumnLayout::Float64: {
+        if (column.layout == SQLiteColumnLayout::Float64) {
+            type = "number"_s;
+        }
+        JSValue values = createTypedArrayFromVector<JSC::Float64Adaptor>(lexicalGlobalObject, column.doubles);
+        RETURN_IF_EXCEPTION(scope, {});
+        object->putDirect(vm, Identifier::fromString(vm, "values"_s), values, 0);
+        break;
+    }
+    case SQLiteColumnLayout::BigInt64: {
+        type = "bigint"_s;
+        JSValue values = createTypedArrayFromVector<JSC::BigInt64Adaptor>(lexicalGlobalObject, column.integers);
+        RETURN_IF_EXCEPTION(scope, {});
+        object->putDirect(vm, Identifier::fromString(vm, "values"_s), values, 0);
+        break;
+    }
+    case SQLiteColumnLayout::Text:
+    case SQLiteColumnLayout::Blob: {
+        type = column.layout == SQLiteColumnLayout::Text ? "text"_s : "blob"_s;
+        JSValue offsets = createTypedArrayFromVector<JSC::Uint32Adaptor>(lexicalGlobalObject, column.offsets);
+        RETURN_IF_EXCEPTION(scope, {});
+        object->putDirect(vm, Identifier::fromString(vm, "offsets"_s), offsets, 0);
+        JSValue bytes = createTypedArrayFromVector<JSC::Uint8Adaptor>(lexicalGlobalObject, column.bytes);
+        RETURN_IF_EXCEPTION(scope, {});
+        object->putDirect(vm, Identifier::fromString(vm, "bytes"_s), bytes, 0);
+        break;
     }
+    case SQLiteColumnLayout::Mixed: {
+        type = "mixed"_s;
+        object->putDirect(vm, Identifier::fromString(vm, "values"_s), mixedColumns.at(column.mixedIndex), 0);
+        break;
+    }
+    }
+    object->putDirect(vm, Identifier::fromString(vm, "type"_s), jsString(vm, WTF::String(type)), 0);
 
-    int64_t memoryChange = sqlite_malloc_amount - currentMemoryUsage;
-    if (memoryChange > 255) {
-        vm.heap.deprecatedReportExtraMemory(memoryChange);
+    if (column.hasNulls) {
+        JSValue nulls = createTypedArrayFromVector<JSC::Uint8Adaptor>(lexicalGlobalObject, column.nulls);
+        RETURN_IF_EXCEPTION(scope, {});
+        object->putDirect(vm, Identifier::fromString(vm, "nulls"_s), nulls, 0);
     }
 
-    RELEASE_AND_RETURN(scope, JSC::JSValue::encode(result));
+    return object;
 }
 
-JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionGet, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+// Returns an array with one { name, type, values | offsets + bytes, nulls? } object per column.
+// "number" and "bigint" columns fill a Float64Array or BigInt64Array, NULL reads as NaN or 0n.
+// "text" (UTF-8) and "blob" columns concatenate every value into one Uint8Array and row i
+// spans offsets[i] to offsets[i + 1]. "mixed" columns held values of more than one storage class
+// and values is a plain array of what get() would return. nulls is a Uint8Array of 0 and 1, present
+// if any value was NULL.
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionColumnar, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
 {
-
     auto& vm = JSC::getVM(lexicalGlobalObject);
     auto scope = DECLARE_THROW_SCOPE(vm);
     auto castedThis = jsDynamicCast<JSSQLStatement*>(callFrame->thisValue());
 
-    CHECK_THIS
+    CHECK_THIS;
 
     auto* stmt = castedThis->stmt;
     CHECK_PREPARED
@@ -2101,6 +3599,7 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionGet, (JSC::JSGlob
     int statusCode = sqlite3_reset(stmt);
     if (UNLIKELY(statusCode != SQLITE_OK)) {
         throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
+        sqlite3_reset(stmt);
         return {};
     }
 
@@ -2114,38 +3613,57 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionGet, (JSC::JSGlob
         castedThis->version_db->version++;
     }
 
-    if (!castedThis->hasExecuted || castedThis->need_update()) {
-        initializeColumnNames(lexicalGlobalObject, castedThis);
-    }
-
-    JSValue result = jsNull();
-    if (status == SQLITE_ROW) {
-        bool useBigInt64 = castedThis->useBigInt64;
+    int columnCount = sqlite3_column_count(stmt);
+    bool useBigInt64 = castedThis->useBigInt64;
+    Vector<SQLiteColumnBuffer> columns(columnCount);
+    JSC::MarkedArgumentBuffer mixedColumns;
+    size_t rowCount = 0;
 
-        result = useBigInt64 ? constructResultObject<true>(lexicalGlobalObject, castedThis)
-                             : constructResultObject<false>(lexicalGlobalObject, castedThis);
-        while (status == SQLITE_ROW) {
-            status = sqlite3_step(stmt);
+    while (status == SQLITE_ROW) {
+        for (int i = 0; i < columnCount; i++) {
+            if (UNLIKELY(!appendColumnValue(lexicalGlobalObject, columns[i], mixedColumns, stmt, i, rowCount, useBigInt64))) {
+                sqlite3_reset(stmt);
+                throwRangeError(lexicalGlobalObject, scope, "columnar() column exceeds 4 GB"_s);
+                return {};
+            }
+            if (UNLIKELY(scope.exception())) {
+                sqlite3_reset(stmt);
+                return {};
+            }
         }
+        rowCount++;
+        status = sqlite3_step(stmt);
     }
 
-    if (status == SQLITE_DONE || status == SQLITE_OK) {
-        RELEASE_AND_RETURN(scope, JSValue::encode(result));
-    } else {
+    if (UNLIKELY(status != SQLITE_DONE && status != SQLITE_OK)) {
         throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
         sqlite3_reset(stmt);
         return {};
     }
+
+    JSC::JSArray* result = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, columnCount);
+    RETURN_IF_EXCEPTION(scope, {});
+    for (int i = 0; i < columnCount; i++) {
+        JSValue column = constructResultColumn(vm, lexicalGlobalObject, stmt, i, columns[i], mixedColumns, rowCount);
+        RETURN_IF_EXCEPTION(scope, {});
+        result->putDirectIndex(lexicalGlobalObject, i, column);
+        RETURN_IF_EXCEPTION(scope, {});
+
+        // Let go of the copy we no longer need before the next column allocates
+        columns[i] = {};
+    }
+
+    RELEASE_AND_RETURN(scope, JSC::JSValue::encode(result));
 }
 
-JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRows, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRun, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
 {
 
     auto& vm = JSC::getVM(lexicalGlobalObject);
     auto scope = DECLARE_THROW_SCOPE(vm);
     auto castedThis = jsDynamicCast<JSSQLStatement*>(callFrame->thisValue());
 
-    CHECK_THIS;
+    CHECK_THIS
 
     auto* stmt = castedThis->stmt;
     CHECK_PREPARED
@@ -2153,16 +3671,23 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRows, (JSC::JSGlo
     int statusCode = sqlite3_reset(stmt);
     if (UNLIKELY(statusCode != SQLITE_OK)) {
         throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
-        sqlite3_reset(stmt);
         return {};
     }
 
-    int count = callFrame->argumentCount();
-    if (count > 0) {
-        auto arg0 = callFrame->argument(0);
+    JSValue diffValue = callFrame->argument(0);
+
+    if (callFrame->argumentCount() > 1) {
+        auto arg0 = callFrame->argument(1);
         DO_REBIND(arg0);
     }
 
+    if (UNLIKELY(!castedThis->version_db->db)) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Database has closed"_s));
+        return {};
+    }
+
+    int total_changes_before = sqlite3_total_changes(castedThis->version_db->db);
+
     int status = sqlite3_step(stmt);
     if (!sqlite3_stmt_readonly(stmt)) {
         castedThis->version_db->version++;
@@ -2172,54 +3697,132 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRows, (JSC::JSGlo
         initializeColumnNames(lexicalGlobalObject, castedThis);
     }
 
-    size_t columnCount = castedThis->columnNames->size();
-    JSValue result = jsNull();
-    if (status == SQLITE_ROW) {
-        // this is a count from UPDATE or another query like that
-        if (columnCount == 0) {
-            while (status == SQLITE_ROW) {
-                status = sqlite3_step(stmt);
-            }
+    while (status == SQLITE_ROW) {
+        status = sqlite3_step(stmt);
+    }
 
-            result = jsNumber(sqlite3_column_count(stmt));
+    if (UNLIKELY(status != SQLITE_DONE && status != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
+        sqlite3_reset(stmt);
+        return {};
+    }
 
+    if (auto* diff = JSC::jsDynamicCast<JSC::InternalFieldTuple*>(diffValue)) {
+        auto* db = castedThis->version_db->db;
+        const int total_changes_after = sqlite3_total_changes(db);
+        int64_t last_insert_rowid = sqlite3_last_insert_rowid(db);
+        diff->putInternalField(vm, 0, JSC::jsNumber(total_changes_after - total_changes_before));
+        if (castedThis->useBigInt64) {
+            diff->putInternalField(vm, 1, JSBigInt::createFrom(lexicalGlobalObject, last_insert_rowid));
         } else {
+            diff->putInternalField(vm, 1, JSC::jsNumber(last_insert_rowid));
+        }
+    }
 
-            JSC::JSArray* resultArray = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, 0);
-            {
-                size_t columnCount = sqlite3_column_count(stmt);
+    RELEASE_AND_RETURN(scope, JSC::JSValue::encode(jsUndefined()));
+}
 
-                do {
-                    JSC::JSArray* row = constructResultRow(vm, lexicalGlobalObject, castedThis, columnCount);
-                    if (UNLIKELY(!row || scope.exception())) {
-                        sqlite3_reset(stmt);
-                        RELEASE_AND_RETURN(scope, {});
-                    }
-                    resultArray->push(lexicalGlobalObject, row);
-                    status = sqlite3_step(stmt);
-                } while (status == SQLITE_ROW);
-            }
+// One parameter's values in a columnar runMany() batch. Numeric typed arrays over a fixed-length
+// buffer are read straight from their backing store, anything else goes through rebindValue.
+struct SQLiteBatchColumn {
+    JSC::JSArrayBufferView* view = nullptr;
+    JSC::JSObject* values = nullptr;
+    JSC::TypedArrayType type = JSC::NotTypedArray;
+};
 
-            result = resultArray;
-        }
-    } else if (status == SQLITE_DONE && columnCount != 0) {
-        // breaking change in Bun v0.6.8
-        result = JSC::constructEmptyArray(lexicalGlobalObject, nullptr, 0);
+static bool hasBatchFastPath(JSC::TypedArrayType type)
+{
+    switch (type) {
+    case JSC::TypeInt8:
+    case JSC::TypeUint8:
+    case JSC::TypeUint8Clamped:
+    case JSC::TypeInt16:
+    case JSC::TypeUint16:
+    case JSC::TypeInt32:
+    case JSC::TypeUint32:
+    case JSC::TypeFloat32:
+    case JSC::TypeFloat64:
+    case JSC::TypeBigInt64:
+    case JSC::TypeBigUint64:
+        return true;
+    default:
+        return false;
     }
+}
 
-    if (UNLIKELY(status != SQLITE_DONE && status != SQLITE_OK)) {
-        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
-        sqlite3_reset(stmt);
-        return {};
+static bool bindBatchColumnValue(JSC::JSGlobalObject* lexicalGlobalObject, JSC::ThrowScope& scope, sqlite3* db, sqlite3_stmt* stmt, int i, const SQLiteBatchColumn& column, size_t row, bool safeIntegers)
+{
+    if (!column.view) {
+        JSValue value = column.values->getIndex(lexicalGlobalObject, row);
+        RETURN_IF_EXCEPTION(scope, false);
+        // A getter reached by a later column may detach or change this value's buffer, so copy
+        return rebindValue(lexicalGlobalObject, db, stmt, i, value, scope, true, safeIntegers);
     }
 
-    // sqlite3_reset(stmt);
-    RELEASE_AND_RETURN(scope, JSC::JSValue::encode(result));
+    // A getter on an earlier column may have detached the buffer
+    if (UNLIKELY(column.view->isDetached() || column.view->length() <= row)) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "TypedArray was detached or resized"_s));
+        return false;
+    }
+
+    const void* data = column.view->vector();
+    int result = SQLITE_OK;
+    switch (column.type) {
+    case JSC::TypeInt8:
+        result = sqlite3_bind_int(stmt, i, static_cast<const int8_t*>(data)[row]);
+        break;
+    case JSC::TypeUint8:
+    case JSC::TypeUint8Clamped:
+        result = sqlite3_bind_int(stmt, i, static_cast<const uint8_t*>(data)[row]);
+        break;
+    case JSC::TypeInt16:
+        result = sqlite3_bind_int(stmt, i, static_cast<const int16_t*>(data)[row]);
+        break;
+    case JSC::TypeUint16:
+        result = sqlite3_bind_int(stmt, i, static_cast<const uint16_t*>(data)[row]);
+        break;
+    case JSC::TypeInt32:
+        result = sqlite3_bind_int(stmt, i, static_cast<const int32_t*>(data)[row]);
+        break;
+    case JSC::TypeUint32:
+        result = sqlite3_bind_int64(stmt, i, static_cast<const uint32_t*>(data)[row]);
+        break;
+    case JSC::TypeFloat32:
+        result = sqlite3_bind_double(stmt, i, static_cast<const float*>(data)[row]);
+        break;
+    case JSC::TypeFloat64:
+        result = sqlite3_bind_double(stmt, i, static_cast<const double*>(data)[row]);
+        break;
+    case JSC::TypeBigInt64:
+        result = sqlite3_bind_int64(stmt, i, static_cast<const int64_t*>(data)[row]);
+        break;
+    case JSC::TypeBigUint64: {
+        uint64_t value = static_cast<const uint64_t*>(data)[row];
+        if (UNLIKELY(value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))) {
+            throwRangeError(lexicalGlobalObject, scope, makeString("BigInt value '"_s, value, "' is out of range"_s));
+            return false;
+        }
+        result = sqlite3_bind_int64(stmt, i, static_cast<int64_t>(value));
+        break;
+    }
+    default:
+        RELEASE_ASSERT_NOT_REACHED();
+    }
+
+    if (UNLIKELY(result != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, WTF::String::fromUTF8(sqlite3_errmsg(db))));
+        return false;
+    }
+    return true;
 }
 
-JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRun, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
+// runMany(diff, rows | { columns }) runs the statement once per row inside a single savepoint,
+// so a batch either lands completely or not at all, also inside an outer transaction.
+// rows takes the same bindings run() does. columns has one array per parameter in order, where
+// numeric typed arrays skip the conversion to JSValue entirely. Resizable and growable shared
+// buffers are rejected, since a getter could change them while the batch runs.
+JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRunMany, (JSC::JSGlobalObject * lexicalGlobalObject, JSC::CallFrame* callFrame))
 {
-
     auto& vm = JSC::getVM(lexicalGlobalObject);
     auto scope = DECLARE_THROW_SCOPE(vm);
     auto castedThis = jsDynamicCast<JSSQLStatement*>(callFrame->thisValue());
@@ -2229,47 +3832,142 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementExecuteStatementFunctionRun, (JSC::JSGlob
     auto* stmt = castedThis->stmt;
     CHECK_PREPARED
 
-    int statusCode = sqlite3_reset(stmt);
-    if (UNLIKELY(statusCode != SQLITE_OK)) {
-        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
+    auto* db = castedThis->version_db->db;
+    if (UNLIKELY(!db)) {
+        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Database has closed"_s));
         return {};
     }
 
     JSValue diffValue = callFrame->argument(0);
+    JSC::EnsureStillAliveScope batchValue = callFrame->argument(1);
+    JSC::JSObject* batch = batchValue.value().getObject();
+    if (UNLIKELY(!batch)) {
+        throwException(lexicalGlobalObject, scope, createTypeError(lexicalGlobalObject, "Expected an array of rows or { columns }"_s));
+        return {};
+    }
 
-    if (callFrame->argumentCount() > 1) {
-        auto arg0 = callFrame->argument(1);
-        DO_REBIND(arg0);
+    JSC::JSArray* rows = jsDynamicCast<JSC::JSArray*>(batch);
+    Vector<SQLiteBatchColumn> columns;
+    JSC::EnsureStillAliveScope columnsValue;
+    size_t rowCount = 0;
+
+    if (rows) {
+        rowCount = rows->length();
+    } else {
+        columnsValue = batch->get(lexicalGlobalObject, Identifier::fromString(vm, "columns"_s));
+        RETURN_IF_EXCEPTION(scope, {});
+        JSC::JSArray* columnsArray = jsDynamicCast<JSC::JSArray*>(columnsValue.value());
+        if (UNLIKELY(!columnsArray)) {
+            throwException(lexicalGlobalObject, scope, createTypeError(lexicalGlobalObject, "Expected columns to be an array"_s));
+            return {};
+        }
+
+        int required = sqlite3_bind_parameter_count(stmt);
+        if (UNLIKELY(static_cast<int>(columnsArray->length()) != required)) {
+            throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, makeString("SQLite query expected "_s, required, " columns, received "_s, columnsArray->length())));
+            return {};
+        }
+
+        for (unsigned i = 0; i < columnsArray->length(); i++) {
+            JSValue value = columnsArray->getIndex(lexicalGlobalObject, i);
+            RETURN_IF_EXCEPTION(scope, {});
+
+            SQLiteBatchColumn column;
+            size_t length = 0;
+            if (auto* view = jsDynamicCast<JSC::JSArrayBufferView*>(value); view && view->type() != DataViewType) {
+                if (UNLIKELY(view->isDetached())) {
+                    throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "TypedArray is detached"_s));
+                    return {};
+                }
+                if (UNLIKELY(view->isResizableOrGrowableShared())) {
+                    throwException(lexicalGlobalObject, scope, createTypeError(lexicalGlobalObject, "Expected each column's TypedArray to use a fixed-length buffer"_s));
+                    return {};
+                }
+                column.type = JSC::typedArrayType(view->type());
+                if (hasBatchFastPath(column.type)) {
+                    column.view = view;
+                } else {
+                    column.values = view;
+                }
+                length = view->length();
+            } else if (auto* array = jsDynamicCast<JSC::JSArray*>(value)) {
+                column.values = array;
+                length = array->length();
+            } else {
+                throwException(lexicalGlobalObject, scope, createTypeError(lexicalGlobalObject, "Expected each column to be a TypedArray or an array"_s));
+                return {};
+            }
+
+            if (i == 0) {
+                rowCount = length;
+            } else if (UNLIKELY(length != rowCount)) {
+                throwException(lexicalGlobalObject, scope, createRangeError(lexicalGlobalObject, "Expected every column to have the same length"_s));
+                return {};
+            }
+            columns.append(column);
+        }
     }
 
-    if (UNLIKELY(!castedThis->version_db->db)) {
-        throwException(lexicalGlobalObject, scope, createError(lexicalGlobalObject, "Database has closed"_s));
+    if (UNLIKELY(sqlite3_exec(db, "SAVEPOINT bun_run_many", nullptr, nullptr, nullptr) != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, db));
         return {};
     }
 
-    int total_changes_before = sqlite3_total_changes(castedThis->version_db->db);
+    int total_changes_before = sqlite3_total_changes(db);
+    bool isReadOnly = sqlite3_stmt_readonly(stmt);
+    int status = SQLITE_DONE;
+    sqlite3_reset(stmt);
 
-    int status = sqlite3_step(stmt);
-    if (!sqlite3_stmt_readonly(stmt)) {
-        castedThis->version_db->version++;
+    for (size_t row = 0; row < rowCount; row++) {
+        if (rows) {
+            JSValue bindings = rows->getIndex(lexicalGlobalObject, row);
+            if (!scope.exception()) {
+                // Copied like run() does, a getter later in the row could detach a buffer bound before it
+                rebindStatement(lexicalGlobalObject, bindings, scope, db, stmt, true, castedThis->m_bindingNames, castedThis->useBigInt64);
+            }
+        } else {
+            for (size_t i = 0; i < columns.size() && !scope.exception(); i++) {
+                bindBatchColumnValue(lexicalGlobalObject, scope, db, stmt, i + 1, columns[i], row, castedThis->useBigInt64);
+            }
+        }
+        if (UNLIKELY(scope.exception())) {
+            break;
+        }
+
+        do {
+            status = sqlite3_step(stmt);
+        } while (status == SQLITE_ROW);
+        sqlite3_reset(stmt);
+
+        if (UNLIKELY(status != SQLITE_DONE)) {
+            throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, db));
+            break;
+        }
     }
 
-    if (!castedThis->hasExecuted || castedThis->need_update()) {
-        initializeColumnNames(lexicalGlobalObject, castedThis);
+    sqlite3_clear_bindings(stmt);
+    if (!isReadOnly) {
+        castedThis->version_db->version++;
     }
 
-    while (status == SQLITE_ROW) {
-        status = sqlite3_step(stmt);
+    if (UNLIKELY(scope.exception())) {
+        sqlite3_exec(db, "ROLLBACK TO bun_run_many", nullptr, nullptr, nullptr);
+        sqlite3_exec(db, "RELEASE bun_run_many", nullptr, nullptr, nullptr);
+        return {};
     }
 
-    if (UNLIKELY(status != SQLITE_DONE && status != SQLITE_OK)) {
-        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, castedThis->version_db->db));
-        sqlite3_reset(stmt);
+    if (UNLIKELY(sqlite3_exec(db, "RELEASE bun_run_many", nullptr, nullptr, nullptr) != SQLITE_OK)) {
+        throwException(lexicalGlobalObject, scope, createSQLiteError(lexicalGlobalObject, db));
+        sqlite3_exec(db, "ROLLBACK TO bun_run_many", nullptr, nullptr, nullptr);
+        sqlite3_exec(db, "RELEASE bun_run_many", nullptr, nullptr, nullptr);
         return {};
     }
 
+    if (!castedThis->hasExecuted || castedThis->need_update()) {
+        initializeColumnNames(lexicalGlobalObject, castedThis);
+    }
+
     if (auto* diff = JSC::jsDynamicCast<JSC::InternalFieldTuple*>(diffValue)) {
-        auto* db = castedThis->version_db->db;
         const int total_changes_after = sqlite3_total_changes(db);
         int64_t last_insert_rowid = sqlite3_last_insert_rowid(db);
         diff->putInternalField(vm, 0, JSC::jsNumber(total_changes_after - total_changes_before));
@@ -2291,6 +3989,11 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementToStringFunction, (JSC::JSGlobalObject *
 
     CHECK_THIS
 
+    // A statement reused for a differently spelled query has no parameters, see SQLiteStatementCache::take
+    if (castedThis->stmt && castedThis->sql != castedThis->preparedSql) {
+        RELEASE_AND_RETURN(scope, JSValue::encode(JSC::jsString(vm, castedThis->sql)));
+    }
+
     char* string = sqlite3_expanded_sql(castedThis->stmt);
     if (!string) {
         RELEASE_AND_RETURN(scope, JSValue::encode(jsEmptyString(vm)));
@@ -2384,10 +4087,7 @@ JSC_DEFINE_HOST_FUNCTION(jsSQLStatementFunctionFinalize, (JSC::JSGlobalObject *
     auto scope = DECLARE_THROW_SCOPE(vm);
     CHECK_THIS
 
-    if (castedThis->stmt) {
-        sqlite3_finalize(castedThis->stmt);
-        castedThis->stmt = nullptr;
-    }
+    castedThis->finalizeStatement();
 
     RELEASE_AND_RETURN(scope, JSValue::encode(jsUndefined()));
 }
@@ -2404,11 +4104,23 @@ void JSSQLStatement::finishCreation(VM& vm)
     vm.heap.reportExtraMemoryAllocated(this, this->extraMemorySize);
 }
 
-JSSQLStatement::~JSSQLStatement()
+void JSSQLStatement::finalizeStatement()
 {
-    if (this->stmt) {
+    if (!this->stmt) {
+        return;
+    }
+
+    if (!this->cacheKey.isNull() && this->version_db && this->version_db->db) {
+        this->version_db->statementCache.put(WTFMove(this->cacheKey), { this->stmt, WTFMove(this->preparedSql), static_cast<int64_t>(this->extraMemorySize) });
+    } else {
         sqlite3_finalize(this->stmt);
     }
+    this->stmt = nullptr;
+}
+
+JSSQLStatement::~JSSQLStatement()
+{
+    finalizeStatement();
 
     if (auto* columnNames = this->columnNames.get()) {
         columnNames->releaseData();
@@ -5343,10 +5343,20 @@ SerializedScriptValue::SerializedScriptValue(Vector<uint8_t>&& buffer, std::uniq
     m_memoryCost = computeMemoryCost();
 }
 
+SerializedScriptValue::SerializedScriptValue(Vector<SimpleCloneEntry>&& simpleValues)
+    : m_simpleValues(WTFMove(simpleValues))
+{
+    m_memoryCost = computeMemoryCost();
+}
+
 size_t SerializedScriptValue::computeMemoryCost() const
 {
     size_t cost = m_data.size();
 
+    cost += m_simpleValues.size() * sizeof(SimpleCloneEntry);
+    for (auto& entry : m_simpleValues)
+        cost += entry.key.sizeInBytes() + entry.string.sizeInBytes();
+
     if (m_arrayBufferContentsArray) {
         for (auto& content : *m_arrayBufferContentsArray)
             cost += content.sizeInBytes();
@@ -5506,6 +5516,131 @@ static bool canDetachRTCDataChannels(const Vector<Ref<RTCDataChannel>>& channels
 }
 #endif
 
+// Deep enough for job descriptors and API payloads, shallow enough that a cycle fails fast
+static constexpr unsigned maxSimpleCloneDepth = 32;
+
+enum class SimpleCloneResult : uint8_t {
+    Success,
+    NotSimple,
+    Exception,
+};
+
+// Appends value to entries if every part of it is a primitive, a string, or a plain object or
+// array whose own enumerable properties are data properties. Anything the clone serializer would
+// treat differently, including a second reference to the same object, makes the caller fall back.
+static SimpleCloneResult appendSimpleCloneValue(JSGlobalObject& globalObject, JSValue value, Vector<SimpleCloneEntry>& entries, HashSet<JSObject*>& visited, unsigned depth, String&& key)
+{
+    VM& vm = globalObject.vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+
+    if (value.isNumber() || value.isBoolean() || value.isUndefinedOrNull()) {
+        entries.append({ SimpleCloneEntry::Kind::Primitive, 0, JSValue::encode(value), WTFMove(key), {} });
+        return SimpleCloneResult::Success;
+    }
+
+    if (value.isString()) {
+        String string = asString(value)->value(&globalObject);
+        RETURN_IF_EXCEPTION(scope, SimpleCloneResult::Exception);
+        entries.append({ SimpleCloneEntry::Kind::String, 0, {}, WTFMove(key), WTFMove(string).isolatedCopy() });
+        return SimpleCloneResult::Success;
+    }
+
+    if (!value.isObject() || depth >= maxSimpleCloneDepth)
+        return SimpleCloneResult::NotSimple;
+
+    JSObject* object = asObject(value);
+    if (!visited.add(object).isNewEntry)
+        return SimpleCloneResult::NotSimple;
+
+    if (isJSArray(object)) {
+        JSArray* array = jsCast<JSArray*>(object);
+        // Extra named properties or a patched prototype would show up in the general path
+        if (!globalObject.isOriginalArrayStructure(array->structure()))
+            return SimpleCloneResult::NotSimple;
+
+        unsigned length = array->length();
+        entries.append({ SimpleCloneEntry::Kind::Array, length, {}, WTFMove(key), {} });
+        for (unsigned i = 0; i < length; i++) {
+            // Holes have to stay holes
+            if (!array->canGetIndexQuickly(i))
+                return SimpleCloneResult::NotSimple;
+            auto result = appendSimpleCloneValue(globalObject, array->getIndexQuickly(i), entries, visited, depth + 1, {});
+            if (result != SimpleCloneResult::Success)
+                return result;
+        }
+        return SimpleCloneResult::Success;
+    }
+
+    Structure* structure = object->structure();
+    if (object->type() != FinalObjectType
+        || object->getPrototypeDirect() != globalObject.objectPrototype()
+        || hasIndexedProperties(structure->indexingType())
+        || !structure->canPerformFastPropertyEnumeration())
+        return SimpleCloneResult::NotSimple;
+
+    size_t objectIndex = entries.size();
+    entries.append({ SimpleCloneEntry::Kind::Object, 0, {}, WTFMove(key), {} });
+
+    uint32_t length = 0;
+    SimpleCloneResult result = SimpleCloneResult::Success;
+    structure->forEachProperty(vm, [&](const PropertyTableEntry& property) -> bool {
+        if (property.attributes() & PropertyAttribute::DontEnum || property.key()->isSymbol())
+            return true;
+
+        result = appendSimpleCloneValue(globalObject, object->getDirect(property.offset()), entries, visited, depth + 1, String(property.key()).isolatedCopy());
+        length++;
+        return result == SimpleCloneResult::Success;
+    });
+    RETURN_IF_EXCEPTION(scope, SimpleCloneResult::Exception);
+
+    entries[objectIndex].length = length;
+    return result;
+}
+
+// The entries may be read by several threads at once, as with BroadcastChannel, so strings are
+// copied rather than shared
+static JSValue constructSimpleCloneValue(JSGlobalObject& globalObject, const Vector<SimpleCloneEntry>& entries, size_t& index)
+{
+    VM& vm = globalObject.vm();
+    auto scope = DECLARE_THROW_SCOPE(vm);
+    const auto& entry = entries[index++];
+
+    switch (entry.kind) {
+    case SimpleCloneEntry::Kind::Primitive:
+        return JSValue::decode(entry.primitive);
+    case SimpleCloneEntry::Kind::String: {
+        if (entry.string.isEmpty())
+            return jsEmptyString(vm);
+        String copy = entry.string.is8Bit() ? String(entry.string.span8()) : String(entry.string.span16());
+        return jsString(vm, WTFMove(copy));
+    }
+    case SimpleCloneEntry::Kind::Array: {
+        JSArray* array = constructEmptyArray(&globalObject, nullptr, entry.length);
+        RETURN_IF_EXCEPTION(scope, {});
+        for (unsigned i = 0; i < entry.length; i++) {
+            JSValue element = constructSimpleCloneValue(globalObject, entries, index);
+            RETURN_IF_EXCEPTION(scope, {});
+            array->putDirectIndex(&globalObject, i, element);
+            RETURN_IF_EXCEPTION(scope, {});
+        }
+        return array;
+    }
+    case SimpleCloneEntry::Kind::Object: {
+        JSObject* object = constructEmptyObject(&globalObject);
+        for (unsigned i = 0; i < entry.length; i++) {
+            const String& key = entries[index].key;
+            Identifier name = key.is8Bit() ? Identifier::fromString(vm, key.span8()) : Identifier::fromString(vm, key.span16());
+            JSValue property = constructSimpleCloneValue(globalObject, entries, index);
+            RETURN_IF_EXCEPTION(scope, {});
+            object->putDirect(vm, name, property);
+        }
+        return object;
+    }
+    }
+
+    RELEASE_ASSERT_NOT_REACHED();
+}
+
 RefPtr<SerializedScriptValue> SerializedScriptValue::create(JSC::JSGlobalObject& globalObject, JSC::JSValue value, SerializationForStorage forStorage, SerializationErrorMode throwExceptions, SerializationContext serializationContext)
 {
     Vector<RefPtr<MessagePort>> dummyPorts;
@@ -5530,6 +5665,22 @@ ExceptionOr<Ref<SerializedScriptValue>> SerializedScriptValue::create(JSGlobalOb
 ExceptionOr<Ref<SerializedScriptValue>> SerializedScriptValue::create(JSGlobalObject& lexicalGlobalObject, JSValue value, Vector<JSC::Strong<JSC::JSObject>>&& transferList, Vector<RefPtr<MessagePort>>& messagePorts, SerializationForStorage forStorage, SerializationErrorMode throwExceptions, SerializationContext context)
 {
     VM& vm = lexicalGlobalObject.vm();
+
+    // Most messages are a string or a small tree of plain objects, which can skip the wire format.
+    // Values for storage are read back from m_data, so they always take the general path.
+    if (forStorage == SerializationForStorage::No && transferList.isEmpty()) {
+        Vector<SimpleCloneEntry> simpleValues;
+        HashSet<JSObject*> visited;
+        switch (appendSimpleCloneValue(lexicalGlobalObject, value, simpleValues, visited, 0, {})) {
+        case SimpleCloneResult::Success:
+            return adoptRef(*new SerializedScriptValue(WTFMove(simpleValues)));
+        case SimpleCloneResult::Exception:
+            return Exception { ExistingExceptionError };
+        case SimpleCloneResult::NotSimple:
+            break;
+        }
+    }
+
     Vector<RefPtr<JSC::ArrayBuffer>> arrayBuffers;
     // Vector<RefPtr<ImageBitmap>> imageBitmaps;
 #if ENABLE(OFFSCREEN_CANVAS_IN_WORKERS)
@@ -5753,11 +5904,16 @@ RefPtr<SerializedScriptValue> SerializedScriptValue::create(JSContextRef originC
 
 String SerializedScriptValue::toString() const
 {
+    if (!m_simpleValues.isEmpty()) {
+        const auto& root = m_simpleValues.first();
+        return root.kind == SimpleCloneEntry::Kind::String ? root.string.isolatedCopy() : String();
+    }
     return CloneDeserializer::deserializeString(m_data);
 }
 
 Ref<JSC::ArrayBuffer> SerializedScriptValue::toArrayBuffer()
 {
+    ASSERT(m_simpleValues.isEmpty());
     if (this->m_data.size() == 0) {
         return ArrayBuffer::create(static_cast<size_t>(0), static_cast<unsigned>(1));
     }
@@ -5845,6 +6001,18 @@ JSValue SerializedScriptValue::deserialize(JSGlobalObject& lexicalGlobalObject,
 
 JSValue SerializedScriptValue::deserialize(JSGlobalObject& lexicalGlobalObject, JSGlobalObject* globalObject, const Vector<RefPtr<MessagePort>>& messagePorts, const Vector<String>& blobURLs, const Vector<String>& blobFilePaths, SerializationErrorMode throwExceptions, bool* didFail)
 {
+    if (!m_simpleValues.isEmpty()) {
+        auto scope = DECLARE_CATCH_SCOPE(lexicalGlobalObject.vm());
+        size_t index = 0;
+        JSValue result = constructSimpleCloneValue(*globalObject, m_simpleValues, index);
+        bool failed = !!scope.exception();
+        if (didFail)
+            *didFail = failed;
+        if (failed && throwExceptions == SerializationErrorMode::NonThrowing)
+            scope.clearException();
+        return failed ? jsNull() : result;
+    }
+
     DeserializationResult result = CloneDeserializer::deserialize(&lexicalGlobalObject, globalObject, messagePorts
 #if ENABLE(OFFSCREEN_CANVAS_IN_WORKERS)
         ,
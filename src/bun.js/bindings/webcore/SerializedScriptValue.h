@@ -81,6 +81,26 @@ using WasmModuleArray = Vector<RefPtr<JSC::Wasm::Module>>;
 using WasmMemoryHandleArray = Vector<RefPtr<JSC::SharedArrayBufferContents>>;
 #endif
 
+// A value create() could copy without the clone serializer: a primitive, a string, or a plain
+// object or array of them. Objects and arrays are followed by their members, depth first.
+struct SimpleCloneEntry {
+    enum class Kind : uint8_t {
+        Primitive,
+        String,
+        Object,
+        Array,
+    };
+
+    Kind kind { Kind::Primitive };
+    // Members of an object or array
+    uint32_t length { 0 };
+    // Never a cell, so it is safe to hand to another thread
+    JSC::EncodedJSValue primitive { 0 };
+    // Property name, when the parent is an object
+    String key;
+    String string;
+};
+
 DECLARE_ALLOCATOR_WITH_HEAP_IDENTIFIER(SerializedScriptValue);
 class SerializedScriptValue : public ThreadSafeRefCounted<SerializedScriptValue> {
     WTF_MAKE_FAST_ALLOCATED_WITH_HEAP_IDENTIFIER(SerializedScriptValue);
@@ -126,7 +146,13 @@ public:
     {
         return adoptRef(*new SerializedScriptValue(WTFMove(data)));
     }
-    const Vector<uint8_t>& wireBytes() const { return m_data; }
+    const Vector<uint8_t>& wireBytes() const
+    {
+        // Values meant to be read back from bytes are created with SerializationForStorage::Yes,
+        // which never takes the fast path
+        ASSERT(m_simpleValues.isEmpty());
+        return m_data;
+    }
 
     template<class Encoder> void encode(Encoder&) const;
     template<class Decoder> static RefPtr<SerializedScriptValue> decode(Decoder&);
@@ -196,9 +222,13 @@ private:
 #endif
     );
 
+    explicit SerializedScriptValue(Vector<SimpleCloneEntry>&&);
+
     size_t computeMemoryCost() const;
 
     Vector<unsigned char> m_data;
+    // Used instead of m_data when the value was simple enough, see SimpleCloneEntry
+    Vector<SimpleCloneEntry> m_simpleValues;
     std::unique_ptr<ArrayBufferContentsArray> m_arrayBufferContentsArray;
     std::unique_ptr<ArrayBufferContentsArray> m_sharedBufferContentsArray;
     // Vector<std::optional<ImageBitmapBacking>> m_backingStores;
@@ -96,6 +96,7 @@ Worker::Worker(ScriptExecutionContext& context, WorkerOptions&& options)
     , m_options(WTFMove(options))
     , m_identifier(makeString("worker:"_s, Inspector::IdentifiersFactory::createIdentifier()))
     , m_clientIdentifier(ScriptExecutionContext::generateIdentifier())
+    , m_parentMailbox(context.mailbox())
 {
     // static bool addedListener;
     // if (!addedListener) {
@@ -328,20 +329,19 @@ void Worker::drainEvents()
 
 void Worker::dispatchOnline(Zig::GlobalObject* workerGlobalObject)
 {
-    auto* ctx = scriptExecutionContext();
-    if (ctx) {
-        ScriptExecutionContext::postTaskTo(ctx->identifier(), [protectedThis = Ref { *this }](ScriptExecutionContext& context) -> void {
-            if (protectedThis->hasEventListeners(eventNames().openEvent)) {
-                auto event = Event::create(eventNames().openEvent, Event::CanBubble::No, Event::IsCancelable::No);
-                protectedThis->dispatchEvent(event);
-            }
-        });
-    }
+    m_parentMailbox->post([protectedThis = Ref { *this }](ScriptExecutionContext& context) -> void {
+        if (protectedThis->hasEventListeners(eventNames().openEvent)) {
+            auto event = Event::create(eventNames().openEvent, Event::CanBubble::No, Event::IsCancelable::No);
+            protectedThis->dispatchEvent(event);
+        }
+    });
 
     Locker lock(this->m_pendingTasksMutex);
 
-    m_onlineClosingFlags.fetch_or(OnlineFlag);
     auto* thisContext = workerGlobalObject->scriptExecutionContext();
+    if (thisContext)
+        m_workerMailbox = &thisContext->mailbox();
+    m_onlineClosingFlags.fetch_or(OnlineFlag);
     if (!thisContext) {
         return;
     }
@@ -368,12 +368,7 @@ void Worker::dispatchOnline(Zig::GlobalObject* workerGlobalObject)
 }
 void Worker::dispatchError(WTF::String message)
 {
-
-    auto* ctx = scriptExecutionContext();
-    if (!ctx)
-        return;
-
-    ScriptExecutionContext::postTaskTo(ctx->identifier(), [protectedThis = Ref { *this }, message = message.isolatedCopy()](ScriptExecutionContext& context) -> void {
+    m_parentMailbox->post([protectedThis = Ref { *this }, message = message.isolatedCopy()](ScriptExecutionContext& context) -> void {
         ErrorEvent::Init init;
         init.message = message;
 
@@ -383,11 +378,7 @@ void Worker::dispatchError(WTF::String message)
 }
 void Worker::dispatchExit(int32_t exitCode)
 {
-    auto* ctx = scriptExecutionContext();
-    if (!ctx)
-        return;
-
-    ScriptExecutionContext::postTaskTo(ctx->identifier(), [exitCode, protectedThis = Ref { *this }](ScriptExecutionContext& context) -> void {
+    m_parentMailbox->post([exitCode, protectedThis = Ref { *this }](ScriptExecutionContext& context) -> void {
         protectedThis->m_onlineClosingFlags = ClosingFlag;
 
         if (protectedThis->hasEventListeners(eventNames().closeEvent)) {
@@ -406,7 +397,8 @@ void Worker::postTaskToWorkerGlobalScope(Function<void(ScriptExecutionContext&)>
         return;
     }
 
-    ScriptExecutionContext::postTaskTo(m_clientIdentifier, WTFMove(task));
+    if (m_workerMailbox)
+        m_workerMailbox->post(WTFMove(task));
 }
 
 void Worker::forEachWorker(const Function<Function<void(ScriptExecutionContext&)>()>& callback)
@@ -577,7 +569,7 @@ JSC_DEFINE_HOST_FUNCTION(jsFunctionPostMessage,
 
     MessageWithMessagePorts messageWithMessagePorts { serialized.releaseReturnValue(), disentangledPorts.releaseReturnValue() };
 
-    ScriptExecutionContext::postTaskTo(context->identifier(), [message = messageWithMessagePorts, protectedThis = Ref { *worker }, ports](ScriptExecutionContext& context) mutable {
+    worker->parentMailbox().post([message = messageWithMessagePorts, protectedThis = Ref { *worker }, ports](ScriptExecutionContext& context) mutable {
         Zig::GlobalObject* globalObject = jsCast<Zig::GlobalObject*>(context.jsGlobalObject());
 
         auto ports = MessagePort::entanglePorts(context, WTFMove(message.transferredPorts));
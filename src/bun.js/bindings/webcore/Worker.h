@@ -98,6 +98,7 @@ public:
     void dispatchExit(int32_t exitCode);
     ScriptExecutionContext* scriptExecutionContext() const final { return ContextDestructionObserver::scriptExecutionContext(); }
     ScriptExecutionContextIdentifier clientIdentifier() const { return m_clientIdentifier; }
+    ScriptExecutionContextMailbox& parentMailbox() { return m_parentMailbox.get(); }
     WorkerOptions& options() { return m_options; }
 
 private:
@@ -143,6 +144,10 @@ private:
     // Tracks TerminateRequestedFlag and TerminatedFlag
     std::atomic<uint8_t> m_terminationFlags { 0 };
     const ScriptExecutionContextIdentifier m_clientIdentifier;
+    // Resolved once so that posting a message does not look either context up again.
+    Ref<ScriptExecutionContextMailbox> m_parentMailbox;
+    // Set before OnlineFlag is published.
+    RefPtr<ScriptExecutionContextMailbox> m_workerMailbox;
     void* impl_ { nullptr };
 };
 
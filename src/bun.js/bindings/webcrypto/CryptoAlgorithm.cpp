@@ -92,30 +92,40 @@ ExceptionOr<size_t> CryptoAlgorithm::getKeyLength(const CryptoAlgorithmParameter
     return Exception { NotSupportedError };
 }
 
+template<typename ResultType, typename ResultCallbackType>
+static void postAlgorithmResult(ScriptExecutionContextIdentifier contextIdentifier, ResultType&& result, ResultCallbackType&& callback, CryptoAlgorithm::ExceptionCallback&& exceptionCallback)
+{
+    ScriptExecutionContext::postTaskTo(contextIdentifier, [result = WTFMove(result), callback = WTFMove(callback), exceptionCallback = WTFMove(exceptionCallback)](auto& context) mutable {
+        if (result.hasException()) {
+            exceptionCallback(result.releaseException().code(), ""_s);
+            return;
+        }
+        callback(result.releaseReturnValue());
+    });
+}
+
 template<typename ResultCallbackType, typename OperationType>
-static void dispatchAlgorithmOperation(WorkQueue& workQueue, ScriptExecutionContext& context, ResultCallbackType&& callback, CryptoAlgorithm::ExceptionCallback&& exceptionCallback, OperationType&& operation)
+static void dispatchAlgorithmOperation(WorkQueue& workQueue, ScriptExecutionContext& context, ResultCallbackType&& callback, CryptoAlgorithm::ExceptionCallback&& exceptionCallback, OperationType&& operation, size_t inputSize)
 {
+    if (inputSize <= CryptoAlgorithm::maxInlineOperationSize) {
+        postAlgorithmResult(context.identifier(), operation(), WTFMove(callback), WTFMove(exceptionCallback));
+        return;
+    }
+
     workQueue.dispatch(context.globalObject(),
         [operation = WTFMove(operation), callback = WTFMove(callback), exceptionCallback = WTFMove(exceptionCallback), contextIdentifier = context.identifier()]() mutable {
-            auto result = operation();
-            ScriptExecutionContext::postTaskTo(contextIdentifier, [result = crossThreadCopy(WTFMove(result)), callback = WTFMove(callback), exceptionCallback = WTFMove(exceptionCallback)](auto& context) mutable {
-                if (result.hasException()) {
-                    exceptionCallback(result.releaseException().code(), ""_s);
-                    return;
-                }
-                callback(result.releaseReturnValue());
-            });
+            postAlgorithmResult(contextIdentifier, crossThreadCopy(operation()), WTFMove(callback), WTFMove(exceptionCallback));
         });
 }
 
-void CryptoAlgorithm::dispatchOperationInWorkQueue(WorkQueue& workQueue, ScriptExecutionContext& context, VectorCallback&& callback, ExceptionCallback&& exceptionCallback, Function<ExceptionOr<Vector<uint8_t>>()>&& operation)
+void CryptoAlgorithm::dispatchOperationInWorkQueue(WorkQueue& workQueue, ScriptExecutionContext& context, VectorCallback&& callback, ExceptionCallback&& exceptionCallback, Function<ExceptionOr<Vector<uint8_t>>()>&& operation, size_t inputSize)
 {
-    dispatchAlgorithmOperation(workQueue, context, WTFMove(callback), WTFMove(exceptionCallback), WTFMove(operation));
+    dispatchAlgorithmOperation(workQueue, context, WTFMove(callback), WTFMove(exceptionCallback), WTFMove(operation), inputSize);
 }
 
-void CryptoAlgorithm::dispatchOperationInWorkQueue(WorkQueue& workQueue, ScriptExecutionContext& context, BoolCallback&& callback, ExceptionCallback&& exceptionCallback, Function<ExceptionOr<bool>()>&& operation)
+void CryptoAlgorithm::dispatchOperationInWorkQueue(WorkQueue& workQueue, ScriptExecutionContext& context, BoolCallback&& callback, ExceptionCallback&& exceptionCallback, Function<ExceptionOr<bool>()>&& operation, size_t inputSize)
 {
-    dispatchAlgorithmOperation(workQueue, context, WTFMove(callback), WTFMove(exceptionCallback), WTFMove(operation));
+    dispatchAlgorithmOperation(workQueue, context, WTFMove(callback), WTFMove(exceptionCallback), WTFMove(operation), inputSize);
 }
 
 }
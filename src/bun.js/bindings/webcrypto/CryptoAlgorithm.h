@@ -77,8 +77,13 @@ public:
     virtual void unwrapKey(Ref<CryptoKey>&&, Vector<uint8_t>&&, VectorCallback&&, ExceptionCallback&&);
     virtual ExceptionOr<size_t> getKeyLength(const CryptoAlgorithmParameters&);
 
-    static void dispatchOperationInWorkQueue(WorkQueue&, ScriptExecutionContext&, VectorCallback&&, ExceptionCallback&&, Function<ExceptionOr<Vector<uint8_t>>()>&&);
-    static void dispatchOperationInWorkQueue(WorkQueue&, ScriptExecutionContext&, BoolCallback&&, ExceptionCallback&&, Function<ExceptionOr<bool>()>&&);
+    // Hashing, HMAC and AES over this many bytes take less time than the round trip through the
+    // work pool, so they run on the calling thread. Their result is still delivered as a task.
+    static constexpr size_t maxInlineOperationSize = 4096;
+
+    // Callers with a cheap, size-bound operation pass inputSize to allow running it inline.
+    static void dispatchOperationInWorkQueue(WorkQueue&, ScriptExecutionContext&, VectorCallback&&, ExceptionCallback&&, Function<ExceptionOr<Vector<uint8_t>>()>&&, size_t inputSize = SIZE_MAX);
+    static void dispatchOperationInWorkQueue(WorkQueue&, ScriptExecutionContext&, BoolCallback&&, ExceptionCallback&&, Function<ExceptionOr<bool>()>&&, size_t inputSize = SIZE_MAX);
 };
 
 } // namespace WebCore
@@ -51,7 +51,7 @@ void CryptoAlgorithmSHA1::digest(Vector<uint8_t>&& message, VectorCallback&& cal
         return;
     }
 
-    if (message.size() < 64) {
+    if (message.size() <= maxInlineOperationSize) {
         auto moved = WTFMove(message);
         digest->addBytes(moved.data(), moved.size());
         auto result = digest->computeHash();
@@ -783,7 +783,7 @@ JSC_DEFINE_HOST_FUNCTION(functionSerialize,
     Vector<JSC::Strong<JSC::JSObject>> transferList;
     Vector<RefPtr<MessagePort>> dummyPorts;
     ExceptionOr<Ref<SerializedScriptValue>> serialized = SerializedScriptValue::create(*globalObject, value, WTFMove(transferList),
-        dummyPorts);
+        dummyPorts, SerializationForStorage::Yes);
 
     if (serialized.hasException()) {
         WebCore::propagateException(*globalObject, throwScope,
@@ -1696,6 +1696,13 @@ __attribute__((callback (corker, ctx)))
       ptr[0] = '\r';
       ptr[1] = '\n';
       uwsRes->uncork();
+#ifdef LIBUS_USE_IO_URING
+      // sendfile writes to the fd directly, the headers must not still be queued in the ring
+      us_socket_t *s = (us_socket_t *)uwsRes;
+      if (us_internal_ring_serves_writes(s)) {
+        us_internal_ring_drain(s);
+      }
+#endif
     }
   }
 
@@ -1760,6 +1767,16 @@ __attribute__((callback (corker, ctx)))
     }
   }
 
+  // Whether sendfile may write to the fd now, or would get ahead of bytes still queued for it
+  bool us_socket_sendfile_can_write(us_socket_r s) {
+#ifdef LIBUS_USE_IO_URING
+    if (us_internal_ring_serves_writes(s)) {
+      return us_internal_ring_drain(s) == 0;
+    }
+#endif
+    return true;
+  }
+
   void us_socket_sendfile_needs_more(us_socket_r s) {
     s->context->loop->data.last_write_failed = 1;
     us_poll_change(&s->p, s->context->loop, LIBUS_SOCKET_READABLE | LIBUS_SOCKET_WRITABLE);
@@ -13,6 +13,7 @@ pub const LIBUS_LISTEN_REUSE_PORT: i32 = 4;
 pub const LIBUS_SOCKET_IPV6_ONLY: i32 = 8;
 pub const LIBUS_LISTEN_REUSE_ADDR: i32 = 16;
 pub const LIBUS_LISTEN_DISALLOW_REUSE_PORT_FAILURE: i32 = 32;
+pub const LIBUS_SOCKET_UDP_GRO: i32 = 64;
 
 pub const Socket = opaque {
     pub fn write2(this: *Socket, first: []const u8, second: []const u8) i32 {
@@ -73,6 +74,8 @@ pub const InternalLoopData = extern struct {
     parent_tag: c_char,
     iteration_nr: usize,
     jsc_vm: ?*JSC.VM,
+    socket_pool: ?*anyopaque,
+    ring: ?*anyopaque,
 
     pub fn recvSlice(this: *InternalLoopData) []u8 {
         return this.recv_buf[0..LIBUS_RECV_BUFFER_LENGTH];
@@ -1524,6 +1527,14 @@ pub fn NewSocketHandler(comptime is_ssl: bool) type {
                 bun.toFD(@as(i32, @intCast(@intFromPtr(us_socket_get_native_handle(0, socket)))));
         }
 
+        pub fn canSendfile(this: ThisSocket) bool {
+            if (comptime is_ssl) {
+                @compileError("SSL sockets do not support sendfile yet");
+            }
+            const socket = this.socket.get() orelse return true;
+            return us_socket_sendfile_can_write(socket);
+        }
+
         pub fn markNeedsMoreForSendfile(this: ThisSocket) void {
             if (comptime is_ssl) {
                 @compileError("SSL sockets do not support sendfile yet");
@@ -2692,6 +2703,7 @@ extern fn us_socket_context_get_native_handle(ssl: i32, context: ?*SocketContext
 pub extern fn us_create_socket_context(ssl: i32, loop: ?*Loop, ext_size: i32, options: us_socket_context_options_t) ?*SocketContext;
 pub extern fn us_create_bun_socket_context(ssl: i32, loop: ?*Loop, ext_size: i32, options: us_bun_socket_context_options_t, err: *create_bun_socket_error_t) ?*SocketContext;
 pub extern fn us_bun_socket_context_add_server_name(ssl: i32, context: ?*SocketContext, hostname_pattern: [*c]const u8, options: us_bun_socket_context_options_t, ?*anyopaque) void;
+pub extern fn us_bun_socket_context_replace_server_name(ssl: i32, context: ?*SocketContext, hostname_pattern: [*c]const u8, options: us_bun_socket_context_options_t, ?*anyopaque) i32;
 pub extern fn us_socket_context_free(ssl: i32, context: ?*SocketContext) void;
 pub extern fn us_socket_context_ref(ssl: i32, context: ?*SocketContext) void;
 pub extern fn us_socket_context_unref(ssl: i32, context: ?*SocketContext) void;
@@ -4312,6 +4324,7 @@ pub const State = enum(u8) {
 };
 
 extern fn us_socket_sendfile_needs_more(socket: *Socket) void;
+extern fn us_socket_sendfile_can_write(socket: *Socket) bool;
 
 extern fn uws_app_listen_domain_with_options(
     ssl_flag: c_int,
@@ -4672,11 +4685,18 @@ pub const udp = struct {
             const len = us_udp_packet_buffer_payload_length(this, index);
             return payload[0..@as(usize, @intCast(len))];
         }
+
+        /// Non-zero when the payload is several datagrams of this size (the last may be shorter),
+        /// only on sockets created with LIBUS_SOCKET_UDP_GRO
+        pub fn getSegmentSize(this: *PacketBuffer, index: c_int) usize {
+            return @intCast(us_udp_packet_buffer_segment_size(this, index));
+        }
     };
 
     extern fn us_udp_packet_buffer_peer(buf: ?*PacketBuffer, index: c_int) *std.posix.sockaddr.storage;
     extern fn us_udp_packet_buffer_payload(buf: ?*PacketBuffer, index: c_int) [*]u8;
     extern fn us_udp_packet_buffer_payload_length(buf: ?*PacketBuffer, index: c_int) c_int;
+    extern fn us_udp_packet_buffer_segment_size(buf: ?*PacketBuffer, index: c_int) c_int;
 };
 
 extern fn bun_clear_loop_at_thread_exit() void;
@@ -170,6 +170,11 @@ pub const Sendfile = struct {
         const adjusted_count = @as(u63, @intCast(adjusted_count_temporary));
 
         if (Environment.isLinux) {
+            // headers may still be queued on the socket, the file must not overtake them
+            if (!socket.canSendfile()) {
+                return .{ .again = {} };
+            }
+
             var signed_offset = @as(i64, @intCast(this.offset));
             const begin = this.offset;
             const val =
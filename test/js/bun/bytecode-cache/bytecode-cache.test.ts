@@ -0,0 +1,32 @@
+import { expect, test } from "bun:test";
+import { mkdtempSync, readdirSync, truncateSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+
+function run(cwd: string, cacheDirectory: string) {
+  const { exitCode, stdout } = Bun.spawnSync({
+    cmd: [process.execPath, join(cwd, "index.js")],
+    env: { ...process.env, BUN_BYTECODE_CACHE_PATH: cacheDirectory },
+    stderr: "inherit",
+  });
+  return { exitCode, stdout: stdout.toString() };
+}
+
+test("damaged bytecode cache entries are ignored", async () => {
+  const cwd = mkdtempSync(join(tmpdir(), "bytecode-cache-"));
+  const cacheDirectory = join(cwd, "cache");
+  writeFileSync(join(cwd, "index.js"), "const sum = [1, 2, 3].reduce((a, b) => a + b); console.log(sum); await Bun.sleep(200);");
+
+  expect(run(cwd, cacheDirectory)).toEqual({ exitCode: 0, stdout: "6\n" });
+
+  const entries = readdirSync(cacheDirectory).filter(name => name.endsWith(".jscbc"));
+  for (const entry of entries) {
+    truncateSync(join(cacheDirectory, entry), 48);
+  }
+  expect(run(cwd, cacheDirectory)).toEqual({ exitCode: 0, stdout: "6\n" });
+
+  for (const entry of entries) {
+    writeFileSync(join(cacheDirectory, entry), Buffer.alloc(4096, 0xff));
+  }
+  expect(run(cwd, cacheDirectory)).toEqual({ exitCode: 0, stdout: "6\n" });
+});
@@ -0,0 +1,9 @@
+// Attaches to the ring posted by the test and writes `count` messages into it, then closes it.
+self.onmessage = ({ data: { buffer, count } }) => {
+  const channel = new Bun.RingChannel(buffer);
+  for (let i = 0; i < count; i++) {
+    channel.writeSync(`message ${i}`);
+  }
+  channel.close();
+  postMessage("done");
+};
@@ -0,0 +1,92 @@
+import { describe, expect, test } from "bun:test";
+
+const decoder = new TextDecoder();
+const text = (bytes: Uint8Array | null) => (bytes === null ? null : decoder.decode(bytes));
+
+describe("Bun.RingChannel", () => {
+  test("messages keep their bytes and order when they wrap around the end of the ring", () => {
+    const channel = new Bun.RingChannel(64);
+    expect(channel.capacity).toBe(64);
+
+    for (let i = 0; i < 200; i++) {
+      const message = new Uint8Array(1 + (i % 23)).map((_, j) => (i + j) & 0xff);
+      expect(channel.write(message)).toBe(true);
+      if (i % 2) {
+        expect(channel.write(String(i))).toBe(true);
+      }
+      expect(channel.tryRead()).toEqual(message);
+      if (i % 2) {
+        expect(text(channel.tryRead())).toBe(String(i));
+      }
+    }
+    expect(channel.tryRead()).toBeNull();
+    expect(channel.byteLength).toBe(0);
+  });
+
+  test("a full ring refuses writes until a read makes room", () => {
+    const channel = new Bun.RingChannel(64);
+    // Each 12 byte message takes 16 bytes with its length
+    for (let i = 0; i < 4; i++) {
+      expect(channel.write(new Uint8Array(12).fill(i))).toBe(true);
+    }
+    expect(channel.byteLength).toBe(64);
+    expect(channel.write(new Uint8Array(1))).toBe(false);
+    expect(channel.writeSync(new Uint8Array(1), 10)).toBe(false);
+
+    expect(channel.tryRead()).toEqual(new Uint8Array(12).fill(0));
+    expect(channel.write(new Uint8Array(12).fill(4))).toBe(true);
+    for (let i = 1; i <= 4; i++) {
+      expect(channel.tryRead()).toEqual(new Uint8Array(12).fill(i));
+    }
+
+    expect(() => channel.write(new Uint8Array(61))).toThrow(RangeError);
+    expect(channel.write(new Uint8Array(60))).toBe(true);
+  });
+
+  test("read() waits for a write from another thread and close() ends it", async () => {
+    const channel = new Bun.RingChannel(256);
+    const reads = [channel.read(), channel.read()];
+    const worker = new Worker(new URL("./ring-channel-writer-fixture.js", import.meta.url).href);
+    worker.postMessage({ buffer: channel.buffer, count: 50 });
+
+    const received = (await Promise.all(reads)).map(text);
+    for (;;) {
+      const message = await channel.read();
+      if (message === null) break;
+      received.push(text(message));
+    }
+    worker.terminate();
+
+    expect(received).toEqual(Array.from({ length: 50 }, (_, i) => `message ${i}`));
+    expect(channel.closed).toBe(true);
+    expect(await channel.read()).toBeNull();
+  });
+
+  test("readSync() times out on an empty ring", () => {
+    const channel = new Bun.RingChannel(64);
+    expect(channel.readSync(10)).toBeNull();
+  });
+
+  test("buffers that are not a ring are rejected", () => {
+    expect(() => new Bun.RingChannel(new SharedArrayBuffer(256))).toThrow();
+    expect(() => new Bun.RingChannel(new ArrayBuffer(256))).toThrow();
+    const growable = new SharedArrayBuffer(192 + 64, { maxByteLength: 4096 });
+    new Uint8Array(growable).set(new Uint8Array(new Bun.RingChannel(64).buffer).subarray(0, 192));
+    expect(() => new Bun.RingChannel(growable)).toThrow();
+  });
+
+  test("a lock word left taken in shared memory fails the operation instead of hanging", () => {
+    const channel = new Bun.RingChannel(64);
+    const words = new Int32Array(channel.buffer);
+    // readerLock is the second word of the header, writerLock the second word of the next cache line
+    Atomics.store(words, 17, 1);
+    expect(() => channel.write("x")).toThrow("corrupted");
+    Atomics.store(words, 17, 0);
+    expect(channel.write("x")).toBe(true);
+
+    Atomics.store(words, 1, 1);
+    expect(() => channel.tryRead()).toThrow("corrupted");
+    Atomics.store(words, 1, 0);
+    expect(text(channel.tryRead())).toBe("x");
+  });
+});
@@ -0,0 +1,61 @@
+import { Database } from "bun:sqlite";
+import { describe, expect, test } from "bun:test";
+
+describe("columnar()", () => {
+  test("typed columns", () => {
+    const db = new Database(":memory:");
+    db.run("CREATE TABLE t (n REAL, s TEXT, b BLOB)");
+    db.run("INSERT INTO t VALUES (1.5, 'a', x'01'), (NULL, 'bc', NULL), (3, '', x'0203')");
+
+    const [n, s, b] = db.query("SELECT n, s, b FROM t").columnar();
+    expect(n.type).toBe("number");
+    expect(Array.from(n.values)).toEqual([1.5, NaN, 3]);
+    expect(Array.from(n.nulls)).toEqual([0, 1, 0]);
+    expect(s.type).toBe("text");
+    expect(Array.from(s.offsets)).toEqual([0, 1, 3, 3]);
+    expect(new TextDecoder().decode(s.bytes)).toBe("abc");
+    expect(b.type).toBe("blob");
+    expect(Array.from(b.offsets)).toEqual([0, 1, 1, 3]);
+    expect(Array.from(b.bytes)).toEqual([1, 2, 3]);
+  });
+
+  test("a column of mixed storage classes becomes a plain array", () => {
+    const db = new Database(":memory:");
+    db.run("CREATE TABLE t (v)");
+    db.run("INSERT INTO t VALUES (1), (NULL), (2.5), ('text'), (x'0102'), (NULL)");
+
+    const [v] = db.query("SELECT v FROM t").columnar();
+    expect(v.type).toBe("mixed");
+    expect(v.values).toEqual([1, null, 2.5, "text", new Uint8Array([1, 2]), null]);
+    expect(Array.from(v.nulls)).toEqual([0, 1, 0, 0, 0, 1]);
+    expect(v.values).toEqual(db.query("SELECT v FROM t").values().map(row => row[0]));
+  });
+
+  test("text after blob and blob after text are not converted", () => {
+    const db = new Database(":memory:");
+    db.run("CREATE TABLE t (a, b)");
+    db.run("INSERT INTO t VALUES ('x', x'ff'), (x'6869', 'y')");
+
+    const [a, b] = db.query("SELECT a, b FROM t").columnar();
+    expect(a.type).toBe("mixed");
+    expect(a.values).toEqual(["x", new Uint8Array([0x68, 0x69])]);
+    expect(b.type).toBe("mixed");
+    expect(b.values).toEqual([new Uint8Array([0xff]), "y"]);
+  });
+
+  test("integers stay numbers, floats in a bigint column do not get truncated", () => {
+    const db = new Database(":memory:");
+    db.run("CREATE TABLE t (v)");
+    db.run("INSERT INTO t VALUES (1.25), (2)");
+    const [numbers] = db.query("SELECT v FROM t").columnar();
+    expect(numbers.type).toBe("number");
+    expect(Array.from(numbers.values)).toEqual([1.25, 2]);
+
+    const bigints = new Database(":memory:", { safeIntegers: true });
+    bigints.run("CREATE TABLE t (v)");
+    bigints.run("INSERT INTO t VALUES (1), (2.5)");
+    const [v] = bigints.query("SELECT v FROM t").columnar();
+    expect(v.type).toBe("mixed");
+    expect(v.values).toEqual([1n, 2.5]);
+  });
+});
@@ -0,0 +1,14 @@
+// Opens the pool the parent opened, writes through it and gives its reference back
+import { Database } from "bun:sqlite";
+
+const Run = 0;
+
+self.onmessage = ({ data: { path, rows } }) => {
+  const pool = Database.openPool(path);
+  for (let i = 0; i < rows; i++) {
+    Database.poolQuery(pool, "INSERT INTO items (name) VALUES (?)", [`worker ${i}`], Run);
+  }
+  const stats = Database.poolStats(pool);
+  Database.closePool(pool);
+  postMessage({ pool, stats });
+};
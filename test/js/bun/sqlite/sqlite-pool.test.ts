@@ -0,0 +1,136 @@
+import { Database } from "bun:sqlite";
+import { expect, test } from "bun:test";
+import { mkdtempSync, rmSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join, relative } from "node:path";
+
+// The modes poolQuery() takes
+const Run = 0;
+const All = 1;
+const Get = 3;
+
+function withPoolDirectory(fn: (path: string) => Promise<void> | void) {
+  return async () => {
+    const dir = mkdtempSync(join(tmpdir(), "sqlite-pool-"));
+    try {
+      await fn(join(dir, "pool.db"));
+    } finally {
+      rmSync(dir, { recursive: true, force: true });
+    }
+  };
+}
+
+test(
+  "reads go to readers and writes to the writer",
+  withPoolDirectory(path => {
+    const pool = Database.openPool(path, 2);
+    try {
+      Database.poolQuery(pool, "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)", null, Run);
+      const inserted = Database.poolQuery(pool, "INSERT INTO items (name) VALUES (?)", ["a"], Run);
+      expect(inserted).toEqual({ changes: 1, lastInsertRowid: 1 });
+
+      const before = Database.poolStats(pool);
+      expect(Database.poolQuery(pool, "SELECT name FROM items", null, All)).toEqual([{ name: "a" }]);
+      expect(Database.poolQuery(pool, "SELECT count(*) AS n FROM items", null, Get)).toEqual({ n: 1 });
+      let stats = Database.poolStats(pool);
+      expect(stats.reads).toBe(before.reads + 2);
+      expect(stats.writes).toBe(before.writes);
+      expect(stats).toMatchObject({ readers: 2, idleReaders: 2 });
+
+      // The first run of a write finds out on a reader, later runs go straight to the writer
+      Database.poolQuery(pool, "INSERT INTO items (name) VALUES (?)", ["b"], Run);
+      stats = Database.poolStats(pool);
+      expect(stats.reads).toBe(before.reads + 2);
+      expect(stats.writes).toBe(before.writes + 1);
+
+      expect(() => Database.poolQuery(pool, "BEGIN", null, Run)).toThrow(/rolled back/);
+      expect(Database.poolQuery(pool, "SELECT name FROM items ORDER BY id", null, All)).toEqual([
+        { name: "a" },
+        { name: "b" },
+      ]);
+    } finally {
+      Database.closePool(pool);
+    }
+  }),
+);
+
+test(
+  "differently spelled paths to the same file share a pool",
+  withPoolDirectory(path => {
+    const absolute = Database.openPool(path);
+    const relativePath = relative(process.cwd(), path);
+    const dotted = join(path, "..", ".", "pool.db");
+    try {
+      expect(Database.openPool(relativePath)).toBe(absolute);
+      expect(Database.openPool(dotted)).toBe(absolute);
+    } finally {
+      Database.closePool(absolute);
+      Database.closePool(absolute);
+      Database.closePool(absolute);
+    }
+  }),
+);
+
+test(
+  "a binding getter that queries the same pool throws instead of waiting",
+  withPoolDirectory(path => {
+    const pool = Database.openPool(path, 1, 10_000);
+    try {
+      Database.poolQuery(pool, "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)", null, Run);
+      Database.poolQuery(pool, "INSERT INTO items (name) VALUES (?)", ["first"], Run);
+
+      const reentrant = (sql: string, mode: number) => ({
+        get $name() {
+          return Database.poolQuery(pool, sql, null, mode);
+        },
+      });
+
+      const start = performance.now();
+      expect(() =>
+        Database.poolQuery(pool, "INSERT INTO items (name) VALUES ($name)", reentrant("DELETE FROM items", Run), Run),
+      ).toThrow(/another query/);
+      expect(() =>
+        Database.poolQuery(pool, "SELECT $name AS name", reentrant("SELECT 1", Get), Get),
+      ).toThrow(/another query/);
+      expect(performance.now() - start).toBeLessThan(5_000);
+
+      // Neither connection was left borrowed
+      expect(Database.poolStats(pool).idleReaders).toBe(1);
+      expect(Database.poolQuery(pool, "SELECT name FROM items", null, All)).toEqual([{ name: "first" }]);
+      Database.poolQuery(pool, "INSERT INTO items (name) VALUES (?)", ["second"], Run);
+    } finally {
+      Database.closePool(pool);
+    }
+  }),
+);
+
+test(
+  "Workers share the pool and closePool() only gives back their own reference",
+  withPoolDirectory(async path => {
+    const pool = Database.openPool(path);
+    try {
+      Database.poolQuery(pool, "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)", null, Run);
+
+      const worker = new Worker(new URL("./sqlite-pool-worker-fixture.js", import.meta.url).href);
+      const { promise, resolve, reject } = Promise.withResolvers<any>();
+      worker.onerror = reject;
+      worker.onmessage = ({ data }) => resolve(data);
+      worker.postMessage({ path: relative(process.cwd(), path), rows: 20 });
+      const result = await promise;
+      worker.terminate();
+
+      expect(result.pool).toBe(pool);
+      expect(result.stats.writes).toBeGreaterThanOrEqual(20);
+      expect(Database.poolQuery(pool, "SELECT count(*) AS n FROM items", null, Get)).toEqual({ n: 20 });
+
+      // Closing a pool this thread never opened, or twice, does not release anyone else's reference
+      Database.closePool(pool + 1);
+      Database.poolQuery(pool, "INSERT INTO items (name) VALUES (?)", ["main"], Run);
+    } finally {
+      Database.closePool(pool);
+    }
+
+    Database.closePool(pool);
+    expect(() => Database.poolQuery(pool, "SELECT 1", null, Get)).toThrow(/closed database pool/);
+  }),
+);
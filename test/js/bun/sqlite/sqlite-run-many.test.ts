@@ -0,0 +1,80 @@
+import { Database } from "bun:sqlite";
+import { describe, expect, test } from "bun:test";
+
+describe("runMany()", () => {
+  test("rows and columns", () => {
+    const db = new Database(":memory:");
+    db.run("CREATE TABLE t (a INTEGER, b TEXT)");
+    const insert = db.query("INSERT INTO t VALUES (?, ?)");
+    insert.runMany([
+      [1, "one"],
+      [2, "two"],
+    ]);
+    insert.runMany({ columns: [new Int32Array([3, 4]), ["three", "four"]] });
+    expect(db.query("SELECT a, b FROM t ORDER BY a").values()).toEqual([
+      [1, "one"],
+      [2, "two"],
+      [3, "three"],
+      [4, "four"],
+    ]);
+  });
+
+  test("a getter that detaches a buffer bound earlier in the row does not change what was bound", () => {
+    const db = new Database(":memory:");
+    db.run("CREATE TABLE t (a BLOB, b INTEGER)");
+    const insert = db.query("INSERT INTO t VALUES ($a, $b)");
+
+    const blob = new Uint8Array([1, 2, 3, 4]);
+    insert.runMany([
+      {
+        $a: blob,
+        get $b() {
+          blob.buffer.transfer();
+          new Uint8Array(1024).fill(0xff);
+          return 1;
+        },
+      },
+    ]);
+    expect(blob.byteLength).toBe(0);
+
+    const blobs = [new Uint8Array([5, 6, 7])];
+    const detaching = [];
+    Object.defineProperty(detaching, 0, {
+      get() {
+        blobs[0].buffer.transfer();
+        return 2;
+      },
+    });
+    insert.runMany({ columns: [blobs, detaching] });
+
+    expect(db.query("SELECT a, b FROM t ORDER BY b").values()).toEqual([
+      [new Uint8Array([1, 2, 3, 4]), 1],
+      [new Uint8Array([5, 6, 7]), 2],
+    ]);
+  });
+
+  test("typed array columns over resizable buffers are rejected", () => {
+    const db = new Database(":memory:");
+    db.run("CREATE TABLE t (a REAL)");
+    const insert = db.query("INSERT INTO t VALUES (?)");
+    const values = new Float64Array(new ArrayBuffer(16, { maxByteLength: 64 }));
+    expect(() => insert.runMany({ columns: [values] })).toThrow(TypeError);
+    expect(db.query("SELECT count(*) FROM t").values()).toEqual([[0]]);
+  });
+
+  test("a detached typed array column fails the batch and rolls it back", () => {
+    const db = new Database(":memory:");
+    db.run("CREATE TABLE t (a INTEGER, b INTEGER)");
+    const insert = db.query("INSERT INTO t VALUES (?, ?)");
+    const numbers = new Int32Array([1, 2]);
+    const detaching = [1];
+    Object.defineProperty(detaching, 1, {
+      get() {
+        numbers.buffer.transfer();
+        return 2;
+      },
+    });
+    expect(() => insert.runMany({ columns: [detaching, numbers] })).toThrow("TypedArray was detached or resized");
+    expect(db.query("SELECT count(*) FROM t").values()).toEqual([[0]]);
+  });
+});
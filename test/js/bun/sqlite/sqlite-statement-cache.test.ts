@@ -0,0 +1,130 @@
+import { Database } from "bun:sqlite";
+import { expect, test } from "bun:test";
+
+function prepareAndFinalize(db: Database, sql: string, ...params: any[]) {
+  const stmt = db.prepare(sql);
+  const rows = stmt.all(...params);
+  stmt.finalize();
+  return rows;
+}
+
+test("a differently spelled query reuses the statement and reports its own text", () => {
+  const db = new Database(":memory:");
+  db.run("CREATE TABLE t (a INTEGER, b TEXT)");
+  db.run("INSERT INTO t VALUES (1, 'one'), (2, 'two')");
+
+  prepareAndFinalize(db, "SELECT a, b FROM t ORDER BY a");
+  const before = db.statementCacheStats();
+
+  const respelled = "  SELECT a,b\n  FROM t -- all rows\n  ORDER BY a;";
+  const stmt = db.prepare(respelled);
+  expect(stmt.all()).toEqual([
+    { a: 1, b: "one" },
+    { a: 2, b: "two" },
+  ]);
+  expect(stmt.toString()).toBe(respelled);
+  stmt.finalize();
+
+  const after = db.statementCacheStats();
+  expect(after.hits).toBe(before.hits + 1);
+  expect(after.misses).toBe(before.misses);
+});
+
+test("a differently spelled query with parameters gets its own statement", () => {
+  const db = new Database(":memory:");
+  prepareAndFinalize(db, "SELECT ? AS v", 1);
+  const before = db.statementCacheStats();
+
+  const stmt = db.prepare("SELECT  ?  AS v");
+  expect(stmt.get(2)).toEqual({ v: 2 });
+  expect(stmt.toString()).toBe("SELECT  2  AS v");
+  stmt.finalize();
+
+  expect(db.statementCacheStats().hits).toBe(before.hits);
+});
+
+test("queries that only differ in literals do not share a statement", () => {
+  const db = new Database(":memory:");
+  expect(prepareAndFinalize(db, "SELECT 1 AS v")).toEqual([{ v: 1 }]);
+  expect(prepareAndFinalize(db, "SELECT 2 AS v")).toEqual([{ v: 2 }]);
+  expect(prepareAndFinalize(db, "SELECT 'a b' AS v")).toEqual([{ v: "a b" }]);
+  expect(prepareAndFinalize(db, "SELECT 'a  b' AS v")).toEqual([{ v: "a  b" }]);
+  expect(prepareAndFinalize(db, 'SELECT 1 AS "x y"')).toEqual([{ "x y": 1 }]);
+  expect(prepareAndFinalize(db, 'SELECT 1 AS "x  y"')).toEqual([{ "x  y": 1 }]);
+
+  const stats = db.statementCacheStats();
+  expect(stats.hits).toBe(0);
+  expect(stats.size).toBe(6);
+});
+
+test("unaliased expression columns keep the caller's names", () => {
+  const db = new Database(":memory:");
+  expect(prepareAndFinalize(db, "SELECT 1+1")).toEqual([{ "1+1": 2 }]);
+  expect(prepareAndFinalize(db, "SELECT 1 + 1")).toEqual([{ "1 + 1": 2 }]);
+});
+
+test("a reused statement starts with no bindings", () => {
+  const db = new Database(":memory:");
+  const first = db.prepare("SELECT ? AS a, ? AS b");
+  expect(first.get("x", "y")).toEqual({ a: "x", b: "y" });
+  first.finalize();
+
+  const before = db.statementCacheStats();
+  const second = db.prepare("SELECT ? AS a, ? AS b");
+  expect(db.statementCacheStats().hits).toBe(before.hits + 1);
+  expect(second.get()).toEqual({ a: null, b: null });
+  expect(second.toString()).toBe("SELECT NULL AS a, NULL AS b");
+  second.finalize();
+});
+
+test("a statement is never handed out twice", () => {
+  const db = new Database(":memory:");
+  prepareAndFinalize(db, "SELECT ? AS v", 0);
+
+  const a = db.prepare("SELECT ? AS v");
+  const b = db.prepare("SELECT ? AS v");
+  expect(a.get(1)).toEqual({ v: 1 });
+  expect(b.get(2)).toEqual({ v: 2 });
+  expect(a.toString()).toBe("SELECT 1 AS v");
+  a.finalize();
+  b.finalize();
+  expect(db.statementCacheStats().size).toBe(1);
+});
+
+test("the least recently finalized statement is evicted first", () => {
+  const db = new Database(":memory:");
+  db.setStatementCacheSize(2);
+
+  prepareAndFinalize(db, "SELECT 1");
+  prepareAndFinalize(db, "SELECT 2");
+  prepareAndFinalize(db, "SELECT 3");
+  let stats = db.statementCacheStats();
+  expect(stats).toMatchObject({ size: 2, capacity: 2, evictions: 1 });
+
+  const hits = stats.hits;
+  prepareAndFinalize(db, "SELECT 3");
+  prepareAndFinalize(db, "SELECT 2");
+  expect(db.statementCacheStats().hits).toBe(hits + 2);
+  prepareAndFinalize(db, "SELECT 1");
+  stats = db.statementCacheStats();
+  expect(stats.hits).toBe(hits + 2);
+  expect(stats.evictions).toBe(2);
+
+  db.setStatementCacheSize(0);
+  stats = db.statementCacheStats();
+  expect(stats).toMatchObject({ size: 0, capacity: 0, evictions: 4 });
+  prepareAndFinalize(db, "SELECT 1");
+  expect(db.statementCacheStats().size).toBe(0);
+});
+
+test("close() finalizes every cached statement", () => {
+  const db = new Database(":memory:");
+  db.run("CREATE TABLE t (a INTEGER)");
+  for (let i = 0; i < 10; i++) {
+    prepareAndFinalize(db, `SELECT a + ${i} FROM t`);
+  }
+  expect(db.statementCacheStats().size).toBe(10);
+
+  // sqlite3_close() refuses to close a database that still has statements
+  expect(() => db.close(true)).not.toThrow();
+});
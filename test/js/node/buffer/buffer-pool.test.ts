@@ -0,0 +1,207 @@
+import { afterEach, describe, expect, test } from "bun:test";
+
+// Small Buffer.allocUnsafe() and Buffer.from(string) results are slices of a shared pool, as in
+// Node: `buffer` is the pool, `byteOffset` points into it, and slices never overlap.
+
+const defaultPoolSize = Buffer.poolSize;
+
+afterEach(() => {
+  Buffer.poolSize = defaultPoolSize;
+});
+
+function isPooled(buffer: Buffer) {
+  return buffer.buffer.byteLength > buffer.length;
+}
+
+// Allocates until a new pool is started, so the next small allocations are laid out next to each other.
+function startNewPool() {
+  const half = Buffer.poolSize >>> 1;
+  while (Buffer.allocUnsafe(half - 1).byteOffset !== 0);
+}
+
+// The same bytes, encoded outside of the pool.
+function unpooled(source: string, encoding: BufferEncoding) {
+  const poolSize = Buffer.poolSize;
+  Buffer.poolSize = 0;
+  try {
+    return Buffer.from(source, encoding).toString("hex");
+  } finally {
+    Buffer.poolSize = poolSize;
+  }
+}
+
+// Every pair of slices of the same pool covers disjoint bytes.
+function expectDisjoint(buffers: Buffer[]) {
+  const byPool = new Map<ArrayBufferLike, Buffer[]>();
+  for (const buffer of buffers) {
+    const list = byPool.get(buffer.buffer) ?? [];
+    list.push(buffer);
+    byPool.set(buffer.buffer, list);
+  }
+  for (const list of byPool.values()) {
+    list.sort((a, b) => a.byteOffset - b.byteOffset);
+    for (let i = 1; i < list.length; i++) {
+      expect(list[i - 1].byteOffset + list[i - 1].length <= list[i].byteOffset).toBe(true);
+    }
+  }
+}
+
+describe("Buffer pool", () => {
+  test("Buffer.poolSize defaults to 8KB and reads back what was written", () => {
+    expect(defaultPoolSize).toBe(8192);
+    Buffer.poolSize = 1 << 16;
+    expect(Buffer.poolSize).toBe(1 << 16);
+    // Coerced like Node's `Buffer.poolSize >>> 1` would see it
+    Buffer.poolSize = "4096" as any;
+    expect(Buffer.poolSize).toBe(4096);
+    Buffer.poolSize = -1;
+    expect(Buffer.poolSize).toBe(0xffffffff);
+  });
+
+  test("small allocUnsafe results share one ArrayBuffer at 8 byte aligned offsets", () => {
+    startNewPool();
+    const first = Buffer.allocUnsafe(1);
+    const second = Buffer.allocUnsafe(1);
+    const third = Buffer.allocUnsafe(13);
+    expect(isPooled(first)).toBe(true);
+    expect(first.buffer.byteLength).toBe(Buffer.poolSize);
+    expect(second.buffer).toBe(first.buffer);
+    expect(third.buffer).toBe(first.buffer);
+    expect(second.byteOffset).toBe(first.byteOffset + 8);
+    expect(third.byteOffset).toBe(second.byteOffset + 8);
+    for (const buffer of [first, second, third]) expect(buffer.byteOffset % 8).toBe(0);
+  });
+
+  test("small Buffer.from(string) results share the pool with allocUnsafe", () => {
+    startNewPool();
+    const allocated = Buffer.allocUnsafe(3);
+    const fromString = Buffer.from("hello");
+    const fromHex = Buffer.from("deadbeef", "hex");
+    expect(fromString.buffer).toBe(allocated.buffer);
+    expect(fromHex.buffer).toBe(allocated.buffer);
+    expect(fromString.byteOffset).toBe(allocated.byteOffset + 8);
+    expect(fromHex.byteOffset).toBe(fromString.byteOffset + 8);
+    expect(fromString.toString()).toBe("hello");
+    expect(fromHex.toString("hex")).toBe("deadbeef");
+  });
+
+  test("nothing at or above half of Buffer.poolSize comes from the pool", () => {
+    const half = Buffer.poolSize >>> 1;
+    for (const size of [half, half + 1, Buffer.poolSize, Buffer.poolSize + 1]) {
+      const allocated = Buffer.allocUnsafe(size);
+      expect(allocated.byteOffset).toBe(0);
+      expect(allocated.buffer.byteLength).toBe(size);
+      const fromString = Buffer.from("a".repeat(size));
+      expect(fromString.byteOffset).toBe(0);
+      expect(fromString.buffer.byteLength).toBe(size);
+    }
+    expect(isPooled(Buffer.allocUnsafe(half - 1))).toBe(true);
+    expect(isPooled(Buffer.from("a".repeat(half - 1)))).toBe(true);
+
+    // Strings are measured by encoded length, but like Node, one at least that many code units long
+    // is never pooled even when it decodes to fewer bytes
+    expect(isPooled(Buffer.from("é".repeat(half >> 1)))).toBe(false);
+    expect(isPooled(Buffer.from("é".repeat((half >> 1) - 1)))).toBe(true);
+    expect(isPooled(Buffer.from("ab".repeat((half >> 1) - 1), "hex"))).toBe(true);
+    expect(isPooled(Buffer.from("ab".repeat(half >> 1), "hex"))).toBe(false);
+  });
+
+  test("allocUnsafeSlow, alloc and empty buffers never come from the pool", () => {
+    for (const buffer of [Buffer.allocUnsafeSlow(16), Buffer.alloc(16), Buffer.alloc(16, "x")]) {
+      expect(buffer.byteOffset).toBe(0);
+      expect(buffer.buffer.byteLength).toBe(16);
+    }
+    expect(Buffer.allocUnsafe(0).buffer.byteLength).toBe(0);
+    expect(Buffer.from("").buffer.byteLength).toBe(0);
+    // Decodes to nothing
+    expect(Buffer.from("zz", "hex").length).toBe(0);
+  });
+
+  test("a new Buffer.poolSize applies to the next pool", () => {
+    Buffer.poolSize = 1 << 16;
+    // Too big for the old pool's threshold, and for what's left of it, so a new pool is made
+    const large = Buffer.allocUnsafe(10000);
+    expect(large.buffer.byteLength).toBe(1 << 16);
+    expect(Buffer.allocUnsafe(10000).buffer).toBe(large.buffer);
+    expect(Buffer.from("x".repeat(10000)).buffer).toBe(large.buffer);
+
+    Buffer.poolSize = 1 << 10;
+    // The threshold changes right away, the current pool is still used until it runs out
+    expect(isPooled(Buffer.allocUnsafe(600))).toBe(false);
+    expect(Buffer.allocUnsafe(100).buffer).toBe(large.buffer);
+    const filler = Buffer.allocUnsafe(500);
+    let next = filler;
+    while (next.buffer === large.buffer) next = Buffer.allocUnsafe(500);
+    expect(next.buffer.byteLength).toBe(1 << 10);
+  });
+
+  test("Buffer.poolSize = 0 turns the pool off", () => {
+    Buffer.poolSize = 0;
+    for (const buffer of [Buffer.allocUnsafe(1), Buffer.from("a"), Buffer.from("00", "hex")]) {
+      expect(buffer.byteOffset).toBe(0);
+      expect(buffer.buffer.byteLength).toBe(1);
+    }
+  });
+
+  test("pooled buffers never overlap and keep their contents", () => {
+    let seed = 7;
+    const random = () => (seed = (seed * 1103515245 + 12345) >>> 0) / 2 ** 32;
+    const encodings = ["utf8", "latin1", "ascii", "hex", "base64", "base64url", "ucs2"] as const;
+
+    const buffers: Buffer[] = [];
+    const expected: string[] = [];
+    for (let i = 0; i < 5000; i++) {
+      const length = Math.floor(random() * 300);
+      if (random() < 0.3) {
+        const buffer = Buffer.allocUnsafe(length).fill(i & 0xff);
+        buffers.push(buffer);
+        expected.push(Buffer.alloc(length, i & 0xff).toString("hex"));
+        continue;
+      }
+      const encoding = encodings[Math.floor(random() * encodings.length)];
+      let string = "";
+      for (let j = 0; j < length; j++) {
+        const kind = random();
+        string += kind < 0.6 ? String.fromCharCode(0x61 + (j % 26)) : kind < 0.8 ? "é" : kind < 0.95 ? "€" : "😀";
+      }
+      let source = string;
+      if (encoding === "hex" || encoding.startsWith("base64")) {
+        source = Buffer.allocUnsafeSlow(length).fill(i).toString(encoding);
+        // Invalid input decodes to fewer bytes than were set aside for it
+        if (random() < 0.2) source += "zz";
+      }
+      buffers.push(Buffer.from(source, encoding));
+      expected.push(unpooled(source, encoding));
+    }
+
+    expectDisjoint(buffers);
+    expect(buffers.some(isPooled)).toBe(true);
+    for (let i = 0; i < buffers.length; i++) {
+      if (buffers[i].toString("hex") !== expected[i]) expect({ i, bytes: buffers[i].toString("hex") }).toEqual({ i, bytes: expected[i] });
+    }
+  });
+
+  test("writing to one pooled buffer leaves its neighbours alone", () => {
+    startNewPool();
+    const a = Buffer.from("aaaaaaa");
+    const b = Buffer.from("bbbbbbbbb");
+    const c = Buffer.allocUnsafe(5).fill("c");
+    expect(b.buffer).toBe(a.buffer);
+    expect(c.buffer).toBe(a.buffer);
+    a.fill("x");
+    b.fill("y");
+    expect(a.toString()).toBe("xxxxxxx");
+    expect(b.toString()).toBe("yyyyyyyyy");
+    expect(c.toString()).toBe("ccccc");
+  });
+
+  test("the pool can't be transferred out from under its slices", () => {
+    startNewPool();
+    const a = Buffer.allocUnsafe(8).fill(1);
+    const b = Buffer.allocUnsafe(8).fill(2);
+    expect(b.buffer).toBe(a.buffer);
+    expect(() => structuredClone(a.buffer, { transfer: [a.buffer] })).toThrow();
+    expect(a.buffer.byteLength).toBe(Buffer.poolSize);
+    expect([...b]).toEqual([2, 2, 2, 2, 2, 2, 2, 2]);
+  });
+});
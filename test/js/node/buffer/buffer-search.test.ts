@@ -0,0 +1,209 @@
+import { describe, expect, test } from "bun:test";
+
+// Buffer#indexOf, #lastIndexOf and #includes against a naive search with Node's offset rules.
+// Needle lengths straddle the SIMD strides and the switch to Horspool at 128 bytes, and haystacks
+// straddle the 1MB past which long needles go back to the SIMD filter.
+
+function normalizeOffset(length: number, byteOffset: number | undefined, needleLength: number, forward: boolean) {
+  let offset = byteOffset === undefined ? NaN : +byteOffset;
+  if (Number.isNaN(offset)) offset = forward ? 0 : length;
+  offset = Math.trunc(Math.max(-0x80000000, Math.min(0x7fffffff, offset)));
+  if (offset < 0) {
+    if (offset + length >= 0) return length + offset;
+    return forward || needleLength === 0 ? 0 : -1;
+  }
+  if (offset + needleLength <= length) return offset;
+  if (needleLength === 0) return length;
+  return forward ? -1 : length - 1;
+}
+
+function referenceSearch(haystack: Uint8Array, needle: Uint8Array, byteOffset: number | undefined, forward: boolean, ucs2 = false) {
+  if (haystack.length === 0) return -1;
+  const offset = normalizeOffset(haystack.length, byteOffset, needle.length, forward);
+  if (offset === -1) return -1;
+  if (needle.length === 0) return offset;
+  if ((forward && offset + needle.length > haystack.length) || needle.length > haystack.length) return -1;
+
+  const unit = ucs2 ? 2 : 1;
+  const n = Math.floor(haystack.length / unit);
+  const m = Math.floor(needle.length / unit);
+  if (m === 0) return -1;
+  const matchesAt = (i: number) => {
+    for (let k = 0; k < m * unit; k++) if (haystack[i * unit + k] !== needle[k]) return false;
+    return true;
+  };
+  const start = Math.floor(offset / unit);
+  if (forward) {
+    for (let i = start; i + m <= n; i++) if (matchesAt(i)) return i * unit;
+  } else {
+    for (let i = Math.min(start, n - m); i >= 0; i--) if (matchesAt(i)) return i * unit;
+  }
+  return -1;
+}
+
+function offsetsFor(n: number, m: number) {
+  return [undefined, 0, 1, 2, 3, -1, -2, -3, -m, -m - 1, n - m - 1, n - m, n - m + 1, n - 1, n, n + 1, n + 1000, -n, -n - 1, 2 ** 40, -(2 ** 40), 1.5, -1.5, NaN];
+}
+
+function check(haystack: Buffer, needle: Buffer, encoding?: "ucs2") {
+  const ucs2 = encoding === "ucs2";
+  for (const offset of offsetsFor(haystack.length, needle.length)) {
+    const first = haystack.indexOf(needle, offset, encoding);
+    const last = haystack.lastIndexOf(needle, offset, encoding);
+    const expected = [referenceSearch(haystack, needle, offset, true, ucs2), referenceSearch(haystack, needle, offset, false, ucs2)];
+    if (first !== expected[0] || last !== expected[1]) {
+      // Only build the failure message when there is one
+      expect({ haystack: haystack.length, needle: needle.length, offset, first, last }).toEqual({
+        haystack: haystack.length,
+        needle: needle.length,
+        offset,
+        first: expected[0],
+        last: expected[1],
+      });
+    }
+    expect(haystack.includes(needle, offset, encoding)).toBe(first !== -1);
+    if (ucs2 && first !== -1) expect(first % 2).toBe(0);
+    if (ucs2 && last !== -1) expect(last % 2).toBe(0);
+  }
+}
+
+// A needle whose first and last bytes are the same as a near miss planted in the haystack, so the
+// SIMD filter's candidates have to be rejected by the full comparison.
+function needleOf(length: number) {
+  const needle = Buffer.alloc(length);
+  for (let i = 0; i < length; i++) needle[i] = 0x62 + (i % 7);
+  return needle;
+}
+
+function nearMiss(needle: Buffer) {
+  const miss = Buffer.from(needle);
+  if (miss.length > 2) miss[miss.length >> 1] = 0x61;
+  else miss[miss.length - 1] = 0x61;
+  return miss;
+}
+
+function haystackWith(size: number, needle: Buffer, places: ("start" | "middle" | "end" | "miss")[]) {
+  const haystack = Buffer.alloc(size, 0x61);
+  for (const place of places) {
+    const at = place === "start" ? 0 : place === "end" ? size - needle.length : (size - needle.length) >> 1;
+    (place === "miss" ? nearMiss(needle) : needle).copy(haystack, at);
+  }
+  return haystack;
+}
+
+const needleLengths = [1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 200, 300];
+const placements: ("start" | "middle" | "end" | "miss")[][] = [[], ["start"], ["end"], ["start", "end"], ["miss"], ["miss", "end"], ["middle"]];
+
+describe("Buffer search", () => {
+  for (const m of needleLengths) {
+    test(`needle of ${m} bytes, matches at the edges`, () => {
+      const needle = needleOf(m);
+      for (const size of [m, m + 1, m + 15, m + 16, m + 31, 2 * m + 33, 1000 + m]) {
+        for (const places of placements) {
+          if (places.length > 1 && size < 2 * m) continue;
+          check(haystackWith(size, needle, places), needle);
+        }
+      }
+    });
+  }
+
+  for (const m of [1, 2, 16, 32, 33, 128, 300]) {
+    test(`needle of ${m} bytes in haystacks around 1MB`, () => {
+      const needle = needleOf(m);
+      for (const size of [(1 << 20) - 1, 1 << 20, (1 << 20) + 4097]) {
+        for (const places of [[], ["start", "end"], ["miss", "end"]] as const) {
+          const haystack = haystackWith(size, needle, [...places]);
+          for (const offset of [undefined, 0, 1, -1, -m, size - m, size - m + 1]) {
+            const first = haystack.indexOf(needle, offset);
+            const last = haystack.lastIndexOf(needle, offset);
+            expect([first, last]).toEqual([
+              referenceSearch(haystack, needle, offset, true),
+              referenceSearch(haystack, needle, offset, false),
+            ]);
+            expect(haystack.includes(needle, offset)).toBe(first !== -1);
+          }
+        }
+      }
+    });
+  }
+
+  test("random haystacks over a two letter alphabet", () => {
+    let seed = 1;
+    const random = () => (seed = (seed * 1103515245 + 12345) >>> 0) / 2 ** 32;
+    for (let round = 0; round < 300; round++) {
+      const haystack = Buffer.alloc(Math.floor(random() * 400) + 1);
+      for (let i = 0; i < haystack.length; i++) haystack[i] = random() < 0.5 ? 0x61 : 0x62;
+      const m = needleLengths[Math.floor(random() * needleLengths.length)];
+      let needle: Buffer;
+      if (m <= haystack.length && random() < 0.7) {
+        const at = Math.floor(random() * (haystack.length - m + 1));
+        needle = Buffer.from(haystack.subarray(at, at + m));
+      } else {
+        needle = Buffer.alloc(m);
+        for (let i = 0; i < m; i++) needle[i] = random() < 0.5 ? 0x61 : 0x62;
+      }
+      check(haystack, needle);
+    }
+  });
+
+  test("ucs2 searches by whole code units, from odd offsets too", () => {
+    for (const units of [1, 2, 8, 16, 17, 64, 65, 150]) {
+      const needle = Buffer.from("é".repeat(units - 1) + "z", "ucs2");
+      for (const size of [units, units + 1, units + 16, 3 * units + 40]) {
+        // Even sized haystacks: Node itself reads odd ones inconsistently
+        const haystack = Buffer.from("a".repeat(size), "ucs2");
+        check(haystack, needle, "ucs2");
+        needle.copy(haystack, 0);
+        check(haystack, needle, "ucs2");
+        needle.copy(haystack, haystack.length - needle.length);
+        check(haystack, needle, "ucs2");
+      }
+    }
+
+    // A match only at an odd byte offset is not a ucs2 match.
+    const haystack = Buffer.from([0x00, 0x61, 0x00, 0x62, 0x00, 0x00]);
+    const needle = Buffer.from("ab", "ucs2");
+    expect(haystack.indexOf(needle)).toBe(1);
+    expect(haystack.indexOf(needle, 0, "ucs2")).toBe(-1);
+    expect(haystack.lastIndexOf(needle, undefined, "ucs2")).toBe(-1);
+    expect(haystack.indexOf("ab", "ucs2")).toBe(-1);
+    expect(haystack.includes("ab", "ucs2")).toBe(false);
+
+    const aligned = Buffer.from("xxabxxab", "ucs2");
+    // Odd offsets round down to the code unit they fall in
+    expect(aligned.indexOf("ab", 3, "ucs2")).toBe(4);
+    expect(aligned.indexOf("ab", 5, "ucs2")).toBe(4);
+    expect(aligned.indexOf("ab", 7, "ucs2")).toBe(12);
+    expect(aligned.lastIndexOf("ab", 11, "ucs2")).toBe(4);
+    expect(aligned.lastIndexOf("ab", -3, "ucs2")).toBe(12);
+    // Rounding -1 down to a code unit would land on a match that runs past the end
+    expect(aligned.indexOf("b", -1, "ucs2")).toBe(-1);
+    expect(aligned.indexOf("b", -2, "ucs2")).toBe(14);
+  });
+
+  test("string needles are offset by their encoded length", () => {
+    const haystack = Buffer.from("aéaéaé");
+    for (const needle of ["é", "aé", "éa", "aéaéaé", "aéaéaéa"]) {
+      const bytes = Buffer.from(needle);
+      for (const offset of offsetsFor(haystack.length, bytes.length)) {
+        expect([haystack.indexOf(needle, offset), haystack.lastIndexOf(needle, offset)]).toEqual([
+          referenceSearch(haystack, bytes, offset, true),
+          referenceSearch(haystack, bytes, offset, false),
+        ]);
+      }
+    }
+  });
+
+  test("empty needles", () => {
+    const haystack = Buffer.from("abc");
+    expect(haystack.indexOf("")).toBe(0);
+    expect(haystack.indexOf("", 2)).toBe(2);
+    expect(haystack.indexOf("", 10)).toBe(3);
+    expect(haystack.indexOf("", -1)).toBe(2);
+    expect(haystack.indexOf("", -10)).toBe(0);
+    expect(haystack.lastIndexOf("")).toBe(3);
+    expect(haystack.lastIndexOf("", -10)).toBe(0);
+    expect(haystack.indexOf(Buffer.alloc(0), 1)).toBe(1);
+    expect(haystack.includes("")).toBe(true);
+  });
+});
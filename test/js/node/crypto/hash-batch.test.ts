@@ -0,0 +1,174 @@
+import { describe, expect, test } from "bun:test";
+import crypto from "node:crypto";
+
+// hashBatch(algorithm, inputs) and hashBatch(algorithm, buffer, offsets) must return exactly the
+// digests createHash() gives for each message, concatenated. SHA-256 goes through the multi-buffer
+// kernel where the CPU has one, so every length around its block and padding boundaries is checked.
+
+const { hashBatch } = crypto as typeof crypto & {
+  hashBatch(algorithm: string, inputs: ArrayBufferView[]): Buffer;
+  hashBatch(algorithm: string, buffer: ArrayBufferView, offsets: Uint32Array | number[]): Buffer;
+};
+
+function bytes(length: number, seed = 0) {
+  const data = Buffer.allocUnsafeSlow(length);
+  for (let i = 0; i < length; i++) data[i] = (i * 31 + seed) ^ (i >>> 8);
+  return data;
+}
+
+function expected(algorithm: string, messages: ArrayBufferView[]) {
+  return Buffer.concat(messages.map(message => crypto.createHash(algorithm).update(message).digest()));
+}
+
+// Lays the messages out back to back and returns the buffer and its offsets.
+function concatenated(messages: Uint8Array[]) {
+  const offsets = new Uint32Array(messages.length + 1);
+  for (let i = 0; i < messages.length; i++) offsets[i + 1] = offsets[i] + messages[i].length;
+  return { buffer: Buffer.concat(messages), offsets };
+}
+
+function expectCode(fn: () => unknown, code: string) {
+  let error: any;
+  try {
+    fn();
+  } catch (e) {
+    error = e;
+  }
+  expect(error?.code).toBe(code);
+}
+
+function expectBothForms(algorithm: string, messages: Uint8Array[]) {
+  const digests = expected(algorithm, messages);
+  expect(hashBatch(algorithm, messages).equals(digests)).toBe(true);
+  const { buffer, offsets } = concatenated(messages);
+  expect(hashBatch(algorithm, buffer, offsets).equals(digests)).toBe(true);
+  expect(hashBatch(algorithm, buffer, Array.from(offsets)).equals(digests)).toBe(true);
+}
+
+describe("hashBatch", () => {
+  for (const algorithm of ["sha256", "sha1", "sha512", "md5", "sha224"]) {
+    test(`${algorithm} of every length from 0 to 300`, () => {
+      const messages = Array.from({ length: 301 }, (_, length) => bytes(length, length));
+      expectBothForms(algorithm, messages);
+      // One length at a time, so each lands in every lane of the kernel with the others empty
+      for (let length = 0; length <= 300; length += 7) {
+        expectBothForms(algorithm, [bytes(length, 1)]);
+        expectBothForms(algorithm, [bytes(length, 1), bytes(0), bytes(300 - length, 2)]);
+      }
+    });
+  }
+
+  test("digests are in input order and the result is one Buffer", () => {
+    const messages = [bytes(5, 1), bytes(100, 2), bytes(0), bytes(64, 3)];
+    const result = hashBatch("sha256", messages);
+    expect(result).toBeInstanceOf(Buffer);
+    expect(result.length).toBe(4 * 32);
+    for (let i = 0; i < messages.length; i++) {
+      expect(result.subarray(i * 32, (i + 1) * 32).toString("hex")).toBe(crypto.createHash("sha256").update(messages[i]).digest("hex"));
+    }
+  });
+
+  test("messages the kernel leaves to the scalar path", () => {
+    const sizes = [16 * 1024 - 1, 16 * 1024, 16 * 1024 + 1, 3, 100_000, 0, 64, 1 << 20];
+    expectBothForms("sha256", sizes.map((size, i) => bytes(size, i)));
+  });
+
+  test("a batch big enough to be split into tasks", () => {
+    // Far past one task's worth of input, with the sizes varying so tasks end mid-pattern
+    const messages = Array.from({ length: 40_000 }, (_, i) => bytes((i * 2654435761) % 301, i));
+    for (const algorithm of ["sha256", "sha512"]) expectBothForms(algorithm, messages);
+
+    // Large messages between small ones
+    const mixed = Array.from({ length: 2000 }, (_, i) => bytes(i % 500 === 0 ? 200_000 + i : i % 97, i));
+    expectBothForms("sha256", mixed);
+
+    // Many empty messages
+    expectBothForms("sha256", Array.from({ length: 20_000 }, () => new Uint8Array(0)));
+  });
+
+  test("any ArrayBufferView, by its bytes", () => {
+    const backing = bytes(256, 9);
+    const views = [
+      new Uint16Array(backing.buffer, 2, 10),
+      new Float64Array(backing.buffer, 8, 3),
+      new DataView(backing.buffer, 1, 33),
+      backing.subarray(17, 90),
+    ];
+    const asBytes = views.map(view => new Uint8Array(view.buffer, view.byteOffset, view.byteLength));
+    expect(hashBatch("sha256", views).equals(expected("sha256", asBytes))).toBe(true);
+
+    // Offsets count bytes of the view, not elements, from its start
+    const wide = new Uint32Array(backing.buffer, 16, 8);
+    expect(hashBatch("sha256", wide, [0, 4, 32]).equals(expected("sha256", [backing.subarray(16, 20), backing.subarray(20, 48)]))).toBe(true);
+  });
+
+  test("offsets need not start at zero or reach the end", () => {
+    const data = bytes(100);
+    expect(hashBatch("sha256", data, [10, 20, 20, 50]).equals(expected("sha256", [data.subarray(10, 20), data.subarray(20, 20), data.subarray(20, 50)]))).toBe(true);
+    // One offset is no messages at all
+    expect(hashBatch("sha256", data, [0]).length).toBe(0);
+    expect(hashBatch("sha256", data, new Uint32Array([100])).length).toBe(0);
+    expect(hashBatch("sha256", []).length).toBe(0);
+  });
+
+  test("offsets out of order or out of range", () => {
+    const data = bytes(100);
+    for (const offsets of [
+      [0, 50, 49],
+      [0, 10, 5, 20],
+      [20, 10],
+      [0, 101],
+      [101],
+      [-1, 10],
+      [0, 1.5],
+      [0, NaN],
+      [0, Infinity],
+      new Uint32Array([0, 60, 30]),
+      new Uint32Array([0, 0xffffffff]),
+    ]) {
+      expectCode(() => hashBatch("sha256", data, offsets as number[]), "ERR_OUT_OF_RANGE");
+    }
+
+    expectCode(() => hashBatch("sha256", data, []), "ERR_INVALID_ARG_VALUE");
+    expectCode(() => hashBatch("sha256", data, new Uint32Array(0)), "ERR_INVALID_ARG_VALUE");
+    for (const offsets of [[0, "10"], [0, 10n], [0, null]]) {
+      expectCode(() => hashBatch("sha256", data, offsets as number[]), "ERR_INVALID_ARG_TYPE");
+    }
+    for (const offsets of [undefined, 10, new Int32Array([0, 10]), "0,10"]) {
+      expectCode(() => hashBatch("sha256", data, offsets as number[]), "ERR_INVALID_ARG_TYPE");
+    }
+  });
+
+  test("invalid inputs and algorithms", () => {
+    for (const inputs of [undefined, "abc", 5, {}, [bytes(1), "abc"], [bytes(1), null], [new ArrayBuffer(4)]]) {
+      expectCode(() => hashBatch("sha256", inputs as any), "ERR_INVALID_ARG_TYPE");
+    }
+    expectCode(() => hashBatch(5 as any, []), "ERR_INVALID_ARG_TYPE");
+    for (const algorithm of ["nope", "", "blake2b256"]) {
+      expect(() => hashBatch(algorithm, [bytes(1)])).toThrow("Digest method not supported");
+    }
+  });
+
+  test("a getter that detaches the buffer is caught before hashing", () => {
+    const data = new Uint8Array(new ArrayBuffer(64));
+    const offsets = [0, 32, 64];
+    Object.defineProperty(offsets, 1, {
+      get() {
+        data.buffer.transfer();
+        return 32;
+      },
+    });
+    expectCode(() => hashBatch("sha256", data, offsets), "ERR_OUT_OF_RANGE");
+
+    const inputs = [bytes(10), bytes(20)];
+    const detached = new Uint8Array(new ArrayBuffer(16));
+    Object.defineProperty(inputs, 1, {
+      get() {
+        detached.buffer.transfer();
+        return detached;
+      },
+    });
+    // The view was detached while the inputs were being read, so it hashes as empty
+    expect(hashBatch("sha256", inputs).equals(expected("sha256", [inputs[0], new Uint8Array(0)]))).toBe(true);
+  });
+});
@@ -0,0 +1,176 @@
+import { afterAll, beforeAll, describe, expect, test } from "bun:test";
+import { once } from "node:events";
+import { createServer, type Server } from "node:http";
+import type { AddressInfo } from "node:net";
+import { connect } from "node:net";
+
+// node:http remembers the Structure of a request's headers object per ordered list of well-known
+// header names. These send requests whose names line up with an earlier one but whose values,
+// duplicates, set-cookie headers or unknown names differ, and check every request still sees
+// exactly its own headers.
+
+type Seen = { method: string; headers: Record<string, string | string[]>; keys: string[]; rawHeaders: string[] };
+
+let server: Server;
+let port: number;
+
+beforeAll(async () => {
+  server = createServer((req, res) => {
+    const seen: Seen = {
+      method: req.method!,
+      headers: { ...req.headers } as Seen["headers"],
+      keys: Object.keys(req.headers),
+      rawHeaders: req.rawHeaders,
+    };
+    res.setHeader("Connection", "close");
+    res.end(JSON.stringify(seen));
+  });
+  server.listen(0, "127.0.0.1");
+  await once(server, "listening");
+  port = (server.address() as AddressInfo).port;
+});
+
+afterAll(() => {
+  server.close();
+});
+
+// Sends the headers verbatim, so names keep their case and duplicates stay duplicated.
+async function send(headers: [string, string][], method = "GET"): Promise<Seen> {
+  const socket = connect(port, "127.0.0.1");
+  await once(socket, "connect");
+  const lines = [`${method} / HTTP/1.1`, ...headers.map(([name, value]) => `${name}: ${value}`)];
+  socket.end(lines.join("\r\n") + "\r\n\r\n");
+
+  let response = "";
+  socket.setEncoding("latin1");
+  for await (const chunk of socket) response += chunk;
+  expect(response).toStartWith("HTTP/1.1 200");
+  return JSON.parse(response.slice(response.indexOf("\r\n\r\n") + 4));
+}
+
+function raw(headers: [string, string][]) {
+  return headers.flat();
+}
+
+describe("node:http headers with a cached shape", () => {
+  const base: [string, string][] = [
+    ["Host", "example.com"],
+    ["Accept", "text/html"],
+    ["User-Agent", "shape-test"],
+  ];
+
+  test("same names, different values", async () => {
+    for (let i = 0; i < 5; i++) {
+      const headers: [string, string][] = [
+        ["Host", `host-${i}.example.com`],
+        ["Accept", `type/${i}`],
+        ["User-Agent", `agent ${i}`],
+      ];
+      const seen = await send(headers);
+      expect(seen.headers).toEqual({ host: `host-${i}.example.com`, accept: `type/${i}`, "user-agent": `agent ${i}` });
+      expect(seen.keys).toEqual(["host", "accept", "user-agent"]);
+      expect(seen.rawHeaders).toEqual(raw(headers));
+    }
+  });
+
+  test("same names in another order is another shape", async () => {
+    await send(base);
+    const headers: [string, string][] = [
+      ["User-Agent", "reordered"],
+      ["Host", "example.com"],
+      ["Accept", "*/*"],
+    ];
+    const seen = await send(headers);
+    expect(seen.keys).toEqual(["user-agent", "host", "accept"]);
+    expect(seen.headers).toEqual({ "user-agent": "reordered", host: "example.com", accept: "*/*" });
+    expect(seen.rawHeaders).toEqual(raw(headers));
+  });
+
+  test("a duplicated header keeps the shape of its first appearance", async () => {
+    const headers: [string, string][] = [
+      ["Host", "example.com"],
+      ["Accept", "text/html"],
+      ["User-Agent", "dup"],
+      ["Accept", "application/json"],
+    ];
+    // The first of these may build the Structure, the rest reuse it; all must agree.
+    const first = await send(headers);
+    await send(base);
+    const second = await send(headers);
+    expect(second).toEqual(first);
+    expect(first.keys).toEqual(["host", "accept", "user-agent"]);
+    expect(first.rawHeaders).toEqual(raw(headers));
+    expect(first.headers.host).toBe("example.com");
+    expect(first.headers["user-agent"]).toBe("dup");
+    expect(String(first.headers.accept)).toContain("application/json");
+
+    // And a request shaped like it without the duplicate is not given the duplicate's value.
+    const plain = await send(base);
+    expect(plain.headers.accept).toBe("text/html");
+  });
+
+  test("set-cookie is an array in both the cached and uncached object", async () => {
+    const oneCookie: [string, string][] = [
+      ["Host", "example.com"],
+      ["Set-Cookie", "a=1"],
+      ["Accept", "text/html"],
+    ];
+    const twoCookies: [string, string][] = [
+      ["Host", "example.com"],
+      ["Set-Cookie", "a=1"],
+      ["Accept", "text/html"],
+      ["Set-Cookie", "b=2"],
+    ];
+
+    for (let i = 0; i < 3; i++) {
+      const one = await send(oneCookie);
+      expect(one.headers["set-cookie"]).toEqual(["a=1"]);
+      expect(one.keys).toEqual(["host", "set-cookie", "accept"]);
+      expect(one.rawHeaders).toEqual(raw(oneCookie));
+
+      // Same shape, one more value: the array is fresh per request.
+      const two = await send(twoCookies);
+      expect(two.headers["set-cookie"]).toEqual(["a=1", "b=2"]);
+      expect(two.keys).toEqual(["host", "set-cookie", "accept"]);
+      expect(two.rawHeaders).toEqual(raw(twoCookies));
+    }
+  });
+
+  test("unknown headers next to a cached shape", async () => {
+    await send(base);
+    await send(base);
+
+    const headers: [string, string][] = [...base, ["X-Custom-Header", "Mixed Case"]];
+    const seen = await send(headers);
+    expect(seen.headers).toEqual({
+      host: "example.com",
+      accept: "text/html",
+      "user-agent": "shape-test",
+      "x-custom-header": "Mixed Case",
+    });
+    expect(seen.keys).toEqual(["host", "accept", "user-agent", "x-custom-header"]);
+    expect(seen.rawHeaders).toEqual(raw(headers));
+
+    // An unknown name before the known ones, then the known shape again.
+    const leading: [string, string][] = [["X-First", "1"], ...base];
+    const leadingSeen = await send(leading);
+    expect(leadingSeen.keys).toEqual(["x-first", "host", "accept", "user-agent"]);
+    expect(leadingSeen.rawHeaders).toEqual(raw(leading));
+
+    const again = await send(base);
+    expect(again.headers).toEqual({ host: "example.com", accept: "text/html", "user-agent": "shape-test" });
+    expect(again.headers).not.toHaveProperty("x-custom-header");
+    expect(again.headers).not.toHaveProperty("x-first");
+  });
+
+  test("a request's headers object does not share state with the next one", async () => {
+    const seen: Seen[] = [];
+    for (const method of ["GET", "POST", "PUT", "DELETE", "PATCH"]) {
+      seen.push(await send(base, method));
+    }
+    expect(seen.map(s => s.method)).toEqual(["GET", "POST", "PUT", "DELETE", "PATCH"]);
+    for (const s of seen) {
+      expect(s.headers).toEqual({ host: "example.com", accept: "text/html", "user-agent": "shape-test" });
+    }
+  });
+});
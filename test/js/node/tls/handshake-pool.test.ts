@@ -0,0 +1,63 @@
+import { expect, test } from "bun:test";
+import { mkdtempSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { connect } from "node:tls";
+
+const serverSource = `
+const dir = process.env.CERT_DIR;
+const server = Bun.listen({
+  hostname: "127.0.0.1",
+  port: 0,
+  tls: { cert: Bun.file(dir + "/cert.pem"), key: Bun.file(dir + "/key.pem") },
+  socket: { data: (socket, data) => socket.write(data) },
+});
+console.log(server.port);
+`;
+
+function echo(port: number, message: string) {
+  const { promise, resolve, reject } = Promise.withResolvers<{ cipher: string; reply: string }>();
+  const socket = connect({
+    host: "127.0.0.1",
+    port,
+    rejectUnauthorized: false,
+    ciphers: "AES128-GCM-SHA256",
+    maxVersion: "TLSv1.2",
+  });
+  socket.on("error", reject);
+  socket.once("secureConnect", () => socket.write(message));
+  socket.once("data", data => {
+    resolve({ cipher: socket.getCipher().name, reply: data.toString() });
+    socket.destroy();
+  });
+  return promise;
+}
+
+// With RSA key exchange the server decrypts the pre-master secret on the handshake pool. The
+// client's ClientKeyExchange, ChangeCipherSpec and Finished go out as one flight, so the records
+// behind the key exchange are still unread when the decryption suspends the handshake.
+test("TLS 1.2 RSA key exchange completes when its private key operation runs on the handshake pool", async () => {
+  const dir = mkdtempSync(join(tmpdir(), "handshake-pool-"));
+  const openssl = Bun.spawnSync(
+    ["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "1"]
+      .concat(["-subj", "/CN=localhost", "-keyout", join(dir, "key.pem"), "-out", join(dir, "cert.pem")]),
+  );
+  expect(openssl.exitCode).toBe(0);
+
+  const server = Bun.spawn({
+    cmd: [process.execPath, "-e", serverSource],
+    env: { ...process.env, CERT_DIR: dir, BUN_TLS_HANDSHAKE_THREADS: "2" },
+    stdout: "pipe",
+    stderr: "inherit",
+  });
+  try {
+    const { value } = await server.stdout.getReader().read();
+    const port = Number(new TextDecoder().decode(value));
+
+    for (let i = 0; i < 10; i++) {
+      expect(await echo(port, `hello ${i}`)).toEqual({ cipher: "AES128-GCM-SHA256", reply: `hello ${i}` });
+    }
+  } finally {
+    server.kill();
+  }
+});
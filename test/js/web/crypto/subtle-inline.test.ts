@@ -0,0 +1,141 @@
+import { describe, expect, test } from "bun:test";
+import nodeCrypto from "node:crypto";
+
+// Digests, HMAC and AES over at most 4 KiB run on the calling thread instead of the work pool.
+// Their promises must still settle from a later task, never during the call or its microtasks,
+// failures must still reject, and the results must match the pool's on either side of the limit.
+
+const { subtle } = crypto;
+const inlineLimit = 4096;
+
+function bytes(length: number, seed = 1) {
+  const data = new Uint8Array(length);
+  for (let i = 0; i < length; i++) data[i] = (i * 31 + seed) & 0xff;
+  return data;
+}
+
+// Runs operation, checks its promise is still pending once the call and every queued microtask
+// have run, and returns what it settles to.
+async function expectSettlesLater<T>(operation: () => Promise<T>): Promise<T> {
+  let returned = false;
+  const promise = operation();
+  const settledAfterReturn = promise.then(
+    () => returned,
+    () => returned,
+  );
+  returned = true;
+  expect(Bun.peek.status(promise)).toBe("pending");
+  for (let i = 0; i < 10; i++) await Promise.resolve();
+  expect(Bun.peek.status(promise)).toBe("pending");
+  expect(await settledAfterReturn).toBe(true);
+  return promise;
+}
+
+async function keys() {
+  const raw = bytes(32, 7);
+  return {
+    hmac: await subtle.importKey("raw", raw, { name: "HMAC", hash: "SHA-256" }, false, ["sign", "verify"]),
+    cbc: await subtle.importKey("raw", raw, "AES-CBC", false, ["encrypt", "decrypt"]),
+    ctr: await subtle.importKey("raw", raw, "AES-CTR", false, ["encrypt", "decrypt"]),
+    gcm: await subtle.importKey("raw", raw, "AES-GCM", false, ["encrypt", "decrypt"]),
+    raw,
+  };
+}
+
+const iv = bytes(16, 3);
+const nonce = bytes(12, 5);
+
+describe("small WebCrypto operations", () => {
+  test("settle asynchronously", async () => {
+    const { hmac, cbc, ctr, gcm } = await keys();
+    const data = bytes(32);
+
+    for (const algorithm of ["SHA-1", "SHA-256", "SHA-384", "SHA-512"]) {
+      await expectSettlesLater(() => subtle.digest(algorithm, data));
+    }
+    const signature = await expectSettlesLater(() => subtle.sign("HMAC", hmac, data));
+    expect(await expectSettlesLater(() => subtle.verify("HMAC", hmac, signature, data))).toBe(true);
+
+    const cbcText = await expectSettlesLater(() => subtle.encrypt({ name: "AES-CBC", iv }, cbc, data));
+    expect(new Uint8Array(await expectSettlesLater(() => subtle.decrypt({ name: "AES-CBC", iv }, cbc, cbcText)))).toEqual(data);
+
+    const ctrParams = { name: "AES-CTR", counter: iv, length: 64 };
+    const ctrText = await expectSettlesLater(() => subtle.encrypt(ctrParams, ctr, data));
+    expect(new Uint8Array(await expectSettlesLater(() => subtle.decrypt(ctrParams, ctr, ctrText)))).toEqual(data);
+
+    const gcmParams = { name: "AES-GCM", iv: nonce, additionalData: bytes(20, 9) };
+    const gcmText = await expectSettlesLater(() => subtle.encrypt(gcmParams, gcm, data));
+    expect(new Uint8Array(await expectSettlesLater(() => subtle.decrypt(gcmParams, gcm, gcmText)))).toEqual(data);
+  });
+
+  test("failures still reject, asynchronously", async () => {
+    const { hmac, cbc, gcm } = await keys();
+    const data = bytes(32);
+
+    // A bad tag
+    const gcmParams = { name: "AES-GCM", iv: nonce };
+    const gcmText = new Uint8Array(await subtle.encrypt(gcmParams, gcm, data));
+    gcmText[gcmText.length - 1] ^= 1;
+    let error = await expectSettlesLater(() => subtle.decrypt(gcmParams, gcm, gcmText)).catch(e => e);
+    expect(error).toBeInstanceOf(DOMException);
+    expect(error.name).toBe("OperationError");
+
+    // Additional data that doesn't match
+    const tagged = await subtle.encrypt({ ...gcmParams, additionalData: bytes(8) }, gcm, data);
+    error = await expectSettlesLater(() => subtle.decrypt({ ...gcmParams, additionalData: bytes(9) }, gcm, tagged)).catch(e => e);
+    expect(error.name).toBe("OperationError");
+
+    // Bad padding, and a length that isn't a whole number of blocks
+    const cbcText = new Uint8Array(await subtle.encrypt({ name: "AES-CBC", iv }, cbc, data));
+    cbcText[cbcText.length - 1] ^= 0xff;
+    error = await expectSettlesLater(() => subtle.decrypt({ name: "AES-CBC", iv }, cbc, cbcText)).catch(e => e);
+    expect(error.name).toBe("OperationError");
+    error = await expectSettlesLater(() => subtle.decrypt({ name: "AES-CBC", iv }, cbc, bytes(17))).catch(e => e);
+    expect(error.name).toBe("OperationError");
+
+    // A wrong signature is false, not an error
+    const signature = new Uint8Array(await subtle.sign("HMAC", hmac, data));
+    signature[0] ^= 1;
+    expect(await expectSettlesLater(() => subtle.verify("HMAC", hmac, signature, data))).toBe(false);
+  });
+
+  test("results match node:crypto on both sides of the inline limit", async () => {
+    const { hmac, cbc, gcm, raw } = await keys();
+    for (const size of [0, 1, 15, 16, 17, inlineLimit - 16, inlineLimit - 1, inlineLimit, inlineLimit + 1, 4 * inlineLimit]) {
+      const data = bytes(size, size);
+
+      const digest = Buffer.from(await subtle.digest("SHA-256", data));
+      expect(digest.toString("hex")).toBe(nodeCrypto.createHash("sha256").update(data).digest("hex"));
+
+      const signature = Buffer.from(await subtle.sign("HMAC", hmac, data));
+      expect(signature.toString("hex")).toBe(nodeCrypto.createHmac("sha256", raw).update(data).digest("hex"));
+      expect(await subtle.verify("HMAC", hmac, signature, data)).toBe(true);
+
+      const cipher = nodeCrypto.createCipheriv("aes-256-cbc", raw, iv);
+      const cbcText = Buffer.from(await subtle.encrypt({ name: "AES-CBC", iv }, cbc, data));
+      expect(cbcText.equals(Buffer.concat([cipher.update(data), cipher.final()]))).toBe(true);
+      expect(new Uint8Array(await subtle.decrypt({ name: "AES-CBC", iv }, cbc, cbcText))).toEqual(data);
+
+      // The additional data counts towards the limit too: 4080 + 16 runs inline, 4096 + 16 does not
+      const additionalData = bytes(16, 2);
+      const gcmParams = { name: "AES-GCM", iv: nonce, additionalData };
+      const gcmText = Buffer.from(await subtle.encrypt(gcmParams, gcm, data));
+      const gcmCipher = nodeCrypto.createCipheriv("aes-256-gcm", raw, nonce);
+      gcmCipher.setAAD(additionalData);
+      const expected = Buffer.concat([gcmCipher.update(data), gcmCipher.final(), gcmCipher.getAuthTag()]);
+      expect(gcmText.equals(expected)).toBe(true);
+      expect(new Uint8Array(await subtle.decrypt(gcmParams, gcm, gcmText))).toEqual(data);
+    }
+  });
+
+  test("many in flight at once all settle with their own result", async () => {
+    const { hmac } = await keys();
+    const messages = Array.from({ length: 2000 }, (_, i) => bytes(i % 300, i));
+    const signatures = await Promise.all(messages.map(message => subtle.sign("HMAC", hmac, message)));
+    const verified = await Promise.all(messages.map((message, i) => subtle.verify("HMAC", hmac, signatures[i], message)));
+    expect(verified.every(Boolean)).toBe(true);
+    // Swapped signatures don't verify
+    const swapped = await Promise.all(messages.slice(1, 50).map((message, i) => subtle.verify("HMAC", hmac, signatures[i], message)));
+    expect(swapped.some(Boolean)).toBe(false);
+  });
+});
@@ -0,0 +1,7 @@
+// Forwards the first broadcast back to the parent once it has subscribed
+const channel = new BroadcastChannel("structured-clone-fast-path");
+channel.onmessage = ({ data }) => {
+  postMessage(data);
+  channel.close();
+};
+postMessage("ready");
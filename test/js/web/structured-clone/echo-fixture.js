@@ -0,0 +1,4 @@
+// Echoes every message back so the parent sees values that crossed threads twice
+self.onmessage = ({ data }) => {
+  postMessage(data);
+};
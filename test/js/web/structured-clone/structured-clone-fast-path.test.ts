@@ -0,0 +1,191 @@
+import { deserialize, serialize } from "bun:jsc";
+import { describe, expect, test } from "bun:test";
+
+// bun:jsc serializes for storage, which always takes the wire format path, so it is the
+// reference the in-memory simple clone has to agree with.
+function wireClone<T>(value: T): T {
+  return deserialize(serialize(value));
+}
+
+function expectSameClone(value: unknown) {
+  const fast = structuredClone(value);
+  const wire = wireClone(value);
+  expect(fast).toStrictEqual(wire);
+  return [fast, wire] as const;
+}
+
+function nested(depth: number) {
+  let value: any = { leaf: "end" };
+  for (let i = 0; i < depth; i++) value = { next: value, items: [i] };
+  return value;
+}
+
+describe("structuredClone simple path", () => {
+  test("keeps own key order", () => {
+    const value = { b: 1, a: "two", c: null, d: undefined, e: true, f: [1.5, "x"] };
+    const [fast, wire] = expectSameClone(value);
+    expect(Object.keys(fast)).toEqual(["b", "a", "c", "d", "e", "f"]);
+    expect(Object.keys(fast)).toEqual(Object.keys(wire));
+  });
+
+  test("keeps integer-like keys ahead of named ones", () => {
+    const value = { z: 1, 2: "two", a: 3, 1: "one" };
+    const [fast] = expectSameClone(value);
+    expect(Object.keys(fast)).toEqual(["1", "2", "z", "a"]);
+  });
+
+  test("preserves shared and cyclic references", () => {
+    const shared = { n: 1 };
+    const value: any = { x: shared, y: shared, list: [shared, shared] };
+    value.self = value;
+    const [fast, wire] = [structuredClone(value), wireClone(value)];
+    for (const clone of [fast, wire]) {
+      expect(clone.x).not.toBe(shared);
+      expect(clone.x).toBe(clone.y);
+      expect(clone.list[0]).toBe(clone.x);
+      expect(clone.list[1]).toBe(clone.x);
+      expect(clone.self).toBe(clone);
+    }
+  });
+
+  test("keeps holes in arrays", () => {
+    const value = [1, , 3, , ,];
+    const [fast, wire] = [structuredClone(value), wireClone(value)];
+    for (const clone of [fast, wire]) {
+      expect(clone.length).toBe(5);
+      expect(1 in clone).toBe(false);
+      expect(3 in clone).toBe(false);
+      expect(clone[2]).toBe(3);
+    }
+  });
+
+  test("matches the wire format for arrays with a non-original structure", () => {
+    const named: any = [1, 2, 3];
+    named.extra = "named";
+    const [fast] = expectSameClone(named);
+    expect(fast.extra).toBe(wireClone(named).extra);
+
+    class List extends Array {}
+    const subclass = List.from([1, 2]);
+    const [clone] = expectSameClone(subclass);
+    expect(Object.getPrototypeOf(clone)).toBe(Array.prototype);
+
+    const mixed = [1, "a", { b: 2 }, [3.5]];
+    expectSameClone(mixed);
+  });
+
+  test("falls back for getters and non-Object prototypes", () => {
+    let calls = 0;
+    const withGetter = {
+      before: 1,
+      get value() {
+        calls++;
+        return "got";
+      },
+      after: 2,
+    };
+    const [fast] = expectSameClone(withGetter);
+    expect(calls).toBe(2);
+    expect(Object.getOwnPropertyDescriptor(fast, "value")).toEqual({
+      value: "got",
+      writable: true,
+      enumerable: true,
+      configurable: true,
+    });
+    expect(Object.keys(fast)).toEqual(["before", "value", "after"]);
+
+    const nullProto = Object.assign(Object.create(null), { a: 1, b: [2] });
+    const [nullClone] = expectSameClone(nullProto);
+    expect(Object.getPrototypeOf(nullClone)).toBe(Object.prototype);
+
+    class Point {
+      constructor(
+        public x: number,
+        public y: number,
+      ) {}
+    }
+    const [pointClone] = expectSameClone({ p: new Point(1, 2) });
+    expect(Object.getPrototypeOf(pointClone.p)).toBe(Object.prototype);
+
+    const hidden = Object.defineProperty({ shown: 1 }, "hidden", { value: 2, enumerable: false });
+    const [hiddenClone] = expectSameClone(hidden);
+    expect(Object.keys(hiddenClone)).toEqual(["shown"]);
+
+    const symbols = { [Symbol("s")]: 1, kept: 2 };
+    const [symbolClone] = expectSameClone(symbols);
+    expect(Object.getOwnPropertySymbols(symbolClone)).toEqual([]);
+  });
+
+  test("clones values on both sides of the depth limit", () => {
+    for (const depth of [30, 31, 32, 33, 64]) {
+      const value = nested(depth);
+      expectSameClone(value);
+      let cursor = structuredClone(value);
+      for (let i = depth - 1; i >= 0; i--) {
+        expect(cursor.items).toEqual([i]);
+        cursor = cursor.next;
+      }
+      expect(cursor).toEqual({ leaf: "end" });
+    }
+  });
+
+  test("rejects uncloneable values nested inside plain objects", () => {
+    expect(() => structuredClone({ a: [1, { f() {} }] })).toThrow();
+    expect(() => wireClone({ a: [1, { f() {} }] })).toThrow();
+  });
+});
+
+describe("postMessage simple path", () => {
+  const strings = {
+    empty: "",
+    latin1: "caf\xe9 na\xefve",
+    utf16: "\u{1f600} 中文 \ud800",
+    long: Buffer.alloc(64 * 1024, "abcÿ").toString("latin1"),
+    keys: { "été": 1, "\u{1f600}": [2, "中"] },
+  };
+
+  test("strings and keys survive crossing threads", async () => {
+    const worker = new Worker(new URL("./echo-fixture.js", import.meta.url).href);
+    const { promise, resolve, reject } = Promise.withResolvers<any>();
+    worker.onerror = reject;
+    worker.onmessage = ({ data }) => resolve(data);
+    worker.postMessage(strings);
+    const echoed = await promise;
+    worker.terminate();
+
+    expect(echoed).toStrictEqual(wireClone(strings));
+    expect(echoed.utf16).toBe(strings.utf16);
+    expect(echoed.long).toBe(strings.long);
+    expect(Object.keys(echoed.keys)).toEqual(Object.keys(strings.keys));
+  });
+
+  test("the same message can be delivered to every receiver", async () => {
+    const channel = new BroadcastChannel("structured-clone-fast-path");
+    const workers = [0, 1, 2].map(() => new Worker(new URL("./broadcast-fixture.js", import.meta.url).href));
+    try {
+      const ready = workers.map(
+        worker =>
+          new Promise<void>((resolve, reject) => {
+            worker.onerror = reject;
+            worker.onmessage = () => resolve();
+          }),
+      );
+      await Promise.all(ready);
+
+      const received = workers.map(
+        worker =>
+          new Promise<any>((resolve, reject) => {
+            worker.onerror = reject;
+            worker.onmessage = ({ data }) => resolve(data);
+          }),
+      );
+      channel.postMessage(strings);
+      for (const data of await Promise.all(received)) {
+        expect(data).toStrictEqual(wireClone(strings));
+      }
+    } finally {
+      channel.close();
+      for (const worker of workers) worker.terminate();
+    }
+  });
+});
@@ -0,0 +1,26 @@
+import { expect, test } from "bun:test";
+
+test("microtasks queued by one message event run before the next message is delivered", async () => {
+  const worker = new Worker(new URL("./message-order-fixture.js", import.meta.url).href);
+  const events: string[] = [];
+  const { promise, resolve, reject } = Promise.withResolvers<void>();
+
+  worker.onerror = reject;
+  worker.onmessage = ({ data }) => {
+    events.push(`message ${data}`);
+    queueMicrotask(() => events.push(`microtask ${data}`));
+    Promise.resolve().then(() => {
+      events.push(`promise ${data}`);
+      if (data === 19) resolve();
+    });
+  };
+
+  await promise;
+  worker.terminate();
+
+  const expected: string[] = [];
+  for (let i = 0; i < 20; i++) {
+    expected.push(`message ${i}`, `microtask ${i}`, `promise ${i}`);
+  }
+  expect(events).toEqual(expected);
+});
@@ -0,0 +1,4 @@
+// Posts a burst of messages so the parent receives them in one mailbox drain
+for (let i = 0; i < 20; i++) {
+  postMessage(i);
+}
@@ -226,6 +226,37 @@ static napi_value perform_set(const Napi::CallbackInfo &info) {
   return ok(env);
 }
 
+// Always the same address, so repeated calls hit the same entry of Bun's
+// named property cache.
+static const char cached_property_name[] = "cached";
+
+// get_cached_named_property(object)
+static napi_value get_cached_named_property(const Napi::CallbackInfo &info) {
+  napi_env env = info.Env();
+  napi_value value;
+  NODE_API_CALL(env,
+                napi_get_named_property(env, info[0], cached_property_name,
+                                        &value));
+  return value;
+}
+
+// has_cached_named_property(object)
+static napi_value has_cached_named_property(const Napi::CallbackInfo &info) {
+  napi_env env = info.Env();
+  bool has;
+  NODE_API_CALL(env, napi_has_named_property(env, info[0],
+                                             cached_property_name, &has));
+  return Napi::Boolean::New(env, has);
+}
+
+// set_cached_named_property(object, value)
+static napi_value set_cached_named_property(const Napi::CallbackInfo &info) {
+  napi_env env = info.Env();
+  NODE_API_CALL(env, napi_set_named_property(env, info[0],
+                                             cached_property_name, info[1]));
+  return env.Undefined();
+}
+
 static napi_value make_empty_array(const Napi::CallbackInfo &info) {
   napi_env env = info.Env();
   napi_value js_size = info[0];
@@ -326,6 +357,9 @@ void register_js_test_helpers(Napi::Env env, Napi::Object exports) {
   REGISTER_FUNCTION(env, exports, call_and_get_exception);
   REGISTER_FUNCTION(env, exports, perform_get);
   REGISTER_FUNCTION(env, exports, perform_set);
+  REGISTER_FUNCTION(env, exports, get_cached_named_property);
+  REGISTER_FUNCTION(env, exports, has_cached_named_property);
+  REGISTER_FUNCTION(env, exports, set_cached_named_property);
   REGISTER_FUNCTION(env, exports, throw_error);
   REGISTER_FUNCTION(env, exports, create_and_throw_error);
   REGISTER_FUNCTION(env, exports, make_empty_array);
@@ -164,6 +164,78 @@ nativeTests.test_set_property = () => {
   }
 };
 
+// Bun remembers where the last object of a shape kept a named property. Once the property is
+// deleted or redefined the object has another shape, so the lookup must miss and go the slow way.
+nativeTests.test_named_property_cache = gc => {
+  const get = nativeTests.get_cached_named_property;
+  const has = nativeTests.has_cached_named_property;
+  const set = nativeTests.set_cached_named_property;
+  const shaped = value => ({ before: 0, cached: value, after: 0 });
+
+  for (let i = 0; i < 3; i++) {
+    const object = shaped(i);
+    assert.strictEqual(get(object), i);
+    assert.strictEqual(has(object), true);
+    set(object, i + 1);
+    assert.strictEqual(object.cached, i + 1);
+  }
+
+  const deleted = shaped(1);
+  assert.strictEqual(get(deleted), 1);
+  delete deleted.cached;
+  assert.strictEqual(get(deleted), undefined);
+  assert.strictEqual(has(deleted), false);
+  set(deleted, 2);
+  assert.strictEqual(deleted.cached, 2);
+  assert.deepStrictEqual(Object.keys(deleted), ["before", "after", "cached"]);
+  console.log("deleted own property misses");
+
+  const inherits = Object.assign(Object.create({ cached: "prototype" }), shaped("own"));
+  assert.strictEqual(get(inherits), "own");
+  delete inherits.cached;
+  assert.strictEqual(get(inherits), "prototype");
+  assert.strictEqual(has(inherits), true);
+  console.log("deleted own property falls through to the prototype");
+
+  const accessor = shaped(1);
+  assert.strictEqual(get(accessor), 1);
+  let setterValue;
+  Object.defineProperty(accessor, "cached", {
+    get() {
+      return "getter";
+    },
+    set(value) {
+      setterValue = value;
+    },
+  });
+  assert.strictEqual(get(accessor), "getter");
+  assert.strictEqual(has(accessor), true);
+  set(accessor, 5);
+  assert.strictEqual(setterValue, 5);
+  assert.strictEqual(accessor.cached, "getter");
+  console.log("accessor replacing a data property is called");
+
+  const readOnly = shaped(1);
+  set(readOnly, 2);
+  Object.defineProperty(readOnly, "cached", { writable: false });
+  try {
+    set(readOnly, 3);
+  } catch {}
+  assert.strictEqual(readOnly.cached, 2);
+  assert.strictEqual(get(readOnly), 2);
+  console.log("read-only property is not overwritten");
+
+  // Objects that still have the original shape are unaffected by all of the above.
+  assert.strictEqual(get(shaped(7)), 7);
+
+  gc();
+  const fresh = { cached: "fresh" };
+  assert.strictEqual(get(fresh), "fresh");
+  set(fresh, "after gc");
+  assert.strictEqual(fresh.cached, "after gc");
+  console.log("lookups after gc see the new shape");
+};
+
 nativeTests.test_number_integer_conversions_from_js = () => {
   const i32 = { min: -(2 ** 31), max: 2 ** 31 - 1 };
   const u32Max = 2 ** 32 - 1;